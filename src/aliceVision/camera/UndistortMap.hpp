@@ -0,0 +1,319 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/Sampler.hpp>
+#include <aliceVision/camera/IntrinsicBase.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace aliceVision {
+namespace camera {
+
+/**
+ * @brief Pixel arithmetic used to apply an undistortion map.
+ *        Generic pixel types are interpolated in double precision (as image::Sampler2d),
+ *        float pixel types are interpolated in single precision.
+ */
+template<typename T>
+struct UndistortMapPixel
+{
+  typedef typename image::RealPixel<T>::real_type real_type;
+  typedef double weight_type;
+
+  static real_type toReal(const T& value) { return image::RealPixel<T>::convert_to_real(value); }
+  static T fromReal(const real_type& value) { return image::RealPixel<T>::convert_from_real(value); }
+};
+
+template<>
+struct UndistortMapPixel<float>
+{
+  typedef float real_type;
+  typedef float weight_type;
+
+  static real_type toReal(const float& value) { return value; }
+  static float fromReal(const real_type& value) { return value; }
+};
+
+template<>
+struct UndistortMapPixel<image::RGBfColor>
+{
+  typedef image::RGBfColor real_type;
+  typedef float weight_type;
+
+  static const real_type& toReal(const image::RGBfColor& value) { return value; }
+  static const image::RGBfColor& fromReal(const real_type& value) { return value; }
+};
+
+/**
+ * @brief Undistortion remap table: for each pixel of the undistorted image,
+ *        the coordinates of the corresponding pixel in the distorted image.
+ *
+ * Building the map evaluates the camera distortion model once per pixel,
+ * applying it to an image is a bilinear resampling.
+ */
+class UndistortMap
+{
+public:
+
+  /**
+   * @brief Build the undistortion map of a camera
+   * @param[in] intrinsic the camera intrinsic
+   * @param[in] width the image width
+   * @param[in] height the image height
+   * @param[in] ppCorrection offset applied to the distorted coordinates
+   */
+  UndistortMap(const IntrinsicBase& intrinsic, int width, int height, const Vec2& ppCorrection = Vec2(0.0, 0.0))
+    : _width(width)
+    , _height(height)
+    , _mapX(static_cast<std::size_t>(width) * height)
+    , _mapY(static_cast<std::size_t>(width) * height)
+  {
+    #pragma omp parallel for
+    for(int j = 0; j < _height; ++j)
+    {
+      float* mapX = &_mapX[static_cast<std::size_t>(j) * _width];
+      float* mapY = &_mapY[static_cast<std::size_t>(j) * _width];
+
+      for(int i = 0; i < _width; ++i)
+      {
+        // compute coordinates with distortion
+        const Vec2 disto_pix = intrinsic.get_d_pixel(Vec2(i, j)) + ppCorrection;
+
+        // pick pixel if it is in the image domain
+        // (same as Image::Contains on the truncated coordinates)
+        if(disto_pix(0) > -1.0 && disto_pix(0) < _width &&
+           disto_pix(1) > -1.0 && disto_pix(1) < _height)
+        {
+          mapX[i] = static_cast<float>(disto_pix(0));
+          mapY[i] = static_cast<float>(disto_pix(1));
+        }
+        else
+        {
+          mapX[i] = invalidCoordinate();
+          mapY[i] = invalidCoordinate();
+        }
+      }
+    }
+  }
+
+  inline int width() const { return _width; }
+  inline int height() const { return _height; }
+
+  /**
+   * @brief Get the memory size of the map in bytes
+   */
+  inline std::size_t memorySize() const
+  {
+    return (_mapX.size() + _mapY.size()) * sizeof(float);
+  }
+
+  /**
+   * @brief Undistort an image with a bilinear interpolation
+   * @param[in] imageIn the distorted image (of the map resolution)
+   * @param[out] imageOut the undistorted image
+   * @param[in] fillcolor color of the pixels outside of the distorted image
+   */
+  template<typename T>
+  void apply(const image::Image<T>& imageIn, image::Image<T>& imageOut, const T& fillcolor) const
+  {
+    typedef UndistortMapPixel<T> PixelT;
+    typedef typename PixelT::real_type real_type;
+    typedef typename PixelT::weight_type weight_type;
+
+    imageOut.resize(_width, _height, true, fillcolor);
+
+    const int lastCol = imageIn.Width() - 1;
+    const int lastRow = imageIn.Height() - 1;
+
+    #pragma omp parallel for
+    for(int j = 0; j < _height; ++j)
+    {
+      const float* mapX = &_mapX[static_cast<std::size_t>(j) * _width];
+      const float* mapY = &_mapY[static_cast<std::size_t>(j) * _width];
+      T* out = &imageOut(j, 0);
+
+      for(int i = 0; i < _width; ++i)
+      {
+        const float x = mapX[i];
+        const float y = mapY[i];
+
+        if(x == invalidCoordinate())
+          continue;
+
+        const float fx = std::floor(x);
+        const float fy = std::floor(y);
+        const weight_type dx = static_cast<weight_type>(x - fx);
+        const weight_type dy = static_cast<weight_type>(y - fy);
+
+        // neighbors outside of the image are replaced by the nearest border pixels
+        const int x0 = std::max(static_cast<int>(fx), 0);
+        const int y0 = std::max(static_cast<int>(fy), 0);
+        const int x1 = std::min(static_cast<int>(fx) + 1, lastCol);
+        const int y1 = std::min(static_cast<int>(fy) + 1, lastRow);
+
+        const real_type top = PixelT::toReal(imageIn(y0, x0)) * (weight_type(1) - dx) + PixelT::toReal(imageIn(y0, x1)) * dx;
+        const real_type bottom = PixelT::toReal(imageIn(y1, x0)) * (weight_type(1) - dx) + PixelT::toReal(imageIn(y1, x1)) * dx;
+
+        out[i] = PixelT::fromReal(top * (weight_type(1) - dy) + bottom * dy);
+      }
+    }
+  }
+
+private:
+  static inline float invalidCoordinate() { return -2.f; }
+
+  int _width;
+  int _height;
+  /// distorted image x coordinate per undistorted pixel
+  std::vector<float> _mapX;
+  /// distorted image y coordinate per undistorted pixel
+  std::vector<float> _mapY;
+};
+
+/**
+ * @brief Cache of undistortion maps, keyed by the intrinsic model, parameters and the image resolution.
+ *        The least recently used maps are removed when the memory budget is exceeded.
+ * @note thread-safe, a given map is computed only once
+ */
+class UndistortMapCache
+{
+public:
+
+  /**
+   * @brief Get the global undistortion map cache
+   */
+  static UndistortMapCache& get()
+  {
+    static UndistortMapCache cache;
+    return cache;
+  }
+
+  /**
+   * @brief Set the maximum memory size of the cached maps
+   * @param[in] maxMemSize the memory size in bytes
+   * @note removed maps remain valid for the users still holding them
+   */
+  void setMaxMemorySize(std::size_t maxMemSize)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maxMemSize = maxMemSize;
+    evict(nullptr);
+  }
+
+  /**
+   * @brief Get the undistortion map of a camera, compute it if needed
+   * @param[in] intrinsic the camera intrinsic
+   * @param[in] width the image width
+   * @param[in] height the image height
+   * @param[in] ppCorrection offset applied to the distorted coordinates
+   * @return the undistortion map
+   */
+  std::shared_ptr<const UndistortMap> getMap(const IntrinsicBase& intrinsic, int width, int height, const Vec2& ppCorrection = Vec2(0.0, 0.0))
+  {
+    const Key key(static_cast<int>(intrinsic.getType()), intrinsic.getParams(), width, height, ppCorrection(0), ppCorrection(1));
+
+    std::shared_ptr<Entry> entry;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _entries.find(key);
+      if(it == _entries.end())
+      {
+        entry = std::make_shared<Entry>();
+        _lru.push_front(key);
+        entry->lruPosition = _lru.begin();
+        _entries.emplace(key, entry);
+      }
+      else
+      {
+        entry = it->second;
+        _lru.splice(_lru.begin(), _lru, entry->lruPosition);
+      }
+    }
+
+    // only one thread computes a given map, others wait for it
+    std::lock_guard<std::mutex> entryLock(entry->mutex);
+    if(entry->map == nullptr)
+    {
+      ALICEVISION_LOG_DEBUG("Compute undistortion map (" << width << "x" << height << ").");
+      entry->map = std::make_shared<UndistortMap>(intrinsic, width, height, ppCorrection);
+
+      std::lock_guard<std::mutex> lock(_mutex);
+      entry->memSize = entry->map->memorySize();
+      _memSize += entry->memSize;
+      evict(entry.get());
+    }
+    return entry->map;
+  }
+
+  /**
+   * @brief Remove all the cached maps
+   */
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _lru.clear();
+    _memSize = 0;
+  }
+
+private:
+  typedef std::tuple<int, std::vector<double>, int, int, double, double> Key;
+
+  struct Entry
+  {
+    std::mutex mutex;
+    std::shared_ptr<const UndistortMap> map;
+    std::size_t memSize = 0;
+    std::list<Key>::iterator lruPosition;
+  };
+
+  UndistortMapCache() = default;
+
+  /**
+   * @brief Remove the least recently used maps until the memory budget is respected
+   * @param[in] keep entry to keep in the cache
+   * @note _mutex should be locked
+   */
+  void evict(const Entry* keep)
+  {
+    auto it = _lru.end();
+    while(_memSize > _maxMemSize && it != _lru.begin())
+    {
+      --it;
+      auto entryIt = _entries.find(*it);
+      Entry* entry = entryIt->second.get();
+
+      // do not remove the kept entry nor maps being computed (their size is still unknown)
+      if(entry == keep || entry->memSize == 0)
+        continue;
+
+      _memSize -= entry->memSize;
+      _entries.erase(entryIt);
+      it = _lru.erase(it);
+    }
+  }
+
+  std::mutex _mutex;
+  std::map<Key, std::shared_ptr<Entry>> _entries;
+  /// cached keys, most recently used first
+  std::list<Key> _lru;
+  std::size_t _memSize = 0;
+  std::size_t _maxMemSize = std::size_t(1024) * 1024 * 1024;
+};
+
+} // namespace camera
+} // namespace aliceVision
@@ -14,6 +14,7 @@
 #include <aliceVision/camera/cameraCommon.hpp>
 #include <aliceVision/camera/IntrinsicBase.hpp>
 #include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/camera/UndistortMap.hpp>
 
 #include <memory>
 
@@ -21,6 +22,7 @@ namespace aliceVision {
 namespace camera {
 
 /// Undistort an image according a given camera and its distortion model
+/// The undistortion map of the camera is computed once and reused for all the images of the same camera
 template <typename T>
 void UndistortImage(
   const image::Image<T>& imageIn,
@@ -47,22 +49,8 @@ void UndistortImage(
       }
     }
 
-    image_ud.resize(imageIn.Width(), imageIn.Height(), true, fillcolor);
-    const image::Sampler2d<image::SamplerLinear> sampler;
-
-    #pragma omp parallel for
-    for (int j = 0; j < imageIn.Height(); ++j)
-      for (int i = 0; i < imageIn.Width(); ++i)
-      {
-        const Vec2 undisto_pix(i,j);
-
-        // compute coordinates with distortion
-        const Vec2 disto_pix = intrinsicPtr->get_d_pixel(undisto_pix) + ppCorrection;
-
-        // pick pixel if it is in the image domain
-        if ( imageIn.Contains(disto_pix(1), disto_pix(0)) )
-          image_ud( j, i ) = sampler(imageIn, disto_pix(1), disto_pix(0));
-      }
+    const std::shared_ptr<const UndistortMap> undistortMap = UndistortMapCache::get().getMap(*intrinsicPtr, imageIn.Width(), imageIn.Height(), ppCorrection);
+    undistortMap->apply(imageIn, image_ud, fillcolor);
   }
 }
 
@@ -0,0 +1,129 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/camera.hpp>
+
+#define BOOST_TEST_MODULE undistortMap
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <cmath>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+
+/**
+ * @brief Reference undistortion: distortion model and sampler evaluated for each pixel
+ */
+template <typename T>
+void referenceUndistortImage(const image::Image<T>& imageIn, const IntrinsicBase& intrinsic, image::Image<T>& image_ud, T fillcolor)
+{
+  image_ud.resize(imageIn.Width(), imageIn.Height(), true, fillcolor);
+  const image::Sampler2d<image::SamplerLinear> sampler;
+
+  for(int j = 0; j < imageIn.Height(); ++j)
+    for(int i = 0; i < imageIn.Width(); ++i)
+    {
+      const Vec2 disto_pix = intrinsic.get_d_pixel(Vec2(i, j));
+      if(imageIn.Contains(disto_pix(1), disto_pix(0)))
+        image_ud(j, i) = sampler(imageIn, disto_pix(1), disto_pix(0));
+    }
+}
+
+/**
+ * @brief Return true if the bilinear neighborhood of the distorted pixel is inside the image
+ */
+bool isInterior(const IntrinsicBase& intrinsic, int i, int j, int width, int height)
+{
+  const Vec2 disto_pix = intrinsic.get_d_pixel(Vec2(i, j));
+  return disto_pix(0) >= 0.0 && disto_pix(0) < width - 1 &&
+         disto_pix(1) >= 0.0 && disto_pix(1) < height - 1;
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a PinholeRadialK3 camera and random float / RGB images
+// - Undistort the images with the precomputed map and with the reference per pixel evaluation
+// - Assert that both results are equal inside the image domain
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortMap_sameAsReference)
+{
+  const int width = 320;
+  const int height = 240;
+  const PinholeRadialK3 cam(width, height, 300, 160, 120, -0.2, 0.05, -0.01);
+
+  image::Image<float> imageFloat(width, height);
+  imageFloat.setRandom();
+
+  image::Image<image::RGBColor> imageRGB(width, height);
+  for(int i = 0; i < imageRGB.size(); ++i)
+  {
+    const unsigned char value = static_cast<unsigned char>((imageFloat(i) + 1.f) * 127.f);
+    imageRGB(i) = image::RGBColor(value, 255 - value, value / 2);
+  }
+
+  image::Image<float> undistortedFloat, referenceFloat;
+  UndistortImage(imageFloat, &cam, undistortedFloat, 0.f);
+  referenceUndistortImage(imageFloat, cam, referenceFloat, 0.f);
+
+  image::Image<image::RGBColor> undistortedRGB, referenceRGB;
+  UndistortImage(imageRGB, &cam, undistortedRGB, image::BLACK);
+  referenceUndistortImage(imageRGB, cam, referenceRGB, image::BLACK);
+
+  BOOST_CHECK_EQUAL(undistortedFloat.Width(), width);
+  BOOST_CHECK_EQUAL(undistortedFloat.Height(), height);
+
+  for(int j = 0; j < height; ++j)
+    for(int i = 0; i < width; ++i)
+    {
+      if(!isInterior(cam, i, j, width, height))
+      {
+        // fill color must be the same
+        if(referenceFloat(j, i) == 0.f)
+          BOOST_CHECK_EQUAL(undistortedFloat(j, i), 0.f);
+        continue;
+      }
+
+      BOOST_CHECK_SMALL(undistortedFloat(j, i) - referenceFloat(j, i), 1e-5f);
+      for(int c = 0; c < 3; ++c)
+        BOOST_CHECK_LE(std::abs(int(undistortedRGB(j, i)(c)) - int(referenceRGB(j, i)(c))), 1);
+    }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Request the undistortion maps of the same and different cameras
+// - Assert that the maps are computed only once per camera and resolution
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortMap_cache)
+{
+  UndistortMapCache& cache = UndistortMapCache::get();
+  cache.clear();
+
+  const PinholeRadialK3 camA(320, 240, 300, 160, 120, -0.2, 0.05, -0.01);
+  const PinholeRadialK3 camB(320, 240, 300, 160, 120, -0.2, 0.05, -0.01);
+  const PinholeRadialK3 camC(320, 240, 300, 160, 120, 0.1, 0.0, 0.0);
+
+  const std::shared_ptr<const UndistortMap> mapA = cache.getMap(camA, 320, 240);
+  const std::shared_ptr<const UndistortMap> mapB = cache.getMap(camB, 320, 240);
+  const std::shared_ptr<const UndistortMap> mapC = cache.getMap(camC, 320, 240);
+  const std::shared_ptr<const UndistortMap> mapHalf = cache.getMap(camA, 160, 120);
+
+  BOOST_CHECK(mapA == mapB);
+  BOOST_CHECK(mapA != mapC);
+  BOOST_CHECK(mapA != mapHalf);
+  BOOST_CHECK_EQUAL(mapHalf->width(), 160);
+  BOOST_CHECK_EQUAL(mapHalf->height(), 120);
+
+  // the least recently used maps are removed, the maps in use remain valid
+  cache.setMaxMemorySize(mapA->memorySize());
+  BOOST_CHECK_EQUAL(mapA->width(), 320);
+  BOOST_CHECK(cache.getMap(camA, 320, 240) != mapA);
+
+  cache.clear();
+}
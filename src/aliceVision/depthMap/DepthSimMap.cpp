@@ -419,9 +419,8 @@ void DepthSimMap::save(int rc, const StaticVector<int>& tcams)
     }
 
     using namespace imageIO;
-    OutputFileColorSpace colorspace(EImageColorSpace::NO_CONVERSION);
-    writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), width, height, depthMap->getDataWritable(), EImageQuality::LOSSLESS, colorspace,  metadata);
-    writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, scale), width, height, simMap->getDataWritable(), EImageQuality::OPTIMIZED,  colorspace, metadata);
+    writeMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), width, height, depthMap->getDataWritable(), EImageQuality::LOSSLESS, metadata);
+    writeMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, scale), width, height, simMap->getDataWritable(), EImageQuality::OPTIMIZED, metadata);
 }
 
 void DepthSimMap::load(int rc, int fromScale)
@@ -469,9 +468,8 @@ void DepthSimMap::saveRefine(int rc, std::string depthMapFileName, std::string s
     }
 
     using namespace imageIO;
-    OutputFileColorSpace colorspace(EImageColorSpace::NO_CONVERSION);
-    writeImage(depthMapFileName, width, height, depthMap, EImageQuality::LOSSLESS,  colorspace, metadata);
-    writeImage(simMapFileName, width, height, simMap, EImageQuality::OPTIMIZED,  colorspace, metadata);
+    writeMap(depthMapFileName, width, height, depthMap, EImageQuality::LOSSLESS, metadata);
+    writeMap(simMapFileName, width, height, simMap, EImageQuality::OPTIMIZED, metadata);
 }
 
 float DepthSimMap::getCellSmoothStep(int rc, const int cellId)
@@ -6,6 +6,7 @@
 
 #include "RefineRc.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/gpu/gpu.hpp>
 
 #include <aliceVision/mvsData/Point2d.hpp>
@@ -44,8 +45,7 @@ RefineRc::~RefineRc()
 
 void RefineRc::preloadSgmTcams_async()
 {
-  for(int tc : _sgmTCams.getData())
-    _sp->cps._ic.refreshData_async(tc);
+  _sp->cps._ic.prefetch(_sgmTCams.getData());
 }
 
 DepthSimMap* RefineRc::getDepthPixSizeMapFromSGM()
@@ -232,6 +232,8 @@ DepthSimMap* RefineRc::optimizeDepthSimMapCUDA(DepthSimMap* depthPixSizeMapVis,
 
 bool RefineRc::refinerc(bool checkIfExists)
 {
+    ALICEVISION_TRACE_ZONE("depthMap::refine");
+
     const IndexT viewId = _sp->mp->getViewId(_rc);
 
     if(_sp->mp->verbose)
@@ -283,6 +285,8 @@ bool RefineRc::refinerc(bool checkIfExists)
 
 void RefineRc::writeDepthMap()
 {
+  ALICEVISION_TRACE_ZONE("depthMap::writeDepthMap");
+
   _depthSimMapOpt->save(_rc, _refineTCams);
 }
 
@@ -361,6 +365,8 @@ void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp,
 
   for(const int rc : cams)
   {
+      ALICEVISION_TRACE_ZONE("depthMap::estimateAndRefineView");
+
       RefineRc sgmRefineRc(rc, sgmScale, sgmStep, &sp);
 
       sgmRefineRc.preloadSgmTcams_async();
@@ -374,6 +380,8 @@ void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp,
       // write results
       sgmRefineRc.writeDepthMap();
   }
+
+  ic.logStats();
 }
 
 
@@ -6,6 +6,7 @@
 
 #include "SemiGlobalMatchingRc.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/gpu/gpu.hpp>
 
 #include <aliceVision/depthMap/SemiGlobalMatchingRcTc.hpp>
@@ -413,6 +414,8 @@ void SemiGlobalMatchingRc::getSubDepthsForTCam( int tcamid, std::vector<float>&
 
 bool SemiGlobalMatchingRc::sgmrc(bool checkIfExists)
 {
+    ALICEVISION_TRACE_ZONE("depthMap::sgm");
+
     if(_sp->mp->verbose)
       ALICEVISION_LOG_DEBUG("SGM (rc: " << (_rc + 1) << " / " << _sp->mp->ncams << ")");
 
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/system/Tracer.hpp>
 
 #include <iostream>
 #include <iterator>
@@ -293,6 +294,8 @@ inline void loadDescsFromBinFile(
   if(fileIn.bad())
     throw std::runtime_error("Can't load descriptor binary file, '" + sfileNameDescs + "' is incorrect !");
 
+  ALICEVISION_TRACE_COUNTER(system::traceCounter::bytesRead, sizeof(std::size_t) + (vec_desc.size() - previousSize) * oneDescSize);
+
   fileIn.close();
 }
 
@@ -322,6 +325,8 @@ inline void saveDescsToBinFile(
   if(!file.good())
     throw std::runtime_error("Can't save descriptor binary file, '" + sfileNameDescs + "' is incorrect !");
 
+  ALICEVISION_TRACE_COUNTER(system::traceCounter::bytesWritten, sizeof(std::size_t) + cardDesc * VALUE::static_size * sizeof(typename VALUE::bin_type));
+
   file.close();
 }
 
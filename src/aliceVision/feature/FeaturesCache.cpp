@@ -0,0 +1,301 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "FeaturesCache.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace feature {
+
+namespace {
+
+/// version of the cache entries, to increment when the features file format changes
+const std::string cacheVersion = "1";
+
+/// the eviction removes entries until the cache size is below this ratio of the maximum size
+constexpr double evictionRatio = 0.9;
+
+constexpr std::uint64_t fnvOffsetBasis = 14695981039346656037ULL;
+constexpr std::uint64_t fnvPrime = 1099511628211ULL;
+
+/// FNV-1a 64 bits hash
+std::uint64_t hashBuffer(const char* data, std::size_t size, std::uint64_t hash = fnvOffsetBasis)
+{
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= fnvPrime;
+  }
+  return hash;
+}
+
+std::string toHex(std::uint64_t value)
+{
+  static const char digits[] = "0123456789abcdef";
+  std::string str(16, '0');
+  for(int i = 15; i >= 0; --i, value >>= 4)
+    str[i] = digits[value & 0xf];
+  return str;
+}
+
+/**
+ * @brief Copy a file in a temporary file next to the destination and rename it,
+ *        so the destination is never seen partially written
+ * @return false if the copy failed
+ */
+bool copyFileAtomic(const fs::path& src, const fs::path& dst)
+{
+  const fs::path tmpPath = dst.parent_path() / (dst.stem().string() + "." + fs::unique_path().string() + dst.extension().string());
+
+  boost::system::error_code ec;
+  fs::copy_file(src, tmpPath, fs::copy_option::overwrite_if_exists, ec);
+  if(!ec)
+    fs::rename(tmpPath, dst, ec);
+
+  if(ec)
+  {
+    boost::system::error_code removeEc;
+    fs::remove(tmpPath, removeEc);
+    return false;
+  }
+  return true;
+}
+
+std::uint64_t getFileSize(const fs::path& path)
+{
+  boost::system::error_code ec;
+  const std::uint64_t fileSize = fs::file_size(path, ec);
+  return ec ? 0 : fileSize;
+}
+
+/// check if a cache file is an entry (and not a temporary file): the keys contain no dot
+bool isCacheEntry(const fs::path& path)
+{
+  const std::string extension = path.extension().string();
+  return (extension == ".feat" || extension == ".desc") &&
+         path.stem().string().find('.') == std::string::npos;
+}
+
+} // namespace
+
+FeaturesCache::FeaturesCache(const std::string& folder, std::uint64_t maxSize)
+  : _folder(folder)
+  , _maxSize(maxSize)
+  , _size(0)
+{
+  boost::system::error_code ec;
+  fs::create_directories(_folder, ec);
+
+  if(!fs::is_directory(_folder))
+    throw std::runtime_error("Cannot create the features cache folder: " + _folder);
+
+  _size = computeSize();
+
+  ALICEVISION_LOG_INFO("Features cache: " << _folder << std::endl
+                       << "\t- size: " << _size / (1024 * 1024) << " MB" << std::endl
+                       << "\t- max size: " << (_maxSize == 0 ? std::string("no limit") : std::to_string(_maxSize / (1024 * 1024)) + " MB"));
+}
+
+std::string FeaturesCache::computeFileHash(const std::string& filePath)
+{
+  std::ifstream stream(filePath, std::ios::binary);
+  if(!stream.is_open())
+    throw std::runtime_error("Cannot read the file to hash: " + filePath);
+
+  std::vector<char> buffer(1024 * 1024);
+  std::uint64_t hash = fnvOffsetBasis;
+  std::uint64_t fileSize = 0;
+
+  while(stream)
+  {
+    stream.read(buffer.data(), buffer.size());
+    const std::size_t nbRead = static_cast<std::size_t>(stream.gcount());
+    hash = hashBuffer(buffer.data(), nbRead, hash);
+    fileSize += nbRead;
+  }
+
+  // the size limits the collisions between files of different sizes
+  hash = hashBuffer(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize), hash);
+  return toHex(hash);
+}
+
+std::string FeaturesCache::computeKey(const std::string& imageHash,
+                                      EImageDescriberType imageDescriberType,
+                                      const std::string& configuration)
+{
+  const std::string imageDescriberTypeName = EImageDescriberType_enumToString(imageDescriberType);
+  const std::string fullConfiguration = cacheVersion + "|" + imageDescriberTypeName + "|" + configuration;
+  const std::uint64_t configurationHash = hashBuffer(fullConfiguration.data(), fullConfiguration.size());
+
+  return imageHash + "_" + imageDescriberTypeName + "_" + toHex(configurationHash);
+}
+
+bool FeaturesCache::get(const std::string& key, const std::string& featuresPath, const std::string& descriptorsPath)
+{
+  const fs::path cacheFeaturesPath = getEntryPath(key, ".feat");
+  const fs::path cacheDescriptorsPath = getEntryPath(key, ".desc");
+
+  // the entry can be evicted by another process at any time: any error is a cache miss
+  if(fs::exists(cacheFeaturesPath) &&
+     fs::exists(cacheDescriptorsPath) &&
+     copyFileAtomic(cacheFeaturesPath, featuresPath) &&
+     copyFileAtomic(cacheDescriptorsPath, descriptorsPath))
+  {
+    // update the access time for the least recently used eviction
+    boost::system::error_code ec;
+    const std::time_t now = std::time(nullptr);
+    fs::last_write_time(cacheFeaturesPath, now, ec);
+    fs::last_write_time(cacheDescriptorsPath, now, ec);
+
+    ++_nbHits;
+    return true;
+  }
+
+  ++_nbMisses;
+  return false;
+}
+
+void FeaturesCache::put(const std::string& key, const std::string& featuresPath, const std::string& descriptorsPath)
+{
+  const fs::path cacheFeaturesPath = getEntryPath(key, ".feat");
+  const fs::path cacheDescriptorsPath = getEntryPath(key, ".desc");
+
+  boost::system::error_code ec;
+  fs::create_directories(cacheFeaturesPath.parent_path(), ec);
+
+  // the descriptors are added first: an entry is valid as soon as its features file exists
+  if(!copyFileAtomic(descriptorsPath, cacheDescriptorsPath) ||
+     !copyFileAtomic(featuresPath, cacheFeaturesPath))
+  {
+    ALICEVISION_LOG_WARNING("Cannot add the features '" << featuresPath << "' to the features cache.");
+    return;
+  }
+
+  _size += getFileSize(cacheFeaturesPath) + getFileSize(cacheDescriptorsPath);
+
+  if(_maxSize != 0 && _size > _maxSize)
+    evict();
+}
+
+void FeaturesCache::evict()
+{
+  if(_maxSize == 0)
+    return;
+
+  std::lock_guard<std::mutex> lock(_evictionMutex);
+
+  struct Entry
+  {
+    std::uint64_t size = 0;
+    std::time_t lastUse = 0;
+    std::vector<fs::path> files;
+  };
+
+  // list the entries of all the processes sharing the cache
+  std::map<std::string, Entry> entries;
+  std::uint64_t cacheSize = 0;
+  boost::system::error_code ec;
+
+  for(fs::recursive_directory_iterator it(_folder, ec), end; it != end; it.increment(ec))
+  {
+    if(ec || !fs::is_regular_file(it->path(), ec) || !isCacheEntry(it->path()))
+      continue;
+
+    const std::uint64_t fileSize = getFileSize(it->path());
+
+    Entry& entry = entries[it->path().stem().string()];
+    entry.size += fileSize;
+    entry.lastUse = std::max(entry.lastUse, fs::last_write_time(it->path(), ec));
+    entry.files.push_back(it->path());
+    cacheSize += fileSize;
+  }
+
+  const std::uint64_t targetSize = static_cast<std::uint64_t>(evictionRatio * _maxSize);
+
+  if(cacheSize > targetSize)
+  {
+    std::vector<const Entry*> sortedEntries;
+    sortedEntries.reserve(entries.size());
+    for(const auto& entryPair : entries)
+      sortedEntries.push_back(&entryPair.second);
+
+    // least recently used first
+    std::sort(sortedEntries.begin(), sortedEntries.end(), [](const Entry* a, const Entry* b) {
+      return a->lastUse < b->lastUse;
+    });
+
+    std::size_t nbEvicted = 0;
+    for(const Entry* entry : sortedEntries)
+    {
+      if(cacheSize <= targetSize)
+        break;
+
+      // remove the features file first to invalidate the entry
+      std::vector<fs::path> files = entry->files;
+      std::sort(files.begin(), files.end(), [](const fs::path& a, const fs::path& b) {
+        return a.extension().string() == ".feat" && b.extension().string() != ".feat";
+      });
+
+      for(const fs::path& file : files)
+        fs::remove(file, ec);
+
+      cacheSize -= entry->size;
+      ++nbEvicted;
+    }
+
+    ALICEVISION_LOG_DEBUG("Features cache: " << nbEvicted << " entries evicted.");
+  }
+
+  _size = cacheSize;
+}
+
+std::uint64_t FeaturesCache::computeSize() const
+{
+  std::uint64_t cacheSize = 0;
+  boost::system::error_code ec;
+
+  for(fs::recursive_directory_iterator it(_folder, ec), end; it != end; it.increment(ec))
+  {
+    if(ec || !fs::is_regular_file(it->path(), ec) || !isCacheEntry(it->path()))
+      continue;
+
+    cacheSize += getFileSize(it->path());
+  }
+  return cacheSize;
+}
+
+void FeaturesCache::logStatistics() const
+{
+  const std::size_t nbHits = _nbHits;
+  const std::size_t nbRequests = nbHits + _nbMisses;
+  const double hitRate = (nbRequests == 0) ? 0.0 : (100.0 * nbHits) / nbRequests;
+
+  ALICEVISION_LOG_INFO("Features cache statistics:" << std::endl
+                       << "\t- # hits: " << nbHits << std::endl
+                       << "\t- # misses: " << _nbMisses << std::endl
+                       << "\t- hit rate: " << hitRate << "%" << std::endl
+                       << "\t- size: " << _size / (1024 * 1024) << " MB");
+}
+
+std::string FeaturesCache::getEntryPath(const std::string& key, const std::string& extension) const
+{
+  // sub-folders limit the number of files per folder
+  return (fs::path(_folder) / key.substr(0, 2) / (key + extension)).string();
+}
+
+} // namespace feature
+} // namespace aliceVision
@@ -0,0 +1,115 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Persistent on-disk cache of extracted features and descriptors.
+ *
+ * The entries are addressed by the content of the image and the image describer configuration,
+ * so the same image extracted with the same describer and preset is only computed once
+ * whatever the input SfMData or the output folder.
+ *
+ * Files are written in a temporary file and renamed, so the cache can be shared between
+ * several processes (e.g. parallel rangeStart jobs on a shared storage).
+ * When a maximum size is set, the least recently used entries are evicted.
+ */
+class FeaturesCache
+{
+public:
+
+  /**
+   * @param[in] folder The cache folder (created if needed)
+   * @param[in] maxSize The maximum cache size in bytes (0 for no limit)
+   */
+  FeaturesCache(const std::string& folder, std::uint64_t maxSize = 0);
+
+  /**
+   * @brief Compute a hash of the content of a file
+   * @param[in] filePath The file path
+   * @return the hash as an hexadecimal string
+   */
+  static std::string computeFileHash(const std::string& filePath);
+
+  /**
+   * @brief Compute the cache key of an image extraction
+   * @param[in] imageHash The image content hash (see computeFileHash)
+   * @param[in] imageDescriberType The image describer type
+   * @param[in] configuration The image describer configuration (preset, parameters, cpu/gpu)
+   * @return the cache key
+   */
+  static std::string computeKey(const std::string& imageHash,
+                                EImageDescriberType imageDescriberType,
+                                const std::string& configuration);
+
+  /**
+   * @brief Copy the cached features and descriptors of a key to the given paths
+   * @param[in] key The cache key
+   * @param[in] featuresPath The output features file path
+   * @param[in] descriptorsPath The output descriptors file path
+   * @return true if the entry was found (cache hit)
+   */
+  bool get(const std::string& key, const std::string& featuresPath, const std::string& descriptorsPath);
+
+  /**
+   * @brief Add the features and descriptors files of a key to the cache
+   * @param[in] key The cache key
+   * @param[in] featuresPath The features file path
+   * @param[in] descriptorsPath The descriptors file path
+   */
+  void put(const std::string& key, const std::string& featuresPath, const std::string& descriptorsPath);
+
+  /**
+   * @brief Remove the least recently used entries until the cache size is below the maximum size
+   */
+  void evict();
+
+  /**
+   * @brief Get the current cache size (all entries, including those of other processes)
+   * @return the cache size in bytes
+   */
+  std::uint64_t computeSize() const;
+
+  std::size_t getNbHits() const
+  {
+    return _nbHits;
+  }
+
+  std::size_t getNbMisses() const
+  {
+    return _nbMisses;
+  }
+
+  /**
+   * @brief Log the number of hits / misses and the hit rate
+   */
+  void logStatistics() const;
+
+private:
+  std::string getEntryPath(const std::string& key, const std::string& extension) const;
+
+  const std::string _folder;
+  const std::uint64_t _maxSize;
+  /// estimation of the cache size, updated on put and refreshed by the eviction
+  std::atomic<std::uint64_t> _size;
+  std::atomic<std::size_t> _nbHits{0};
+  std::atomic<std::size_t> _nbMisses{0};
+  std::mutex _evictionMutex;
+};
+
+} // namespace feature
+} // namespace aliceVision
@@ -0,0 +1,108 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/FeaturesCache.hpp>
+
+#define BOOST_TEST_MODULE FeaturesCache
+#include <boost/test/included/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+void writeFile(const fs::path& path, const std::string& content)
+{
+  std::ofstream stream(path.string(), std::ios::binary);
+  stream << content;
+}
+
+std::string readFile(const fs::path& path)
+{
+  std::ifstream stream(path.string(), std::ios::binary);
+  std::stringstream ss;
+  ss << stream.rdbuf();
+  return ss.str();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(FeaturesCache_key)
+{
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path("featuresCache_%%%%%%");
+  fs::create_directories(folder);
+
+  writeFile(folder / "a.jpg", "image content A");
+  writeFile(folder / "a_copy.jpg", "image content A");
+  writeFile(folder / "b.jpg", "image content B");
+
+  const std::string hashA = FeaturesCache::computeFileHash((folder / "a.jpg").string());
+
+  // the hash only depends on the content
+  BOOST_CHECK_EQUAL(hashA, FeaturesCache::computeFileHash((folder / "a_copy.jpg").string()));
+  BOOST_CHECK_NE(hashA, FeaturesCache::computeFileHash((folder / "b.jpg").string()));
+
+  // the key depends on the describer type and configuration
+  const std::string key = FeaturesCache::computeKey(hashA, EImageDescriberType::SIFT, "normal|cpu");
+  BOOST_CHECK_EQUAL(key, FeaturesCache::computeKey(hashA, EImageDescriberType::SIFT, "normal|cpu"));
+  BOOST_CHECK_NE(key, FeaturesCache::computeKey(hashA, EImageDescriberType::SIFT, "high|cpu"));
+  BOOST_CHECK_NE(key, FeaturesCache::computeKey(hashA, EImageDescriberType::AKAZE, "normal|cpu"));
+
+  BOOST_CHECK_THROW(FeaturesCache::computeFileHash((folder / "missing.jpg").string()), std::runtime_error);
+
+  fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_CASE(FeaturesCache_getPutEvict)
+{
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path("featuresCache_%%%%%%");
+  const fs::path cacheFolder = folder / "cache";
+  fs::create_directories(folder);
+
+  const std::string featuresContent(1000, 'f');
+  const std::string descriptorsContent(1000, 'd');
+  writeFile(folder / "0.sift.feat", featuresContent);
+  writeFile(folder / "0.sift.desc", descriptorsContent);
+
+  // 5 entries of 2000 bytes fit in the cache
+  FeaturesCache cache(cacheFolder.string(), 10000);
+
+  const std::string key = FeaturesCache::computeKey("0123456789abcdef", EImageDescriberType::SIFT, "normal|cpu");
+
+  BOOST_CHECK(!cache.get(key, (folder / "out.feat").string(), (folder / "out.desc").string()));
+  cache.put(key, (folder / "0.sift.feat").string(), (folder / "0.sift.desc").string());
+  BOOST_CHECK(cache.get(key, (folder / "out.feat").string(), (folder / "out.desc").string()));
+
+  BOOST_CHECK_EQUAL(readFile(folder / "out.feat"), featuresContent);
+  BOOST_CHECK_EQUAL(readFile(folder / "out.desc"), descriptorsContent);
+  BOOST_CHECK_EQUAL(cache.getNbHits(), 1);
+  BOOST_CHECK_EQUAL(cache.getNbMisses(), 1);
+  BOOST_CHECK_EQUAL(cache.computeSize(), 2000);
+
+  // a new cache instance on the same folder sees the entry
+  {
+    FeaturesCache otherCache(cacheFolder.string(), 10000);
+    BOOST_CHECK(otherCache.get(key, (folder / "out2.feat").string(), (folder / "out2.desc").string()));
+  }
+
+  // adding more entries than the maximum size evicts the oldest ones
+  for(int i = 1; i < 10; ++i)
+  {
+    const std::string otherKey = FeaturesCache::computeKey("0123456789abcdef", EImageDescriberType::SIFT, "config" + std::to_string(i));
+    cache.put(otherKey, (folder / "0.sift.feat").string(), (folder / "0.sift.desc").string());
+  }
+
+  BOOST_CHECK(cache.computeSize() <= 10000);
+
+  fs::remove_all(folder);
+}
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "aliceVision/numeric/numeric.hpp"
+#include <aliceVision/system/Tracer.hpp>
 #include <iostream>
 #include <iterator>
 #include <fstream>
@@ -160,6 +161,8 @@ inline void saveFeatsToFile(
   if(!file.good())
     throw std::runtime_error("Can't save features file, '" + sfileNameFeats + "' is incorrect !");
 
+  ALICEVISION_TRACE_COUNTER(system::traceCounter::bytesWritten, file.tellp());
+
   file.close();
 }
 
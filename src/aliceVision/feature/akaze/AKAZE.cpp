@@ -115,75 +115,97 @@ float computeAutomaticContrastFactor(const image::Image<float>& image,
 }
 
 /**
- * @brief Compute an AKAZE slice
- * @param[in] src Input image for the given octave
+ * @brief Compute the nonlinear evolution image of an AKAZE slice
+ * @param[in] src Input image for the given octave (previous slice)
  * @param[in] p Octave index
  * @param[in] q Slice index
  * @param[in] nbSlice Slices per octave
  * @param[in] sigma0 First octave initial scale
  * @param[in] contrastFactor
- * @param Li Diffusion image
- * @param Lx X derivatives
- * @param Ly Y derivatives
- * @param Lhess Det(Hessian)
+ * @param[out] Li Diffusion image
+ * @note each slice depends on the previous one, only the internal
+ *       image operations are parallelized here
  */
-void computeAKAZESlice(const image::Image<float>& src,
-                       const int p,
-                       const int q,
-                       const int nbSlice,
-                       const float sigma0,
-                       const float contrastFactor,
-                       image::Image<float>& Li,
-                       image::Image<float>& Lx,
-                       image::Image<float>& Ly,
-                       image::Image<float>& Lhess)
+void computeAKAZESliceEvolution(const image::Image<float>& src,
+                                const int p,
+                                const int q,
+                                const int nbSlice,
+                                const float sigma0,
+                                const float contrastFactor,
+                                image::Image<float>& Li)
 {
-  const float sigmaCur = sigma(sigma0, p, q, nbSlice);
-  const float ratio = 1 << p; //pow(2,p);
-  const int sigmaScale = MathTrait<float>::round(sigmaCur * derivativeFactor / ratio);
-
-  image::Image<float> smoothed;
-
   if(p == 0 && q == 0)
   {
     // compute new image
     image::ImageGaussianFilter(src , sigma0 , Li, 0, 0);
+    return;
+  }
+
+  // general case
+  image::Image<float> in;
+  if( q == 0 )
+  {
+    image::ImageHalfSample(src , in);
   }
   else
   {
-    // general case
-    image::Image<float> in;
-    if( q == 0 )
-    {
-      image::ImageHalfSample(src , in);
-    }
-    else
-    {
-      in = src;
-    }
-
-    const float sigmaPrev = ( q == 0 ) ? sigma(sigma0, p - 1, nbSlice - 1, nbSlice) : sigma(sigma0, p, q - 1, nbSlice);
-
-    // compute non linear timing between two consecutive slices
-    const float t_prev = 0.5f * (sigmaPrev * sigmaPrev);
-    const float t_cur  = 0.5f * (sigmaCur * sigmaCur);
-    const float total_cycle_time = t_cur - t_prev;
+    in = src;
+  }
 
-    // compute first derivatives (Scharr scale 1, non normalized) for diffusion coef
-    image::ImageGaussianFilter(in , 1.f , smoothed, 0, 0 );
-    image::ImageScharrXDerivative(smoothed, Lx, false);
-    image::ImageScharrYDerivative(smoothed, Ly, false);
+  const float sigmaCur = sigma(sigma0, p, q, nbSlice);
+  const float sigmaPrev = ( q == 0 ) ? sigma(sigma0, p - 1, nbSlice - 1, nbSlice) : sigma(sigma0, p, q - 1, nbSlice);
+
+  // compute non linear timing between two consecutive slices
+  const float t_prev = 0.5f * (sigmaPrev * sigmaPrev);
+  const float t_cur  = 0.5f * (sigmaCur * sigmaCur);
+  const float total_cycle_time = t_cur - t_prev;
+
+  // compute first derivatives (Scharr scale 1, non normalized) for diffusion coef
+  image::Image<float> smoothed, Lx, Ly;
+  image::ImageGaussianFilter(in , 1.f , smoothed, 0, 0 );
+  image::ImageScharrXDerivative(smoothed, Lx, false);
+  image::ImageScharrYDerivative(smoothed, Ly, false);
+
+  // compute diffusion coefficient
+  image::Image<float> & diff = smoothed; // diffusivity image (reuse existing memory)
+  image::ImagePeronaMalikG2DiffusionCoef(Lx, Ly, contrastFactor, diff) ;
+
+  // compute FED cycles
+  std::vector<float> tau ;
+  image::FEDCycleTimings(total_cycle_time, 0.25f, tau);
+  image::ImageFEDCycle(in, diff, tau);
+
+  // evolution image (avoid a copy)
+  Li.swap(in);
+}
 
-    // compute diffusion coefficient
-    image::Image<float> & diff = smoothed; // diffusivity image (reuse existing memory)
-    image::ImagePeronaMalikG2DiffusionCoef(Lx, Ly, contrastFactor, diff) ;
+/**
+ * @brief Compute the derivatives and the Hessian response of an AKAZE slice
+ * @param[in] Li Diffusion image
+ * @param[in] p Octave index
+ * @param[in] q Slice index
+ * @param[in] nbSlice Slices per octave
+ * @param[in] sigma0 First octave initial scale
+ * @param[out] Lx X derivatives
+ * @param[out] Ly Y derivatives
+ * @param[out] Lhess Det(Hessian)
+ * @note only depends on the slice evolution image,
+ *       so all slices can be processed concurrently
+ */
+void computeAKAZESliceHessian(const image::Image<float>& Li,
+                              const int p,
+                              const int q,
+                              const int nbSlice,
+                              const float sigma0,
+                              image::Image<float>& Lx,
+                              image::Image<float>& Ly,
+                              image::Image<float>& Lhess)
+{
+  const float sigmaCur = sigma(sigma0, p, q, nbSlice);
+  const float ratio = 1 << p; //pow(2,p);
+  const int sigmaScale = MathTrait<float>::round(sigmaCur * derivativeFactor / ratio);
 
-    // compute FED cycles
-    std::vector<float> tau ;
-    image::FEDCycleTimings(total_cycle_time, 0.25f, tau);
-    image::ImageFEDCycle(in, diff, tau);
-    Li = in ; // evolution image
-  }
+  image::Image<float> smoothed;
 
   // compute Hessian response
   if(p == 0 && q == 0)
@@ -239,36 +261,50 @@ AKAZE::AKAZE(const image::Image<float>& image, const AKAZEOptions& options):
 void AKAZE::computeScaleSpace()
 {
   float contrastFactor = computeAutomaticContrastFactor( _input, 0.7f);
-  image::Image<float> input = _input;
+  const int nbSlices = _options.nbOctaves * _options.nbSlicePerOctave;
+
+  _evolution.resize(nbSlices);
 
-  // octave computation
+  // nonlinear evolution images
+  // each slice is computed from the previous one
   for(int p = 0; p < _options.nbOctaves; ++p)
   {
     contrastFactor *= (p == 0) ? 1.f : 0.75f;
 
     for(int q = 0; q < _options.nbSlicePerOctave; ++q)
     {
-      _evolution.emplace_back(TEvolution());
-      TEvolution& evo = _evolution.back();
+      const int sliceIndex = p * _options.nbSlicePerOctave + q;
+      const image::Image<float>& input = (sliceIndex == 0) ? _input : _evolution.at(sliceIndex - 1).cur;
 
-      // compute Slice at (p,q) index
-      computeAKAZESlice(input, p, q, _options.nbSlicePerOctave, _options.sigma0, contrastFactor,
-        evo.cur, evo.Lx, evo.Ly, evo.Lhess);
+      // compute slice evolution at (p,q) index
+      computeAKAZESliceEvolution(input, p, q, _options.nbSlicePerOctave, _options.sigma0, contrastFactor, _evolution.at(sliceIndex).cur);
+    }
+  }
+
+  // derivatives and Hessian responses
+  // slices are independent, largest slices (first octave) are scheduled first
+  #pragma omp parallel for schedule(dynamic)
+  for(int sliceIndex = 0; sliceIndex < nbSlices; ++sliceIndex)
+  {
+    const int p = sliceIndex / _options.nbSlicePerOctave;
+    const int q = sliceIndex % _options.nbSlicePerOctave;
+    TEvolution& evo = _evolution.at(sliceIndex);
 
-      // Prepare inputs for next slice
-      input = evo.cur;
+    computeAKAZESliceHessian(evo.cur, p, q, _options.nbSlicePerOctave, _options.sigma0, evo.Lx, evo.Ly, evo.Lhess);
+  }
 
-      // DEBUG octave image
+  // DEBUG octave image
 #if DEBUG_OCTAVE
-      std::stringstream str ;
-      str << "./" << "_oct_" << p << "_" << q << ".png" ;
-      image::Image<float> tmp = evo.cur;
-      convertScale(tmp);
-      image::Image< unsigned char > tmp2 ((tmp*255).cast<unsigned char>());
-      image::writeImage(str.str(), tmp2, image::EImageColorSpace::NO_CONVERSION);
-#endif // DEBUG_OCTAVE
-    }
+  for(int sliceIndex = 0; sliceIndex < nbSlices; ++sliceIndex)
+  {
+    std::stringstream str ;
+    str << "./" << "_oct_" << sliceIndex / _options.nbSlicePerOctave << "_" << sliceIndex % _options.nbSlicePerOctave << ".png" ;
+    image::Image<float> tmp = _evolution.at(sliceIndex).cur;
+    convertScale(tmp);
+    image::Image< unsigned char > tmp2 ((tmp*255).cast<unsigned char>());
+    image::writeImage(str.str(), tmp2, image::EImageColorSpace::NO_CONVERSION);
   }
+#endif // DEBUG_OCTAVE
 }
 
 void detectDuplicates(std::vector<std::pair<AKAZEKeypoint, bool>>& previous,
@@ -16,6 +16,7 @@
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/imageAlgo.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 
 #include "nanoflann.hpp"
@@ -460,6 +461,8 @@ void DelaunayGraphCut::initVertices()
 
 void DelaunayGraphCut::computeDelaunay()
 {
+    ALICEVISION_TRACE_ZONE("fuseCut::computeDelaunay");
+
     ALICEVISION_LOG_DEBUG("computeDelaunay GEOGRAM ...\n");
 
     assert(_verticesCoords.size() == _verticesAttr.size());
@@ -835,6 +838,8 @@ void DelaunayGraphCut::addHelperPoints(int nGridHelperVolumePointsDim, const Poi
 
 void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Point3d voxel[8], const FuseParams& params)
 {
+    ALICEVISION_TRACE_ZONE("fuseCut::fuseFromDepthMaps");
+
     ALICEVISION_LOG_INFO("fuseFromDepthMaps, maxVertices: " << params.maxPoints);
 
     std::vector<Point3d> verticesCoordsPrepare;
@@ -2493,6 +2498,8 @@ void DelaunayGraphCut::createDensePointCloud(Point3d hexah[8], const StaticVecto
 
 void DelaunayGraphCut::createGraphCut(Point3d hexah[8], const StaticVector<int>& cams, VoxelsGrid* ls, const std::string& folderName, const std::string& tmpCamsPtsFolderName, bool removeSmallSegments, const Point3d& spaceSteps)
 {
+  ALICEVISION_TRACE_ZONE("fuseCut::createGraphCut");
+
   initVertices();
 
   // Create tetrahedralization
@@ -2547,6 +2554,8 @@ void DelaunayGraphCut::reconstructGC(const Point3d* hexah)
 
 void DelaunayGraphCut::maxflow()
 {
+    ALICEVISION_TRACE_ZONE("fuseCut::maxflow");
+
     long t_maxflow = clock();
 
     ALICEVISION_LOG_INFO("Maxflow: start allocation.");
@@ -2749,6 +2758,8 @@ void DelaunayGraphCut::reconstructExpetiments(const StaticVector<int>& cams, con
 
 mesh::Mesh* DelaunayGraphCut::createMesh(bool filterHelperPointsTriangles)
 {
+    ALICEVISION_TRACE_ZONE("fuseCut::createMesh");
+
     ALICEVISION_LOG_INFO("Extract mesh from Graph Cut.");
 
     int nbSurfaceFacets = setIsOnSurface();
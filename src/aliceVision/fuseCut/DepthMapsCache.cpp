@@ -0,0 +1,118 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DepthMapsCache.hpp"
+#include <aliceVision/mvsData/imageIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+namespace aliceVision {
+namespace fuseCut {
+
+DepthMapsCache::DepthMapsCache(const mvsUtils::MultiViewParams* mp, mvsUtils::EFileType fileType, int scale, std::size_t maxMemSize)
+  : _mp(mp)
+  , _fileType(fileType)
+  , _scale(scale)
+  , _maxMemSize(maxMemSize)
+  , _depthMaps(mp->ncams)
+  , _loadMutexes(mp->ncams)
+{
+    _lruPositions.resize(_mp->ncams, _lruCamIds.end());
+}
+
+DepthMapsCache::~DepthMapsCache()
+{
+    system::MemoryBudget::get().track("depthMapsCache", -static_cast<std::int64_t>(_memSize));
+}
+
+void DepthMapsCache::insert(int camId, const DepthMapPtr& depthMap)
+{
+    const std::size_t depthMapSize = depthMap->values.size() * sizeof(float);
+
+    // remove the least recently used maps
+    // note: an evicted map stays valid for the consumers still using it
+    while(!_lruCamIds.empty() && _memSize + depthMapSize > _maxMemSize)
+    {
+        const int oldCamId = _lruCamIds.back();
+        const std::size_t oldDepthMapSize = _depthMaps[oldCamId]->values.size() * sizeof(float);
+        _memSize -= oldDepthMapSize;
+        system::MemoryBudget::get().track("depthMapsCache", -static_cast<std::int64_t>(oldDepthMapSize));
+        _depthMaps[oldCamId].reset();
+        _lruPositions[oldCamId] = _lruCamIds.end();
+        _lruCamIds.pop_back();
+        ++_stats.nbEvictions;
+    }
+
+    _depthMaps[camId] = depthMap;
+    _lruCamIds.push_front(camId);
+    _lruPositions[camId] = _lruCamIds.begin();
+    _memSize += depthMapSize;
+    system::MemoryBudget::get().track("depthMapsCache", static_cast<std::int64_t>(depthMapSize));
+}
+
+DepthMapsCache::DepthMapPtr DepthMapsCache::get(int camId)
+{
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        if(_depthMaps[camId] != nullptr)
+        {
+            _lruCamIds.splice(_lruCamIds.begin(), _lruCamIds, _lruPositions[camId]);
+            ++_stats.nbHits;
+            return _depthMaps[camId];
+        }
+    }
+
+    // only one thread decodes a given map, others wait for it
+    std::lock_guard<std::mutex> loadLock(_loadMutexes[camId]);
+
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        if(_depthMaps[camId] != nullptr)
+        {
+            // loaded by another thread in the meantime
+            _lruCamIds.splice(_lruCamIds.begin(), _lruCamIds, _lruPositions[camId]);
+            ++_stats.nbHits;
+            return _depthMaps[camId];
+        }
+    }
+
+    // decode without locking the cache
+    const system::Timer timer;
+    std::shared_ptr<DepthMap> depthMap = std::make_shared<DepthMap>();
+    imageIO::readMapLevel(mvsUtils::getFileNameFromIndex(_mp, camId, _fileType, _scale), 0, depthMap->width, depthMap->height, depthMap->values);
+    const double decodeTimeMs = timer.elapsedMs();
+
+    std::lock_guard<std::mutex> lock(_cacheMutex);
+    insert(camId, depthMap);
+    _stats.decodeTimeMs += decodeTimeMs;
+    ++_stats.nbMisses;
+
+    return depthMap;
+}
+
+DepthMapsCache::Stats DepthMapsCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_cacheMutex);
+    return _stats;
+}
+
+void DepthMapsCache::logStats() const
+{
+    const Stats stats = getStats();
+    const std::size_t nbRequests = stats.nbHits + stats.nbMisses;
+
+    ALICEVISION_LOG_INFO("Depth maps cache statistics:" << std::endl
+                         << "\t- requests: " << nbRequests << std::endl
+                         << "\t- hits: " << stats.nbHits << " (" << (nbRequests ? (100.0 * stats.nbHits / nbRequests) : 0.0) << "%)" << std::endl
+                         << "\t- misses: " << stats.nbMisses << std::endl
+                         << "\t- evictions: " << stats.nbEvictions << std::endl
+                         << "\t- decode time: " << system::prettyTime(stats.decodeTimeMs)
+                         << " (" << (stats.nbMisses ? (stats.decodeTimeMs / stats.nbMisses) : 0.0) << " ms per map)");
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,117 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/fileIO.hpp>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Cache of decoded depth maps (or any single channel float map), shared between threads.
+ *
+ * The cache size is a memory budget in bytes. Maps are evicted in least recently used order.
+ * Evicted maps remain valid as long as a consumer keeps a shared pointer on them.
+ */
+class DepthMapsCache
+{
+public:
+
+    /**
+     * @brief Decoded map
+     */
+    struct DepthMap
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<float> values;
+    };
+
+    typedef std::shared_ptr<const DepthMap> DepthMapPtr;
+
+    /**
+     * @brief Cache usage statistics
+     */
+    struct Stats
+    {
+        /// number of requests served from the cache
+        std::size_t nbHits = 0;
+        /// number of requests that needed to decode the map
+        std::size_t nbMisses = 0;
+        /// number of maps removed from the cache
+        std::size_t nbEvictions = 0;
+        /// total time spent decoding maps (milliseconds)
+        double decodeTimeMs = 0.0;
+    };
+
+    /**
+     * @param[in] mp the multi-view parameters
+     * @param[in] fileType the type of the cached maps
+     * @param[in] scale the scale of the cached maps (see mvsUtils::getFileNameFromIndex)
+     * @param[in] maxMemSize the maximum size of the cached maps in bytes
+     */
+    DepthMapsCache(const mvsUtils::MultiViewParams* mp, mvsUtils::EFileType fileType, int scale, std::size_t maxMemSize);
+    ~DepthMapsCache();
+
+    DepthMapsCache(const DepthMapsCache&) = delete;
+    DepthMapsCache& operator=(const DepthMapsCache&) = delete;
+
+    /**
+     * @brief Get the map of a camera, decode it if needed
+     * @param[in] camId the camera index
+     * @return the map (empty if the file cannot be read)
+     */
+    DepthMapPtr get(int camId);
+
+    /**
+     * @brief Get the cache usage statistics
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief Log the cache usage statistics
+     */
+    void logStats() const;
+
+private:
+    /**
+     * @brief Add a decoded map to the cache, evicting least recently used maps if needed
+     * @note _cacheMutex should be locked
+     */
+    void insert(int camId, const DepthMapPtr& depthMap);
+
+    const mvsUtils::MultiViewParams* _mp;
+    const mvsUtils::EFileType _fileType;
+    const int _scale;
+
+    /// maximum size of the cached maps (in bytes)
+    std::size_t _maxMemSize = 0;
+    /// current size of the cached maps (in bytes)
+    std::size_t _memSize = 0;
+
+    /// cached map per camera index (nullptr if not in cache)
+    std::vector<DepthMapPtr> _depthMaps;
+    /// camera indexes of the cached maps, most recently used first
+    std::list<int> _lruCamIds;
+    /// position of each camera index in _lruCamIds (_lruCamIds.end() if not in cache)
+    std::vector<std::list<int>::iterator> _lruPositions;
+    /// protects the cache content (_depthMaps, _lruCamIds, _lruPositions, _memSize, _stats)
+    mutable std::mutex _cacheMutex;
+    /// per camera mutex held while decoding, to avoid loading the same map twice
+    std::vector<std::mutex> _loadMutexes;
+
+    Stats _stats;
+};
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -5,7 +5,12 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "Fuser.hpp"
+#include "DepthMapsCache.hpp"
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
+#include <aliceVision/system/ProcessingPipeline.hpp>
+#include <aliceVision/system/Timer.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/Pixel.hpp>
@@ -67,6 +72,106 @@ Fuser::~Fuser()
 }
 
 
+namespace {
+
+/**
+ * @brief Remove the depths which are not consistent in enough cameras, and make strongly supported the
+ *        weakly supported depths which are consistent in enough cameras
+ * @return the number of remaining depth values
+ */
+int filterWithNumOfModals(const std::vector<unsigned char>& numOfModalsMap, int minNumOfModals, int minNumOfModalsWSP2SSP,
+                          std::vector<float>& depthMap, std::vector<float>& simMap)
+{
+    int nbDepthValues = 0;
+
+    for(std::size_t i = 0; i < depthMap.size(); i++)
+    {
+        // if the reference point is consistent in three target cameras and is denoted as weakly supported point
+        // make him strongly supported
+        if((numOfModalsMap.at(i) >= minNumOfModalsWSP2SSP - 1) && (simMap.at(i) >= 1.0f))
+        {
+            simMap[i] = simMap[i] - 2.0f;
+        }
+
+        // if it is conistent in only one camera and is weakly supported then remove him
+        // weakly supported point must be consisten in at least two cameras
+        if((numOfModalsMap.at(i) <= 1) && (simMap.at(i) >= 1.0f))
+        {
+            depthMap[i] = -1.0f;
+            simMap[i] = 1.0f;
+        }
+
+        // if it is not conistent in minimal number of cameras and is strongly supported then remove him
+        if((numOfModalsMap.at(i) < minNumOfModals - 1) && (simMap.at(i) < 1.0f))
+        {
+            depthMap[i] = -1.0f;
+            simMap[i] = 1.0f;
+        }
+
+        if(depthMap[i] > 0.0f)
+          ++nbDepthValues;
+    }
+    return nbDepthValues;
+}
+
+void checkDepthMapDimensions(const mvsUtils::MultiViewParams* mp, int rc, const std::vector<float>& depthMap, const std::vector<float>& simMap)
+{
+    const std::size_t nbPixels = static_cast<std::size_t>(mp->getWidth(rc)) * mp->getHeight(rc);
+
+    if((depthMap.empty()) || (simMap.empty()) || (depthMap.size() != nbPixels) || (simMap.size() != nbPixels))
+    {
+        std::stringstream s;
+        s << "Depth map filtering: bad image dimension for camera: " << mp->getViewId(rc) << "\n";
+        s << "depthMap size: " << depthMap.size() << ", simMap size: " << simMap.size() << ", width: " << mp->getWidth(rc) << ", height: " << mp->getHeight(rc);
+       throw std::runtime_error(s.str());
+    }
+}
+
+/**
+ * @brief Get the depth maps resolution level to read instead of sampling one value every @p step values
+ * @note each resolution level has 4 times less values than the previous one
+ * @param[in,out] step the sampling step, updated to the remaining sampling step in the returned level
+ * @return the resolution level
+ */
+int getSamplingLevel(int& step)
+{
+    int level = 0;
+    while(step >= 4)
+    {
+        step /= 4;
+        ++level;
+    }
+    return level;
+}
+
+/**
+ * @brief Get the bounding box of the projection of an hexahedron in a camera (in full resolution pixels)
+ * @return false if the hexahedron is not in front of the camera
+ */
+bool getHexahedronImageBBox(const mvsUtils::MultiViewParams* mp, int rc, const Point3d* hexah, Point2d& bboxMin, Point2d& bboxMax)
+{
+    const Point3d viewDir = (mp->iCamArr[rc] * Point2d(mp->getWidth(rc) / 2.0, mp->getHeight(rc) / 2.0)).normalize();
+
+    bboxMin = Point2d(std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    bboxMax = Point2d(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+
+    for(int i = 0; i < 8; ++i)
+    {
+        if(dot(hexah[i] - mp->CArr[rc], viewDir) <= 0.0)
+            return false;
+
+        Point2d pix;
+        mp->getPixelFor3DPoint(&pix, hexah[i], rc);
+        bboxMin.x = std::min(bboxMin.x, pix.x);
+        bboxMin.y = std::min(bboxMin.y, pix.y);
+        bboxMax.x = std::max(bboxMax.x, pix.x);
+        bboxMax.y = std::max(bboxMax.y, pix.y);
+    }
+    return true;
+}
+
+} // namespace
+
 /**
  * @brief 
  * 
@@ -81,7 +186,7 @@ Fuser::~Fuser()
  * @param[in] scale
  */
 bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc,
-                           StaticVector<int>* numOfPtsMap, StaticVector<float>* depthMap, StaticVector<float>* simMap,
+                           std::vector<int>& numOfPtsMap, const std::vector<float>& depthMap, const std::vector<float>& simMap,
                            int scale)
 {
     int w = mp->getWidth(rc) / scale;
@@ -102,7 +207,7 @@ bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc
 
     int d = pixSizeBall;
 
-    float sim = (*simMap)[cell.y * w + cell.x];
+    float sim = simMap[cell.y * w + cell.x];
     if(sim >= 1.0f)
     {
         d = pixSizeBallWSP;
@@ -116,14 +221,10 @@ bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc
     {
         for(ncell.y = std::max(0, cell.y - d); ncell.y <= std::min(h - 1, cell.y + d); ncell.y++)
         {
-            // printf("%i %i %i %i %i %i %i %i\n",ncell.x,ncell.y,w,h,w*h,depthMap->size(),cam,scale);
-            float depth = (*depthMap)[ncell.y * w + ncell.x];
-            // Point3d p1 = mp->CArr[rc] +
-            // (mp->iCamArr[rc]*Point2d((float)ncell.x*(float)scale,(float)ncell.y*(float)scale)).normalize()*depth;
-            // if ( (p1-p).size() < pixSize ) {
+            float depth = depthMap[ncell.y * w + ncell.x];
             if(fabs(pixDepth - depth) < pixSize)
             {
-                (*numOfPtsMap)[ncell.y * w + ncell.x]++;
+                numOfPtsMap[ncell.y * w + ncell.x]++;
             }
         }
     }
@@ -131,6 +232,70 @@ bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc
     return true;
 }
 
+void Fuser::computeNumOfModalsMap(int rc, const std::vector<float>& depthMap, const std::vector<float>& simMap,
+                                  const StaticVector<int>& tcams, const std::vector<const std::vector<float>*>& tcDepthMaps,
+                                  const std::vector<Pixel>& tcDimensions, int pixSizeBall, int pixSizeBallWSP,
+                                  std::vector<unsigned char>& out_numOfModalsMap)
+{
+    const int w = mp->getWidth(rc);
+    const int h = mp->getHeight(rc);
+
+    out_numOfModalsMap.assign(w * h, 0);
+
+    // note: the number of points map is not reset between the target cameras
+    std::vector<int> numOfPtsMap(w * h, 0);
+
+    for(int c = 0; c < tcams.size(); c++)
+    {
+        const int tc = tcams[c];
+        const std::vector<float>& tcdepthMap = *tcDepthMaps[c];
+        const int tcWidth = tcDimensions[c].x;
+        const int tcHeight = tcDimensions[c].y;
+
+        if(!tcdepthMap.empty())
+        {
+            for(int y = 0; y < tcHeight; ++y)
+            {
+                for(int x = 0; x < tcWidth; ++x)
+                {
+                    float depth = tcdepthMap[y * tcWidth + x];
+                    if(depth > 0.0f)
+                    {
+                      Point3d p = mp->CArr[tc] + (mp->iCamArr[tc] * Point2d((float)x, (float)y)).normalize() * depth;
+                      updateInSurr(pixSizeBall, pixSizeBallWSP, p, rc, tc, numOfPtsMap, depthMap, simMap, 1);
+                    }
+                }
+            }
+
+            for(int i = 0; i < w * h; i++)
+            {
+                out_numOfModalsMap[i] += static_cast<int>(numOfPtsMap[i] > 0);
+            }
+        }
+    }
+}
+
+void Fuser::writeFilteredDepthMap(int rc, const std::vector<float>& depthMap, const std::vector<float>& simMap, int nbDepthValues) const
+{
+    const int w = mp->getWidth(rc);
+    const int h = mp->getHeight(rc);
+
+    oiio::ParamValueList metadata = imageIO::getMetadataFromMap(mp->getMetadata(rc));
+    metadata.push_back(oiio::ParamValue("AliceVision:nbDepthValues", oiio::TypeDesc::INT32, 1, &nbDepthValues));
+    metadata.push_back(oiio::ParamValue("AliceVision:downscale", mp->getDownscaleFactor(rc)));
+    metadata.push_back(oiio::ParamValue("AliceVision:CArr", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::VEC3), 1, mp->CArr[rc].m));
+    metadata.push_back(oiio::ParamValue("AliceVision:iCamArr", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, mp->iCamArr[rc].m));
+
+    {
+      std::vector<double> matrixP = mp->getOriginalP(rc);
+      metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, matrixP.data()));
+    }
+
+    using namespace imageIO;
+    writeMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 0), w, h, depthMap, EImageQuality::LOSSLESS, metadata);
+    writeMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 0), w, h, simMap, EImageQuality::OPTIMIZED, metadata);
+}
+
 // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,...
 void Fuser::filterGroups(const StaticVector<int>& cams, int pixSizeBall, int pixSizeBallWSP, int nNearestCams)
 {
@@ -158,72 +323,38 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
     int w = mp->getWidth(rc);
     int h = mp->getHeight(rc);
 
-    StaticVector<float> depthMap;
-    StaticVector<float> simMap;
+    std::vector<float> depthMap;
+    std::vector<float> simMap;
 
     {
         int width, height;
 
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 1), width, height, depthMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 1), width, height, simMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
-    }
-
-    std::vector<unsigned char> numOfModalsMap(w * h, 0);
-
-    if((depthMap.empty()) || (simMap.empty()) || (depthMap.size() != w * h) || (simMap.size() != w * h))
-    {
-        std::stringstream s;
-        s << "filterGroupsRC: bad image dimension for camera: " << mp->getViewId(rc) << "\n";
-        s << "depthMap size: " << depthMap.size() << ", simMap size: " << simMap.size() << ", width: " << w << ", height: " << h;
-       throw std::runtime_error(s.str());
+        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 1), width, height, depthMap, imageIO::EImageColorSpace::NO_CONVERSION);
+        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 1), width, height, simMap, imageIO::EImageColorSpace::NO_CONVERSION);
     }
 
-    StaticVector<int>* numOfPtsMap = new StaticVector<int>();
-    numOfPtsMap->reserve(w * h);
-    numOfPtsMap->resize_with(w * h, 0);
+    checkDepthMapDimensions(mp, rc, depthMap, simMap);
 
     StaticVector<int> tcams = mp->findNearestCamsFromLandmarks(rc, nNearestCams);
 
+    std::vector<std::vector<float>> tcDepthMapsData(tcams.size());
+    std::vector<const std::vector<float>*> tcDepthMaps(tcams.size());
+    std::vector<Pixel> tcDimensions(tcams.size());
     for(int c = 0; c < tcams.size(); c++)
     {
-        numOfPtsMap->resize_with(w * h, 0);
-        int tc = tcams[c];
-
-        StaticVector<float> tcdepthMap;
-
-        int tcWidth, tcHeight;
-        imageIO::readImage(getFileNameFromIndex(mp, tc, mvsUtils::EFileType::depthMap, 1), tcWidth, tcHeight, tcdepthMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
-
-        if(!tcdepthMap.empty())
-        {
-            for(int y = 0; y < tcHeight; ++y)
-            {
-                for(int x = 0; x < tcWidth; ++x)
-                {
-                    float depth = tcdepthMap[y * tcWidth + x];
-                    if(depth > 0.0f)
-                    {
-                      Point3d p = mp->CArr[tc] + (mp->iCamArr[tc] * Point2d((float)x, (float)y)).normalize() * depth;
-                      updateInSurr(pixSizeBall, pixSizeBallWSP, p, rc, tc, numOfPtsMap, &depthMap, &simMap, 1);
-                    }
-                }
-            }
-
-            for(int i = 0; i < w * h; i++)
-            {
-                numOfModalsMap.at(i) += static_cast<int>((*numOfPtsMap)[i] > 0);
-            }
-        }
+        imageIO::readImage(getFileNameFromIndex(mp, tcams[c], mvsUtils::EFileType::depthMap, 1), tcDimensions[c].x, tcDimensions[c].y, tcDepthMapsData[c], imageIO::EImageColorSpace::NO_CONVERSION);
+        tcDepthMaps[c] = &tcDepthMapsData[c];
     }
 
+    std::vector<unsigned char> numOfModalsMap;
+    computeNumOfModalsMap(rc, depthMap, simMap, tcams, tcDepthMaps, tcDimensions, pixSizeBall, pixSizeBallWSP, numOfModalsMap);
+
     {
       using namespace imageIO;
       OutputFileColorSpace colorspace(EImageColorSpace::NO_CONVERSION);
       writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::nmodMap), w, h, numOfModalsMap, EImageQuality::LOSSLESS, colorspace);
     }
 
-    delete numOfPtsMap;
-
     if(mp->verbose)
         ALICEVISION_LOG_DEBUG(rc << " solved.");
     if(mp->verbose)
@@ -252,8 +383,6 @@ void Fuser::filterDepthMaps(const StaticVector<int>& cams, int minNumOfModals, i
 bool Fuser::filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2SSP)
 {
     long t1 = clock();
-    int w = mp->getWidth(rc);
-    int h = mp->getHeight(rc);
 
     std::vector<float> depthMap;
     std::vector<float> simMap;
@@ -267,63 +396,152 @@ bool Fuser::filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2
         imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::nmodMap), width, height, numOfModalsMap, imageIO::EImageColorSpace::NO_CONVERSION);
     }
 
-    int nbDepthValues = 0;
+    const int nbDepthValues = filterWithNumOfModals(numOfModalsMap, minNumOfModals, minNumOfModalsWSP2SSP, depthMap, simMap);
+    writeFilteredDepthMap(rc, depthMap, simMap, nbDepthValues);
 
-    for(int i = 0; i < w * h; i++)
+    if(mp->verbose)
+        ALICEVISION_LOG_DEBUG(rc << " solved.");
+    if(mp->verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+void Fuser::filterDepthMapsPipeline(const StaticVector<int>& cams, int pixSizeBall, int pixSizeBallWSP, int nNearestCams,
+                                    int minNumOfModals, int minNumOfModalsWSP2SSP, int nbIOThreads)
+{
+    ALICEVISION_LOG_INFO("Filtering depth maps.");
+    const system::Timer timer;
+
+    // nearest cameras of each camera to filter
+    std::vector<StaticVector<int>> camsTCams(cams.size());
+#pragma omp parallel for
+    for(int c = 0; c < cams.size(); c++)
+        camsTCams[c] = mp->findNearestCamsFromLandmarks(cams[c], nNearestCams);
+
+    // processing order: breadth-first traversal of the nearest cameras graph,
+    // so that the cameras processed at the same time share most of their target depth maps
+    std::vector<int> order;
+    order.reserve(cams.size());
     {
-        // if the reference point is consistent in three target cameras and is denoted as weakly supported point
-        // make him strongly supported
-        if((numOfModalsMap.at(i) >= minNumOfModalsWSP2SSP - 1) && (simMap.at(i) >= 1.0f))
-        {
-            simMap[i] = simMap[i] - 2.0f;
-        }
+        std::vector<int> camToIndex(mp->ncams, -1);
+        for(int c = 0; c < cams.size(); c++)
+            camToIndex[cams[c]] = c;
 
-        // if it is conistent in only one camera and is weakly supported then remove him
-        // weakly supported point must be consisten in at least two cameras
-        if((numOfModalsMap.at(i) <= 1) && (simMap.at(i) >= 1.0f))
+        std::vector<char> visited(cams.size(), 0);
+        for(int start = 0; start < cams.size(); start++)
         {
-            depthMap[i] = -1.0f;
-            simMap[i] = 1.0f;
+            if(visited[start])
+                continue;
+            visited[start] = 1;
+            order.push_back(start);
+            for(std::size_t i = order.size() - 1; i < order.size(); ++i)
+            {
+                for(const int tc : camsTCams[order[i]])
+                {
+                    const int c = camToIndex[tc];
+                    if(c != -1 && !visited[c])
+                    {
+                        visited[c] = 1;
+                        order.push_back(c);
+                    }
+                }
+            }
         }
+    }
 
-        // if it is not conistent in minimal number of cameras and is strongly supported then remove him
-        if((numOfModalsMap.at(i) < minNumOfModals - 1) && (simMap.at(i) < 1.0f))
+    const int nbComputeThreads = omp_get_max_threads();
+    const std::size_t maxInFlight = 2 * (nbComputeThreads + nbIOThreads);
+
+    // the input depth maps are shared between the cameras, the cache uses at most half of the available memory
+    const std::size_t depthMapSize = sizeof(float) * mp->getMaxImageWidth() * mp->getMaxImageHeight();
+    const std::size_t cacheSize = std::max(system::MemoryBudget::get().getAvailableMemory() / 2, (nNearestCams + 1) * depthMapSize);
+    DepthMapsCache depthMapsCache(mp, mvsUtils::EFileType::depthMap, 1, cacheSize);
+
+    struct FilterItem
+    {
+        int rc = -1;
+        bool numOfModalsMapComputed = false;
+        DepthMapsCache::DepthMapPtr depthMap;
+        std::vector<DepthMapsCache::DepthMapPtr> tcDepthMaps;
+        std::vector<float> filteredDepthMap;
+        std::vector<float> simMap;
+        std::vector<unsigned char> numOfModalsMap;
+        int nbDepthValues = 0;
+    };
+
+    system::ProcessingPipeline<FilterItem> pipeline(maxInFlight);
+
+    pipeline.addStage("read", nbIOThreads, [&](std::size_t index, FilterItem& item) {
+        const int c = order[index];
+        item.rc = cams[c];
+
+        int width, height;
+        item.depthMap = depthMapsCache.get(item.rc);
+        imageIO::readImage(getFileNameFromIndex(mp, item.rc, mvsUtils::EFileType::simMap, 1), width, height, item.simMap, imageIO::EImageColorSpace::NO_CONVERSION);
+        checkDepthMapDimensions(mp, item.rc, item.depthMap->values, item.simMap);
+
+        // an existing number of modals map is reused (resume)
+        const std::string nmodMapFilepath = getFileNameFromIndex(mp, item.rc, mvsUtils::EFileType::nmodMap);
+        if(mvsUtils::FileExists(nmodMapFilepath))
         {
-            depthMap[i] = -1.0f;
-            simMap[i] = 1.0f;
+            imageIO::readImage(nmodMapFilepath, width, height, item.numOfModalsMap, imageIO::EImageColorSpace::NO_CONVERSION);
+            item.numOfModalsMapComputed = true;
+            return;
         }
 
-        if(depthMap[i] > 0.0f)
-          ++nbDepthValues;
-    }
+        item.tcDepthMaps.reserve(camsTCams[c].size());
+        for(const int tc : camsTCams[c])
+            item.tcDepthMaps.push_back(depthMapsCache.get(tc));
+    });
 
-    oiio::ParamValueList metadata = imageIO::getMetadataFromMap(mp->getMetadata(rc));
-    metadata.push_back(oiio::ParamValue("AliceVision:nbDepthValues", oiio::TypeDesc::INT32, 1, &nbDepthValues));
-    metadata.push_back(oiio::ParamValue("AliceVision:downscale", mp->getDownscaleFactor(rc)));
-    metadata.push_back(oiio::ParamValue("AliceVision:CArr", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::VEC3), 1, mp->CArr[rc].m));
-    metadata.push_back(oiio::ParamValue("AliceVision:iCamArr", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, mp->iCamArr[rc].m));
+    pipeline.addStage("filter", nbComputeThreads, [&](std::size_t index, FilterItem& item) {
+        const int c = order[index];
 
-    {
-      std::vector<double> matrixP = mp->getOriginalP(rc);
-      metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, matrixP.data()));
-    }
+        if(!item.numOfModalsMapComputed)
+        {
+            std::vector<const std::vector<float>*> tcDepthMaps(item.tcDepthMaps.size());
+            std::vector<Pixel> tcDimensions(item.tcDepthMaps.size());
+            for(std::size_t i = 0; i < item.tcDepthMaps.size(); ++i)
+            {
+                tcDepthMaps[i] = &item.tcDepthMaps[i]->values;
+                tcDimensions[i] = Pixel(item.tcDepthMaps[i]->width, item.tcDepthMaps[i]->height);
+            }
+            computeNumOfModalsMap(item.rc, item.depthMap->values, item.simMap, camsTCams[c], tcDepthMaps, tcDimensions,
+                                  pixSizeBall, pixSizeBallWSP, item.numOfModalsMap);
+            // release the target depth maps as soon as possible
+            item.tcDepthMaps.clear();
+        }
 
-    using namespace imageIO;
-    OutputFileColorSpace colorspace(EImageColorSpace::NO_CONVERSION);
-    writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 0), w, h, depthMap, EImageQuality::LOSSLESS,  colorspace, metadata);
-    writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 0), w, h, simMap, EImageQuality::OPTIMIZED,  colorspace, metadata);
+        item.filteredDepthMap = item.depthMap->values;
+        item.depthMap.reset();
+        item.nbDepthValues = filterWithNumOfModals(item.numOfModalsMap, minNumOfModals, minNumOfModalsWSP2SSP, item.filteredDepthMap, item.simMap);
+    });
 
-    if(mp->verbose)
-        ALICEVISION_LOG_DEBUG(rc << " solved.");
-    if(mp->verbose)
-        mvsUtils::printfElapsedTime(t1);
+    pipeline.addStage("write", nbIOThreads, [&](std::size_t index, FilterItem& item) {
+        if(!item.numOfModalsMapComputed)
+        {
+            using namespace imageIO;
+            OutputFileColorSpace colorspace(EImageColorSpace::NO_CONVERSION);
+            writeImage(getFileNameFromIndex(mp, item.rc, mvsUtils::EFileType::nmodMap), mp->getWidth(item.rc), mp->getHeight(item.rc),
+                       item.numOfModalsMap, EImageQuality::LOSSLESS, colorspace);
+        }
+        writeFilteredDepthMap(item.rc, item.filteredDepthMap, item.simMap, item.nbDepthValues);
+    });
 
-    return true;
+    pipeline.run(cams.size());
+
+    pipeline.logStats();
+    depthMapsCache.logStats();
+    ALICEVISION_LOG_INFO("Depth maps filtered in " << system::prettyTime(timer.elapsedMs()) << ".");
 }
 
 float Fuser::computeAveragePixelSizeInHexahedron(Point3d* hexah, int step, int scale)
 {
-    int scaleuse = std::max(1, scale);
+    const int scaleuse = std::max(1, scale);
+    // read a lower resolution level of the depth maps instead of skipping values
+    const int level = getSamplingLevel(step);
+    const int levelScale = scaleuse << level;
 
     StaticVector<int> cams = mp->findCamsWhichIntersectsHexahedron(hexah);
     int j = 0;
@@ -334,25 +552,39 @@ float Fuser::computeAveragePixelSizeInHexahedron(Point3d* hexah, int step, int s
     for(int c = 0; c < cams.size(); c++)
     {
         int rc = cams[c];
-        int h = mp->getHeight(rc) / scaleuse;
-        int w = mp->getWidth(rc) / scaleuse;
-        StaticVector<float> rcdepthMap;
-
+        const int levelWidth = imageIO::getMapLevelSize(mp->getWidth(rc) / scaleuse, level);
+        const int levelHeight = imageIO::getMapLevelSize(mp->getHeight(rc) / scaleuse, level);
+
+        // only read the part of the depth map where the hexahedron is visible
+        int xBegin = 0;
+        int yBegin = 0;
+        int xEnd = levelWidth;
+        int yEnd = levelHeight;
+        Point2d bboxMin, bboxMax;
+        if(getHexahedronImageBBox(mp, rc, hexah, bboxMin, bboxMax))
         {
-            int width, height;
-            imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), width, height, rcdepthMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
+            xBegin = static_cast<int>(std::min<double>(levelWidth, std::max(0.0, std::floor(bboxMin.x / levelScale))));
+            yBegin = static_cast<int>(std::min<double>(levelHeight, std::max(0.0, std::floor(bboxMin.y / levelScale))));
+            xEnd = static_cast<int>(std::min<double>(levelWidth, std::max(0.0, std::floor(bboxMax.x / levelScale) + 1.0)));
+            yEnd = static_cast<int>(std::min<double>(levelHeight, std::max(0.0, std::floor(bboxMax.y / levelScale) + 1.0)));
         }
+        if(xBegin >= xEnd || yBegin >= yEnd)
+            continue;
 
-        for(int y = 0; y < h; y++)
-            for(int x = 0; x < w; ++x)
+        const int w = xEnd - xBegin;
+        std::vector<float> rcdepthMap;
+        imageIO::readMapRegion(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), level, xBegin, yBegin, w, yEnd - yBegin, rcdepthMap);
+
+        for(int y = yBegin; y < yEnd; y++)
+            for(int x = xBegin; x < xEnd; ++x)
             {
-                float depth = rcdepthMap[y * w + x];
+                float depth = rcdepthMap[(y - yBegin) * w + (x - xBegin)];
                 if(depth > 0.0f)
                 {
                     if(j % step == 0)
                     {
                         Point3d p = mp->CArr[rc] +
-                                    (mp->iCamArr[rc] * Point2d((float)x * (float)scaleuse, (float)y * (float)scaleuse))
+                                    (mp->iCamArr[rc] * Point2d((float)x * (float)levelScale, (float)y * (float)levelScale))
                                             .normalize() *
                                         depth;
                         if(mvsUtils::isPointInHexahedron(p, hexah))
@@ -417,6 +649,33 @@ float Fuser::computeAveragePixelSizeInHexahedron(Point3d* hexah, const sfmData::
  *@param[out] hexah: table of 8 values
  *@param[out] minPixSize
  */
+void Fuser::sampleDepthMapsPoints(unsigned long maxPoints, std::vector<Point3d>& out_points) const
+{
+    const int scale = 0;
+
+    const unsigned long npset = computeNumberOfAllPoints(mp, scale);
+    int stepPts = std::max(1, (int)(npset / std::max(1ul, maxPoints)));
+    // read a lower resolution level of the depth maps instead of skipping values
+    const int level = getSamplingLevel(stepPts);
+
+    out_points.clear();
+    for(int rc = 0; rc < mp->ncams; rc++)
+    {
+        int w, h;
+        std::vector<float> depthMap;
+        imageIO::readMapLevel(mvsUtils::getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), level, w, h, depthMap);
+
+        for(int i = 0; i < depthMap.size(); i += stepPts)
+        {
+            const int x = (i % w) << level;
+            const int y = (i / w) << level;
+            const float depth = depthMap[i];
+            if(depth > 0.0f)
+                out_points.push_back(mp->CArr[rc] + (mp->iCamArr[rc] * Point2d((float)x, (float)y)).normalize() * depth);
+        }
+    }
+}
+
 void Fuser::divideSpaceFromDepthMaps(Point3d* hexah, float& minPixSize)
 {
     ALICEVISION_LOG_INFO("Estimate space from depth maps.");
@@ -424,25 +683,22 @@ void Fuser::divideSpaceFromDepthMaps(Point3d* hexah, float& minPixSize)
 
     unsigned long npset = computeNumberOfAllPoints(mp, scale);
     int stepPts = std::max(1, (int)(npset / (unsigned long)1000000));
+    // read a lower resolution level of the depth maps instead of skipping values
+    const int level = getSamplingLevel(stepPts);
 
     minPixSize = std::numeric_limits<float>::max();
     //long t1 = mvsUtils::initEstimate();
     Stat3d s3d = Stat3d();
     for(int rc = 0; rc < mp->ncams; rc++)
     {
-        int w = mp->getWidth(rc);
-
-        StaticVector<float> depthMap;
-        {
-            int width, height;
-
-            imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), width, height, depthMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
-        }
+        int w, h;
+        std::vector<float> depthMap;
+        imageIO::readMapLevel(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), level, w, h, depthMap);
 
-        for(int i = 0; i < sizeOfStaticVector<float>(&depthMap); i += stepPts)
+        for(int i = 0; i < depthMap.size(); i += stepPts)
         {
-            int x = i % w;
-            int y = i / w;
+            int x = (i % w) << level;
+            int y = (i / w) << level;
             float depth = depthMap[i];
             if(depth > 0.0f)
             {
@@ -474,19 +730,14 @@ void Fuser::divideSpaceFromDepthMaps(Point3d* hexah, float& minPixSize)
 
     for(int rc = 0; rc < mp->ncams; ++rc)
     {
-        int w = mp->getWidth(rc);
-
-        StaticVector<float> depthMap;
-        {
-            int width, height;
-
-            imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), width, height, depthMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
-        }
+        int w, h;
+        std::vector<float> depthMap;
+        imageIO::readMapLevel(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), level, w, h, depthMap);
 
         for(int i = 0; i < depthMap.size(); i += stepPts)
         {
-            int x = i % w;
-            int y = i / w;
+            int x = (i % w) << level;
+            int y = (i / w) << level;
             float depth = depthMap[i];
             if(depth > 0.0f)
             {
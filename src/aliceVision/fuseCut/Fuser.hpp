@@ -7,11 +7,14 @@
 #pragma once
 
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsData/Pixel.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsData/Universe.hpp>
 #include <aliceVision/mvsData/Voxel.hpp>
 
+#include <vector>
+
 namespace aliceVision {
 
 namespace sfmData {
@@ -35,9 +38,27 @@ public:
     void filterDepthMaps(const StaticVector<int>& cams, int minNumOfModals, int minNumOfModalsWSP2SSP);
     bool filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2SSP);
 
+    /**
+     * @brief Filter the depth maps of the given cameras (filterGroups then filterDepthMaps) without a barrier between the two steps:
+     *        each camera is filtered as soon as its own number of modals map is computed.
+     *        The cameras are processed in neighborhood order and the input depth maps are decoded once in a shared cache,
+     *        reading and writing are done by dedicated threads.
+     * @param[in] cams the cameras to filter
+     * @param[in] nbIOThreads the number of threads reading the inputs and the number of threads writing the outputs
+     */
+    void filterDepthMapsPipeline(const StaticVector<int>& cams, int pixSizeBall, int pixSizeBallWSP, int nNearestCams,
+                                 int minNumOfModals, int minNumOfModalsWSP2SSP, int nbIOThreads);
+
     void divideSpaceFromDepthMaps(Point3d* hexah, float& minPixSize);
     void divideSpaceFromSfM(const sfmData::SfMData& sfmData, Point3d* hexah, std::size_t minObservations = 0, float minObservationAngle = 0.0f) const;
 
+    /**
+     * @brief Sample the 3D points of the depth maps, which are the points fused in the dense point cloud
+     * @param[in] maxPoints the approximate maximum number of sampled points
+     * @param[out] out_points the sampled points
+     */
+    void sampleDepthMapsPoints(unsigned long maxPoints, std::vector<Point3d>& out_points) const;
+
     /// @brief Compute average pixel size in the given hexahedron
     float computeAveragePixelSizeInHexahedron(Point3d* hexah, int step, int scale);
     float computeAveragePixelSizeInHexahedron(Point3d* hexah, const sfmData::SfMData& sfmData);
@@ -45,8 +66,22 @@ public:
     Voxel estimateDimensions(Point3d* vox, Point3d* newSpace, int scale, int maxOcTreeDim, const sfmData::SfMData* sfmData = nullptr);
 
 private:
-    bool updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc, StaticVector<int>* numOfPtsMap,
-                      StaticVector<float>* depthMap, StaticVector<float>* simMap, int scale);
+    bool updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc, std::vector<int>& numOfPtsMap,
+                      const std::vector<float>& depthMap, const std::vector<float>& simMap, int scale);
+
+    /**
+     * @brief Count the number of target cameras whose depth maps are consistent with each pixel of the rc depth map
+     * @param[in] tcDepthMaps the depth maps of the target cameras (tcams), with their width and height
+     */
+    void computeNumOfModalsMap(int rc, const std::vector<float>& depthMap, const std::vector<float>& simMap,
+                               const StaticVector<int>& tcams, const std::vector<const std::vector<float>*>& tcDepthMaps,
+                               const std::vector<Pixel>& tcDimensions, int pixSizeBall, int pixSizeBallWSP,
+                               std::vector<unsigned char>& out_numOfModalsMap);
+
+    /**
+     * @brief Write the filtered depth and similarity maps of a camera with their metadata
+     */
+    void writeFilteredDepthMap(int rc, const std::vector<float>& depthMap, const std::vector<float>& simMap, int nbDepthValues) const;
 };
 
 unsigned long computeNumberOfAllPoints(const mvsUtils::MultiViewParams* mp, int scale);
@@ -0,0 +1,1004 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PartitionedMeshing.hpp"
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/fuseCut/DelaunayGraphCut.hpp>
+#include <aliceVision/fuseCut/Fuser.hpp>
+#include <aliceVision/mesh/MeshClean.hpp>
+#include <aliceVision/mesh/MeshConnectivity.hpp>
+#include <aliceVision/mvsUtils/common.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Tracer.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace fuseCut {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+/**
+ * @brief Normalized coordinates in the parallelepiped defined by a hexahedron
+ *        (origin hexah[0], axes hexah[1], hexah[3] and hexah[4])
+ */
+class HexahedronFrame
+{
+public:
+    explicit HexahedronFrame(const Point3d* hexah)
+      : _origin(hexah[0])
+      , _vx(hexah[1] - hexah[0])
+      , _vy(hexah[3] - hexah[0])
+      , _vz(hexah[4] - hexah[0])
+    {
+        // dual basis
+        const double volume = dot(_vx, cross(_vy, _vz));
+        _dx = cross(_vy, _vz) / volume;
+        _dy = cross(_vz, _vx) / volume;
+        _dz = cross(_vx, _vy) / volume;
+    }
+
+    inline Point3d toNormalized(const Point3d& p) const
+    {
+        const Point3d v = p - _origin;
+        return Point3d(dot(v, _dx), dot(v, _dy), dot(v, _dz));
+    }
+
+    inline Point3d fromNormalized(const Point3d& uvw) const
+    {
+        return _origin + _vx * uvw.x + _vy * uvw.y + _vz * uvw.z;
+    }
+
+    inline double getAxisLength(int axis) const
+    {
+        return (axis == 0) ? _vx.size() : ((axis == 1) ? _vy.size() : _vz.size());
+    }
+
+    /// hexahedron of a box in normalized coordinates, with the same corners order
+    void getHexahedron(const Point3d& boxMin, const Point3d& boxMax, std::array<Point3d, 8>& out_hexah) const
+    {
+        out_hexah[0] = fromNormalized(Point3d(boxMin.x, boxMin.y, boxMin.z));
+        out_hexah[1] = fromNormalized(Point3d(boxMax.x, boxMin.y, boxMin.z));
+        out_hexah[2] = fromNormalized(Point3d(boxMax.x, boxMax.y, boxMin.z));
+        out_hexah[3] = fromNormalized(Point3d(boxMin.x, boxMax.y, boxMin.z));
+        out_hexah[4] = fromNormalized(Point3d(boxMin.x, boxMin.y, boxMax.z));
+        out_hexah[5] = fromNormalized(Point3d(boxMax.x, boxMin.y, boxMax.z));
+        out_hexah[6] = fromNormalized(Point3d(boxMax.x, boxMax.y, boxMax.z));
+        out_hexah[7] = fromNormalized(Point3d(boxMin.x, boxMax.y, boxMax.z));
+    }
+
+private:
+    Point3d _origin;
+    Point3d _vx, _vy, _vz;
+    Point3d _dx, _dy, _dz;
+};
+
+/**
+ * @brief Check if a point (in normalized coordinates) belongs to a partition cell.
+ *        The cells are half-open, except on the reconstruction hexahedron upper faces,
+ *        so each point of the hexahedron belongs to exactly one cell.
+ */
+bool isInPartitionCell(const Point3d& uvw, const MeshingPartition& partition)
+{
+    for(int k = 0; k < 3; ++k)
+    {
+        const double cellMin = partition.cellMin.m[k];
+        const double cellMax = partition.cellMax.m[k];
+        if(uvw.m[k] < cellMin || uvw.m[k] > cellMax || (uvw.m[k] == cellMax && cellMax < 1.0))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Distance from a point (in normalized coordinates) to the closest face of its partition cell
+ *        shared with another cell (infinite if the cell is the whole reconstruction hexahedron)
+ */
+double getSeamDistance(const Point3d& uvw, const MeshingPartition& partition, const HexahedronFrame& frame)
+{
+    double distance = std::numeric_limits<double>::max();
+    for(int k = 0; k < 3; ++k)
+    {
+        const double axisLength = frame.getAxisLength(k);
+        if(partition.cellMin.m[k] > 0.0)
+            distance = std::min(distance, std::abs(uvw.m[k] - partition.cellMin.m[k]) * axisLength);
+        if(partition.cellMax.m[k] < 1.0)
+            distance = std::min(distance, std::abs(partition.cellMax.m[k] - uvw.m[k]) * axisLength);
+    }
+    return distance;
+}
+
+/// child cell of a point (in normalized coordinates), children cells are ordered by x, then y, then z
+inline int getChildCellId(const Point3d& uvw, const Point3d& cellCenter)
+{
+    return (uvw.x >= cellCenter.x ? 1 : 0) + (uvw.y >= cellCenter.y ? 2 : 0) + (uvw.z >= cellCenter.z ? 4 : 0);
+}
+
+/**
+ * @brief Split a cell until it has a bounded number of landmarks.
+ *        The landmarks estimate the dense points density, the cells without landmarks nor dense points are dropped.
+ */
+void splitPartitionCell(const HexahedronFrame& frame, const std::vector<Point3d>& landmarksUvw, std::vector<int>& landmarksIds,
+                        const std::vector<Point3d>& densePointsUvw, std::vector<int>& densePointsIds,
+                        const Point3d& cellMin, const Point3d& cellMax, int depth, const PartitioningParams& params,
+                        std::vector<MeshingPartition>& out_partitions)
+{
+    if(landmarksIds.empty() && densePointsIds.empty())
+        return;
+
+    if(static_cast<int>(landmarksIds.size()) <= params.maxLandmarksPerPartition || depth >= params.maxDepth)
+    {
+        MeshingPartition partition;
+        partition.cellMin = cellMin;
+        partition.cellMax = cellMax;
+        frame.getHexahedron(cellMin, cellMax, partition.hexah);
+
+        Point3d extendedMin;
+        Point3d extendedMax;
+        for(int k = 0; k < 3; ++k)
+        {
+            const double margin = params.overlap * (cellMax.m[k] - cellMin.m[k]);
+            extendedMin.m[k] = std::max(0.0, cellMin.m[k] - margin);
+            extendedMax.m[k] = std::min(1.0, cellMax.m[k] + margin);
+        }
+        frame.getHexahedron(extendedMin, extendedMax, partition.extendedHexah);
+
+        out_partitions.push_back(partition);
+        return;
+    }
+
+    const Point3d cellCenter = (cellMin + cellMax) / 2.0;
+
+    std::vector<int> childrenLandmarksIds[8];
+    for(const int landmarkId : landmarksIds)
+        childrenLandmarksIds[getChildCellId(landmarksUvw[landmarkId], cellCenter)].push_back(landmarkId);
+    std::vector<int>().swap(landmarksIds);
+
+    std::vector<int> childrenDensePointsIds[8];
+    for(const int densePointId : densePointsIds)
+        childrenDensePointsIds[getChildCellId(densePointsUvw[densePointId], cellCenter)].push_back(densePointId);
+    std::vector<int>().swap(densePointsIds);
+
+    for(int childId = 0; childId < 8; ++childId)
+    {
+        Point3d childMin;
+        Point3d childMax;
+        for(int k = 0; k < 3; ++k)
+        {
+            const bool upper = (childId >> k) & 1;
+            childMin.m[k] = upper ? cellCenter.m[k] : cellMin.m[k];
+            childMax.m[k] = upper ? cellMax.m[k] : cellCenter.m[k];
+        }
+        splitPartitionCell(frame, landmarksUvw, childrenLandmarksIds[childId], densePointsUvw, childrenDensePointsIds[childId],
+                           childMin, childMax, depth + 1, params, out_partitions);
+    }
+}
+
+/// remap the points visibilities after Mesh::removeFreePointsFromMesh
+void remapPtsCams(const StaticVector<int>& ptIdToNewPtId, int nbNewPts, StaticVector<StaticVector<int>>& inout_ptsCams)
+{
+    StaticVector<StaticVector<int>> ptsCams;
+    ptsCams.resize(nbNewPts);
+    for(int i = 0; i < ptIdToNewPtId.size(); ++i)
+    {
+        const int newId = ptIdToNewPtId[i];
+        if(newId > -1 && i < inout_ptsCams.size())
+            ptsCams[newId].swap(inout_ptsCams[i]);
+    }
+    inout_ptsCams.swap(ptsCams);
+}
+
+/// grid cell of a point, packed in a 64 bits key
+inline long long getGridKey(const Point3d& p, double cellSize, int dx = 0, int dy = 0, int dz = 0)
+{
+    const long long x = static_cast<long long>(std::floor(p.x / cellSize)) + dx;
+    const long long y = static_cast<long long>(std::floor(p.y / cellSize)) + dy;
+    const long long z = static_cast<long long>(std::floor(p.z / cellSize)) + dz;
+    return ((x & 0x1FFFFF) << 42) | ((y & 0x1FFFFF) << 21) | (z & 0x1FFFFF);
+}
+
+int findRoot(std::vector<int>& parents, int ptId)
+{
+    while(parents[ptId] != ptId)
+    {
+        parents[ptId] = parents[parents[ptId]];
+        ptId = parents[ptId];
+    }
+    return ptId;
+}
+
+/**
+ * @brief Merge the seam vertices of different partitions, closest pairs first.
+ *        A merged vertex contains at most one vertex of each partition.
+ *        The triangles flipped by the merge are degenerated.
+ * @return the number of merged vertices
+ */
+int weldSeamVertices(mesh::Mesh& mesh, StaticVector<StaticVector<int>>& ptsCams, const std::vector<int>& ptsPartition,
+                     const std::vector<double>& ptsTolerance, std::vector<char>& inout_ptsSeam)
+{
+    const int nbPts = mesh.pts.size();
+
+    std::vector<int> seamPts;
+    for(int ptId = 0; ptId < nbPts; ++ptId)
+    {
+        if(inout_ptsSeam[ptId])
+            seamPts.push_back(ptId);
+    }
+    if(seamPts.empty())
+        return 0;
+
+    // grid of the seam vertices, the cell size is the median tolerance
+    double cellSize;
+    {
+        std::vector<double> tolerances;
+        tolerances.reserve(seamPts.size());
+        for(const int ptId : seamPts)
+            tolerances.push_back(ptsTolerance[ptId]);
+        std::nth_element(tolerances.begin(), tolerances.begin() + tolerances.size() / 2, tolerances.end());
+        cellSize = tolerances[tolerances.size() / 2];
+    }
+    if(!(cellSize > 0.0))
+        return 0;
+
+    std::vector<std::pair<long long, int>> grid;
+    grid.reserve(seamPts.size());
+    for(const int ptId : seamPts)
+        grid.emplace_back(getGridKey(mesh.pts[ptId], cellSize), ptId);
+    std::sort(grid.begin(), grid.end());
+
+    struct WeldCandidate
+    {
+        double distance;
+        int ptA;
+        int ptB;
+
+        bool operator<(const WeldCandidate& other) const
+        {
+            if(distance != other.distance)
+                return distance < other.distance;
+            if(ptA != other.ptA)
+                return ptA < other.ptA;
+            return ptB < other.ptB;
+        }
+    };
+
+    std::vector<WeldCandidate> candidates;
+    for(const int ptA : seamPts)
+    {
+        const Point3d& pA = mesh.pts[ptA];
+        const int radius = std::min(2, static_cast<int>(std::ceil(ptsTolerance[ptA] / cellSize)));
+
+        for(int dz = -radius; dz <= radius; ++dz)
+            for(int dy = -radius; dy <= radius; ++dy)
+                for(int dx = -radius; dx <= radius; ++dx)
+                {
+                    const long long key = getGridKey(pA, cellSize, dx, dy, dz);
+                    auto it = std::lower_bound(grid.begin(), grid.end(), std::make_pair(key, std::numeric_limits<int>::min()));
+                    for(; it != grid.end() && it->first == key; ++it)
+                    {
+                        const int ptB = it->second;
+                        if(ptB <= ptA || ptsPartition[ptA] == ptsPartition[ptB])
+                            continue;
+                        const double distance = dist(pA, mesh.pts[ptB]);
+                        if(distance <= std::min(ptsTolerance[ptA], ptsTolerance[ptB]))
+                            candidates.push_back({distance, ptA, ptB});
+                    }
+                }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    std::vector<int> parents(nbPts);
+    std::iota(parents.begin(), parents.end(), 0);
+    std::vector<std::vector<int>> clustersPartitions(nbPts);
+    for(const int ptId : seamPts)
+        clustersPartitions[ptId].push_back(ptsPartition[ptId]);
+
+    int nbWelds = 0;
+    for(const WeldCandidate& candidate : candidates)
+    {
+        const int rootA = findRoot(parents, candidate.ptA);
+        const int rootB = findRoot(parents, candidate.ptB);
+        if(rootA == rootB)
+            continue;
+
+        std::vector<int>& partitionsA = clustersPartitions[rootA];
+        std::vector<int>& partitionsB = clustersPartitions[rootB];
+        bool samePartition = false;
+        for(const int partitionId : partitionsB)
+            samePartition = samePartition || (std::find(partitionsA.begin(), partitionsA.end(), partitionId) != partitionsA.end());
+        if(samePartition)
+            continue;
+
+        // the root is the lowest point id
+        const int root = std::min(rootA, rootB);
+        const int child = std::max(rootA, rootB);
+        parents[child] = root;
+        clustersPartitions[root].insert(clustersPartitions[root].end(), clustersPartitions[child].begin(), clustersPartitions[child].end());
+        std::vector<int>().swap(clustersPartitions[child]);
+        ++nbWelds;
+    }
+
+    if(nbWelds == 0)
+        return 0;
+
+    // normals of the triangles with a seam vertex, before the merge
+    std::vector<std::pair<int, Point3d>> movedTrisNormals;
+    for(int triId = 0; triId < mesh.tris.size(); ++triId)
+    {
+        const mesh::Mesh::triangle& t = mesh.tris[triId];
+        if(inout_ptsSeam[t.v[0]] || inout_ptsSeam[t.v[1]] || inout_ptsSeam[t.v[2]])
+        {
+            const Point3d& p0 = mesh.pts[t.v[0]];
+            movedTrisNormals.emplace_back(triId, cross(mesh.pts[t.v[1]] - p0, mesh.pts[t.v[2]] - p0));
+        }
+    }
+
+    // merged vertex: mean position and union of the visibilities
+    std::vector<Point3d> sums(nbPts);
+    std::vector<int> counts(nbPts, 0);
+    for(const int ptId : seamPts)
+    {
+        const int root = findRoot(parents, ptId);
+        sums[root] = sums[root] + mesh.pts[ptId];
+        ++counts[root];
+        if(root != ptId)
+        {
+            for(const int camId : ptsCams[ptId])
+                ptsCams[root].push_back_distinct(camId);
+            inout_ptsSeam[root] = 1;
+        }
+    }
+    for(const int ptId : seamPts)
+    {
+        if(counts[ptId] > 1)
+            mesh.pts[ptId] = sums[ptId] / static_cast<double>(counts[ptId]);
+    }
+
+    for(int triId = 0; triId < mesh.tris.size(); ++triId)
+    {
+        mesh::Mesh::triangle& t = mesh.tris[triId];
+        for(int k = 0; k < 3; ++k)
+            t.v[k] = findRoot(parents, t.v[k]);
+    }
+
+    // the triangles flipped by the merge are degenerated, to be removed with the invalid triangles
+    for(const auto& triNormal : movedTrisNormals)
+    {
+        mesh::Mesh::triangle& t = mesh.tris[triNormal.first];
+        const Point3d& p0 = mesh.pts[t.v[0]];
+        if(dot(cross(mesh.pts[t.v[1]] - p0, mesh.pts[t.v[2]] - p0), triNormal.second) <= 0.0)
+            t.v[1] = t.v[0];
+    }
+    mesh.invalidateConnectivity();
+
+    return nbWelds;
+}
+
+/**
+ * @brief Remove the degenerated and duplicated triangles, the triangles in excess on non-manifold edges
+ *        and the triangles with an opposite orientation on a shared edge (the triangles with the lowest ids are kept)
+ * @return the number of removed triangles
+ */
+int removeInvalidTriangles(mesh::Mesh& mesh)
+{
+    const StaticVector<mesh::Mesh::triangle>& tris = mesh.tris;
+    std::vector<char> trisAlive(tris.size(), 1);
+
+    std::vector<std::array<int, 4>> sortedTris;
+    sortedTris.reserve(tris.size());
+    for(int triId = 0; triId < tris.size(); ++triId)
+    {
+        const mesh::Mesh::triangle& t = tris[triId];
+        if(t.v[0] == t.v[1] || t.v[1] == t.v[2] || t.v[2] == t.v[0])
+        {
+            trisAlive[triId] = 0;
+            continue;
+        }
+        std::array<int, 4> sortedTri = {t.v[0], t.v[1], t.v[2], triId};
+        std::sort(sortedTri.begin(), sortedTri.begin() + 3);
+        sortedTris.push_back(sortedTri);
+    }
+    std::sort(sortedTris.begin(), sortedTris.end());
+    for(std::size_t i = 1; i < sortedTris.size(); ++i)
+    {
+        if(std::equal(sortedTris[i].begin(), sortedTris[i].begin() + 3, sortedTris[i - 1].begin()))
+            trisAlive[sortedTris[i][3]] = 0;
+    }
+
+    const auto keepAliveTriangles = [&]() {
+        StaticVector<int> trisIdsToStay;
+        trisIdsToStay.reserve(tris.size());
+        for(int triId = 0; triId < tris.size(); ++triId)
+        {
+            if(trisAlive[triId])
+                trisIdsToStay.push_back(triId);
+        }
+        const int nbRemoved = tris.size() - trisIdsToStay.size();
+        if(nbRemoved > 0)
+            mesh.letJustTringlesIdsInMesh(trisIdsToStay);
+        return nbRemoved;
+    };
+
+    int nbRemoved = keepAliveTriangles();
+
+    const mesh::MeshConnectivity& connectivity = mesh.getConnectivity();
+    trisAlive.assign(tris.size(), 1);
+    for(int edgeId = 0; edgeId < connectivity.getNbEdges(); ++edgeId)
+    {
+        const mesh::MeshConnectivity::IndexRange halfEdges = connectivity.getEdgeHalfEdges(edgeId);
+        for(int i = 2; i < halfEdges.size(); ++i)
+            trisAlive[mesh::MeshConnectivity::getHalfEdgeTriangle(halfEdges[i])] = 0;
+        if(halfEdges.size() >= 2)
+        {
+            const int triA = mesh::MeshConnectivity::getHalfEdgeTriangle(halfEdges[0]);
+            const int triB = mesh::MeshConnectivity::getHalfEdgeTriangle(halfEdges[1]);
+            if(tris[triA].v[halfEdges[0] % 3] == tris[triB].v[halfEdges[1] % 3])
+                trisAlive[triB] = 0;
+        }
+    }
+    nbRemoved += keepAliveTriangles();
+
+    return nbRemoved;
+}
+
+/**
+ * @brief Close the small holes whose border mostly contains seam vertices (ear clipping, shortest diagonal first).
+ *        On the vertices shared by several triangles fans, a hole border continues on another fan, with the smallest angle,
+ *        and the holes touching themselves are split in simple loops.
+ * @return the number of closed holes
+ */
+int closeSeamHoles(mesh::Mesh& mesh, const std::vector<char>& ptsSeam, int maxHoleEdges)
+{
+    using mesh::MeshConnectivity;
+
+    const int nbPts = mesh.pts.size();
+    const MeshConnectivity& connectivity = mesh.getConnectivity();
+
+    const auto getHalfEdgeStart = [&](int halfEdgeId) {
+        return mesh.tris[MeshConnectivity::getHalfEdgeTriangle(halfEdgeId)].v[halfEdgeId % 3];
+    };
+    const auto getHalfEdgeEnd = [&](int halfEdgeId) {
+        return mesh.tris[MeshConnectivity::getHalfEdgeTriangle(halfEdgeId)].v[(halfEdgeId + 1) % 3];
+    };
+    const auto getPrevHalfEdge = [](int halfEdgeId) {
+        return (halfEdgeId % 3 == 0) ? halfEdgeId + 2 : halfEdgeId - 1;
+    };
+
+    // holes borders: the boundary half-edges, reversed, grouped by start point (the boundary half-edge end)
+    std::vector<std::pair<int, int>> holeEdges;
+    for(int edgeId = 0; edgeId < connectivity.getNbEdges(); ++edgeId)
+    {
+        if(connectivity.isBoundaryEdge(edgeId))
+        {
+            const int halfEdgeId = connectivity.getEdgeHalfEdges(edgeId)[0];
+            holeEdges.emplace_back(getHalfEdgeEnd(halfEdgeId), halfEdgeId);
+        }
+    }
+    std::sort(holeEdges.begin(), holeEdges.end());
+
+    const auto getOutgoingHoleEdges = [&](int ptId) {
+        const auto begin = std::lower_bound(holeEdges.begin(), holeEdges.end(), std::make_pair(ptId, std::numeric_limits<int>::min()));
+        auto end = begin;
+        while(end != holeEdges.end() && end->first == ptId)
+            ++end;
+        return std::make_pair(static_cast<int>(begin - holeEdges.begin()), static_cast<int>(end - holeEdges.begin()));
+    };
+
+    // boundary half-edge ending the triangles fan of a boundary half-edge start point
+    // (-1 on non-manifold edges or on unusually large fans)
+    const auto getFanEndHalfEdge = [&](int halfEdgeId) {
+        for(int i = 0; i < 64; ++i)
+        {
+            const int prevHalfEdgeId = getPrevHalfEdge(halfEdgeId);
+            if(connectivity.isBoundaryEdge(connectivity.getHalfEdgeEdge(prevHalfEdgeId)))
+                return prevHalfEdgeId;
+            halfEdgeId = connectivity.getHalfEdgeTwin(prevHalfEdgeId);
+            if(halfEdgeId == -1)
+                return -1;
+        }
+        return -1;
+    };
+
+    std::set<std::pair<int, int>> newEdges;
+    const auto edgeExists = [&](int ptA, int ptB) {
+        const MeshConnectivity::IndexRange neighbors = connectivity.getPtNeighborPoints(ptA);
+        return std::binary_search(neighbors.begin(), neighbors.end(), ptB) ||
+               newEdges.count(std::make_pair(std::min(ptA, ptB), std::max(ptA, ptB))) > 0;
+    };
+    const auto triangleExists = [&](int ptA, int ptB, int ptC) {
+        for(const int triId : connectivity.getPtNeighborTriangles(ptA))
+        {
+            const mesh::Mesh::triangle& t = mesh.tris[triId];
+            const bool hasB = (t.v[0] == ptB || t.v[1] == ptB || t.v[2] == ptB);
+            const bool hasC = (t.v[0] == ptC || t.v[1] == ptC || t.v[2] == ptC);
+            if(hasB && hasC)
+                return true;
+        }
+        return false;
+    };
+
+    std::vector<mesh::Mesh::triangle> newTris;
+
+    // ear clipping of a simple loop, the triangles follow the hole border orientation
+    const auto closeLoop = [&](std::vector<int> loop, const Point3d& bordersNormal) {
+        std::vector<mesh::Mesh::triangle> loopTris;
+        std::vector<std::pair<int, int>> loopEdges;
+
+        // loop normal (Newell), the reflex ears are not clipped
+        Point3d loopNormal;
+        for(std::size_t i = 0; i < loop.size(); ++i)
+            loopNormal = loopNormal + cross(mesh.pts[loop[i]], mesh.pts[loop[(i + 1) % loop.size()]]);
+
+        // a loop folded over the surface (overlapping partitions) is not closed
+        if(dot(loopNormal, bordersNormal) <= 0.0)
+            return false;
+
+        const auto earContainsPoint = [&](int earId) {
+            const int n = static_cast<int>(loop.size());
+            const Point3d* ear[3] = {&mesh.pts[loop[(earId + n - 1) % n]], &mesh.pts[loop[earId]], &mesh.pts[loop[(earId + 1) % n]]};
+            for(int i = 0; i < n; ++i)
+            {
+                if(i == earId || i == (earId + 1) % n || i == (earId + n - 1) % n)
+                    continue;
+                const Point3d& q = mesh.pts[loop[i]];
+                bool inside = true;
+                for(int k = 0; k < 3 && inside; ++k)
+                    inside = (dot(cross(*ear[(k + 1) % 3] - *ear[k], q - *ear[k]), loopNormal) >= 0.0);
+                if(inside)
+                    return true;
+            }
+            return false;
+        };
+
+        while(loop.size() > 3)
+        {
+            const int n = static_cast<int>(loop.size());
+            int bestId = -1;
+            double bestLength = std::numeric_limits<double>::max();
+            for(int i = 0; i < n; ++i)
+            {
+                const int prevPtId = loop[(i + n - 1) % n];
+                const int nextPtId = loop[(i + 1) % n];
+                if(edgeExists(prevPtId, nextPtId))
+                    continue;
+                const Point3d& p = mesh.pts[loop[i]];
+                if(dot(cross(p - mesh.pts[prevPtId], mesh.pts[nextPtId] - p), loopNormal) <= 0.0 || earContainsPoint(i))
+                    continue;
+                const double length = dist(mesh.pts[prevPtId], mesh.pts[nextPtId]);
+                if(length < bestLength)
+                {
+                    bestLength = length;
+                    bestId = i;
+                }
+            }
+            if(bestId == -1)
+                break;
+
+            const int prevPtId = loop[(bestId + n - 1) % n];
+            const int nextPtId = loop[(bestId + 1) % n];
+            loopTris.emplace_back(prevPtId, loop[bestId], nextPtId);
+            loopEdges.emplace_back(std::min(prevPtId, nextPtId), std::max(prevPtId, nextPtId));
+            newEdges.insert(loopEdges.back());
+            loop.erase(loop.begin() + bestId);
+        }
+
+        if(loop.size() != 3 || triangleExists(loop[0], loop[1], loop[2]))
+        {
+            for(const auto& edge : loopEdges)
+                newEdges.erase(edge);
+            return false;
+        }
+
+        loopTris.emplace_back(loop[0], loop[1], loop[2]);
+        newTris.insert(newTris.end(), loopTris.begin(), loopTris.end());
+        return true;
+    };
+
+    std::vector<char> holeEdgesVisited(holeEdges.size(), 0);
+    std::vector<int> ptsLoopPosition(nbPts, -1);
+    int nbClosedHoles = 0;
+
+    for(int startHoleEdge = 0; startHoleEdge < static_cast<int>(holeEdges.size()); ++startHoleEdge)
+    {
+        if(holeEdgesVisited[startHoleEdge])
+            continue;
+
+        std::vector<int> loopHoleEdges;
+        bool closed = false;
+        int holeEdge = startHoleEdge;
+
+        while(true)
+        {
+            holeEdgesVisited[holeEdge] = 1;
+            const int ptId = holeEdges[holeEdge].first;
+            loopHoleEdges.push_back(holeEdge);
+
+            // the hole edge goes from the boundary half-edge end to its start
+            const int halfEdgeId = holeEdges[holeEdge].second;
+            const int nextPtId = getHalfEdgeStart(halfEdgeId);
+            const std::pair<int, int> outgoing = getOutgoingHoleEdges(nextPtId);
+
+            int nextHoleEdge = -1;
+            if(outgoing.second - outgoing.first == 1)
+            {
+                nextHoleEdge = outgoing.first;
+            }
+            else
+            {
+                // several fans: continue on another fan, with the smallest angle
+                const int sameFanHalfEdgeId = getFanEndHalfEdge(halfEdgeId);
+                const Point3d& p = mesh.pts[nextPtId];
+                const Point3d dirIn = (mesh.pts[ptId] - p).normalize();
+                double bestCos = -2.0;
+                for(int i = outgoing.first; i < outgoing.second; ++i)
+                {
+                    if(holeEdges[i].second == sameFanHalfEdgeId || (holeEdgesVisited[i] && i != startHoleEdge))
+                        continue;
+                    const Point3d dirOut = (mesh.pts[getHalfEdgeStart(holeEdges[i].second)] - p).normalize();
+                    const double cosAngle = dot(dirIn, dirOut);
+                    if(cosAngle > bestCos)
+                    {
+                        bestCos = cosAngle;
+                        nextHoleEdge = i;
+                    }
+                }
+            }
+
+            if(nextHoleEdge == startHoleEdge)
+            {
+                closed = true;
+                break;
+            }
+            if(nextHoleEdge == -1 || holeEdgesVisited[nextHoleEdge])
+                break;
+            holeEdge = nextHoleEdge;
+        }
+
+        if(!closed)
+            continue;
+
+        // a hole touching itself on a vertex shared by several fans is split in simple loops
+        std::vector<int> stack;
+        const auto closeSubLoop = [&](std::size_t begin) {
+            std::vector<int> subLoop;
+            Point3d bordersNormal;
+            int nbSeamPts = 0;
+            for(std::size_t i = begin; i < stack.size(); ++i)
+            {
+                const int ptId = holeEdges[stack[i]].first;
+                const mesh::Mesh::triangle& t = mesh.tris[MeshConnectivity::getHalfEdgeTriangle(holeEdges[stack[i]].second)];
+                bordersNormal = bordersNormal + cross(mesh.pts[t.v[1]] - mesh.pts[t.v[0]], mesh.pts[t.v[2]] - mesh.pts[t.v[0]]);
+                nbSeamPts += (ptsSeam[ptId] != 0);
+                ptsLoopPosition[ptId] = -1;
+                subLoop.push_back(ptId);
+            }
+            stack.resize(begin);
+            if(subLoop.size() >= 3 && static_cast<int>(subLoop.size()) <= maxHoleEdges && 2 * nbSeamPts >= static_cast<int>(subLoop.size()) &&
+               closeLoop(subLoop, bordersNormal))
+                ++nbClosedHoles;
+        };
+        for(const int loopHoleEdge : loopHoleEdges)
+        {
+            const int ptId = holeEdges[loopHoleEdge].first;
+            if(ptsLoopPosition[ptId] != -1)
+                closeSubLoop(ptsLoopPosition[ptId]);
+            ptsLoopPosition[ptId] = static_cast<int>(stack.size());
+            stack.push_back(loopHoleEdge);
+        }
+        closeSubLoop(0);
+    }
+
+    if(!newTris.empty())
+    {
+        mesh.tris.reserveAdd(newTris.size());
+        for(const mesh::Mesh::triangle& t : newTris)
+            mesh.tris.push_back(t);
+        mesh.invalidateConnectivity();
+    }
+    return nbClosedHoles;
+}
+
+} // namespace
+
+void computeMeshingPartitions(const sfmData::SfMData& sfmData, const std::vector<Point3d>& densePoints, const Point3d* hexah,
+                              const PartitioningParams& params, std::vector<MeshingPartition>& out_partitions)
+{
+    const HexahedronFrame frame(hexah);
+
+    // landmarks inside the reconstruction hexahedron, sorted by id
+    std::vector<IndexT> landmarksIds;
+    landmarksIds.reserve(sfmData.getLandmarks().size());
+    for(const auto& landmarkPair : sfmData.getLandmarks())
+        landmarksIds.push_back(landmarkPair.first);
+    std::sort(landmarksIds.begin(), landmarksIds.end());
+
+    const auto isInHexahedron = [](const Point3d& uvw) {
+        return uvw.x >= 0.0 && uvw.x <= 1.0 && uvw.y >= 0.0 && uvw.y <= 1.0 && uvw.z >= 0.0 && uvw.z <= 1.0;
+    };
+
+    std::vector<Point3d> landmarksUvw;
+    landmarksUvw.reserve(landmarksIds.size());
+    for(const IndexT landmarkId : landmarksIds)
+    {
+        const Vec3& X = sfmData.getLandmarks().at(landmarkId).X;
+        const Point3d uvw = frame.toNormalized(Point3d(X(0), X(1), X(2)));
+        if(isInHexahedron(uvw))
+            landmarksUvw.push_back(uvw);
+    }
+
+    // the dense points keep the cells without landmarks (textureless or dense only regions)
+    std::vector<Point3d> densePointsUvw;
+    densePointsUvw.reserve(densePoints.size());
+    for(const Point3d& p : densePoints)
+    {
+        const Point3d uvw = frame.toNormalized(p);
+        if(isInHexahedron(uvw))
+            densePointsUvw.push_back(uvw);
+    }
+
+    std::vector<int> rootLandmarksIds(landmarksUvw.size());
+    std::iota(rootLandmarksIds.begin(), rootLandmarksIds.end(), 0);
+    std::vector<int> rootDensePointsIds(densePointsUvw.size());
+    std::iota(rootDensePointsIds.begin(), rootDensePointsIds.end(), 0);
+
+    out_partitions.clear();
+    splitPartitionCell(frame, landmarksUvw, rootLandmarksIds, densePointsUvw, rootDensePointsIds,
+                       Point3d(0.0, 0.0, 0.0), Point3d(1.0, 1.0, 1.0), 0, params, out_partitions);
+
+    ALICEVISION_LOG_INFO("Meshing partitions: " << out_partitions.size() << " partitions from " << landmarksUvw.size() << " landmarks and "
+                         << densePointsUvw.size() << " dense points samples.");
+}
+
+std::string getPartitionFolder(const std::string& partitionsFolder, int partitionId)
+{
+    return (bfs::path(partitionsFolder) / ("partition_" + mvsUtils::num2strFourDecimal(partitionId))).string() + "/";
+}
+
+std::string getPartitionSignature(const MeshingPartition& partition, const std::string& meshingSignature)
+{
+    std::ostringstream signature;
+    signature << std::setprecision(std::numeric_limits<double>::max_digits10);
+    signature << meshingSignature;
+    signature << "cell: " << partition.cellMin.x << " " << partition.cellMin.y << " " << partition.cellMin.z << " "
+              << partition.cellMax.x << " " << partition.cellMax.y << " " << partition.cellMax.z << std::endl;
+    signature << "extended hexahedron:";
+    for(const Point3d& p : partition.extendedHexah)
+        signature << " " << p.x << " " << p.y << " " << p.z;
+    signature << std::endl;
+    return signature.str();
+}
+
+bool isPartitionMeshComputed(const std::string& partitionFolder, const std::string& signature)
+{
+    // the signature is written last
+    const std::string signatureFilename = partitionFolder + "signature.txt";
+    if(!bfs::exists(signatureFilename) || !bfs::exists(partitionFolder + "mesh.bin"))
+        return false;
+
+    std::ifstream signatureFile(signatureFilename, std::ios::binary);
+    const std::string fileSignature((std::istreambuf_iterator<char>(signatureFile)), std::istreambuf_iterator<char>());
+    return fileSignature == signature;
+}
+
+void computePartitionMesh(mvsUtils::MultiViewParams& mp, const Point3d* hexah, const MeshingPartition& partition, int ocTreeDim,
+                          const sfmData::SfMData* landmarksSfmData, const FuseParams* depthMapsFuseParams,
+                          const sfmData::SfMData* pixelSizeSfmData, const std::string& partitionFolder, const std::string& signature)
+{
+    ALICEVISION_TRACE_ZONE("fuseCut::computePartitionMesh");
+
+    system::Timer timer;
+    bfs::create_directories(partitionFolder);
+    // an interrupted computation must not be reused
+    bfs::remove(partitionFolder + "signature.txt");
+
+    std::array<Point3d, 8> extendedHexah = partition.extendedHexah;
+
+    StaticVector<int> cams;
+    if(depthMapsFuseParams != nullptr)
+    {
+        cams = mp.findCamsWhichIntersectsHexahedron(&extendedHexah[0]);
+    }
+    else
+    {
+        cams.resize(mp.getNbCameras());
+        for(int i = 0; i < cams.size(); ++i)
+            cams[i] = i;
+    }
+
+    mesh::Mesh* mesh = nullptr;
+    StaticVector<StaticVector<int>> ptsCams;
+
+    if(cams.empty())
+    {
+        ALICEVISION_LOG_WARNING("No camera intersects the partition, the partition mesh is empty.");
+        mesh = new mesh::Mesh();
+    }
+    else
+    {
+        Point3d spaceSteps;
+        {
+            Fuser fs(&mp);
+            std::array<Point3d, 8> dimensionsHexah;
+            const Voxel dimensions = fs.estimateDimensions(&extendedHexah[0], &dimensionsHexah[0], 0, ocTreeDim, pixelSizeSfmData);
+            const Point3d vx = extendedHexah[1] - extendedHexah[0];
+            const Point3d vy = extendedHexah[3] - extendedHexah[0];
+            const Point3d vz = extendedHexah[4] - extendedHexah[0];
+            spaceSteps.x = (vx.size() / (double)dimensions.x) / (double)ocTreeDim;
+            spaceSteps.y = (vy.size() / (double)dimensions.y) / (double)ocTreeDim;
+            spaceSteps.z = (vz.size() / (double)dimensions.z) / (double)ocTreeDim;
+        }
+
+        DelaunayGraphCut delaunayGC(&mp);
+        delaunayGC.createDensePointCloud(&extendedHexah[0], cams, landmarksSfmData, depthMapsFuseParams);
+        delaunayGC.createGraphCut(&extendedHexah[0], cams, nullptr, partitionFolder, partitionFolder + "SpaceCamsTracks/", false, spaceSteps);
+        delaunayGC.graphCutPostProcessing();
+        mesh = delaunayGC.createMesh();
+        delaunayGC.createPtsCams(ptsCams);
+    }
+
+    // keep the triangles owned by the partition cell
+    {
+        const HexahedronFrame frame(hexah);
+        StaticVector<int> trisIdsToStay;
+        trisIdsToStay.reserve(mesh->tris.size());
+        for(int triId = 0; triId < mesh->tris.size(); ++triId)
+        {
+            if(isInPartitionCell(frame.toNormalized(mesh->computeTriangleCenterOfGravity(triId)), partition))
+                trisIdsToStay.push_back(triId);
+        }
+        mesh->letJustTringlesIdsInMesh(trisIdsToStay);
+
+        StaticVector<int> ptIdToNewPtId;
+        mesh->removeFreePointsFromMesh(ptIdToNewPtId);
+        remapPtsCams(ptIdToNewPtId, mesh->pts.size(), ptsCams);
+    }
+
+    saveArrayOfArraysToFile<int>(partitionFolder + "meshPtsCams.bin", ptsCams);
+    mesh->saveToBin(partitionFolder + "mesh.bin");
+    {
+        std::ofstream signatureFile(partitionFolder + "signature.txt", std::ios::binary);
+        signatureFile << signature;
+    }
+
+    ALICEVISION_LOG_INFO("Partition mesh: " << mesh->pts.size() << " vertices and " << mesh->tris.size() << " facets, computed in "
+                         << timer.elapsed() << " s.");
+    delete mesh;
+}
+
+mesh::Mesh* stitchPartitionsMeshes(mvsUtils::MultiViewParams& mp, const Point3d* hexah, const std::vector<MeshingPartition>& partitions,
+                                   const std::string& partitionsFolder, const std::string& meshingSignature,
+                                   const PartitioningParams& params, StaticVector<StaticVector<int>>& out_ptsCams)
+{
+    ALICEVISION_TRACE_ZONE("fuseCut::stitchPartitionsMeshes");
+
+    system::Timer timer;
+    const HexahedronFrame frame(hexah);
+
+    mesh::Mesh* mesh = new mesh::Mesh();
+    out_ptsCams.clear();
+    std::vector<int> ptsPartition;
+
+    for(int partitionId = 0; partitionId < static_cast<int>(partitions.size()); ++partitionId)
+    {
+        const std::string partitionFolder = getPartitionFolder(partitionsFolder, partitionId);
+        if(!isPartitionMeshComputed(partitionFolder, getPartitionSignature(partitions[partitionId], meshingSignature)))
+        {
+            delete mesh;
+            throw std::runtime_error("Missing or outdated partition mesh: " + partitionFolder + "mesh.bin");
+        }
+
+        mesh::Mesh partitionMesh;
+        partitionMesh.loadFromBin(partitionFolder + "mesh.bin");
+        StaticVector<StaticVector<int>> partitionPtsCams;
+        loadArrayOfArraysFromFile<int>(partitionPtsCams, partitionFolder + "meshPtsCams.bin");
+        partitionPtsCams.resize(partitionMesh.pts.size());
+
+        mesh->addMesh(partitionMesh);
+        out_ptsCams.reserveAdd(partitionPtsCams.size());
+        for(int i = 0; i < partitionPtsCams.size(); ++i)
+        {
+            out_ptsCams.push_back(StaticVector<int>());
+            out_ptsCams.back().swap(partitionPtsCams[i]);
+        }
+        ptsPartition.resize(mesh->pts.size(), partitionId);
+    }
+
+    ALICEVISION_LOG_INFO("Partitions meshes loaded: " << mesh->pts.size() << " vertices and " << mesh->tris.size() << " facets.");
+
+    const int nbPts = mesh->pts.size();
+
+    // seam vertices: border vertices close to a face shared with another partition
+    std::vector<char> ptsSeam(nbPts, 0);
+    std::vector<double> ptsTolerance(nbPts, 0.0);
+    {
+        const mesh::MeshConnectivity& connectivity = mesh->getConnectivity();
+        std::vector<char> ptsBoundary(nbPts, 0);
+        for(int edgeId = 0; edgeId < connectivity.getNbEdges(); ++edgeId)
+        {
+            if(connectivity.isBoundaryEdge(edgeId))
+            {
+                const Pixel& edgePts = connectivity.getEdgePoints(edgeId);
+                ptsBoundary[edgePts.x] = 1;
+                ptsBoundary[edgePts.y] = 1;
+            }
+        }
+
+        #pragma omp parallel for
+        for(int ptId = 0; ptId < nbPts; ++ptId)
+        {
+            if(!ptsBoundary[ptId])
+                continue;
+
+            const mesh::MeshConnectivity::IndexRange neighbors = connectivity.getPtNeighborPoints(ptId);
+            if(neighbors.empty())
+                continue;
+            double edgesLength = 0.0;
+            for(const int neighborId : neighbors)
+                edgesLength += dist(mesh->pts[ptId], mesh->pts[neighborId]);
+            ptsTolerance[ptId] = params.seamWeldFactor * edgesLength / neighbors.size();
+
+            const Point3d uvw = frame.toNormalized(mesh->pts[ptId]);
+            ptsSeam[ptId] = (getSeamDistance(uvw, partitions[ptsPartition[ptId]], frame) <= 2.0 * ptsTolerance[ptId]);
+        }
+    }
+
+    const int nbWelds = weldSeamVertices(*mesh, out_ptsCams, ptsPartition, ptsTolerance, ptsSeam);
+    const int nbRemovedTris = removeInvalidTriangles(*mesh);
+    const int nbClosedHoles = closeSeamHoles(*mesh, ptsSeam, params.seamMaxHoleEdges);
+
+    {
+        StaticVector<int> ptIdToNewPtId;
+        mesh->removeFreePointsFromMesh(ptIdToNewPtId);
+        remapPtsCams(ptIdToNewPtId, mesh->pts.size(), out_ptsCams);
+    }
+
+    // split the non-manifold vertices left by the merge (triangles fans touching on a vertex)
+    int nbSplitPts = 0;
+    {
+        mesh::MeshClean meshClean(&mp);
+        meshClean.addMesh(*mesh);
+        delete mesh;
+
+        meshClean.init();
+        meshClean.cleanMesh(10);
+
+        nbSplitPts = meshClean.newPtsOldPtId.size();
+        out_ptsCams.reserveAdd(nbSplitPts);
+        for(int i = 0; i < nbSplitPts; ++i)
+            out_ptsCams.push_back(out_ptsCams[meshClean.newPtsOldPtId[i]]);
+
+        meshClean.deallocateCleaningAttributes();
+        mesh = new mesh::Mesh();
+        mesh->addMesh(meshClean);
+    }
+
+    ALICEVISION_LOG_INFO("Partitions meshes stitched in " << timer.elapsed() << " s:" << std::endl
+                         << "\t- # merged seam vertices: " << nbWelds << std::endl
+                         << "\t- # removed invalid facets: " << nbRemovedTris << std::endl
+                         << "\t- # closed seam holes: " << nbClosedHoles << std::endl
+                         << "\t- # split non-manifold vertices: " << nbSplitPts << std::endl
+                         << "\t- # vertices: " << mesh->pts.size() << std::endl
+                         << "\t- # facets: " << mesh->tris.size());
+
+    return mesh;
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,136 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+
+namespace sfmData {
+class SfMData;
+}
+
+namespace fuseCut {
+
+struct FuseParams;
+
+/**
+ * @brief Parameters of the partitioned (out-of-core) meshing
+ */
+struct PartitioningParams
+{
+    /// maximum number of SfM landmarks in a partition, used to estimate the dense points density
+    int maxLandmarksPerPartition = 200000;
+    /// number of depth maps points sampled to find the empty partitions
+    int nbDensePointsSamples = 1000000;
+    /// maximum depth of the partitions octree
+    int maxDepth = 6;
+    /// overlap of the reconstructed partitions with their neighbors, as a fraction of the partition size
+    double overlap = 0.1;
+    /// maximum distance between two merged seam vertices, as a factor of the local edge length
+    double seamWeldFactor = 1.5;
+    /// maximum number of edges of the seam holes closed after the merge of the seam vertices
+    int seamMaxHoleEdges = 32;
+};
+
+/**
+ * @brief Octree cell of the reconstruction space, meshed independently
+ */
+struct MeshingPartition
+{
+    /// cell bounds, in normalized coordinates of the reconstruction hexahedron
+    Point3d cellMin;
+    Point3d cellMax;
+    /// cell hexahedron
+    std::array<Point3d, 8> hexah;
+    /// reconstructed hexahedron: the cell with the overlap
+    std::array<Point3d, 8> extendedHexah;
+};
+
+/**
+ * @brief Split the reconstruction hexahedron in octree cells with a bounded number of SfM landmarks.
+ *        Cells without landmarks nor dense points are not reconstructed. The order of the partitions is deterministic.
+ * @param[in] sfmData the SfM scene
+ * @param[in] densePoints a sample of the fused dense points (empty to mesh the SfM landmarks only)
+ * @param[in] hexah the reconstruction hexahedron
+ * @param[in] params the partitioning parameters
+ * @param[out] out_partitions the partitions
+ */
+void computeMeshingPartitions(const sfmData::SfMData& sfmData, const std::vector<Point3d>& densePoints, const Point3d* hexah,
+                              const PartitioningParams& params, std::vector<MeshingPartition>& out_partitions);
+
+/**
+ * @brief Get the folder of the partition results
+ * @param[in] partitionsFolder the partitions root folder
+ * @param[in] partitionId the partition index
+ * @return the partition folder, ending with a separator
+ */
+std::string getPartitionFolder(const std::string& partitionsFolder, int partitionId);
+
+/**
+ * @brief Get the signature of a partition mesh: the meshing parameters and inputs signature followed by the partition bounds
+ * @param[in] partition the partition
+ * @param[in] meshingSignature the description of everything else the partition mesh depends on (parameters, input files)
+ * @return the partition signature
+ */
+std::string getPartitionSignature(const MeshingPartition& partition, const std::string& meshingSignature);
+
+/**
+ * @brief Check if the mesh of a partition is already computed with the same signature
+ * @param[in] partitionFolder the partition folder
+ * @param[in] signature the partition signature (see getPartitionSignature)
+ */
+bool isPartitionMeshComputed(const std::string& partitionFolder, const std::string& signature);
+
+/**
+ * @brief Delaunay tetrahedralization and graph cut of a partition extended hexahedron.
+ *        Only the triangles owned by the partition cell (by their center of gravity) are kept,
+ *        the mesh and its points visibilities are saved in the partition folder, followed by its signature.
+ *        The memory usage only depends on the partition size (bounded by fuseParams.maxPoints).
+ * @param[in] mp the multi-view parameters
+ * @param[in] hexah the reconstruction hexahedron
+ * @param[in] partition the partition
+ * @param[in] ocTreeDim the octree dimension used to estimate the space steps
+ * @param[in] landmarksSfmData the SfM scene whose landmarks are added to the dense point cloud (or nullptr)
+ * @param[in] depthMapsFuseParams the depth maps fusion parameters (or nullptr to not use the depth maps)
+ * @param[in] pixelSizeSfmData the SfM scene used to estimate the pixel size (or nullptr to use the depth maps)
+ * @param[in] partitionFolder the partition folder
+ * @param[in] signature the partition signature (see getPartitionSignature)
+ */
+void computePartitionMesh(mvsUtils::MultiViewParams& mp, const Point3d* hexah, const MeshingPartition& partition, int ocTreeDim,
+                          const sfmData::SfMData* landmarksSfmData, const FuseParams* depthMapsFuseParams,
+                          const sfmData::SfMData* pixelSizeSfmData, const std::string& partitionFolder, const std::string& signature);
+
+/**
+ * @brief Join the partitions meshes into a single mesh.
+ *        The open borders along the partitions cells faces are merged (closest vertices from different partitions first)
+ *        and the remaining small seam holes are closed. Non-manifold edges created by the merge are removed,
+ *        then the non-manifold vertices are split by the mesh cleaning (MeshClean).
+ *        The stitching is heuristic: the seams are not guaranteed to be watertight, some holes may remain open.
+ *        The result only depends on the partitions meshes.
+ * @param[in] mp the multi-view parameters
+ * @param[in] hexah the reconstruction hexahedron
+ * @param[in] partitions the partitions
+ * @param[in] partitionsFolder the partitions root folder
+ * @param[in] meshingSignature the meshing signature, the partitions meshes must be computed with it
+ * @param[in] params the partitioning parameters
+ * @param[out] out_ptsCams the visibilities of the output mesh points
+ * @return the stitched mesh
+ */
+mesh::Mesh* stitchPartitionsMeshes(mvsUtils::MultiViewParams& mp, const Point3d* hexah, const std::vector<MeshingPartition>& partitions,
+                                   const std::string& partitionsFolder, const std::string& meshingSignature,
+                                   const PartitioningParams& params, StaticVector<StaticVector<int>>& out_ptsCams);
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -14,7 +14,9 @@
 #include <aliceVision/config.hpp>
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
 /**
  ** @file Standard 2D image convolution functions :
@@ -46,6 +48,19 @@ void ImageConvolution( const Image & img , const Mat & kernel , Image & out)
 
   out.resize( img.Width() , img.Height() ) ;
 
+  // clamped indices of the kernel taps (border pixels are copied)
+  std::vector< int > idy_clamped( img.rows() + kernel_height - 1 ) ;
+  std::vector< int > idx_clamped( img.cols() + kernel_width - 1 ) ;
+  for( int i = 0 ; i < static_cast<int>( idy_clamped.size() ) ; ++i )
+  {
+    idy_clamped[ i ] = std::min( std::max( i - kernel_height / 2 , 0 ) , static_cast<int>( img.rows() ) - 1 ) ;
+  }
+  for( int j = 0 ; j < static_cast<int>( idx_clamped.size() ) ; ++j )
+  {
+    idx_clamped[ j ] = std::min( std::max( j - kernel_width / 2 , 0 ) , static_cast<int>( img.cols() ) - 1 ) ;
+  }
+
+  #pragma omp parallel for schedule(static)
   for( int row = 0 ; row < img.rows() ; ++row )
   {
     for( int col = 0 ; col < img.cols() ; ++col )
@@ -54,16 +69,11 @@ void ImageConvolution( const Image & img , const Mat & kernel , Image & out)
 
       for( int i = 0 ; i < kernel_height ; ++i )
       {
+        const int idy = idy_clamped[ row + i ] ;
+
         for( int j = 0 ; j < kernel_width ; ++j )
         {
-          int idy = row + i - kernel_height / 2 ;
-          int idx = col + j - kernel_width / 2 ;
-
-          // Get correct value
-          idx = idx < 0 ? 0 : ( idx >= img.cols() ? img.cols() - 1 : idx ) ;
-          idy = idy < 0 ? 0 : ( idy >= img.rows() ? img.rows() - 1 : idy ) ;
-
-          sum += kernel( i , j ) * img( idy , idx ) ;
+          sum += kernel( i , j ) * img( idy , idx_clamped[ col + j ] ) ;
         }
       }
       out( row , col ) = sum ;
@@ -74,6 +84,8 @@ void ImageConvolution( const Image & img , const Mat & kernel , Image & out)
 /**
  ** Horizontal (1d) convolution
  ** assume kernel has odd size
+ ** rows are processed in parallel, each row is padded once (border pixels are copied)
+ ** then the kernel taps are accumulated on the full row
  ** @param img Input image
  ** @param kernel convolution kernel
  ** @param out Output image
@@ -82,42 +94,60 @@ template< typename ImageTypeIn , typename ImageTypeOut, typename Kernel >
 void ImageHorizontalConvolution( const ImageTypeIn & img , const Kernel & kernel , ImageTypeOut & out)
 {
   typedef typename ImageTypeIn::Tpixel pix_t ;
+  typedef typename ImageTypeOut::Tpixel out_pix_t ;
+  typedef typename Kernel::Scalar kernel_t ;
+  typedef typename ConvolutionSum< pix_t , kernel_t >::Type sum_t ;
 
   const int rows ( img.rows() );
   const int cols ( img.cols() );
 
-  out.resize( cols , rows ) ;
+  out.resize( cols , rows , false ) ;
 
   const int kernel_width = kernel.size() ;
   const int half_kernel_width = kernel_width / 2 ;
 
-  std::vector<pix_t, Eigen::aligned_allocator<pix_t> > line( cols + kernel_width );
-
-  for( int row = 0 ; row < rows ; ++row )
+  #pragma omp parallel
   {
-    // Copy line
-    const pix_t start_pix = img.coeffRef( row , 0 ) ;
-    for( int k = 0 ; k < half_kernel_width ; ++k ) // pad before
-    {
-      line[ k ] = start_pix ;
-    }
-    memcpy(&line[0] + half_kernel_width, img.data() + row * cols, sizeof(pix_t) * cols);
-    const pix_t end_pix = img.coeffRef( row , cols - 1 ) ;
-    for( int k = 0 ; k < half_kernel_width ; ++k ) // pad after
+    std::vector<pix_t, Eigen::aligned_allocator<pix_t> > line( cols + kernel_width );
+    std::vector<sum_t, Eigen::aligned_allocator<sum_t> > sum( cols );
+
+    #pragma omp for schedule(static)
+    for( int row = 0 ; row < rows ; ++row )
     {
-      line[ k + half_kernel_width + cols ] = end_pix ;
-    }
+      // Copy line
+      const pix_t start_pix = img.coeffRef( row , 0 ) ;
+      for( int k = 0 ; k < half_kernel_width ; ++k ) // pad before
+      {
+        line[ k ] = start_pix ;
+      }
+      memcpy(&line[0] + half_kernel_width, img.data() + row * cols, sizeof(pix_t) * cols);
+      const pix_t end_pix = img.coeffRef( row , cols - 1 ) ;
+      for( int k = 0 ; k < half_kernel_width ; ++k ) // pad after
+      {
+        line[ k + half_kernel_width + cols ] = end_pix ;
+      }
 
-    // Apply convolution
-    conv_buffer_( &line[0] , kernel.data() , cols , kernel_width );
+      // Apply convolution
+      std::fill( sum.begin() , sum.end() , sum_t() ) ;
+      for( int k = 0 ; k < kernel_width ; ++k )
+      {
+        conv_accumulate_row_( &sum[0] , &line[k] , kernel.data()[k] , cols ) ;
+      }
 
-    memcpy(out.data() + row * cols, &line[0], sizeof(pix_t) * cols);
+      out_pix_t * out_row = out.data() + row * cols ;
+      for( int col = 0 ; col < cols ; ++col )
+      {
+        out_row[ col ] = sum[ col ] ;
+      }
+    }
   }
 }
 
 /**
  ** Vertical (1d) convolution
  ** assume kernel has odd size
+ ** rows are processed in parallel, each kernel tap accumulates a full (clamped) input row
+ ** so that memory is always read contiguously (border pixels are copied)
  ** @param img Input image
  ** @param kernel convolution kernel
  ** @param out Output image
@@ -126,6 +156,9 @@ template< typename ImageTypeIn , typename ImageTypeOut, typename Kernel >
 void ImageVerticalConvolution( const ImageTypeIn & img , const Kernel & kernel , ImageTypeOut & out)
 {
   typedef typename ImageTypeIn::Tpixel pix_t ;
+  typedef typename ImageTypeOut::Tpixel out_pix_t ;
+  typedef typename Kernel::Scalar kernel_t ;
+  typedef typename ConvolutionSum< pix_t , kernel_t >::Type sum_t ;
 
   const int kernel_width = kernel.size() ;
   const int half_kernel_width = kernel_width / 2 ;
@@ -133,32 +166,34 @@ void ImageVerticalConvolution( const ImageTypeIn & img , const Kernel & kernel ,
   const int rows = img.rows() ;
   const int cols = img.cols() ;
 
-  out.resize( cols , rows ) ;
-
-  std::vector<pix_t, Eigen::aligned_allocator<pix_t> > line( rows + kernel_width );
+  out.resize( cols , rows , false ) ;
 
-  for( int col = 0 ; col < cols ; ++col )
+  // clamped input row of each kernel tap
+  std::vector< int > row_clamped( rows + kernel_width - 1 ) ;
+  for( int k = 0 ; k < static_cast<int>( row_clamped.size() ) ; ++k )
   {
-    // Copy column
-    for( int k = 0 ; k < half_kernel_width ; ++k )
-    {
-      line[ k ] = img.coeffRef( 0 , col ) ;
-    }
-    for( int k = 0 ; k < rows ; ++k )
-    {
-      line[ k + half_kernel_width ] = img.coeffRef( k , col ) ;
-    }
-    for( int k = 0 ; k < half_kernel_width ; ++k )
-    {
-      line[ k + half_kernel_width + rows ] = img.coeffRef( rows - 1 , col ) ;
-    }
+    row_clamped[ k ] = std::min( std::max( k - half_kernel_width , 0 ) , rows - 1 ) ;
+  }
 
-    // Apply convolution
-    conv_buffer_( &line[0] , kernel.data() , rows , kernel_width );
+  #pragma omp parallel
+  {
+    std::vector<sum_t, Eigen::aligned_allocator<sum_t> > sum( cols );
 
+    #pragma omp for schedule(static)
     for( int row = 0 ; row < rows ; ++row )
     {
-      out.coeffRef( row , col ) = line[row];
+      // Apply convolution
+      std::fill( sum.begin() , sum.end() , sum_t() ) ;
+      for( int k = 0 ; k < kernel_width ; ++k )
+      {
+        conv_accumulate_row_( &sum[0] , img.data() + row_clamped[ row + k ] * cols , kernel.data()[k] , cols ) ;
+      }
+
+      out_pix_t * out_row = out.data() + row * cols ;
+      for( int col = 0 ; col < cols ; ++col )
+      {
+        out_row[ col ] = sum[ col ] ;
+      }
     }
   }
 }
@@ -179,9 +214,10 @@ void ImageSeparableConvolution( const ImageType & img ,
 {
   // Cast the Kernel to the appropriate type
   typedef typename ImageType::Tpixel pix_t;
-  typedef Eigen::Matrix<typename Accumulator<pix_t>::Type, Eigen::Dynamic, 1> VecKernel;
-  const VecKernel horiz_k_cast = horiz_k.template cast< typename Accumulator<pix_t>::Type >();
-  const VecKernel vert_k_cast = vert_k.template cast< typename Accumulator<pix_t>::Type >();
+  typedef typename ConvolutionKernel<pix_t>::Type kernel_t;
+  typedef Eigen::Matrix<kernel_t, Eigen::Dynamic, 1> VecKernel;
+  const VecKernel horiz_k_cast = horiz_k.template cast< kernel_t >();
+  const VecKernel vert_k_cast = vert_k.template cast< kernel_t >();
 
   ImageType tmp ;
   ImageHorizontalConvolution( img , horiz_k_cast , tmp ) ;
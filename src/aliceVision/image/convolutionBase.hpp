@@ -7,10 +7,40 @@
 
 #pragma once
 
+#include <aliceVision/numeric/Accumulator.hpp>
+#include <aliceVision/image/pixelTypes.hpp>
+#include <aliceVision/config.hpp>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+#include <xmmintrin.h>
+#endif
+
 #include <cstddef>
 
 namespace aliceVision {
 namespace image {
+
+  /**
+   ** Kernel coefficient type used to convolve an image of the given pixel type
+   ** (color pixels are convolved channel-wise with a scalar kernel)
+   **/
+  template<typename T>
+  struct ConvolutionKernel { typedef typename Accumulator<T>::Type Type; };
+  template<typename T>
+  struct ConvolutionKernel< Rgb<T> > { typedef typename Accumulator<T>::Type Type; };
+  template<typename T>
+  struct ConvolutionKernel< Rgba<T> > { typedef typename Accumulator<T>::Type Type; };
+
+  /**
+   ** Type of the weighted sum of pixels by kernel coefficients
+   **/
+  template<typename TPixel, typename TKernel>
+  struct ConvolutionSum { typedef TKernel Type; };
+  template<typename T, typename TKernel>
+  struct ConvolutionSum< Rgb<T>, TKernel > { typedef Rgb<TKernel> Type; };
+  template<typename T, typename TKernel>
+  struct ConvolutionSum< Rgba<T>, TKernel > { typedef Rgba<TKernel> Type; };
+
   /**
    ** Filter an extended row [halfKernelSize][row][halfKernelSize]
    ** @param buffer data to filter
@@ -31,5 +61,51 @@ namespace image {
       buffer[i] = sum;
     }
   }
+
+  /**
+   ** Accumulate a weighted row: sum[i] += row[i] * weight
+   ** Used to apply a kernel tap to a full row at once (contiguous, vectorizable loop)
+   ** @param sum accumulated row
+   ** @param row row to accumulate
+   ** @param weight kernel coefficient
+   ** @param size row length
+   **/
+  template<class TSum, class TPixel, class TKernel> inline
+  void conv_accumulate_row_( TSum* sum, const TPixel* row, const TKernel weight, int size )
+  {
+    for( int i = 0; i < size; ++i )
+    {
+      sum[i] += row[i] * weight;
+    }
+  }
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+
+  /**
+   ** Accumulate a weighted row: sum[i] += row[i] * weight (SSE float version)
+   ** @param sum accumulated row
+   ** @param row row to accumulate
+   ** @param weight kernel coefficient
+   ** @param size row length
+   **/
+  inline void conv_accumulate_row_( float* sum, const float* row, const float weight, int size )
+  {
+    const __m128 w = _mm_set1_ps( weight );
+    int i = 0;
+    for( ; i + 4 <= size; i += 4 )
+    {
+      const __m128 s = _mm_loadu_ps( sum + i );
+      const __m128 r = _mm_loadu_ps( row + i );
+      _mm_storeu_ps( sum + i, _mm_add_ps( s, _mm_mul_ps( r, w ) ) );
+    }
+    // remaining pixels
+    for( ; i < size; ++i )
+    {
+      sum[i] += row[i] * weight;
+    }
+  }
+
+#endif // ALICEVISION_HAVE_SSE
+
 } // namespace image
 } // namespace aliceVision
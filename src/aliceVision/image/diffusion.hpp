@@ -49,6 +49,8 @@ void ImagePeronaMalikG2DiffusionCoef( const Image & Lx , const Image & Ly , cons
 ** @param out Output image
 ** @param row_start Row range beginning (range is [row_start ; row_end [ )
 ** @param row_end Row range end (range is [row_start ; row_end [ )
+** @note rows are accessed through raw pointers (images are row major)
+**       so that the inner loop can be vectorized by the compiler
 **/
 template< typename Image >
 void ImageFEDCentral( const Image & src , const Image & diff , const typename Image::Tpixel half_t , Image & out ,
@@ -56,32 +58,28 @@ void ImageFEDCentral( const Image & src , const Image & diff , const typename Im
 {
   typedef typename Image::Tpixel Real ;
   const int width = src.Width() ;
-  Real n_diff[4] ;
-  Real n_src[4] ;
+
   // Compute FED step on general range
   for( int i = row_start ; i < row_end ; ++i )
   {
+    const Real * src_prev = src.data() + ( i - 1 ) * width ;
+    const Real * src_cur  = src.data() + i * width ;
+    const Real * src_next = src.data() + ( i + 1 ) * width ;
+    const Real * diff_prev = diff.data() + ( i - 1 ) * width ;
+    const Real * diff_cur  = diff.data() + i * width ;
+    const Real * diff_next = diff.data() + ( i + 1 ) * width ;
+    Real * out_cur = out.data() + i * width ;
+
     for( int j = 1 ; j < width - 1 ; ++j )
     {
-      // Retrieve neighbors : TODO check if we need a cache efficient version ?
-      n_diff[0] = diff( i , j + 1 ) ;
-      n_diff[1] = diff( i - 1 , j ) ;
-      n_diff[2] = diff( i , j - 1 ) ;
-      n_diff[3] = diff( i + 1 , j ) ;
-      n_src[0] = src( i , j + 1 ) ;
-      n_src[1] = src( i - 1 , j ) ;
-      n_src[2] = src( i , j - 1 ) ;
-      n_src[3] = src( i + 1 , j ) ;
-
       // Compute diffusion factor for given pixel
-      const Real cur_src = src( i , j ) ;
-      const Real cur_diff = diff( i , j ) ;
-      const Real a = ( cur_diff + n_diff[0] ) * ( n_src[0] - cur_src ) ;
-      const Real b = ( cur_diff + n_diff[1] ) * ( cur_src - n_src[1] ) ;
-      const Real c = ( cur_diff + n_diff[2] ) * ( cur_src - n_src[2] ) ;
-      const Real d = ( cur_diff + n_diff[3] ) * ( n_src[3] - cur_src ) ;
-      const Real value = half_t * ( a - c + d - b ) ;
-      out( i , j ) = value ;
+      const Real cur_src = src_cur[ j ] ;
+      const Real cur_diff = diff_cur[ j ] ;
+      const Real a = ( cur_diff + diff_cur[ j + 1 ] ) * ( src_cur[ j + 1 ] - cur_src ) ;
+      const Real b = ( cur_diff + diff_prev[ j ] ) * ( cur_src - src_prev[ j ] ) ;
+      const Real c = ( cur_diff + diff_cur[ j - 1 ] ) * ( cur_src - src_cur[ j - 1 ] ) ;
+      const Real d = ( cur_diff + diff_next[ j ] ) * ( src_next[ j ] - cur_src ) ;
+      out_cur[ j ] = half_t * ( a - c + d - b ) ;
     }
   }
 }
@@ -96,16 +94,11 @@ void ImageFEDCentral( const Image & src , const Image & diff , const typename Im
 template< typename Image >
 void ImageFEDCentralCPPThread( const Image & src , const Image & diff , const typename Image::Tpixel half_t , Image & out )
 {
-  const int nb_thread = omp_get_max_threads();
-
-  // Compute ranges
-  std::vector< int > range;
-  SplitRange( 1 , (int) ( src.rows() - 1 ) , nb_thread , range ) ;
-
-  #pragma omp parallel for schedule(dynamic)
-  for( int i = 1 ; i < static_cast<int>(range.size()) ; ++i )
+  // one row per iteration: static chunks keep neighbor rows in the same thread cache
+  #pragma omp parallel for schedule(static)
+  for( int i = 1 ; i < static_cast<int>( src.rows() - 1 ) ; ++i )
   {
-    ImageFEDCentral( src, diff, half_t, out, range[i-1] , range[i]) ;
+    ImageFEDCentral( src, diff, half_t, out, i , i + 1 ) ;
   }
 }
 
@@ -231,7 +224,12 @@ void ImageFEDCycle( Image & self , const Image & diff , const std::vector< typen
   for( int i = 0 ; i < tau.size() ; ++i )
   {
     ImageFED( self , diff , tau[i] , tmp ) ;
-    self.array() += tmp.array();
+
+    #pragma omp parallel for schedule(static)
+    for( int row = 0 ; row < static_cast<int>( self.rows() ) ; ++row )
+    {
+      self.row( row ) += tmp.row( row ) ;
+    }
   }
 }
 
@@ -7,9 +7,83 @@
 
 #include "filtering.hpp"
 
+#include <cstdlib>
+
 namespace aliceVision {
 namespace image {
 
+/**
+ * @brief Apply a separable filter with only 3 non-zero taps located at offsets (-step, 0, +step).
+ * @param[in] img Input image
+ * @param[in] hKernel horizontal taps
+ * @param[in] vKernel vertical taps
+ * @param[in] step distance between two taps
+ * @param[out] out Output image
+ * @note borders are mirrored exactly as in SeparableConvolution2d
+ */
+static void sparseSeparableConvolution3(const Image<float>& img,
+                                        const float hKernel[3],
+                                        const float vKernel[3],
+                                        const int step,
+                                        Image<float>& out)
+{
+  const int rows = img.Height();
+  const int cols = img.Width();
+
+  out.resize(cols, rows, false);
+
+  const Image<float>::Base& in = img.GetMat();
+  Eigen::RowVectorXf tempRow(cols + 2 * step);
+
+  #pragma omp parallel for firstprivate(tempRow) schedule(static)
+  for(int row = 0; row < rows; ++row)
+  {
+    // mirrored neighbor rows
+    const int rowUp = std::abs(row - step);
+    const int rowDown = (row + step < rows) ? row + step : 2 * (rows - 1) - (row + step);
+
+    // vertical pass, written in the middle of the padded row
+    auto center = tempRow.segment(step, cols);
+    center = vKernel[0] * in.row(rowUp) + vKernel[2] * in.row(rowDown);
+    if(vKernel[1] != 0.f)
+      center += vKernel[1] * in.row(row);
+
+    // pad the row
+    tempRow.head(step) = center.segment(1, step).reverse();
+    tempRow.tail(step) = center.segment(cols - 2 - step, step).reverse();
+
+    // horizontal pass
+    auto outRow = out.row(row);
+    outRow = hKernel[0] * tempRow.head(cols) + hKernel[2] * tempRow.tail(cols);
+    if(hKernel[1] != 0.f)
+      outRow += hKernel[1] * tempRow.segment(step, cols);
+  }
+}
+
+void ImageScaledScharrXDerivative(const Image<float>& img, Image<float>& out, const int scale, const bool bNormalize)
+{
+  // Scharr parameter for derivative
+  const double w = 10.0 / 3.0;
+  const double norm = bNormalize ? 1.0 / (2.0 * scale * (w + 2.0)) : 1.0;
+
+  const float hKernel[3] = {-1.f, 0.f, 1.f};
+  const float vKernel[3] = {static_cast<float>(norm), static_cast<float>(w * norm), static_cast<float>(norm)};
+
+  sparseSeparableConvolution3(img, hKernel, vKernel, scale, out);
+}
+
+void ImageScaledScharrYDerivative(const Image<float>& img, Image<float>& out, const int scale, const bool bNormalize)
+{
+  // Scharr parameter for derivative
+  const double w = 10.0 / 3.0;
+  const double norm = bNormalize ? 1.0 / (2.0 * scale * (w + 2.0)) : 1.0;
+
+  const float hKernel[3] = {static_cast<float>(norm), static_cast<float>(w * norm), static_cast<float>(norm)};
+  const float vKernel[3] = {-1.f, 0.f, 1.f};
+
+  sparseSeparableConvolution3(img, hKernel, vKernel, scale, out);
+}
+
 Vec ComputeGaussianKernel(const std::size_t size, const double sigma)
 {
   // If kernel size is 0 computes it's size using uber formula
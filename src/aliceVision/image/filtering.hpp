@@ -238,6 +238,28 @@ namespace image {
   }
 
 
+  /**
+   ** Compute X-derivative using scaled Scharr filter (float image specialization)
+   ** Only the 3 non-zero taps of the scaled kernels are evaluated, rows are processed in parallel.
+   ** Borders are mirrored in the same way as SeparableConvolution2d.
+   ** @param img Input image
+   ** @param out Output image
+   ** @param scale scale of filter (1 -> 3x3 filter ; 2 -> 5x5, ...)
+   ** @param bNormalize true if kernel must be normalized
+   **/
+  void ImageScaledScharrXDerivative( const Image<float> & img , Image<float> & out , const int scale , const bool bNormalize = true);
+
+  /**
+   ** Compute Y-derivative using scaled Scharr filter (float image specialization)
+   ** Only the 3 non-zero taps of the scaled kernels are evaluated, rows are processed in parallel.
+   ** Borders are mirrored in the same way as SeparableConvolution2d.
+   ** @param img Input image
+   ** @param out Output image
+   ** @param scale scale of filter (1 -> 3x3 filter ; 2 -> 5x5, ...)
+   ** @param bNormalize true if kernel must be normalized
+   **/
+  void ImageScaledScharrYDerivative( const Image<float> & img , Image<float> & out , const int scale , const bool bNormalize = true);
+
   /**
    ** Compute (isotropic) gaussian filtering of an image using filter width of k * sigma
    ** @param img Input image
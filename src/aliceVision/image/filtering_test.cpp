@@ -98,6 +98,26 @@ BOOST_AUTO_TEST_CASE(Image_Convolution_Scharr_X_Y)
   BOOST_CHECK_NO_THROW(writeImage("out_ScharrY.png", outFilteredCast, image::EImageColorSpace::NO_CONVERSION));
 }
 
+BOOST_AUTO_TEST_CASE(Image_Convolution_Scaled_Scharr_Float_Specialization)
+{
+  Image<float> in(97,61);
+  in.setRandom();
+
+  for(int scale = 1; scale < 6; ++scale)
+  {
+    Image<float> outSparse, outDense;
+
+    // float specialization vs generic separable convolution
+    ImageScaledScharrXDerivative(in, outSparse, scale);
+    ImageScaledScharrXDerivative<Image<float>>(in, outDense, scale);
+    BOOST_CHECK_SMALL((outSparse - outDense).cwiseAbs().maxCoeff(), 1e-6f);
+
+    ImageScaledScharrYDerivative(in, outSparse, scale);
+    ImageScaledScharrYDerivative<Image<float>>(in, outDense, scale);
+    BOOST_CHECK_SMALL((outSparse - outDense).cwiseAbs().maxCoeff(), 1e-6f);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(Image_Convolution_Sobel_X_Y)
 {
   Image<float> in(40,40,true);
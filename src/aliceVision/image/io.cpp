@@ -6,6 +6,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/image/all.hpp>
 
 #include <OpenImageIO/imageio.h>
@@ -195,6 +196,8 @@ void readImage(const std::string& path,
                Image<T>& image,
                EImageColorSpace imageColorSpace)
 {
+  ALICEVISION_TRACE_ZONE("image::readImage");
+
   // check requested channels number
   assert(nchannels == 1 || nchannels >= 3);
 
@@ -218,6 +221,8 @@ void readImage(const std::string& path,
   if(!inBuf.initialized())
     throw std::runtime_error("Cannot find/open image file '" + path + "'.");
 
+  ALICEVISION_TRACE_COUNTER(system::traceCounter::bytesRead, fs::file_size(path));
+
 #if OIIO_VERSION <= (10000 * 2 + 100 * 0 + 8) // OIIO_VERSION <= 2.0.8
   // Workaround for bug in RAW colorspace management in previous versions of OIIO:
   //     When asking sRGB we got sRGB primaries with linear gamma,
@@ -299,6 +304,8 @@ void readImage(const std::string& path,
 
   // copy pixels from oiio to eigen
   image.resize(inSpec.width, inSpec.height, false);
+  ALICEVISION_TRACE_COUNTER(system::traceCounter::allocations, 1);
+  ALICEVISION_TRACE_COUNTER(system::traceCounter::allocatedBytes, image.size() * sizeof(T));
   {
     oiio::ROI exportROI = inBuf.roi();
     exportROI.chbegin = 0;
@@ -316,6 +323,8 @@ void writeImage(const std::string& path,
                 EImageColorSpace imageColorSpace,
                 const oiio::ParamValueList& metadata = oiio::ParamValueList())
 {
+  ALICEVISION_TRACE_ZONE("image::writeImage");
+
   const fs::path bPath = fs::path(path);
   const std::string extension = bPath.extension().string();
   const std::string tmpPath =  (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + extension;
@@ -360,6 +369,8 @@ void writeImage(const std::string& path,
   if(!outBuf->write(tmpPath))
     throw std::runtime_error("Can't write output image file '" + path + "'.");
 
+  ALICEVISION_TRACE_COUNTER(system::traceCounter::bytesWritten, fs::file_size(tmpPath));
+
   // rename temporay filename
   fs::rename(tmpPath, path);
 }
@@ -9,6 +9,8 @@
 
 #include <aliceVision/image/Sampler.hpp>
 
+#include <vector>
+
 namespace aliceVision {
 namespace image {
 
@@ -16,6 +18,8 @@ namespace image {
    ** Half sample an image (ie reduce it's size by a factor 2) using bilinear interpolation
    ** @param src input image
    ** @param out output image
+   ** @note The bilinear sampling at 2 * (i + .5) falls exactly on the source pixel (2i+1, 2j+1),
+   **       so the interpolation is replaced by a direct strided copy.
    **/
   template < typename Image >
   void ImageHalfSample( const Image & src , Image & out )
@@ -23,16 +27,17 @@ namespace image {
     const int new_width  = src.Width() / 2 ;
     const int new_height = src.Height() / 2 ;
 
-    out.resize( new_width , new_height ) ;
-
-    const Sampler2d<SamplerLinear> sampler;
+    out.resize( new_width , new_height , false ) ;
 
+    #pragma omp parallel for schedule(static)
     for( int i = 0 ; i < new_height ; ++i )
     {
+      const typename Image::Tpixel * src_row = src.data() + ( 2 * i + 1 ) * src.Width() ;
+      typename Image::Tpixel * out_row = out.data() + i * new_width ;
+
       for( int j = 0 ; j < new_width ; ++j )
       {
-        // Use .5f offset to ensure mid pixel and correct bilinear sampling
-        out( i , j ) =  sampler( src, 2.f * (i+.5f), 2.f * (j+.5f) );
+        out_row[ j ] = src_row[ 2 * j + 1 ] ;
       }
     }
   }
@@ -59,10 +64,11 @@ namespace image {
 
     out.resize( output_width , output_height );
 
-    std::vector< std::pair< float , float > >::const_iterator it_pos = sampling_pos.begin();
-
+    #pragma omp parallel for schedule(static)
     for( int i = 0 ; i < output_height ; ++i )
     {
+      std::vector< std::pair< float , float > >::const_iterator it_pos = sampling_pos.begin() + i * output_width;
+
       for( int j = 0 ; j < output_width ; ++j , ++it_pos )
       {
         const float input_x = it_pos->second ;
@@ -122,3 +122,25 @@ BOOST_AUTO_TEST_CASE(Ressampling_SampleRotate)
   BOOST_CHECK_NO_THROW(ImageRotation(image, Sampler2d< SamplerSpline16 >(), "SamplerSpline16"));
   BOOST_CHECK_NO_THROW(ImageRotation(image, Sampler2d< SamplerSpline64 >(), "SamplerSpline64"));
 }
+
+BOOST_AUTO_TEST_CASE(Ressampling_HalfSample)
+{
+  Image<float> image(101, 67);
+  image.setRandom();
+
+  Image<float> imageHalf;
+  ImageHalfSample(image, imageHalf);
+
+  BOOST_CHECK_EQUAL(imageHalf.Width(), 50);
+  BOOST_CHECK_EQUAL(imageHalf.Height(), 33);
+
+  // must be the same as bilinear sampling at the center of each 2x2 block
+  const Sampler2d<SamplerLinear> sampler;
+  for(int i = 0; i < imageHalf.Height(); ++i)
+  {
+    for(int j = 0; j < imageHalf.Width(); ++j)
+    {
+      BOOST_CHECK_EQUAL(imageHalf(i, j), sampler(image, 2.f * (i + .5f), 2.f * (j + .5f)));
+    }
+  }
+}
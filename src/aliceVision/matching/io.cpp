@@ -9,6 +9,7 @@
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/config.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Tracer.hpp>
 
 #include <boost/filesystem.hpp>
 #include <boost/range/iterator_range.hpp>
@@ -33,10 +34,14 @@ bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
 
   if(ext == ".txt")
   {
+    ALICEVISION_TRACE_ZONE("matching::LoadMatchFile");
+
     std::ifstream stream(filepath.c_str());
     if (!stream.is_open())
       return false;
 
+    ALICEVISION_TRACE_COUNTER(system::traceCounter::bytesRead, fs::file_size(filepath));
+
     // Read from the text file
     // I J
     // nbDescType
@@ -297,6 +302,8 @@ private:
     const fs::path bPath = fs::path(filepath);
     const std::string tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + bPath.extension().string();
 
+    ALICEVISION_TRACE_ZONE("matching::saveMatchFile");
+
     // write temporary file
     {
       std::ofstream stream(tmpPath.c_str(), std::ios::out);
@@ -317,6 +324,8 @@ private:
       }
     }
 
+    ALICEVISION_TRACE_COUNTER(system::traceCounter::bytesWritten, fs::file_size(tmpPath));
+
     // rename temporary file
     fs::rename(tmpPath, filepath);
   }
@@ -12,6 +12,7 @@
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp>
+#include <aliceVision/system/Tracer.hpp>
 
 #include <boost/progress.hpp>
 
@@ -46,6 +47,8 @@ void robustModelEstimation(
   const bool guidedMatching = false,
   const double distanceRatio = 0.6)
 {
+  ALICEVISION_TRACE_ZONE("matching::robustModelEstimation");
+
   out_geometricMatches.clear();
 
   boost::progress_display progressBar(putativeMatches.size(), std::cout, "Robust Model Estimation\n");
@@ -62,6 +65,8 @@ void robustModelEstimation(
 
     // apply the geometric filter (robust model estimation)
     {
+      ALICEVISION_TRACE_ZONE("matching::geometricEstimation");
+
       MatchesPerDescType inliers;
       GeometryFunctor geometricFilter = functor; // use a copy since we are in a multi-thread context
       const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, inliers);
@@ -9,6 +9,7 @@
 #include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
 #include <aliceVision/matching/IndMatchDecorator.hpp>
 #include <aliceVision/matching/filters.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/progress.hpp>
@@ -215,6 +216,8 @@ void ImageCollectionMatcher_cascadeHashing::Match
   PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
 ) const
 {
+  ALICEVISION_TRACE_ZONE("matching::putativeMatching");
+
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENMP)
   ALICEVISION_LOG_DEBUG("Using the OPENMP thread interface");
 #endif
@@ -11,6 +11,7 @@
 #include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
 #include <aliceVision/matching/RegionsMatcher.hpp>
 #include <aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/progress.hpp>
@@ -35,6 +36,8 @@ void ImageCollectionMatcher_generic::Match(
   feature::EImageDescriberType descType,
   matching::PairwiseMatches & map_PutativesMatches)const // the pairwise photometric corresponding points
 {
+  ALICEVISION_TRACE_ZONE("matching::putativeMatching");
+
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENMP)
   ALICEVISION_LOG_DEBUG("Using the OPENMP thread interface");
 #endif
@@ -82,6 +85,8 @@ void ImageCollectionMatcher_generic::Match(
         continue;
       }
 
+      ALICEVISION_TRACE_ZONE("matching::matchPair");
+
       IndMatches vec_putatives_matches;
       matcher.Match(_f_dist_ratio, regionsJ, vec_putatives_matches);
       #pragma omp critical
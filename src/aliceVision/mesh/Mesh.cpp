@@ -5,6 +5,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "Mesh.hpp"
+#include "MeshConnectivity.hpp"
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/OrientedPoint.hpp>
@@ -28,6 +29,22 @@ Mesh::~Mesh()
 {
 }
 
+const MeshConnectivity& Mesh::getConnectivity() const
+{
+    if(!_connectivity || !_connectivity->matches(*this))
+    {
+        std::shared_ptr<MeshConnectivity> connectivity = std::make_shared<MeshConnectivity>();
+        connectivity->build(*this);
+        _connectivity = connectivity;
+    }
+    return *_connectivity;
+}
+
+void Mesh::invalidateConnectivity()
+{
+    _connectivity.reset();
+}
+
 void Mesh::saveToObj(const std::string& filename)
 {
   ALICEVISION_LOG_INFO("Save mesh to obj: " << filename);
@@ -87,6 +104,7 @@ bool Mesh::loadFromBin(const std::string& binFileName)
     fread(&tris[0], sizeof(Mesh::triangle), ntris, f);
 
     fclose(f);
+    invalidateConnectivity();
     return true;
 }
 
@@ -144,6 +162,7 @@ void Mesh::addMesh(const Mesh& mesh)
             ALICEVISION_LOG_WARNING("addMesh: bad triangle index: " << t.v[0] << " " << t.v[1] << " " << t.v[2] << ", npts: " << mesh.pts.size());
         }
     }
+    invalidateConnectivity();
 
     if(!mesh.uvCoords.empty())
     {
@@ -464,89 +483,52 @@ bool Mesh::doesTriangleIntersectsRectangle(Mesh::triangle_proj& tp, Mesh::rectan
 
 void Mesh::getPtsNeighborTriangles(StaticVector<StaticVector<int>>& out_ptsNeighTris) const
 {
-    // array of tuples <x: vertexIndex, y: triangleIndex, z: numberOfNeighbors>
-    StaticVector<Voxel> vertexNeighborhoodPairs;
-    vertexNeighborhoodPairs.reserve(tris.size() * 3);
-    for(int i = 0; i < tris.size(); ++i)
-    {
-        vertexNeighborhoodPairs.push_back(Voxel(tris[i].v[0], i, 0));
-        vertexNeighborhoodPairs.push_back(Voxel(tris[i].v[1], i, 0));
-        vertexNeighborhoodPairs.push_back(Voxel(tris[i].v[2], i, 0));
-    }
-    qsort(&vertexNeighborhoodPairs[0], vertexNeighborhoodPairs.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
+    const MeshConnectivity& connectivity = getConnectivity();
 
-    int i = 0; // index of the unique pair of <vertex, neighborhood>
-    int j = 0; // index of the vertex
-    int k = 0; // number of neighbors
-    int firstid = 0;
-    while(i < vertexNeighborhoodPairs.size())
-    {
-        k++;
-        // (*vertexNeighborhoodPairs)[i].z = j;
-        if((i == vertexNeighborhoodPairs.size() - 1) || (vertexNeighborhoodPairs[i].x != vertexNeighborhoodPairs[i + 1].x))
-        {
-            vertexNeighborhoodPairs[firstid].z = k; // store the number of neighbors
-            ++j;
-            firstid = i + 1;
-            k = 0;
-        }
-        ++i;
-    }
-    int npts = j;
-
-    out_ptsNeighTris.reserve(pts.size());
     out_ptsNeighTris.resize(pts.size());
 
-    i = 0;
-    for(j = 0; j < npts; ++j)
+    #pragma omp parallel for
+    for(int ptId = 0; ptId < pts.size(); ++ptId)
     {
-        int middlePtId = vertexNeighborhoodPairs[i].x;
-        int nbNeighbors = vertexNeighborhoodPairs[i].z;
-        int i0 = i;
-        int i1 = i + nbNeighbors;
-        i = i1;
-
-        StaticVector<int>& triTmp = out_ptsNeighTris[middlePtId];
-        triTmp.reserve(nbNeighbors);
-        for(int l = i0; l < i1; ++l)
-        {
-            triTmp.push_back(vertexNeighborhoodPairs[l].y); // index of triangle
-        }
+        const MeshConnectivity::IndexRange ptNeighTris = connectivity.getPtNeighborTriangles(ptId);
+        StaticVector<int>& triTmp = out_ptsNeighTris[ptId];
+        triTmp.resize(0);
+        triTmp.getDataWritable().assign(ptNeighTris.begin(), ptNeighTris.end());
     }
 }
 
 void Mesh::getPtsNeighbors(std::vector<std::vector<int>>& out_ptsNeigh) const
 {
+    const MeshConnectivity& connectivity = getConnectivity();
+
     out_ptsNeigh.resize(pts.size());
-    for(int triangleId = 0; triangleId < tris.size(); ++triangleId)
+
+    #pragma omp parallel for
+    for(int ptId = 0; ptId < pts.size(); ++ptId)
     {
-        const Mesh::triangle& triangle = tris[triangleId];
-        for(int k = 0; k < 3; ++k)
-        {
-            int ptId = triangle.v[k];
-            std::vector<int>& ptNeigh = out_ptsNeigh[ptId];
-            if(std::find(ptNeigh.begin(), ptNeigh.end(), triangle.v[(k+1)%3]) == ptNeigh.end())
-                ptNeigh.push_back(triangle.v[(k+1)%3]);
-            if(std::find(ptNeigh.begin(), ptNeigh.end(), triangle.v[(k+2)%3]) == ptNeigh.end())
-                ptNeigh.push_back(triangle.v[(k+2)%3]);
-        }
+        const MeshConnectivity::IndexRange ptNeighPts = connectivity.getPtNeighborPoints(ptId);
+        out_ptsNeigh[ptId].assign(ptNeighPts.begin(), ptNeighPts.end());
     }
 }
 
 
 void Mesh::getPtsNeighPtsOrdered(StaticVector<StaticVector<int>>& out_ptsNeighPts) const
 {
-    StaticVector<StaticVector<int>> ptsNeighborTriangles;
-    getPtsNeighborTriangles(ptsNeighborTriangles);
+    const MeshConnectivity& connectivity = getConnectivity();
 
     out_ptsNeighPts.resize(pts.size());
 
+    #pragma omp parallel for
     for(int middlePtId = 0; middlePtId < pts.size(); ++middlePtId)
     {
-        StaticVector<int>& neighborTriangles = ptsNeighborTriangles[middlePtId];
-        if(neighborTriangles.empty())
+        const MeshConnectivity::IndexRange ptNeighTris = connectivity.getPtNeighborTriangles(middlePtId);
+        if(ptNeighTris.empty())
             continue;
 
+        // local copy: the triangles are removed from the list while walking around the point
+        StaticVector<int> neighborTriangles;
+        neighborTriangles.getDataWritable().assign(ptNeighTris.begin(), ptNeighTris.end());
+
         StaticVector<int> vhid;
         vhid.reserve(neighborTriangles.size() * 2);
         int currentTriPtId = tris[neighborTriangles[0]].v[0];
@@ -1006,6 +988,7 @@ void Mesh::getVisibleTrianglesIndexes(StaticVector<int>& out_visTri, StaticVecto
 
 void Mesh::generateMeshFromTrianglesSubset(const StaticVector<int>& visTris, Mesh& outMesh, StaticVector<int>& out_ptIdToNewPtId) const
 {
+    outMesh.invalidateConnectivity();
     out_ptIdToNewPtId.resize_with(pts.size(), -1); // -1 means unused
     for(int i = 0; i < visTris.size(); i++)
     {
@@ -1057,56 +1040,24 @@ void Mesh::generateMeshFromTrianglesSubset(const StaticVector<int>& visTris, Mes
 
 void Mesh::getNotOrientedEdges(StaticVector<StaticVector<int>>& edgesNeighTris, StaticVector<Pixel>& edgesPointsPairs)
 {
-    StaticVector<Voxel> edges;
-    edges.reserve(tris.size() * 3);
-
-    for(int i = 0; i < tris.size(); i++)
-    {
-        int a = tris[i].v[0];
-        int b = tris[i].v[1];
-        int c = tris[i].v[2];
-        edges.push_back(Voxel(std::min(a, b), std::max(a, b), i));
-        edges.push_back(Voxel(std::min(b, c), std::max(b, c), i));
-        edges.push_back(Voxel(std::min(c, a), std::max(c, a), i));
-    }
+    const MeshConnectivity& connectivity = getConnectivity();
+    const int nbEdges = connectivity.getNbEdges();
 
-    qsort(&edges[0], edges.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
+    edgesNeighTris.resize(nbEdges);
+    edgesPointsPairs.resize(nbEdges);
 
-    edgesNeighTris.reserve(tris.size() * 3);
-    edgesPointsPairs.reserve(tris.size() * 3);
-    // remove duplicities
-    int i0 = 0;
-    long t1 = mvsUtils::initEstimate();
-    for(int i = 0; i < edges.size(); i++)
+    #pragma omp parallel for
+    for(int edgeId = 0; edgeId < nbEdges; ++edgeId)
     {
-        if((i == edges.size() - 1) || (edges[i].x != edges[i + 1].x))
-        {
-            StaticVector<Voxel> edges1;
-            edges1.reserve(i - i0 + 1);
-            edges1.getDataWritable().insert(edges1.begin(), edges.begin()+i0, edges.begin()+i+1);
-            qsort(&edges1[0], edges1.size(), sizeof(Voxel), qSortCompareVoxelByYAsc);
+        const MeshConnectivity::IndexRange halfEdges = connectivity.getEdgeHalfEdges(edgeId);
+        StaticVector<int>& neighTris = edgesNeighTris[edgeId];
+        neighTris.resize(0);
+        neighTris.reserve(halfEdges.size());
+        for(const int halfEdgeId : halfEdges)
+            neighTris.push_back(MeshConnectivity::getHalfEdgeTriangle(halfEdgeId));
 
-            int j0 = 0;
-            for(int j = 0; j < edges1.size(); j++)
-            {
-                if((j == edges1.size() - 1) || (edges1[j].y != edges1[j + 1].y))
-                {
-                    edgesPointsPairs.push_back(Pixel(edges1[j].x, edges1[j].y));
-                    edgesNeighTris.resize(edgesNeighTris.size() + 1);
-                    StaticVector<int>& neighTris = edgesNeighTris.back();
-                    neighTris.reserve(j - j0 + 1);
-                    for(int k = j0; k <= j; k++)
-                    {
-                        neighTris.push_back(edges1[k].z);
-                    }
-                    j0 = j + 1;
-                }
-            }
-            i0 = i + 1;
-        }
-        mvsUtils::printfEstimate(i, edges.size(), t1);
+        edgesPointsPairs[edgeId] = connectivity.getEdgePoints(edgeId);
     }
-    mvsUtils::finishEstimate();
 }
 
 void Mesh::getLaplacianSmoothingVectors(StaticVector<StaticVector<int>>& ptsNeighPts, StaticVector<Point3d>& out_nms,
@@ -1296,6 +1247,7 @@ void Mesh::removeFreePointsFromMesh(StaticVector<int>& out_ptIdToNewPtId)
 
     std::swap(cleanedMesh.pts, pts);
     std::swap(cleanedMesh.tris, tris);
+    invalidateConnectivity();
     std::swap(cleanedMesh._colors, _colors);
 }
 
@@ -1746,6 +1698,7 @@ int Mesh::subdivideMeshOnce(const Mesh& refMesh, const GEO::AdaptiveKdTree& refM
 
     pts.swap(new_pts);
     tris.swap(new_tris);
+    invalidateConnectivity();
     uvCoords.swap(new_uvCoords);
     trisUvIds.swap(new_trisUvIds);
     _trisMtlIds.swap(new_trisMtlIds);
@@ -1801,6 +1754,7 @@ void Mesh::letJustTringlesIdsInMesh(StaticVector<int>& trisIdsToStay)
         trisTmp.push_back(tris[trisIdsToStay[i]]);
     }
     tris.swap(trisTmp);
+    invalidateConnectivity();
 }
 
 void Mesh::computeTrisCams(StaticVector<StaticVector<int>>& trisCams, const mvsUtils::MultiViewParams& mp, const std::string tmpDir)
@@ -1926,6 +1880,7 @@ void Mesh::initFromDepthMap(int stepDetail, const mvsUtils::MultiViewParams& mp,
 
     tris = StaticVector<Mesh::triangle>();
     tris.reserve(w * h * 2);
+    invalidateConnectivity();
     for(int x = 0; x < w - 1 - stepDetail; x += stepDetail)
     {
         for(int y = 0; y < h - 1 - stepDetail; y += stepDetail)
@@ -2064,6 +2019,7 @@ void Mesh::invertTriangleOrientations()
         Mesh::triangle& t = tris[i];
         std::swap(t.v[1], t.v[2]);
     }
+    invalidateConnectivity();
 }
 
 void Mesh::changeTriPtId(int triId, int oldPtId, int newPtId)
@@ -2075,6 +2031,7 @@ void Mesh::changeTriPtId(int triId, int oldPtId, int newPtId)
             tris[triId].v[k] = newPtId;
         }
     }
+    invalidateConnectivity();
 }
 
 int Mesh::getTriPtIndex(int triId, int ptId, bool failIfDoesNotExists) const
@@ -2142,8 +2099,7 @@ bool Mesh::isTriangleObtuse(int triId) const
 
 void Mesh::getLargestConnectedComponentTrisIds(StaticVector<int>& out) const
 {
-    StaticVector<StaticVector<int>> ptsNeighPtsOrdered;
-    getPtsNeighPtsOrdered(ptsNeighPtsOrdered);
+    const MeshConnectivity& connectivity = getConnectivity();
 
     StaticVector<int> colors;
     colors.reserve(pts.size());
@@ -2160,34 +2116,20 @@ void Mesh::getLargestConnectedComponentTrisIds(StaticVector<int>& out) const
         if(colors[i] != -1) // already labelled with a color id
             continue;
 
+        // points are labelled when pushed, so each point is pushed once
         buff.resize(0);
         buff.push_back(i);
-        int nptsOfCol = 0;
+        colors[i] = col;
+        int nptsOfCol = 1;
         while(buff.size() > 0)
         {
-            int ptid = buff.pop();
-            if(colors[ptid] == -1)
-            {
-                colors[ptid] = col;
-                ++nptsOfCol;
-            }
-            else
+            const int ptid = buff.pop();
+            for(const int nptid : connectivity.getPtNeighborPoints(ptid))
             {
-                if(colors[ptid] != col)
+                if(colors[nptid] == -1)
                 {
-                    throw std::runtime_error("getLargestConnectedComponentTrisIds: bad condition.");
-                }
-            }
-            for(int j = 0; j < sizeOfStaticVector<int>(ptsNeighPtsOrdered[ptid]); ++j)
-            {
-                int nptid = ptsNeighPtsOrdered[ptid][j];
-                if((nptid > -1) && (colors[nptid] == -1))
-                {
-                    if(buff.size() >= buff.capacity()) // should not happen but no problem
-                    {
-                        ALICEVISION_LOG_WARNING("getLargestConnectedComponentTrisIds: bad condition.");
-                        buff.reserveAdd(pts.size());
-                    }
+                    colors[nptid] = col;
+                    ++nptsOfCol;
                     buff.push_back(nptid);
                 }
             }
@@ -2274,6 +2216,7 @@ bool Mesh::loadFromObjAscii(const std::string& objAsciiFileName)
     pts.reserve(npts);
     tris = StaticVector<Mesh::triangle>();
     tris.reserve(ntris);
+    invalidateConnectivity();
     uvCoords.reserve(nuvs);
     trisUvIds.reserve(ntris);
     normals.reserve(nnorms);
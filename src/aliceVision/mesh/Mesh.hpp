@@ -16,9 +16,13 @@
 
 #include <geogram/points/kd_tree.h>
 
+#include <memory>
+
 namespace aliceVision {
 namespace mesh {
 
+class MeshConnectivity;
+
 using PointVisibility = StaticVector<int>;
 using PointsVisibility = StaticVector<PointVisibility>;
 
@@ -113,6 +117,8 @@ protected:
     std::vector<rgb> _colors;
     /// Per triangle material id
     std::vector<int> _trisMtlIds;
+    /// Cached connectivity, shared by the copies of the mesh until their topology changes
+    mutable std::shared_ptr<const MeshConnectivity> _connectivity;
 
 public:
     StaticVector<Point3d> pts;
@@ -152,6 +158,19 @@ public:
     void getDepthMap(StaticVector<float>& depthMap, StaticVector<StaticVector<int>>& tmp, const mvsUtils::MultiViewParams& mp, int rc,
                      int scale, int w, int h);
 
+    /**
+     * @brief Get the mesh connectivity, built on the first call and kept until the topology changes.
+     *        The Mesh methods which modify the triangles invalidate it, code which directly modifies
+     *        the triangles must call invalidateConnectivity().
+     * @note The first call is not thread-safe.
+     */
+    const MeshConnectivity& getConnectivity() const;
+
+    /**
+     * @brief Release the cached connectivity after a topology change
+     */
+    void invalidateConnectivity();
+
     void getPtsNeighbors(std::vector<std::vector<int>>& out_ptsNeighTris) const;
     void getPtsNeighborTriangles(StaticVector<StaticVector<int>>& out_ptsNeighTris) const;
     void getPtsNeighPtsOrdered(StaticVector<StaticVector<int>>& out_ptsNeighTris) const;
@@ -5,6 +5,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "MeshClean.hpp"
+#include "MeshConnectivity.hpp"
 #include <aliceVision/system/Logger.hpp>
 
 namespace aliceVision {
@@ -556,6 +557,29 @@ bool MeshClean::path::isWrongPt()
     return (nNewPtsNeededToAdd > 0);
 }
 
+bool MeshClean::path::getManifoldPath(StaticVector<MeshClean::path::pathPart>& out_path)
+{
+    out_path.clear();
+
+    if(meshClean->ptsNeighTrisSortedAsc[_ptId].empty())
+        return true;
+
+    StaticVector<int> ptNeighTrisSortedAscToProcess;
+    ptNeighTrisSortedAscToProcess.reserve(sizeOfStaticVector<int>(meshClean->ptsNeighTrisSortedAsc[_ptId]));
+    ptNeighTrisSortedAscToProcess.push_back_arr(meshClean->ptsNeighTrisSortedAsc[_ptId]);
+
+    StaticVector<MeshClean::path::pathPart> path;
+    createPath(ptNeighTrisSortedAscToProcess, path);
+
+    // not connected triangles
+    if(ptNeighTrisSortedAscToProcess.size() > 0)
+        return false;
+
+    // the fan should be a single path or cycle
+    removeCycleFromPath(path, out_path);
+    return path.empty();
+}
+
 MeshClean::MeshClean(mvsUtils::MultiViewParams* _mp)
     : Mesh()
 {
@@ -635,15 +659,10 @@ void MeshClean::init()
 {
     deallocateCleaningAttributes();
 
+    const MeshConnectivity& connectivity = getConnectivity();
+
+    // the connectivity lists the triangles of each point in increasing order
     getPtsNeighborTriangles(ptsNeighTrisSortedAsc);
-    for(int i = 0; i < pts.size(); i++)
-    {
-        StaticVector<int>& ptNeigTris = ptsNeighTrisSortedAsc[i];
-        if(sizeOfStaticVector<int>(ptNeigTris) > 1)
-        {
-            qsort(&ptNeigTris[0], ptNeigTris.size(), sizeof(int), qSortCompareIntAsc);
-        }
-    }
 
     ptsNeighPtsOrdered.reserve(pts.size());
     ptsNeighPtsOrdered.resize(pts.size());
@@ -659,65 +678,36 @@ void MeshClean::init()
     edgesXStat.reserve(pts.size());
     edgesXYStat.reserve(tris.size() * 3);
 
-    for(int i = 0; i < tris.size(); i++)
-    {
-        int a = tris[i].v[0];
-        int b = tris[i].v[1];
-        int c = tris[i].v[2];
-        edgesNeigTris.push_back(Voxel(std::max(a, b), std::min(a, b), i));
-        edgesNeigTris.push_back(Voxel(std::max(b, c), std::min(b, c), i));
-        edgesNeigTris.push_back(Voxel(std::max(c, a), std::min(c, a), i));
-
-        edgesNeigTrisAlive.push_back(true);
-        edgesNeigTrisAlive.push_back(true);
-        edgesNeigTrisAlive.push_back(true);
-    }
+    edgesNeigTrisAlive.resize_with(tris.size() * 3, true);
 
-    qsort(&edgesNeigTris[0], edgesNeigTris.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
-
-    // sort
-    int i0 = 0;
-    long t1 = mvsUtils::initEstimate();
-    for(int i = 0; i < edgesNeigTris.size(); i++)
+    // edges <highest point, lowest point, triangle> sorted by highest point, then lowest point, then triangle
+    for(int ptId1 = 0; ptId1 < pts.size(); ++ptId1)
     {
+        const MeshConnectivity::IndexRange ptNeighPts = connectivity.getPtNeighborPoints(ptId1);
+        const MeshConnectivity::IndexRange ptNeighEdges = connectivity.getPtNeighborEdges(ptId1);
+        const int xyI0 = edgesXYStat.size();
 
-        if((i == edgesNeigTris.size() - 1) || (edgesNeigTris[i].x != edgesNeigTris[i + 1].x))
+        for(int i = 0; (i < ptNeighPts.size()) && (ptNeighPts[i] < ptId1); ++i)
         {
-            if(i - i0 + 1 > 1)
-                qsort(&edgesNeigTris[i0], i - i0 + 1, sizeof(Voxel), qSortCompareVoxelByYAsc);
+            const int ptId2 = ptNeighPts[i];
+            const int j0 = edgesNeigTris.size();
 
-            int xyI0 = edgesXYStat.size();
+            for(const int halfEdgeId : connectivity.getEdgeHalfEdges(ptNeighEdges[i]))
+                edgesNeigTris.push_back(Voxel(ptId1, ptId2, MeshConnectivity::getHalfEdgeTriangle(halfEdgeId)));
 
-            int j0 = i0;
-            for(int j = i0; j <= i; j++)
-            {
-                if((j == i) || (edgesNeigTris[j].y != edgesNeigTris[j + 1].y))
-                {
-                    if(j - j0 + 1 > 1)
-                        qsort(&edgesNeigTris[j0], j - j0 + 1, sizeof(Voxel), qSortCompareVoxelByZAsc);
-
-                    edgesXYStat.push_back(Voxel(edgesNeigTris[j].y, j0, j));
-                    j0 = j + 1;
-                }
-            }
-
-            int xyI = edgesXYStat.size() - 1;
-
-            // printf("%i of %i\n",edgesXStat->size(),edgesXStat->reserved());
-            edgesXStat.push_back(Voxel(edgesNeigTris[i].x, xyI0, xyI));
-
-            i0 = i + 1;
+            edgesXYStat.push_back(Voxel(ptId2, j0, edgesNeigTris.size() - 1));
         }
 
-        mvsUtils::printfEstimate(i, edgesNeigTris.size(), t1);
+        if(edgesXYStat.size() > xyI0)
+            edgesXStat.push_back(Voxel(ptId1, xyI0, edgesXYStat.size() - 1));
     }
-    mvsUtils::finishEstimate();
 }
 
 void MeshClean::testPtsNeighTrisSortedAsc()
 {
     ALICEVISION_LOG_DEBUG("Testing if each point of each triangle has the triangleid in ptsNeighTris array.");
     int n = 0;
+#pragma omp parallel for reduction(+:n)
     for(int i = 0; i < tris.size(); i++)
     {
         for(int k = 0; k < 3; k++)
@@ -741,6 +731,7 @@ void MeshClean::testPtsNeighTrisSortedAsc()
 
     ALICEVISION_LOG_DEBUG("Testing for each pt if all neigh triangles are sorted by id in asc");
     n = 0;
+#pragma omp parallel for reduction(+:n)
     for(int i = 0; i < pts.size(); i++)
     {
         StaticVector<int>& ptNeighTris = ptsNeighTrisSortedAsc[i];
@@ -768,6 +759,7 @@ void MeshClean::testEdgesNeighTris()
 {
     ALICEVISION_LOG_DEBUG("Testing if each edge of each triangle has the triangleid in edgeNeighTris array");
     int n = 0;
+#pragma omp parallel for reduction(+:n)
     for(int i = 0; i < tris.size(); i++)
     {
         for(int k = 0; k < 3; k++)
@@ -808,6 +800,7 @@ void MeshClean::testPtsNeighPtsOrdered()
 {
     ALICEVISION_LOG_DEBUG("Testing if each edge of each triangle has both pts in ptsNeighPtsOrdered");
     int n = 0;
+#pragma omp parallel for reduction(+:n)
     for(int i = 0; i < tris.size(); i++)
     {
         for(int k = 0; k < 3; k++)
@@ -849,10 +842,60 @@ int MeshClean::cleanMesh()
 {
     int nWrongPts = 0;
     int nv = pts.size();
+
+    // find the manifold points in parallel and update their neighborhood,
+    // this doesn't modify the mesh so the points are independent
+    std::vector<char> isWrongPt(nv, 0);
+
+#pragma omp parallel for
     for(int i = 0; i < nv; i++)
     {
         path pth(this, i);
-        nWrongPts += static_cast<int>(pth.deployAll() > 0);
+        StaticVector<path::pathPart> manifoldPath;
+        bool isManifold = false;
+
+        try
+        {
+            isManifold = pth.getManifoldPath(manifoldPath);
+        }
+        catch(const std::exception&)
+        {
+            // let the sequential pass handle (and report) it
+        }
+
+        if(!isManifold)
+        {
+            isWrongPt[i] = 1;
+        }
+        else if(!manifoldPath.empty())
+        {
+            // all the triangles are in the path, ptsNeighTrisSortedAsc is unchanged
+            ptsBoundary[i] = (!pth.isClodePath(manifoldPath));
+            pth.updatePtNeighPtsOrderedByPath(i, manifoldPath);
+        }
+    }
+
+    // deploy the wrong points sequentially, in the points order.
+    // deploying a point changes the triangles around it, so the next neighbor points are updated again.
+    std::vector<char> isModifiedPt(nv, 0);
+
+    for(int i = 0; i < nv; i++)
+    {
+        if(!isWrongPt[i] && !isModifiedPt[i])
+            continue;
+
+        const StaticVector<int> ptNeighTris = ptsNeighTrisSortedAsc[i];
+
+        path pth(this, i);
+        if(pth.deployAll() > 0)
+        {
+            ++nWrongPts;
+
+            for(const int triId : ptNeighTris)
+                for(int k = 0; k < 3; ++k)
+                    if(tris[triId].v[k] < nv)
+                        isModifiedPt[tris[triId].v[k]] = 1;
+        }
     }
     // update vertex color data (if any) if points were modified
     if(_colors.size() > 0 && newPtsOldPtId.size() != 0)
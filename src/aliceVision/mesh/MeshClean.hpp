@@ -68,6 +68,13 @@ public:
         void createPath(StaticVector<int>& ptNeighTrisSortedAscToProcess, StaticVector<pathPart>& out_path);
         int deployAll();
         bool isWrongPt();
+
+        /**
+         * @brief Get the triangles fan around the point if it is manifold, without modifying the mesh
+         * @param[out] out_path the triangles fan around the point (empty if the point has no triangle)
+         * @return false if the point needs to be deployed
+         */
+        bool getManifoldPath(StaticVector<pathPart>& out_path);
     };
 
     mvsUtils::MultiViewParams* mp;
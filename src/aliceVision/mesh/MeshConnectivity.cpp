@@ -0,0 +1,203 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MeshConnectivity.hpp"
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <functional>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace {
+
+/**
+ * @brief Parallel counting sort of the items [0, nbItems) by bucket id (a single radix pass over the bucket ids).
+ *        Items with a negative bucket id are dropped.
+ *        The items of each bucket are then sorted with the given comparator,
+ *        so the result does not depend on the number of threads.
+ * @param[in] nbBuckets the number of buckets
+ * @param[in] nbItems the number of items
+ * @param[in] getBucket function returning the bucket id of an item
+ * @param[in] compare comparator of the items in a bucket
+ * @param[out] offsets the first item index of each bucket (size nbBuckets + 1)
+ * @param[out] items the items grouped by bucket
+ */
+template<typename BucketFunction, typename Compare>
+void bucketSort(int nbBuckets, int nbItems, const BucketFunction& getBucket, const Compare& compare,
+                std::vector<int>& offsets, std::vector<int>& items)
+{
+    offsets.assign(nbBuckets + 1, 0);
+
+    #pragma omp parallel for
+    for(int i = 0; i < nbItems; ++i)
+    {
+        const int bucket = getBucket(i);
+        if(bucket < 0)
+            continue;
+        #pragma omp atomic
+        ++offsets[bucket + 1];
+    }
+
+    for(int b = 0; b < nbBuckets; ++b)
+        offsets[b + 1] += offsets[b];
+
+    items.resize(offsets[nbBuckets]);
+    std::vector<int> cursors(offsets.begin(), offsets.end() - 1);
+
+    #pragma omp parallel for
+    for(int i = 0; i < nbItems; ++i)
+    {
+        const int bucket = getBucket(i);
+        if(bucket < 0)
+            continue;
+        int position;
+        #pragma omp atomic capture
+        position = cursors[bucket]++;
+        items[position] = i;
+    }
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(int b = 0; b < nbBuckets; ++b)
+        std::sort(items.begin() + offsets[b], items.begin() + offsets[b + 1], compare);
+}
+
+} // namespace
+
+void MeshConnectivity::build(const Mesh& mesh)
+{
+    system::Timer timer;
+
+    const StaticVector<Mesh::triangle>& tris = mesh.tris;
+    const int nbPts = mesh.pts.size();
+    const int nbHalfEdges = 3 * tris.size();
+
+    // corner point and highest point of each half-edge, triangles with invalid point ids are ignored
+    std::vector<int> halfEdgesPt(nbHalfEdges);
+    std::vector<int> halfEdgesHighPt(nbHalfEdges);
+
+    #pragma omp parallel for
+    for(int triId = 0; triId < tris.size(); ++triId)
+    {
+        const Mesh::triangle& t = tris[triId];
+        const bool valid = (t.v[0] >= 0 && t.v[0] < nbPts) && (t.v[1] >= 0 && t.v[1] < nbPts) && (t.v[2] >= 0 && t.v[2] < nbPts);
+        for(int k = 0; k < 3; ++k)
+        {
+            halfEdgesPt[3 * triId + k] = valid ? t.v[k] : -1;
+            halfEdgesHighPt[3 * triId + k] = valid ? std::max(t.v[k], t.v[(k + 1) % 3]) : -1;
+        }
+    }
+
+    const auto getCornerPt = [&](int halfEdgeId) { return halfEdgesPt[halfEdgeId]; };
+    const auto getHighPt = [&](int halfEdgeId) { return halfEdgesHighPt[halfEdgeId]; };
+    const auto getLowPt = [&](int halfEdgeId) {
+        const int nextHalfEdgeId = (halfEdgeId % 3 == 2) ? halfEdgeId - 2 : halfEdgeId + 1;
+        return std::min(halfEdgesPt[halfEdgeId], halfEdgesPt[nextHalfEdgeId]);
+    };
+
+    // vertex -> triangles: corners grouped by point
+    bucketSort(nbPts, nbHalfEdges, getCornerPt, std::less<int>(), _ptsTrisOffsets, _ptsTris);
+
+    #pragma omp parallel for
+    for(int i = 0; i < static_cast<int>(_ptsTris.size()); ++i)
+        _ptsTris[i] /= 3;
+
+    // edges: half-edges grouped by lowest point, then sorted by highest point
+    std::vector<int> lowPtOffsets;
+    bucketSort(nbPts, nbHalfEdges, getLowPt,
+               [&](int a, int b) {
+                   const int highA = getHighPt(a);
+                   const int highB = getHighPt(b);
+                   return (highA != highB) ? (highA < highB) : (a < b);
+               },
+               lowPtOffsets, _edgesHalfEdges);
+
+    std::vector<int> edgesOffsets(nbPts + 1, 0);
+
+    #pragma omp parallel for
+    for(int ptId = 0; ptId < nbPts; ++ptId)
+    {
+        int nbEdges = 0;
+        for(int i = lowPtOffsets[ptId]; i < lowPtOffsets[ptId + 1]; ++i)
+        {
+            if(i == lowPtOffsets[ptId] || getHighPt(_edgesHalfEdges[i]) != getHighPt(_edgesHalfEdges[i - 1]))
+                ++nbEdges;
+        }
+        edgesOffsets[ptId + 1] = nbEdges;
+    }
+
+    for(int ptId = 0; ptId < nbPts; ++ptId)
+        edgesOffsets[ptId + 1] += edgesOffsets[ptId];
+
+    const int nbEdges = edgesOffsets[nbPts];
+    _edgesPts.resize(nbEdges);
+    _edgesHalfEdgesOffsets.resize(nbEdges + 1);
+    _edgesHalfEdgesOffsets[nbEdges] = static_cast<int>(_edgesHalfEdges.size());
+    _halfEdgesEdge.assign(nbHalfEdges, -1);
+
+    #pragma omp parallel for
+    for(int ptId = 0; ptId < nbPts; ++ptId)
+    {
+        int edgeId = edgesOffsets[ptId] - 1;
+        for(int i = lowPtOffsets[ptId]; i < lowPtOffsets[ptId + 1]; ++i)
+        {
+            const int halfEdgeId = _edgesHalfEdges[i];
+            const int highPt = getHighPt(halfEdgeId);
+
+            if(i == lowPtOffsets[ptId] || highPt != getHighPt(_edgesHalfEdges[i - 1]))
+            {
+                ++edgeId;
+                _edgesPts[edgeId] = Pixel(ptId, highPt);
+                _edgesHalfEdgesOffsets[edgeId] = i;
+            }
+            _halfEdgesEdge[halfEdgeId] = edgeId;
+        }
+    }
+
+    // vertex -> vertices: both sides of each edge, null edges excluded
+    const auto getOtherPt = [&](int item) {
+        const Pixel& edgePts = _edgesPts[item / 2];
+        return (item % 2 == 0) ? edgePts.y : edgePts.x;
+    };
+
+    std::vector<int> ptsItems;
+    bucketSort(nbPts, 2 * nbEdges,
+               [&](int item) {
+                   const Pixel& edgePts = _edgesPts[item / 2];
+                   if(edgePts.x == edgePts.y)
+                       return -1;
+                   return (item % 2 == 0) ? edgePts.x : edgePts.y;
+               },
+               [&](int a, int b) { return getOtherPt(a) < getOtherPt(b); },
+               _ptsPtsOffsets, ptsItems);
+
+    _ptsPts.resize(ptsItems.size());
+    _ptsEdges.resize(ptsItems.size());
+
+    #pragma omp parallel for
+    for(int i = 0; i < static_cast<int>(ptsItems.size()); ++i)
+    {
+        _ptsPts[i] = getOtherPt(ptsItems[i]);
+        _ptsEdges[i] = ptsItems[i] / 2;
+    }
+
+    ALICEVISION_LOG_DEBUG("Mesh connectivity built in " << timer.elapsed() << " s:" << std::endl
+                          << "\t- # points: " << nbPts << std::endl
+                          << "\t- # triangles: " << tris.size() << std::endl
+                          << "\t- # edges: " << nbEdges);
+}
+
+bool MeshConnectivity::matches(const Mesh& mesh) const
+{
+    return (getNbPoints() == mesh.pts.size()) && (getNbTriangles() == mesh.tris.size());
+}
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,156 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Pixel.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+class Mesh;
+
+/**
+ * @brief Compact mesh connectivity stored in compressed sparse rows (CSR):
+ *        - vertex -> triangles (ascending triangle ids)
+ *        - vertex -> vertices (ascending vertex ids) with the corresponding edge ids
+ *        - non-oriented edges (sorted by lowest then highest vertex id) -> half-edges
+ *
+ *        The half-edge k of the triangle t (id 3 * t + k) goes from t.v[k] to t.v[(k + 1) % 3].
+ *        Degenerate triangles are kept as they are: a triangle with a repeated vertex is listed
+ *        twice in the vertex neighborhood and its null edge is in the edge table, but a vertex is
+ *        never its own neighbor.
+ */
+class MeshConnectivity
+{
+public:
+    /**
+     * @brief Contiguous range of indexes in one of the CSR arrays
+     */
+    class IndexRange
+    {
+    public:
+        IndexRange(const int* begin, const int* end)
+          : _begin(begin)
+          , _end(end)
+        {}
+
+        inline const int* begin() const { return _begin; }
+        inline const int* end() const { return _end; }
+        inline int size() const { return static_cast<int>(_end - _begin); }
+        inline bool empty() const { return _begin == _end; }
+        inline int operator[](int i) const { return _begin[i]; }
+
+    private:
+        const int* _begin;
+        const int* _end;
+    };
+
+    /**
+     * @brief Build the connectivity of a mesh, in parallel
+     * @param[in] mesh the input mesh
+     */
+    void build(const Mesh& mesh);
+
+    /**
+     * @brief Check if the connectivity has been built for a mesh with the same number of points and triangles
+     */
+    bool matches(const Mesh& mesh) const;
+
+    inline int getNbPoints() const { return static_cast<int>(_ptsTrisOffsets.size()) - 1; }
+    inline int getNbTriangles() const { return static_cast<int>(_halfEdgesEdge.size()) / 3; }
+    inline int getNbEdges() const { return static_cast<int>(_edgesPts.size()); }
+
+    /// triangles around a point, in increasing order
+    inline IndexRange getPtNeighborTriangles(int ptId) const
+    {
+        return getRange(_ptsTris, _ptsTrisOffsets, ptId);
+    }
+
+    /// points connected to a point by an edge, in increasing order
+    inline IndexRange getPtNeighborPoints(int ptId) const
+    {
+        return getRange(_ptsPts, _ptsPtsOffsets, ptId);
+    }
+
+    /// edges between a point and each of its neighbor points (same order as getPtNeighborPoints)
+    inline IndexRange getPtNeighborEdges(int ptId) const
+    {
+        return getRange(_ptsEdges, _ptsPtsOffsets, ptId);
+    }
+
+    /// points of an edge: x is the lowest point id and y the highest one
+    inline const Pixel& getEdgePoints(int edgeId) const
+    {
+        return _edgesPts[edgeId];
+    }
+
+    /// half-edges of an edge, in increasing order (so by increasing triangle id)
+    inline IndexRange getEdgeHalfEdges(int edgeId) const
+    {
+        return getRange(_edgesHalfEdges, _edgesHalfEdgesOffsets, edgeId);
+    }
+
+    /// edge id of a half-edge
+    inline int getHalfEdgeEdge(int halfEdgeId) const
+    {
+        return _halfEdgesEdge[halfEdgeId];
+    }
+
+    /// opposite half-edge on the neighbor triangle, -1 on boundary or non-manifold edges
+    inline int getHalfEdgeTwin(int halfEdgeId) const
+    {
+        const IndexRange halfEdges = getEdgeHalfEdges(_halfEdgesEdge[halfEdgeId]);
+        if(halfEdges.size() != 2)
+            return -1;
+        return (halfEdges[0] == halfEdgeId) ? halfEdges[1] : halfEdges[0];
+    }
+
+    static inline int getHalfEdgeId(int triId, int k)
+    {
+        return 3 * triId + k;
+    }
+
+    static inline int getHalfEdgeTriangle(int halfEdgeId)
+    {
+        return halfEdgeId / 3;
+    }
+
+    inline bool isBoundaryEdge(int edgeId) const
+    {
+        return getEdgeHalfEdges(edgeId).size() == 1;
+    }
+
+    inline bool isManifoldEdge(int edgeId) const
+    {
+        return getEdgeHalfEdges(edgeId).size() == 2;
+    }
+
+private:
+    static inline IndexRange getRange(const std::vector<int>& values, const std::vector<int>& offsets, int i)
+    {
+        return IndexRange(values.data() + offsets[i], values.data() + offsets[i + 1]);
+    }
+
+    // vertex -> triangles
+    std::vector<int> _ptsTrisOffsets;
+    std::vector<int> _ptsTris;
+    // vertex -> vertices and edges
+    std::vector<int> _ptsPtsOffsets;
+    std::vector<int> _ptsPts;
+    std::vector<int> _ptsEdges;
+    // edges -> half-edges
+    std::vector<Pixel> _edgesPts;
+    std::vector<int> _edgesHalfEdgesOffsets;
+    std::vector<int> _edgesHalfEdges;
+    // half-edge -> edge
+    std::vector<int> _halfEdgesEdge;
+};
+
+} // namespace mesh
+} // namespace aliceVision
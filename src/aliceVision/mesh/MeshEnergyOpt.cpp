@@ -6,74 +6,102 @@
 
 #include "MeshEnergyOpt.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
 
 #include <boost/filesystem.hpp>
 
+#include <cmath>
+#include <vector>
+
 namespace aliceVision {
 namespace mesh {
 
 namespace bfs = boost::filesystem;
 
-MeshEnergyOpt::MeshEnergyOpt(mvsUtils::MultiViewParams* _mp)
-    : MeshAnalyze(_mp)
+namespace {
+
+/**
+ * @brief Smoothing state, allocated once for all the iterations.
+ *        Coordinates are stored as separate x/y/z arrays so the per point passes stay vectorizable.
+ */
+struct SmoothingData
 {
-//    tmpDir = mp->mvDir + "meshEnergyOpt/";
-//    bfs::create_directory(tmpDir);
+    /// neighbors of the point i are neighbors[neighborsOffsets[i]] to neighbors[neighborsOffsets[i+1]-1]
+    std::vector<int> neighborsOffsets;
+    std::vector<int> neighbors;
+    /// 1 / v with v the bi-Laplacian normalization factor (0 if the point has no neighbor or no triangle)
+    std::vector<double> biLaplacianFactors;
+
+    /// point coordinates
+    std::vector<double> x, y, z;
+    /// Laplacian vectors (0 if the Laplacian is invalid)
+    std::vector<double> lx, ly, lz;
+    /// smoothing vectors (0 if the point doesn't move)
+    std::vector<double> bx, by, bz;
+};
+
+inline bool isZero(double x, double y, double z)
+{
+    return (x == 0.0) && (y == 0.0) && (z == 0.0);
 }
 
-MeshEnergyOpt::~MeshEnergyOpt() = default;
-
-void MeshEnergyOpt::computeLaplacianPtsParallel(StaticVector<Point3d>& out_lapPts)
+/**
+ * @brief Check that a Laplacian vector can be normalized
+ */
+inline bool isValidVector(double x, double y, double z)
 {
-    out_lapPts.reserve(pts.size());
-    out_lapPts.resize_with(pts.size(), Point3d(0.0f, 0.0f, 0.f));
-    int nlabpts = 0;
-
-#pragma omp parallel for
-    for(int i = 0; i < pts.size(); i++)
-    {
-        Point3d lapPt;
-        if(getLaplacianSmoothingVector(i, lapPt))
-        {
-            out_lapPts[i] = lapPt;
-            nlabpts++;
-        }
-    }
+    const double size2 = x * x + y * y + z * z;
+    return (size2 > 0.0) && std::isfinite(size2);
 }
 
-void MeshEnergyOpt::updateGradientParallel(float lambda, const Point3d& LU,
-                                                const Point3d& RD, StaticVectorBool& ptsCanMove)
+/**
+ * @brief Apply the umbrella operator to the point i
+ * @note fails if a neighbor value is exactly zero, as it marks an invalid Laplacian
+ * @return false if the result is invalid
+ */
+inline bool applyUmbrellaOperator(const SmoothingData& data, int i,
+                                  const std::vector<double>& vx, const std::vector<double>& vy, const std::vector<double>& vz,
+                                  double& ox, double& oy, double& oz)
 {
-    // printf("nlabpts %i of %i\n",nlabpts,pts->size());
-    StaticVector<Point3d> lapPts;
-    computeLaplacianPtsParallel(lapPts);
+    const int begin = data.neighborsOffsets[i];
+    const int end = data.neighborsOffsets[i + 1];
+
+    if(begin == end)
+        return false;
 
-    StaticVector<Point3d> newPts;
-    newPts.reserve(pts.size());
-    newPts.push_back_arr(&pts);
+    double sx = 0.0;
+    double sy = 0.0;
+    double sz = 0.0;
 
-#pragma omp parallel for
-    for(int i = 0; i < pts.size(); ++i)
+    for(int j = begin; j < end; ++j)
     {
-        if( ptsCanMove.empty() || ptsCanMove[i] )
-        {
-            Point3d n;
-
-            if(getBiLaplacianSmoothingVector(i, lapPts, n))
-            {
-                Point3d p = newPts[i] + n * lambda;
-                if((p.x > LU.x) && (p.y > LU.y) && (p.z > LU.z) && (p.x < RD.x) && (p.y < RD.y) && (p.z < RD.z))
-                {
-                    newPts[i] = p;
-                }
-            }
-        }
+        const int n = data.neighbors[j];
+        if(isZero(vx[n], vy[n], vz[n]))
+            return false;
+        sx += vx[n];
+        sy += vy[n];
+        sz += vz[n];
     }
 
-    pts.clear();
-    pts.swap(newPts);
+    const float size = static_cast<float>(end - begin);
+    ox = sx / size - vx[i];
+    oy = sy / size - vy[i];
+    oz = sz / size - vz[i];
+
+    return isValidVector(ox, oy, oz);
+}
+
+} // namespace
+
+MeshEnergyOpt::MeshEnergyOpt(mvsUtils::MultiViewParams* _mp)
+    : MeshAnalyze(_mp)
+{
+//    tmpDir = mp->mvDir + "meshEnergyOpt/";
+//    bfs::create_directory(tmpDir);
 }
 
+MeshEnergyOpt::~MeshEnergyOpt() = default;
+
 bool MeshEnergyOpt::optimizeSmooth(float lambda, int niter, StaticVectorBool& ptsCanMove)
 {
     if(pts.size() <= 4)
@@ -100,14 +128,108 @@ bool MeshEnergyOpt::optimizeSmooth(float lambda, int niter, StaticVectorBool& pt
                          << "\t- lamda: " << lambda << std::endl
                          << "\t- niters: " << niter << std::endl);
 
-    for(int i = 0; i < niter; i++)
+    const system::Timer timer;
+    const int nbPoints = pts.size();
+    SmoothingData data;
+
+    // flatten the point neighborhoods
+    data.neighborsOffsets.resize(nbPoints + 1, 0);
+    for(int i = 0; i < nbPoints; ++i)
+        data.neighborsOffsets[i + 1] = data.neighborsOffsets[i] + sizeOfStaticVector<int>(ptsNeighPtsOrdered[i]);
+
+    data.neighbors.resize(data.neighborsOffsets[nbPoints]);
+    data.biLaplacianFactors.resize(nbPoints, 0.0);
+    data.x.resize(nbPoints);
+    data.y.resize(nbPoints);
+    data.z.resize(nbPoints);
+    data.lx.resize(nbPoints);
+    data.ly.resize(nbPoints);
+    data.lz.resize(nbPoints);
+    data.bx.resize(nbPoints);
+    data.by.resize(nbPoints);
+    data.bz.resize(nbPoints);
+
+#pragma omp parallel for
+    for(int i = 0; i < nbPoints; ++i)
     {
-        ALICEVISION_LOG_INFO("Optimizing mesh smooth: iteration " << i);
-        updateGradientParallel(lambda, LU, RD, ptsCanMove);
+        data.x[i] = pts[i].x;
+        data.y[i] = pts[i].y;
+        data.z[i] = pts[i].z;
+
+        const StaticVector<int>& ptNeighPtsOrdered = ptsNeighPtsOrdered[i];
+        if(ptNeighPtsOrdered.empty())
+            continue;
+
+        std::copy(ptNeighPtsOrdered.begin(), ptNeighPtsOrdered.end(), data.neighbors.begin() + data.neighborsOffsets[i]);
+
+        if(ptsNeighTrisSortedAsc[i].empty())
+            continue;
+
+        // Kobbelt et al. 98, Interactive Multi-Resolution Modeling on Arbitrary Meshes, page 6 eq (8)
+        float sum = 0.0f;
+        for(const int neighPtId : ptNeighPtsOrdered)
+        {
+            const int neighValence = sizeOfStaticVector<int>(ptsNeighPtsOrdered[neighPtId]);
+            if(neighValence > 0)
+                sum += 1.0f / (float)neighValence;
+        }
+        const float v = 1.0f + (1.0f / (float)ptNeighPtsOrdered.size()) * sum;
+        data.biLaplacianFactors[i] = 1.0f / v;
+    }
+
+    const bool allPtsCanMove = ptsCanMove.empty();
+
+    for(int iter = 0; iter < niter; ++iter)
+    {
+        ALICEVISION_LOG_INFO("Optimizing mesh smooth: iteration " << iter);
+
+        // Laplacian of the points
+#pragma omp parallel for
+        for(int i = 0; i < nbPoints; ++i)
+        {
+            double lx, ly, lz;
+            const bool valid = applyUmbrellaOperator(data, i, data.x, data.y, data.z, lx, ly, lz);
+            data.lx[i] = valid ? lx : 0.0;
+            data.ly[i] = valid ? ly : 0.0;
+            data.lz[i] = valid ? lz : 0.0;
+        }
+
+        // bi-Laplacian of the points, applied to the Laplacian
+#pragma omp parallel for
+        for(int i = 0; i < nbPoints; ++i)
+        {
+            double bx, by, bz;
+            const bool valid = (allPtsCanMove || ptsCanMove[i]) && (data.biLaplacianFactors[i] != 0.0) &&
+                               applyUmbrellaOperator(data, i, data.lx, data.ly, data.lz, bx, by, bz);
+            const double factor = valid ? -data.biLaplacianFactors[i] * lambda : 0.0;
+            data.bx[i] = valid ? bx * factor : 0.0;
+            data.by[i] = valid ? by * factor : 0.0;
+            data.bz[i] = valid ? bz * factor : 0.0;
+        }
+
+        // move the points staying in the initial bounding box
+#pragma omp parallel for
+        for(int i = 0; i < nbPoints; ++i)
+        {
+            const double px = data.x[i] + data.bx[i];
+            const double py = data.y[i] + data.by[i];
+            const double pz = data.z[i] + data.bz[i];
+            const bool inside = (px > LU.x) && (py > LU.y) && (pz > LU.z) && (px < RD.x) && (py < RD.y) && (pz < RD.z);
+            data.x[i] = inside ? px : data.x[i];
+            data.y[i] = inside ? py : data.y[i];
+            data.z[i] = inside ? pz : data.z[i];
+        }
+
         //if(saveDebug)
         //    saveToObj(folder + "mesh_smoothed_" + std::to_string(i) + ".obj");
     }
 
+#pragma omp parallel for
+    for(int i = 0; i < nbPoints; ++i)
+        pts[i] = Point3d(data.x[i], data.y[i], data.z[i]);
+
+    ALICEVISION_LOG_INFO("Optimizing mesh smooth done in " << system::prettyTime(timer.elapsedMs()) << ".");
+
     return true;
 }
 
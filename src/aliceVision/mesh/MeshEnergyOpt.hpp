@@ -19,11 +19,15 @@ public:
     explicit MeshEnergyOpt(mvsUtils::MultiViewParams* _mp);
     ~MeshEnergyOpt();
 
+    /**
+     * @brief Smooth the mesh points with the bi-Laplacian (umbrella) operator
+     * @note ptsNeighPtsOrdered and ptsNeighTrisSortedAsc should be up to date (see MeshClean::cleanMesh)
+     * @param[in] lambda the smoothing step
+     * @param[in] niter the number of iterations
+     * @param[in] ptsCanMove the points allowed to move (all points if empty)
+     * @return false if the mesh is too small to be smoothed
+     */
     bool optimizeSmooth(float lambda, int niter, StaticVectorBool& ptsCanMove);
-
-private:
-    void computeLaplacianPtsParallel(StaticVector<Point3d>& out_lapPts);
-    void updateGradientParallel(float lambda, const Point3d& LU, const Point3d& RD, StaticVectorBool& ptsCanMove);
 };
 
 } // namespace mesh
@@ -9,7 +9,8 @@
 #include "UVAtlas.hpp"
 
 #include <aliceVision/system/Logger.hpp>
-#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/mvsData/Color.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
@@ -124,6 +125,60 @@ Point3d barycentricToCartesian(const Point3d* triangle, const Point2d& coords)
     return triangle[0] + (triangle[2] - triangle[0]) * coords.x + (triangle[1] - triangle[0]) * coords.y;
 }
 
+namespace {
+
+/**
+ * @brief Barycentric coordinates of a 2D triangle as linear functions of the position (edge functions).
+ *        Used to classify the pixels of a triangle without computing their distance to it.
+ */
+struct TriangleEdgeFunctions
+{
+    /// barycentric coordinate i at position p: a[i] * p.x + b[i] * p.y + c[i]
+    double a[3];
+    double b[3];
+    double c[3];
+    /// barycentric coordinate i below which a position is more than 0.75 pixel away from the triangle
+    double minCoord[3];
+    /// false for degenerate triangles
+    bool valid = false;
+
+    explicit TriangleEdgeFunctions(const Point2d* triangle)
+    {
+        const double area2 = (triangle[1].x - triangle[0].x) * (triangle[2].y - triangle[0].y) -
+                             (triangle[1].y - triangle[0].y) * (triangle[2].x - triangle[0].x);
+        valid = (area2 != 0.0) && std::isfinite(area2);
+        if(!valid)
+            return;
+
+        for(int i = 0; i < 3; ++i)
+        {
+            const Point2d& pj = triangle[(i + 1) % 3];
+            const Point2d& pk = triangle[(i + 2) % 3];
+            a[i] = (pj.y - pk.y) / area2;
+            b[i] = (pk.x - pj.x) / area2;
+            c[i] = -(a[i] * pj.x + b[i] * pj.y);
+            // coordinate i is the signed distance to the opposite edge divided by the triangle height
+            minCoord[i] = -0.75 * (pk - pj).size() / std::abs(area2);
+        }
+    }
+};
+
+/**
+ * @brief Triangle contribution of a camera to a texture atlas, ready to be rasterized
+ */
+struct TriangleContribution
+{
+    unsigned int triangleId;
+    float score;
+    int band;
+    Point2d triPixs[3];     // UV coordinates (in pixels)
+    Point3d triPts[3];      // 3D coordinates
+    Pixel LU;               // bounding box in pixel indexes
+    Pixel RD;
+};
+
+} // namespace
+
 void Texturing::generateUVsBasicMethod(mvsUtils::MultiViewParams& mp)
 {
     if(!mesh)
@@ -240,6 +295,8 @@ void Texturing::updateAtlases()
 void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
                                  const boost::filesystem::path& outPath, imageIO::EImageFileType textureFileType)
 {
+    ALICEVISION_TRACE_ZONE("texturing::generateTextures");
+
     // Ensure that contribution levels do not contain 0 and are sorted (as each frequency band contributes to lower bands).
     auto& m = texParams.multiBandNbContrib;
     m.erase(std::remove(std::begin(m), std::end(m), 0), std::end(m));
@@ -263,13 +320,14 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
     ALICEVISION_LOG_INFO("Images loaded from cache with: " + imageCache.ECorrectEV_enumToString(texParams.correctEV));
 
     //calculate the maximum number of atlases in memory in MB
-    system::MemoryInfo memInfo = system::getMemoryInfo();
+    //(bounded by the process memory budget if any)
+    const std::size_t availableMemory = system::MemoryBudget::get().getAvailableMemory();
     const std::size_t imageMaxMemSize =  mp.getMaxImageWidth() * mp.getMaxImageHeight() * sizeof(Color) / std::pow(2,20); //MB
     const std::size_t imagePyramidMaxMemSize = texParams.nbBand * imageMaxMemSize;
     const std::size_t atlasContribMemSize = texParams.textureSide * texParams.textureSide * (sizeof(Color)+sizeof(float)) / std::pow(2,20); //MB
     const std::size_t atlasPyramidMaxMemSize = texParams.nbBand * atlasContribMemSize;
 
-    const int freeRam = int(memInfo.freeRam / std::pow(2,20));
+    const int freeRam = int(availableMemory / std::pow(2,20));
     const int availableMem = freeRam - 2 * imageMaxMemSize - imagePyramidMaxMemSize; // keep some memory for the 2 input images in cache and one laplacian pyramid
 
     const int nbAtlas = _atlases.size();
@@ -279,7 +337,7 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
         nbAtlasMax -= 1;
     nbAtlasMax = std::max(1, nbAtlasMax); //if not enough memory, do it one by one
 
-    ALICEVISION_LOG_INFO("Total amount of free RAM  : " << freeRam << " MB.");
+    ALICEVISION_LOG_INFO("Total amount of available RAM  : " << freeRam << " MB.");
     ALICEVISION_LOG_INFO("Total amount of memory available : " << availableMem << " MB.");
     ALICEVISION_LOG_INFO("Total amount of an image in memory  : " << imageMaxMemSize << " MB.");
     ALICEVISION_LOG_INFO("Total amount of an atlas pyramid in memory: " << atlasPyramidMaxMemSize << " MB.");
@@ -303,11 +361,14 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
         ALICEVISION_LOG_INFO("Generating texture for atlases " << n*nbAtlasMax + 1 << " to " << n*nbAtlasMax+imax );
         generateTexturesSubSet(mp, atlasIDs, imageCache, outPath, textureFileType);
     }
+    imageCache.logStats();
 }
 
 void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
                                 const std::vector<size_t>& atlasIDs, mvsUtils::ImagesCache& imageCache, const bfs::path& outPath, imageIO::EImageFileType textureFileType)
 {
+    ALICEVISION_TRACE_ZONE("texturing::generateTexturesSubSet");
+
     if(atlasIDs.size() > _atlases.size())
         throw std::runtime_error("Invalid atlas IDs ");
 
@@ -453,6 +514,19 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
     for(std::size_t atlasID: atlasIDs)
         accuPyramids[atlasID].init(texParams.nbBand, texParams.textureSide, texParams.textureSide);
 
+    const system::MemoryReservation accuPyramidsMemory("texturing.atlasPyramids",
+        atlasIDs.size() * texParams.nbBand * textureSize * (sizeof(Color) + sizeof(float)));
+
+    // downscale factor of each frequency band
+    std::vector<int> bandDownscales(texParams.nbBand);
+    for(int band = 0; band < texParams.nbBand; ++band)
+        bandDownscales[band] = std::pow(texParams.multiBandDownscale, band);
+
+    // atlases are filled by tiles of rows, so that the tasks write distinct texels
+    const int texSide = static_cast<int>(texParams.textureSide);
+    const int tileHeight = 64;
+    const int nbTiles = (texSide + tileHeight - 1) / tileHeight;
+
     //for each camera, for each texture, iterate over triangles and fill the accuPyramids map
     for(int camId = 0; camId < contributionsPerCamera.size(); ++camId)
     {
@@ -469,113 +543,219 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
         mvsUtils::ImagesCache::ImgSharedPtr imgPtr = imageCache.getImg_sync(camId);
         const Image& camImg = *imgPtr;
 
+        // decode the next used camera image in background
+        for(int nextCamId = camId + 1; nextCamId < contributionsPerCamera.size(); ++nextCamId)
+        {
+            if(!contributionsPerCamera[nextCamId].empty())
+            {
+                imageCache.prefetch({nextCamId});
+                break;
+            }
+        }
+
         // Calculate laplacianPyramid
         std::vector<Image> pyramidL; //laplacian pyramid
         camImg.laplacianPyramid(pyramidL, texParams.nbBand, texParams.multiBandDownscale);
 
-        // for each output texture file
+        // list the triangles of each output texture file, by frequency band
+        std::vector<AccuPyramid*> cameraAccuPyramids;
+        std::vector<std::vector<TriangleContribution>> cameraTriangles;
         for(const auto& c : cameraContributions)
         {
             AtlasIndex atlasID = c.first;
             ALICEVISION_LOG_INFO("  - Texture file: " << atlasID + 1);
+            cameraAccuPyramids.push_back(&accuPyramids.at(atlasID));
+            cameraTriangles.emplace_back();
+            std::vector<TriangleContribution>& triangles = cameraTriangles.back();
             //for each frequency band
             for(int band = 0; band < c.second.size(); ++band)
             {
                 const ScorePerTriangle& trianglesId = c.second[band];
                 ALICEVISION_LOG_INFO("      - band " << band + 1 << ": " << trianglesId.size() << " triangles.");
+                for(const auto& triangleScore : trianglesId)
+                {
+                    TriangleContribution triangle;
+                    triangle.triangleId = std::get<0>(triangleScore);
+                    triangle.score = texParams.useScore ? std::get<1>(triangleScore) : 1.0f;
+                    triangle.band = band;
+                    triangles.push_back(triangle);
+                }
+            }
+        }
+
+        // retrieve triangles 3D and UV coordinates, and bucket them by tiles of rows
+        std::vector<std::vector<std::vector<int>>> tilesTriangles(cameraTriangles.size(), std::vector<std::vector<int>>(nbTiles));
+        for(std::size_t a = 0; a < cameraTriangles.size(); ++a)
+        {
+            std::vector<TriangleContribution>& triangles = cameraTriangles[a];
+
+            #pragma omp parallel for
+            for(int ti = 0; ti < triangles.size(); ++ti)
+            {
+                TriangleContribution& triangle = triangles[ti];
+                auto& triangleUvIds = mesh->trisUvIds[triangle.triangleId];
+                // compute the Bottom-Left minima of the current UDIM for [0,1] range remapping
+                Point2d udimBL;
+                StaticVector<Point2d>& uvCoords = mesh->uvCoords;
+                udimBL.x = std::floor(std::min(std::min(uvCoords[triangleUvIds[0]].x, uvCoords[triangleUvIds[1]].x), uvCoords[triangleUvIds[2]].x));
+                udimBL.y = std::floor(std::min(std::min(uvCoords[triangleUvIds[0]].y, uvCoords[triangleUvIds[1]].y), uvCoords[triangleUvIds[2]].y));
+
+                for(int k = 0; k < 3; k++)
+                {
+                   const int pointIndex = mesh->tris[triangle.triangleId].v[k];
+                   triangle.triPts[k] = mesh->pts[pointIndex];                      // 3D coordinates
+                   const int uvPointIndex = triangleUvIds.m[k];
+                   Point2d uv = uvCoords[uvPointIndex];
+                   // UDIM: remap coordinates between [0,1]
+                   uv = uv - udimBL;
+
+                   triangle.triPixs[k] = uv * texParams.textureSide;   // UV coordinates
+                }
+
+                // compute triangle bounding box in pixel indexes
+                // min values: floor(value)
+                // max values: ceil(value)
+                const Point2d* triPixs = triangle.triPixs;
+                triangle.LU.x = static_cast<int>(std::floor(std::min(std::min(triPixs[0].x, triPixs[1].x), triPixs[2].x)));
+                triangle.LU.y = static_cast<int>(std::floor(std::min(std::min(triPixs[0].y, triPixs[1].y), triPixs[2].y)));
+                triangle.RD.x = static_cast<int>(std::ceil(std::max(std::max(triPixs[0].x, triPixs[1].x), triPixs[2].x)));
+                triangle.RD.y = static_cast<int>(std::ceil(std::max(std::max(triPixs[0].y, triPixs[1].y), triPixs[2].y)));
+
+                // sanity check: clamp values to [0; textureSide]
+                triangle.LU.x = clamp(triangle.LU.x, 0, texSide);
+                triangle.LU.y = clamp(triangle.LU.y, 0, texSide);
+                triangle.RD.x = clamp(triangle.RD.x, 0, texSide);
+                triangle.RD.y = clamp(triangle.RD.y, 0, texSide);
+            }
 
-                // for each triangle
-                #pragma omp parallel for
-                for(int ti = 0; ti < trianglesId.size(); ++ti)
+            // keep the band order in each tile
+            for(int ti = 0; ti < triangles.size(); ++ti)
+            {
+                const TriangleContribution& triangle = triangles[ti];
+                if(triangle.LU.x >= triangle.RD.x || triangle.LU.y >= triangle.RD.y)
+                    continue;
+                for(int tile = triangle.LU.y / tileHeight; tile <= (triangle.RD.y - 1) / tileHeight; ++tile)
+                    tilesTriangles[a][tile].push_back(ti);
+            }
+        }
+
+        // accumulate the color of a texel of a triangle
+        const auto fillTexel = [&](const TriangleContribution& triangle, int x, int y, const Point2d& barycCoords, AccuPyramid& accuPyramid)
+        {
+            // remap 'y' to image coordinates system (inverted Y axis)
+            const unsigned int y_ = (texParams.textureSide - 1) - y;
+            // 1D pixel index
+            const unsigned int xyoffset = y_ * texParams.textureSide + x;
+            // get 3D coordinates
+            const Point3d pt3d = barycentricToCartesian(triangle.triPts, barycCoords);
+            // get 2D coordinates in source image
+            Point2d pixRC;
+            mp.getPixelFor3DPoint(&pixRC, pt3d, camId);
+            // exclude out of bounds pixels
+            if(!mp.isPixelInImage(pixRC, camId))
+                return;
+
+            // If the color is pure zero (ie. no contributions), we consider it as an invalid pixel.
+            if(camImg.getInterpolateColor(pixRC) == Color(0.f, 0.f, 0.f))
+                return;
+
+            // Fill the accumulated pyramid for this pixel
+            // each frequency band also contributes to lower frequencies (higher band indexes)
+            for(std::size_t bandContrib = triangle.band; bandContrib < pyramidL.size(); ++bandContrib)
+            {
+                AccuImage& accuImage = accuPyramid.pyramid[bandContrib];
+
+                // fill the accumulated color map for this pixel
+                accuImage.img[xyoffset] += pyramidL[bandContrib].getInterpolateColor(pixRC / bandDownscales[bandContrib]) * triangle.score;
+                accuImage.imgCount[xyoffset] += triangle.score;
+            }
+        };
+
+        // rasterize the rows [yBegin, yEnd) of a triangle
+        const auto fillTriangle = [&](const TriangleContribution& triangle, int yBegin, int yEnd, AccuPyramid& accuPyramid)
+        {
+            const TriangleEdgeFunctions edges(triangle.triPixs);
+
+            for(int y = std::max(yBegin, triangle.LU.y); y < std::min(yEnd, triangle.RD.y); ++y)
+            {
+                const double cy = y + 0.5;
+                int xBegin = triangle.LU.x;
+                int xEnd = triangle.RD.x;
+
+                // restrict the row to the span of pixels that may be close enough to the triangle
+                for(int i = 0; edges.valid && i < 3 && xBegin < xEnd; ++i)
                 {
-                    const unsigned int triangleId = std::get<0>(trianglesId[ti]);
-                    const float triangleScore = texParams.useScore ? std::get<1>(trianglesId[ti]) : 1.0f;
-                    // retrieve triangle 3D and UV coordinates
-                    Point2d triPixs[3];
-                    Point3d triPts[3];
-                    auto& triangleUvIds = mesh->trisUvIds[triangleId];
-                    // compute the Bottom-Left minima of the current UDIM for [0,1] range remapping
-                    Point2d udimBL;
-                    StaticVector<Point2d>& uvCoords = mesh->uvCoords;
-                    udimBL.x = std::floor(std::min(std::min(uvCoords[triangleUvIds[0]].x, uvCoords[triangleUvIds[1]].x), uvCoords[triangleUvIds[2]].x));
-                    udimBL.y = std::floor(std::min(std::min(uvCoords[triangleUvIds[0]].y, uvCoords[triangleUvIds[1]].y), uvCoords[triangleUvIds[2]].y));
-
-                    for(int k = 0; k < 3; k++)
+                    const double rowCoord = edges.b[i] * cy + edges.c[i];
+                    if(edges.a[i] != 0.0)
                     {
-                       const int pointIndex = mesh->tris[triangleId].v[k];
-                       triPts[k] = mesh->pts[pointIndex];                               // 3D coordinates
-                       const int uvPointIndex = triangleUvIds.m[k];
-                       Point2d uv = uvCoords[uvPointIndex];
-                       // UDIM: remap coordinates between [0,1]
-                       uv = uv - udimBL;
-
-                       triPixs[k] = uv * texParams.textureSide;   // UV coordinates
+                        // pixel center where the coordinate i reaches its minimum
+                        const double xLimit = (edges.minCoord[i] - rowCoord) / edges.a[i] - 0.5;
+                        if(edges.a[i] > 0.0)
+                            xBegin = std::max(xBegin, static_cast<int>(std::floor(std::min(xLimit, static_cast<double>(xEnd)))));
+                        else
+                            xEnd = std::min(xEnd, static_cast<int>(std::ceil(std::max(xLimit, static_cast<double>(xBegin - 1)))) + 1);
                     }
+                    else if(rowCoord < edges.minCoord[i])
+                    {
+                        xEnd = xBegin;
+                    }
+                }
 
-                    // compute triangle bounding box in pixel indexes
-                    // min values: floor(value)
-                    // max values: ceil(value)
-                    Pixel LU, RD;
-                    LU.x = static_cast<int>(std::floor(std::min(std::min(triPixs[0].x, triPixs[1].x), triPixs[2].x)));
-                    LU.y = static_cast<int>(std::floor(std::min(std::min(triPixs[0].y, triPixs[1].y), triPixs[2].y)));
-                    RD.x = static_cast<int>(std::ceil(std::max(std::max(triPixs[0].x, triPixs[1].x), triPixs[2].x)));
-                    RD.y = static_cast<int>(std::ceil(std::max(std::max(triPixs[0].y, triPixs[1].y), triPixs[2].y)));
-
-                    // sanity check: clamp values to [0; textureSide]
-                    int texSide = static_cast<int>(texParams.textureSide);
-                    LU.x = clamp(LU.x, 0, texSide);
-                    LU.y = clamp(LU.y, 0, texSide);
-                    RD.x = clamp(RD.x, 0, texSide);
-                    RD.y = clamp(RD.y, 0, texSide);
-
-                    // iterate over pixels of the triangle's bounding box
-                    for(int y = LU.y; y < RD.y; y++)
+                for(int x = xBegin; x < xEnd; ++x)
+                {
+                    Point2d barycCoords;
+                    if(edges.valid)
                     {
-                       for(int x = LU.x; x < RD.x; x++)
-                       {
-                           Pixel pix(x, y); // top-left corner of the pixel
-                           Point2d barycCoords;
-
-                           // test if the pixel is inside triangle
-                           // and retrieve its barycentric coordinates
-                           if(!isPixelInTriangle(triPixs, pix, barycCoords))
-                           {
-                               continue;
-                           }
-
-                           // remap 'y' to image coordinates system (inverted Y axis)
-                           const unsigned int y_ = (texParams.textureSide - 1) - y;
-                           // 1D pixel index
-                           unsigned int xyoffset = y_ * texParams.textureSide + x;
-                           // get 3D coordinates
-                           Point3d pt3d = barycentricToCartesian(triPts, barycCoords);
-                           // get 2D coordinates in source image
-                           Point2d pixRC;
-                           mp.getPixelFor3DPoint(&pixRC, pt3d, camId);
-                           // exclude out of bounds pixels
-                           if(!mp.isPixelInImage(pixRC, camId))
-                               continue;
-
-                           // If the color is pure zero (ie. no contributions), we consider it as an invalid pixel.
-                           if(camImg.getInterpolateColor(pixRC) == Color(0.f, 0.f, 0.f))
-                               continue;
-
-                           // Fill the accumulated pyramid for this pixel
-                           // each frequency band also contributes to lower frequencies (higher band indexes)
-                           AccuPyramid& accuPyramid = accuPyramids.at(atlasID);
-                           for(std::size_t bandContrib = band; bandContrib < pyramidL.size(); ++bandContrib)
-                           {
-                               int downscaleCoef = std::pow(texParams.multiBandDownscale, bandContrib);
-                               AccuImage& accuImage = accuPyramid.pyramid[bandContrib];
-
-                               // fill the accumulated color map for this pixel
-                               accuImage.img[xyoffset] += pyramidL[bandContrib].getInterpolateColor(pixRC/downscaleCoef) * triangleScore;
-                               accuImage.imgCount[xyoffset] += triangleScore;
-                           }
-                       }
+                        const double cx = x + 0.5;
+                        const double l0 = edges.a[0] * cx + edges.b[0] * cy + edges.c[0];
+                        const double l1 = edges.a[1] * cx + edges.b[1] * cy + edges.c[1];
+                        const double l2 = edges.a[2] * cx + edges.b[2] * cy + edges.c[2];
+
+                        // pixel center too far from the triangle
+                        if(l0 < edges.minCoord[0] || l1 < edges.minCoord[1] || l2 < edges.minCoord[2])
+                            continue;
+
+                        // pixel center inside the triangle
+                        if(l0 >= 0.0 && l1 >= 0.0 && l2 >= 0.0)
+                        {
+                            barycCoords.x = l2;
+                            barycCoords.y = l1;
+                            fillTexel(triangle, x, y, barycCoords, accuPyramid);
+                            continue;
+                        }
                     }
+
+                    // pixel close to the triangle border:
+                    // test if the pixel is inside triangle and retrieve its barycentric coordinates
+                    if(!isPixelInTriangle(triangle.triPixs, Pixel(x, y), barycCoords))
+                        continue;
+
+                    fillTexel(triangle, x, y, barycCoords, accuPyramid);
                 }
             }
+        };
+
+        // fill all the tiles of all the texture files of this camera in parallel
+        std::vector<std::pair<int, int>> tiles; // <texture file, tile>
+        for(int a = 0; a < tilesTriangles.size(); ++a)
+        {
+            for(int tile = 0; tile < nbTiles; ++tile)
+            {
+                if(!tilesTriangles[a][tile].empty())
+                    tiles.emplace_back(a, tile);
+            }
+        }
+
+        #pragma omp parallel for schedule(dynamic)
+        for(int t = 0; t < tiles.size(); ++t)
+        {
+            const int a = tiles[t].first;
+            const int tile = tiles[t].second;
+            const int yBegin = tile * tileHeight;
+            const int yEnd = std::min(yBegin + tileHeight, texSide);
+
+            for(const int ti : tilesTriangles[a][tile])
+                fillTriangle(cameraTriangles[a][ti], yBegin, yEnd, *cameraAccuPyramids[a]);
         }
     }
 
@@ -623,7 +803,8 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 #endif
 
         ALICEVISION_LOG_INFO("  - Computing final (average) color.");
-        for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+        #pragma omp parallel for
+        for(int yp = 0; yp < texParams.textureSide; ++yp)
         {
             unsigned int yoffset = yp * texParams.textureSide;
             for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
@@ -658,7 +839,8 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 #endif
 
         // Fuse frequency bands into the first buffer, calculate final texture
-        for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+        #pragma omp parallel for
+        for(int yp = 0; yp < texParams.textureSide; ++yp)
         {
             unsigned int yoffset = yp * texParams.textureSide;
             for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
@@ -678,6 +860,8 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 void Texturing::writeTexture(AccuImage& atlasTexture, const std::size_t atlasID, const boost::filesystem::path &outPath,
                              imageIO::EImageFileType textureFileType, const int level)
 {
+    ALICEVISION_TRACE_ZONE("texturing::writeTexture");
+
     unsigned int outTextureSide = texParams.textureSide;
     // WARNING: we modify the "imgCount" to apply the padding (to avoid the creation of a new buffer)
     // edge padding (dilate gutter)
@@ -886,6 +1070,8 @@ void Texturing::replaceMesh(const std::string& otherMeshPath, bool flipNormals)
 
 void Texturing::unwrap(mvsUtils::MultiViewParams& mp, EUnwrapMethod method)
 {
+    ALICEVISION_TRACE_ZONE("texturing::unwrap");
+
     if(method == mesh::EUnwrapMethod::Basic)
     {
         // generate UV coordinates based on automatic uv atlas
@@ -5,15 +5,147 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "UVAtlas.hpp"
+#include <aliceVision/mesh/MeshConnectivity.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 
 namespace aliceVision {
 namespace mesh {
 
 using namespace std;
 
+namespace {
+
+/**
+ * @brief Skyline rectangle allocator (bottom-left heuristic).
+ *        The free space of the bin is described by the top profile of the allocated rectangles,
+ *        each rectangle is placed at the position minimizing its bottom side, then its left side.
+ */
+class Skyline
+{
+public:
+    Skyline(int width, int height)
+        : _width(width)
+        , _height(height)
+    {
+        _segments.push_back({0, 0, width});
+    }
+
+    /**
+     * @brief Allocate a rectangle
+     * @param[in] width the rectangle width
+     * @param[in] height the rectangle height
+     * @param[out] position the left-up corner of the allocated rectangle
+     * @return false if there is not enough space left
+     */
+    bool insert(int width, int height, Pixel& position)
+    {
+        int bestIndex = -1;
+        int bestBottom = std::numeric_limits<int>::max();
+        int bestY = 0;
+
+        for(int i = 0; i < _segments.size(); ++i)
+        {
+            const int y = fit(i, width, height);
+            if(y < 0)
+                continue;
+            // segments are sorted by x, so ties keep the leftmost position
+            if(y + height < bestBottom)
+            {
+                bestIndex = i;
+                bestBottom = y + height;
+                bestY = y;
+            }
+        }
+
+        if(bestIndex < 0)
+            return false;
+
+        position = Pixel(_segments[bestIndex].x, bestY);
+        addSegment(bestIndex, position.x, bestBottom, width);
+        _usedArea += static_cast<std::size_t>(width) * height;
+        return true;
+    }
+
+    std::size_t usedArea() const { return _usedArea; }
+
+private:
+    struct Segment
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    /**
+     * @brief Get the lowest position of a rectangle starting at the left of a segment
+     * @return the rectangle top, or -1 if it doesn't fit
+     */
+    int fit(int index, int width, int height) const
+    {
+        if(_segments[index].x + width > _width)
+            return -1;
+
+        int y = 0;
+        int remainingWidth = width;
+        for(int i = index; remainingWidth > 0; ++i)
+        {
+            y = std::max(y, _segments[i].y);
+            if(y + height > _height)
+                return -1;
+            remainingWidth -= _segments[i].width;
+        }
+        return y;
+    }
+
+    void addSegment(int index, int x, int y, int width)
+    {
+        _segments.insert(_segments.begin() + index, {x, y, width});
+
+        // shrink or remove the segments covered by the new one
+        const int right = x + width;
+        for(int i = index + 1; i < _segments.size();)
+        {
+            Segment& segment = _segments[i];
+            if(segment.x >= right)
+                break;
+            const int overlap = right - segment.x;
+            if(overlap < segment.width)
+            {
+                segment.x += overlap;
+                segment.width -= overlap;
+                break;
+            }
+            _segments.erase(_segments.begin() + i);
+        }
+
+        // merge neighbor segments at the same height
+        for(int i = 0; i + 1 < _segments.size();)
+        {
+            if(_segments[i].y == _segments[i + 1].y)
+            {
+                _segments[i].width += _segments[i + 1].width;
+                _segments.erase(_segments.begin() + i + 1);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    int _width;
+    int _height;
+    std::size_t _usedArea = 0;
+    std::vector<Segment> _segments;
+};
+
+} // namespace
+
 UVAtlas::UVAtlas(const Mesh& mesh, mvsUtils::MultiViewParams& mp,
                                  unsigned int textureSide, unsigned int gutterSize)
     : _textureSide(textureSide)
@@ -31,6 +163,9 @@ UVAtlas::UVAtlas(const Mesh& mesh, mvsUtils::MultiViewParams& mp,
     // finalize charts
     finalizeCharts(charts, mp);
 
+    // merge small charts sharing the same reference camera
+    mergeSmallCharts(charts, mp.ncams, _gutterSize, chartMaxSize());
+
     // create texture atlases
     createTextureAtlases(charts, mp);
 }
@@ -104,79 +239,43 @@ void UVAtlas::packCharts(vector<Chart>& charts, mvsUtils::MultiViewParams& mp)
         return cid;
     };
 
-    // list mesh edges (with duplicates)
-    vector<Edge> alledges;
-    for(int i = 0; i < _mesh.tris.size(); ++i)
-    {
-        int a = _mesh.tris[i].v[0];
-        int b = _mesh.tris[i].v[1];
-        int c = _mesh.tris[i].v[2];
-        Edge e1;
-        e1.pointIDs = make_pair(min(a, b), max(a, b));
-        e1.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e1);
-        Edge e2;
-        e2.pointIDs = make_pair(min(b, c), max(b, c));
-        e2.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e2);
-        Edge e3;
-        e3.pointIDs = make_pair(min(c, a), max(c, a));
-        e3.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e3);
-    }
-    sort(alledges.begin(), alledges.end());
-
-    // merge edges (no duplicate)
-    vector<Edge> edges;
-    auto eit = alledges.begin() + 1;
-    while(eit != alledges.end())
-    {
-        auto& a = *(eit-1);
-        auto& b = *eit;
-        if(a == b)
-        {
-            a.triangleIDs.insert(a.triangleIDs.end(), b.triangleIDs.begin(), b.triangleIDs.end());
-            sort(a.triangleIDs.begin(), a.triangleIDs.end());
-            edges.push_back(a);
-        }
-        ++eit;
-    }
-    alledges.clear();
-
-    // merge charts
-    for(auto& e : edges)
+    // merge charts along mesh edges
+    // note: on non-manifold edges, the triangles are merged two by two in increasing order
+    const MeshConnectivity& connectivity = _mesh.getConnectivity();
+    for(int edgeId = 0; edgeId < connectivity.getNbEdges(); ++edgeId)
     {
-        if(e.triangleIDs.size() != 2)
-            continue;
-        int chartIDA = findChart(e.triangleIDs[0]);
-        int chartIDB = findChart(e.triangleIDs[1]);
-        if(chartIDA == chartIDB)
-            continue;
-        Chart& a = charts[chartIDA];
-        Chart& b = charts[chartIDB];
-        vector<int> cameraIntersection;
-        set_intersection(
-                    a.commonCameraIDs.begin(), a.commonCameraIDs.end(),
-                    b.commonCameraIDs.begin(), b.commonCameraIDs.end(),
-                    back_inserter(cameraIntersection));
-        if(cameraIntersection.size() == 0) // need at least 1 camera in common
-            continue;
-        if(a.triangleIDs.size() > b.triangleIDs.size())
-        {
-            // merge b in a
-            a.commonCameraIDs = cameraIntersection;
-            a.triangleIDs.insert(a.triangleIDs.end(), b.triangleIDs.begin(), b.triangleIDs.end());
-            b.mergedWith = chartIDA;
-        }
-        else
+        const MeshConnectivity::IndexRange halfEdges = connectivity.getEdgeHalfEdges(edgeId);
+        for(int h = 1; h < halfEdges.size(); ++h)
         {
-            // merge a in b
-            b.commonCameraIDs = cameraIntersection;
-            b.triangleIDs.insert(b.triangleIDs.end(), a.triangleIDs.begin(), a.triangleIDs.end());
-            a.mergedWith = chartIDB;
+            int chartIDA = findChart(MeshConnectivity::getHalfEdgeTriangle(halfEdges[h - 1]));
+            int chartIDB = findChart(MeshConnectivity::getHalfEdgeTriangle(halfEdges[h]));
+            if(chartIDA == chartIDB)
+                continue;
+            Chart& a = charts[chartIDA];
+            Chart& b = charts[chartIDB];
+            vector<int> cameraIntersection;
+            set_intersection(
+                        a.commonCameraIDs.begin(), a.commonCameraIDs.end(),
+                        b.commonCameraIDs.begin(), b.commonCameraIDs.end(),
+                        back_inserter(cameraIntersection));
+            if(cameraIntersection.size() == 0) // need at least 1 camera in common
+                continue;
+            if(a.triangleIDs.size() > b.triangleIDs.size())
+            {
+                // merge b in a
+                a.commonCameraIDs = cameraIntersection;
+                a.triangleIDs.insert(a.triangleIDs.end(), b.triangleIDs.begin(), b.triangleIDs.end());
+                b.mergedWith = chartIDA;
+            }
+            else
+            {
+                // merge a in b
+                b.commonCameraIDs = cameraIntersection;
+                b.triangleIDs.insert(b.triangleIDs.end(), a.triangleIDs.begin(), a.triangleIDs.end());
+                a.mergedWith = chartIDB;
+            }
         }
     }
-    edges.clear();
 
     // remove merged charts
     charts.erase(remove_if(charts.begin(), charts.end(), [](Chart& c)
@@ -236,147 +335,221 @@ void UVAtlas::finalizeCharts(vector<Chart>& charts, mvsUtils::MultiViewParams& m
     }
 }
 
-void UVAtlas::createTextureAtlases(vector<Chart>& charts, mvsUtils::MultiViewParams& mp)
+void UVAtlas::mergeSmallCharts(vector<Chart>& charts, int nbCameras, int gutterSize, int chartMaxSize)
 {
-    ALICEVISION_LOG_INFO("Creating texture atlases.");
+    // group the full resolution charts by reference camera
+    vector<vector<int>> chartIDsPerCamera(nbCameras);
+    for(int i = 0; i < charts.size(); ++i)
+    {
+        const Chart& chart = charts[i];
+        if(chart.refCameraID >= 0 && chart.downscale == 1.0f)
+            chartIDsPerCamera[chart.refCameraID].push_back(i);
+    }
 
-    // sort charts by size, descending
-    std::sort(charts.begin(), charts.end(), [](const Chart& a, const Chart& b)
+    const auto paddedArea = [&](const Pixel& lu, const Pixel& rd) -> std::size_t
     {
-        int wa = a.targetWidth();
-        int wb = b.targetWidth();
-        if(wa == wb)
-            return a.targetHeight() > b.targetHeight();
-        return wa > wb;
-    });
+        return static_cast<std::size_t>(rd.x - lu.x + gutterSize * 2) * (rd.y - lu.y + gutterSize * 2);
+    };
+
+    // the source rectangle of a chart padded with the gutter doesn't intersect the other one
+    const auto areSeparated = [&](const Chart& a, const Chart& b) -> bool
+    {
+        return a.sourceLU.x - gutterSize >= b.sourceRD.x || b.sourceLU.x >= a.sourceRD.x + gutterSize ||
+               a.sourceLU.y - gutterSize >= b.sourceRD.y || b.sourceLU.y >= a.sourceRD.y + gutterSize;
+    };
 
-    std::size_t i = 0; // forward index
-    std::size_t j = charts.size() - 1; // backward index
-    std::size_t texCount = 0;
+    // Two charts projected with the same camera can share one rectangle of the atlas:
+    // they are merged if their bounding box doesn't use more texture space than both charts with their gutters
+    // and if they are separated by a gutter, so that their triangles never write the same texels.
+    // Charts are visited from top to bottom in the camera, a chart further than 2 gutters below
+    // another one cannot be merged with it.
+    const int maxCandidates = 64;
 
-    // insert charts into one or more texture atlas
-    while(i <= j)
+    #pragma omp parallel for schedule(dynamic)
+    for(int cameraID = 0; cameraID < chartIDsPerCamera.size(); ++cameraID)
     {
-        texCount++;
-        // create a texture atlas
-        ALICEVISION_LOG_INFO("\t- texture atlas " << texCount);
-        vector<Chart> atlas;
-        // create a tree root
-        ChartRect* root = new ChartRect();
-        root->LU.x = 0;
-        root->LU.y = 0;
-        root->RD.x = _textureSide - 1;
-        root->RD.y = _textureSide - 1;
-
-        const auto insertChart = [&](size_t idx) -> bool
+        vector<int>& chartIDs = chartIDsPerCamera[cameraID];
+        sort(chartIDs.begin(), chartIDs.end(), [&](int a, int b)
         {
-            Chart& chart = charts[idx];
-            ChartRect* rect = root->insert(chart, _gutterSize);
-            if(!rect)
-                return false;
-
-            // store the final position
-            chart.targetLU = rect->LU;
-            chart.targetLU.x += _gutterSize;
-            chart.targetLU.y += _gutterSize;
-            // add to the current texture atlas
-            atlas.emplace_back(chart);
-            return true;
-        };
-        // insert as many charts as possible in forward direction (largest to smallest)
-        while(i <= j && insertChart(i)) { ++i; }
-        // fill potential empty space (i != j) in backward direction
-        while(j > i && insertChart(j)) { --j; }
-
-        if(atlas.empty())
-            throw std::runtime_error("Unable to add any chart to this atlas");
+            const Pixel& luA = charts[a].sourceLU;
+            const Pixel& luB = charts[b].sourceLU;
+            if(luA.y != luB.y)
+                return luA.y < luB.y;
+            if(luA.x != luB.x)
+                return luA.x < luB.x;
+            return a < b;
+        });
+
+        vector<int> candidates;
+        for(int chartID : chartIDs)
+        {
+            Chart& chart = charts[chartID];
+            candidates.erase(remove_if(candidates.begin(), candidates.end(), [&](int candidateID)
+            {
+                return charts[candidateID].sourceRD.y + gutterSize * 2 < chart.sourceLU.y;
+            }), candidates.end());
+
+            bool merged = false;
+            const int firstCandidate = std::max(0, static_cast<int>(candidates.size()) - maxCandidates);
+            for(int c = static_cast<int>(candidates.size()) - 1; c >= firstCandidate && !merged; --c)
+            {
+                Chart& candidate = charts[candidates[c]];
+                const Pixel lu(std::min(candidate.sourceLU.x, chart.sourceLU.x), std::min(candidate.sourceLU.y, chart.sourceLU.y));
+                const Pixel rd(std::max(candidate.sourceRD.x, chart.sourceRD.x), std::max(candidate.sourceRD.y, chart.sourceRD.y));
+
+                if(!areSeparated(candidate, chart))
+                    continue;
+                if(std::max(rd.x - lu.x, rd.y - lu.y) > chartMaxSize)
+                    continue;
+                if(paddedArea(lu, rd) > paddedArea(candidate.sourceLU, candidate.sourceRD) + paddedArea(chart.sourceLU, chart.sourceRD))
+                    continue;
+
+                // merge the chart in the candidate
+                candidate.sourceLU = lu;
+                candidate.sourceRD = rd;
+                candidate.triangleIDs.insert(candidate.triangleIDs.end(), chart.triangleIDs.begin(), chart.triangleIDs.end());
+                chart.mergedWith = candidates[c];
+                merged = true;
+            }
 
-        // atlas is full or all charts have been handled
-        ALICEVISION_LOG_INFO("Filled with " << atlas.size() << " charts.");
-        // store this texture
-        _atlases.emplace_back(atlas);
-        // clear the whole tree
-        root->clear();
-        delete root;
+            if(!merged)
+                candidates.push_back(chartID);
+        }
     }
-}
 
-void UVAtlas::ChartRect::clear()
-{
-    if(child[0])
-        child[0]->clear();
-    if(child[1])
-        child[1]->clear();
-    delete child[0];
-    delete child[1];
+    // remove merged charts
+    const std::size_t nbCharts = charts.size();
+    charts.erase(remove_if(charts.begin(), charts.end(), [](Chart& c)
+            {
+                return (c.mergedWith >= 0);
+            }), charts.end());
+
+    ALICEVISION_LOG_INFO("Merged " << (nbCharts - charts.size()) << " small charts (" << charts.size() << " charts).");
 }
 
-UVAtlas::ChartRect* UVAtlas::ChartRect::insert(Chart& chart, size_t gutter)
+void UVAtlas::createTextureAtlases(vector<Chart>& charts, mvsUtils::MultiViewParams& mp)
 {
-    if(child[0] || child[1]) // not a leaf
+    ALICEVISION_LOG_INFO("Creating texture atlases.");
+
+    const system::Timer timer;
+
+    // sort charts by size, descending
+    std::sort(charts.begin(), charts.end(), [](const Chart& a, const Chart& b)
     {
-        if(child[0])
-            if(ChartRect* rect = child[0]->insert(chart, gutter))
-                return rect;
-        if(child[1])
-            if(ChartRect* rect = child[1]->insert(chart, gutter))
-                return rect;
-        return nullptr;
-    }
-    else
+        int ha = a.targetHeight();
+        int hb = b.targetHeight();
+        if(ha == hb)
+            return a.targetWidth() > b.targetWidth();
+        return ha > hb;
+    });
+
+    const int binSide = _textureSide - 1;
+    const std::size_t binArea = static_cast<std::size_t>(binSide) * binSide;
+
+    vector<Skyline> bins;
+    vector<vector<int>> binChartIDs;
+
+    const auto insertChart = [&](int binID, int chartID) -> bool
+    {
+        Chart& chart = charts[chartID];
+        Pixel position;
+        if(!bins[binID].insert(chart.paddedWidth(_gutterSize), chart.paddedHeight(_gutterSize), position))
+            return false;
+
+        // store the final position
+        chart.targetLU = position;
+        chart.targetLU.x += _gutterSize;
+        chart.targetLU.y += _gutterSize;
+        binChartIDs[binID].push_back(chartID);
+        return true;
+    };
+
+    // charts to insert, largest first
+    vector<int> remainingChartIDs(charts.size());
+    std::iota(remainingChartIDs.begin(), remainingChartIDs.end(), 0);
+
+    while(!remainingChartIDs.empty())
     {
-        size_t chartWidth = chart.targetWidth() + gutter * 2;
-        size_t chartHeight = chart.targetHeight() + gutter * 2;
-        // if there is already a chart here
-        if(c) return nullptr;
-        // not enough space
-        if(chartWidth > (RD.x - LU.x))
-            return nullptr;
-        if(chartHeight > (RD.y - LU.y))
-            return nullptr;
-        // split & create children
-        if(chartWidth >= chartHeight)
+        // create enough new atlases for the remaining charts
+        std::size_t remainingArea = 0;
+        for(int chartID : remainingChartIDs)
+            remainingArea += static_cast<std::size_t>(charts[chartID].paddedWidth(_gutterSize)) * charts[chartID].paddedHeight(_gutterSize);
+
+        const int firstNewBin = bins.size();
+        const int nbNewBins = std::max<std::size_t>(1, (remainingArea + binArea - 1) / binArea);
+        bins.resize(firstNewBin + nbNewBins, Skyline(binSide, binSide));
+        binChartIDs.resize(firstNewBin + nbNewBins);
+
+        // distribute the charts between the new atlases in snake order, so they all get charts of all sizes
+        vector<vector<int>> newBinsChartIDs(nbNewBins);
+        for(int i = 0; i < remainingChartIDs.size(); ++i)
         {
-            if(chartWidth < (RD.x - LU.x))
-            {
-                child[0] = new ChartRect();
-                child[0]->LU.x = LU.x + chartWidth;
-                child[0]->LU.y = LU.y;
-                child[0]->RD.x = RD.x;
-                child[0]->RD.y = LU.y + chartHeight;
-            }
-            if(chartHeight < (RD.y - LU.y))
-            {
-                child[1] = new ChartRect();
-                child[1]->LU.x = LU.x;
-                child[1]->LU.y = LU.y + chartHeight;
-                child[1]->RD.x = RD.x;
-                child[1]->RD.y = RD.y;
-            }
+            const int round = i / nbNewBins;
+            const int index = i % nbNewBins;
+            newBinsChartIDs[(round % 2 == 0) ? index : (nbNewBins - 1 - index)].push_back(remainingChartIDs[i]);
         }
-        else 
+
+        // fill the new atlases independently
+        vector<vector<int>> rejectedChartIDs(nbNewBins);
+        #pragma omp parallel for schedule(dynamic)
+        for(int b = 0; b < nbNewBins; ++b)
         {
-            if(chartHeight < (RD.y - LU.y))
-            {
-                child[0] = new ChartRect();
-                child[0]->LU.x = LU.x;
-                child[0]->LU.y = LU.y + chartHeight;
-                child[0]->RD.x = LU.x + chartWidth;
-                child[0]->RD.y = RD.y;
-            }
-            if(chartWidth < (RD.x - LU.x))
+            for(int chartID : newBinsChartIDs[b])
             {
-                child[1] = new ChartRect();
-                child[1]->LU.x = LU.x + chartWidth;
-                child[1]->LU.y = LU.y;
-                child[1]->RD.x = RD.x;
-                child[1]->RD.y = RD.y;
+                if(!insertChart(firstNewBin + b, chartID))
+                    rejectedChartIDs[b].push_back(chartID);
             }
         }
-        // insert chart
-        c = &chart;
-        return this;
+
+        remainingChartIDs.clear();
+        for(const vector<int>& chartIDs : rejectedChartIDs)
+            remainingChartIDs.insert(remainingChartIDs.end(), chartIDs.begin(), chartIDs.end());
+        // keep the size order
+        std::sort(remainingChartIDs.begin(), remainingChartIDs.end());
+
+        if(binChartIDs[firstNewBin].empty())
+            throw std::runtime_error("Unable to add any chart to this atlas");
+
+        // fill the remaining space of all the atlases
+        vector<int> rejected;
+        for(int chartID : remainingChartIDs)
+        {
+            bool inserted = false;
+            for(int b = 0; b < bins.size() && !inserted; ++b)
+                inserted = insertChart(b, chartID);
+            if(!inserted)
+                rejected.push_back(chartID);
+        }
+        remainingChartIDs.swap(rejected);
+    }
+
+    // store the texture atlases
+    const double textureArea = static_cast<double>(_textureSide) * _textureSide;
+    std::size_t totalChartsArea = 0;
+    for(int b = 0; b < bins.size(); ++b)
+    {
+        vector<int>& chartIDs = binChartIDs[b];
+        if(chartIDs.empty())
+            continue;
+        std::sort(chartIDs.begin(), chartIDs.end());
+
+        std::size_t chartsArea = 0;
+        vector<Chart> atlas;
+        atlas.reserve(chartIDs.size());
+        for(int chartID : chartIDs)
+        {
+            chartsArea += static_cast<std::size_t>(charts[chartID].targetWidth()) * charts[chartID].targetHeight();
+            atlas.emplace_back(std::move(charts[chartID]));
+        }
+        totalChartsArea += chartsArea;
+
+        ALICEVISION_LOG_INFO("\t- texture atlas " << (_atlases.size() + 1) << ": " << atlas.size() << " charts, fill ratio: "
+                             << 100.0 * chartsArea / textureArea << "% (" << 100.0 * bins[b].usedArea() / textureArea << "% with gutters)");
+        _atlases.emplace_back(std::move(atlas));
     }
+
+    ALICEVISION_LOG_INFO("Texture atlases created in " << system::prettyTime(timer.elapsedMs()) << ": " << _atlases.size()
+                         << " atlases, average fill ratio: " << 100.0 * totalChartsArea / (textureArea * _atlases.size()) << "%.");
 }
 
 } // namespace mesh
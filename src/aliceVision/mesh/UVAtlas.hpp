@@ -17,14 +17,6 @@ namespace mesh {
 class UVAtlas
 {
 public:
-    struct Edge
-    {
-        std::pair<int, int> pointIDs;
-        std::vector<int> triangleIDs;
-        bool operator<(const Edge& other) const { return pointIDs < other.pointIDs; }
-        bool operator==(const Edge& other) const { return pointIDs == other.pointIDs; }
-    };
-
     struct Chart
     {
         int refCameraID = -1;                                   // refCamera, used to project all contained triangles
@@ -44,16 +36,10 @@ public:
         int targetWidth() const { return sourceWidth() * downscale; }
         /// Chart target height (uv space, taking downscale into account)
         int targetHeight() const { return sourceHeight() * downscale; }
-    };
-
-    struct ChartRect
-    {
-        Chart* c = nullptr;
-        ChartRect* child[2] {nullptr, nullptr};
-        Pixel LU;
-        Pixel RD;
-        void clear();
-        ChartRect* insert(Chart& chart, size_t gutter);
+        /// Chart width in uv space, with the gutters
+        int paddedWidth(int gutter) const { return targetWidth() + gutter * 2; }
+        /// Chart height in uv space, with the gutters
+        int paddedHeight(int gutter) const { return targetHeight() + gutter * 2; }
     };
 
 public:
@@ -67,6 +53,16 @@ public:
     const Mesh& mesh() const { return _mesh; }
     inline int chartMaxSize() const { return (_textureSide - 1) - _gutterSize * 2; }
 
+    /**
+     * @brief Merge the full resolution charts projected by the same camera that can share one rectangle of the atlas
+     * @details Only charts whose source rectangles are separated by the gutter are merged.
+     * @param[in,out] charts the charts, the merged charts are removed
+     * @param[in] nbCameras the number of cameras
+     * @param[in] gutterSize the gutter size around each chart
+     * @param[in] chartMaxSize the maximum size of a chart in the atlas
+     */
+    static void mergeSmallCharts(std::vector<Chart>& charts, int nbCameras, int gutterSize, int chartMaxSize);
+
 private:
     void createCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams& mp);
     void packCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams& mp);
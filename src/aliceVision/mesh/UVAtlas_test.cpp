@@ -0,0 +1,97 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/UVAtlas.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#define BOOST_TEST_MODULE UVAtlas
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+// Test summary:
+// - Merge small charts projected by the same camera
+// - Assert that:
+//   - close charts separated by the gutter are merged in their bounding box
+//   - overlapping or nested charts stay separate, as their triangles would write the same texels
+//   - charts of different cameras or downscaled charts are never merged
+
+namespace {
+
+const int gutterSize = 4;
+const int chartMaxSize = 1000;
+
+UVAtlas::Chart getChart(int cameraID, const Pixel& lu, const Pixel& rd, int triangleID)
+{
+    UVAtlas::Chart chart;
+    chart.refCameraID = cameraID;
+    chart.commonCameraIDs.push_back(cameraID);
+    chart.triangleIDs.push_back(triangleID);
+    chart.sourceLU = lu;
+    chart.sourceRD = rd;
+    return chart;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(UVATLAS_MergeSeparatedCharts)
+{
+    // 5 pixels between the two charts
+    std::vector<UVAtlas::Chart> charts;
+    charts.push_back(getChart(0, Pixel(0, 0), Pixel(4, 4), 0));
+    charts.push_back(getChart(0, Pixel(9, 0), Pixel(13, 4), 1));
+
+    UVAtlas::mergeSmallCharts(charts, 1, gutterSize, chartMaxSize);
+
+    BOOST_REQUIRE_EQUAL(charts.size(), 1);
+    BOOST_CHECK_EQUAL(charts.front().sourceLU.x, 0);
+    BOOST_CHECK_EQUAL(charts.front().sourceLU.y, 0);
+    BOOST_CHECK_EQUAL(charts.front().sourceRD.x, 13);
+    BOOST_CHECK_EQUAL(charts.front().sourceRD.y, 4);
+
+    std::vector<int> triangleIDs = charts.front().triangleIDs;
+    std::sort(triangleIDs.begin(), triangleIDs.end());
+    BOOST_CHECK(triangleIDs == std::vector<int>({0, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(UVATLAS_KeepOverlappingCharts)
+{
+    std::vector<UVAtlas::Chart> charts;
+    // overlapping charts
+    charts.push_back(getChart(0, Pixel(0, 0), Pixel(4, 4), 0));
+    charts.push_back(getChart(0, Pixel(2, 0), Pixel(6, 4), 1));
+    // nested charts
+    charts.push_back(getChart(1, Pixel(0, 0), Pixel(10, 10), 2));
+    charts.push_back(getChart(1, Pixel(2, 2), Pixel(4, 4), 3));
+    // charts closer than the gutter
+    charts.push_back(getChart(2, Pixel(0, 0), Pixel(4, 4), 4));
+    charts.push_back(getChart(2, Pixel(6, 0), Pixel(10, 4), 5));
+
+    UVAtlas::mergeSmallCharts(charts, 3, gutterSize, chartMaxSize);
+
+    BOOST_REQUIRE_EQUAL(charts.size(), 6);
+    for(int i = 0; i < charts.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(charts[i].triangleIDs.size(), 1);
+        BOOST_CHECK_EQUAL(charts[i].mergedWith, -1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(UVATLAS_KeepOtherCameraOrDownscaledCharts)
+{
+    std::vector<UVAtlas::Chart> charts;
+    charts.push_back(getChart(0, Pixel(0, 0), Pixel(4, 4), 0));
+    charts.push_back(getChart(1, Pixel(9, 0), Pixel(13, 4), 1));
+    charts.push_back(getChart(1, Pixel(0, 0), Pixel(4, 4), 2));
+    charts.back().downscale = 0.5f;
+
+    UVAtlas::mergeSmallCharts(charts, 2, gutterSize, chartMaxSize);
+
+    BOOST_CHECK_EQUAL(charts.size(), 3);
+}
@@ -41,5 +41,29 @@ inline void toGeoMesh(const Mesh& src, GEO::Mesh& dst)
     assert(src.tris.size() == dst.facets.nb());
 }
 
+/**
+* @brief Create an aliceVision::Mesh from a Geogram GEO::Mesh
+*
+* @note only initialize points and triangles, the polygonal facets are split in triangle fans
+* @param[in] the source GEO::Mesh
+* @param[out] the destination aliceVision mesh
+*/
+inline void fromGeoMesh(const GEO::Mesh& src, Mesh& dst)
+{
+    dst.pts.reserve(src.vertices.nb());
+    for (GEO::index_t v = 0; v < src.vertices.nb(); ++v)
+    {
+        const GEO::vec3& point = src.vertices.point(v);
+        dst.pts.push_back(Point3d(point.x, point.y, point.z));
+    }
+
+    dst.tris.reserve(src.facets.nb());
+    for (GEO::index_t f = 0; f < src.facets.nb(); ++f)
+    {
+        for (GEO::index_t lv = 1; lv + 1 < src.facets.nb_vertices(f); ++lv)
+            dst.tris.push_back(Mesh::triangle(src.facets.vertex(f, 0), src.facets.vertex(f, lv), src.facets.vertex(f, lv + 1)));
+    }
+}
+
 }
 }
@@ -0,0 +1,713 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "meshDecimation.hpp"
+#include <aliceVision/mesh/MeshConnectivity.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <queue>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace {
+
+/// minimal number of points per partition in automatic mode
+constexpr int minPartitionNbPoints = 10000;
+/// maximal number of partitions per thread in automatic mode
+constexpr int maxPartitionsPerThread = 8;
+/// weight of the planes which keep the mesh borders in place
+constexpr double boundaryWeight = 100.0;
+/// minimal cosine between a triangle normal before and after a collapse
+constexpr double minNormalCosine = 0.2;
+/// weight of the squared edge length term of the collapse cost, relative to the quadric error of
+/// a unit area triangle: collapses the shortest edges first where the quadric error vanishes (planar regions)
+constexpr double edgeLengthWeight = 1e-3;
+/// maximal number of neighbors of the point resulting from a collapse, avoids triangle fans
+constexpr int maxValence = 16;
+
+/**
+ * @brief Symmetric 4x4 quadric matrix, stored as its upper triangle
+ */
+struct Quadric
+{
+    double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+    double b2 = 0.0, bc = 0.0, bd = 0.0;
+    double c2 = 0.0, cd = 0.0;
+    double d2 = 0.0;
+
+    /// add the squared distance to the plane n.p + d = 0 (n normalized)
+    void addPlane(const Point3d& n, double d, double weight)
+    {
+        a2 += weight * n.x * n.x; ab += weight * n.x * n.y; ac += weight * n.x * n.z; ad += weight * n.x * d;
+        b2 += weight * n.y * n.y; bc += weight * n.y * n.z; bd += weight * n.y * d;
+        c2 += weight * n.z * n.z; cd += weight * n.z * d;
+        d2 += weight * d * d;
+    }
+
+    Quadric operator+(const Quadric& q) const
+    {
+        Quadric r;
+        r.a2 = a2 + q.a2; r.ab = ab + q.ab; r.ac = ac + q.ac; r.ad = ad + q.ad;
+        r.b2 = b2 + q.b2; r.bc = bc + q.bc; r.bd = bd + q.bd;
+        r.c2 = c2 + q.c2; r.cd = cd + q.cd;
+        r.d2 = d2 + q.d2;
+        return r;
+    }
+
+    double evaluate(const Point3d& p) const
+    {
+        return a2 * p.x * p.x + 2.0 * ab * p.x * p.y + 2.0 * ac * p.x * p.z + 2.0 * ad * p.x +
+               b2 * p.y * p.y + 2.0 * bc * p.y * p.z + 2.0 * bd * p.y +
+               c2 * p.z * p.z + 2.0 * cd * p.z +
+               d2;
+    }
+
+    /// point minimizing the quadric, false if the system is ill-conditioned
+    bool getOptimalPoint(Point3d& p) const
+    {
+        const double det = a2 * (b2 * c2 - bc * bc) - ab * (ab * c2 - bc * ac) + ac * (ab * bc - b2 * ac);
+        const double scale = a2 + b2 + c2;
+
+        if(std::abs(det) <= 1e-10 * scale * scale * scale)
+            return false;
+
+        // Cramer's rule on A.p = -(ad, bd, cd)
+        const double x = -ad * (b2 * c2 - bc * bc) + ab * (bd * c2 - bc * cd) - ac * (bd * bc - b2 * cd);
+        const double y = -a2 * (bd * c2 - cd * bc) + ad * (ab * c2 - bc * ac) - ac * (ab * cd - bd * ac);
+        const double z = -a2 * (b2 * cd - bc * bd) + ab * (ab * cd - bd * ac) - ad * (ab * bc - b2 * ac);
+
+        p = Point3d(x / det, y / det, z / det);
+        return true;
+    }
+};
+
+struct CollapseCandidate
+{
+    double cost;
+    int ptA;
+    int ptB;
+    int versionA;
+    int versionB;
+    Point3d point;
+
+    /// ordered by cost, then by point ids for a deterministic order of the collapses with the same cost
+    bool operator>(const CollapseCandidate& other) const
+    {
+        if(cost != other.cost)
+            return cost > other.cost;
+        if(ptA != other.ptA)
+            return ptA > other.ptA;
+        return ptB > other.ptB;
+    }
+};
+
+/**
+ * @brief Edge collapse decimation state shared by the partitions.
+ *        During a pass, the data of a point is only modified by the thread owning its partition.
+ */
+class QuadricDecimator
+{
+public:
+    QuadricDecimator(Mesh& mesh, double maxError)
+      : _mesh(mesh)
+      , _maxError(maxError)
+    {
+        const MeshConnectivity& connectivity = mesh.getConnectivity();
+        const int nbPts = mesh.pts.size();
+
+        _ptsTris.resize(nbPts);
+        _ptsCell.assign(nbPts, -1);
+        _ptsVersion.assign(nbPts, 0);
+        _ptsLocked.assign(nbPts, 0);
+        _ptsLocalId.assign(nbPts, -1);
+
+        #pragma omp parallel for
+        for(int ptId = 0; ptId < nbPts; ++ptId)
+        {
+            for(const int triId : connectivity.getPtNeighborTriangles(ptId))
+            {
+                // triangles with a repeated point are listed twice
+                if(mesh.tris[triId].alive && (_ptsTris[ptId].empty() || _ptsTris[ptId].back() != triId))
+                    _ptsTris[ptId].push_back(triId);
+            }
+        }
+    }
+
+    /// number of points used by at least one triangle
+    int getNbPoints() const
+    {
+        int nbPts = 0;
+        #pragma omp parallel for reduction(+:nbPts)
+        for(int ptId = 0; ptId < static_cast<int>(_ptsTris.size()); ++ptId)
+            nbPts += static_cast<int>(!_ptsTris[ptId].empty());
+        return nbPts;
+    }
+
+    inline int getNbPartitions() const
+    {
+        return static_cast<int>(_cellsOffsets.size()) - 1;
+    }
+
+    inline int getPartitionNbPoints(int cellId) const
+    {
+        return _cellsOffsets[cellId + 1] - _cellsOffsets[cellId];
+    }
+
+    /**
+     * @brief Get the number of points of a partition which can be collapsed (all their triangles are inside the partition)
+     */
+    int getPartitionNbFreePoints(int cellId) const
+    {
+        int nbFreePts = 0;
+        for(int i = _cellsOffsets[cellId]; i < _cellsOffsets[cellId + 1]; ++i)
+        {
+            const int ptId = _cellsPts[i];
+            bool locked = false;
+            for(const int triId : _ptsTris[ptId])
+                for(int k = 0; k < 3; ++k)
+                    locked = locked || (_ptsCell[_mesh.tris[triId].v[k]] != cellId);
+            nbFreePts += !locked;
+        }
+        return nbFreePts;
+    }
+
+    /**
+     * @brief Split the points in balanced spatial partitions (median splits along the longest axis)
+     * @param[in] nbPartitions the number of partitions
+     */
+    void setPartitions(int nbPartitions)
+    {
+        _cellsPts.clear();
+        for(int ptId = 0; ptId < static_cast<int>(_ptsTris.size()); ++ptId)
+        {
+            _ptsCell[ptId] = -1;
+            if(!_ptsTris[ptId].empty())
+                _cellsPts.push_back(ptId);
+        }
+
+        splitPartition(0, static_cast<int>(_cellsPts.size()), 0, nbPartitions);
+
+        // points sorted by partition
+        _cellsOffsets.assign(nbPartitions + 1, 0);
+        for(const int ptId : _cellsPts)
+            ++_cellsOffsets[_ptsCell[ptId] + 1];
+        for(int cellId = 0; cellId < nbPartitions; ++cellId)
+            _cellsOffsets[cellId + 1] += _cellsOffsets[cellId];
+
+        std::vector<int> cursors(_cellsOffsets.begin(), _cellsOffsets.end() - 1);
+        std::vector<int> cellsPts(_cellsPts.size());
+        for(const int ptId : _cellsPts)
+            cellsPts[cursors[_ptsCell[ptId]]++] = ptId;
+        _cellsPts.swap(cellsPts);
+    }
+
+    /**
+     * @brief Collapse the edges of a partition by increasing quadric error
+     * @param[in] cellId the partition id
+     * @param[in] nbPtsToRemove the number of points to remove
+     * @param[in] fromLockedPts only start from the points locked in the previous pass
+     * @return the number of removed points
+     */
+    int decimatePartition(int cellId, int nbPtsToRemove, bool fromLockedPts)
+    {
+        if(nbPtsToRemove <= 0)
+            return 0;
+
+        const int* cellPts = _cellsPts.data() + _cellsOffsets[cellId];
+        const int nbCellPts = getPartitionNbPoints(cellId);
+
+        std::vector<Quadric> quadrics(nbCellPts);
+        std::vector<char> seeds(nbCellPts, 0);
+
+        for(int i = 0; i < nbCellPts; ++i)
+        {
+            const int ptId = cellPts[i];
+            _ptsLocalId[ptId] = i;
+            seeds[i] = !fromLockedPts || _ptsLocked[ptId];
+
+            // a point is locked if one of its triangles crosses the partition boundary
+            bool locked = false;
+            for(const int triId : _ptsTris[ptId])
+                for(int k = 0; k < 3; ++k)
+                    locked = locked || (_ptsCell[_mesh.tris[triId].v[k]] != cellId);
+            _ptsLocked[ptId] = locked;
+
+            computeQuadric(ptId, quadrics[i]);
+        }
+
+        std::priority_queue<CollapseCandidate, std::vector<CollapseCandidate>, std::greater<CollapseCandidate>> candidates;
+        std::vector<int> neighbors;
+
+        const auto addCandidates = [&](int ptId, bool allNeighbors) {
+            if(_ptsLocked[ptId])
+                return;
+            getNeighbors(ptId, neighbors);
+            for(const int neighborId : neighbors)
+            {
+                if(_ptsLocked[neighborId] || (!allNeighbors && neighborId < ptId))
+                    continue;
+                CollapseCandidate candidate;
+                computeCandidate(ptId, neighborId, quadrics[_ptsLocalId[ptId]], quadrics[_ptsLocalId[neighborId]], candidate);
+                candidates.push(candidate);
+            }
+        };
+
+        for(int i = 0; i < nbCellPts; ++i)
+        {
+            if(seeds[i])
+                addCandidates(cellPts[i], fromLockedPts);
+        }
+
+        int nbRemovedPts = 0;
+        while(nbRemovedPts < nbPtsToRemove && !candidates.empty())
+        {
+            const CollapseCandidate candidate = candidates.top();
+            candidates.pop();
+
+            if(_ptsVersion[candidate.ptA] != candidate.versionA || _ptsVersion[candidate.ptB] != candidate.versionB)
+                continue;
+
+            if(_maxError > 0.0 && candidate.cost > _maxError)
+                break;
+
+            if(!collapse(candidate.ptA, candidate.ptB, candidate.point))
+                continue;
+
+            Quadric& quadricA = quadrics[_ptsLocalId[candidate.ptA]];
+            quadricA = quadricA + quadrics[_ptsLocalId[candidate.ptB]];
+            ++nbRemovedPts;
+
+            addCandidates(candidate.ptA, true);
+        }
+
+        return nbRemovedPts;
+    }
+
+    /**
+     * @brief Remove the collapsed points and triangles from the mesh
+     */
+    void compact()
+    {
+        StaticVector<Point3d>& pts = _mesh.pts;
+        StaticVector<Mesh::triangle>& tris = _mesh.tris;
+
+        std::vector<int> newPtIds(pts.size(), -1);
+        int nbPts = 0;
+        for(int ptId = 0; ptId < pts.size(); ++ptId)
+        {
+            if(!_ptsTris[ptId].empty())
+                newPtIds[ptId] = nbPts++;
+        }
+
+        const bool hasColors = (_mesh.colors().size() == pts.size());
+        const bool hasVisibilities = (_mesh.pointsVisibilities.size() == pts.size());
+
+        for(int ptId = 0; ptId < pts.size(); ++ptId)
+        {
+            const int newPtId = newPtIds[ptId];
+            if(newPtId == -1)
+                continue;
+            pts[newPtId] = pts[ptId];
+            if(hasColors)
+                _mesh.colors()[newPtId] = _mesh.colors()[ptId];
+            if(hasVisibilities)
+                std::swap(_mesh.pointsVisibilities[newPtId], _mesh.pointsVisibilities[ptId]);
+        }
+        pts.resize(nbPts);
+        if(hasColors)
+            _mesh.colors().resize(nbPts);
+        if(hasVisibilities)
+            _mesh.pointsVisibilities.resize(nbPts);
+
+        const bool hasMaterials = (_mesh.trisMtlIds().size() == tris.size());
+
+        int nbTris = 0;
+        for(int triId = 0; triId < tris.size(); ++triId)
+        {
+            Mesh::triangle t = tris[triId];
+            if(!t.alive)
+                continue;
+            for(int k = 0; k < 3; ++k)
+                t.v[k] = newPtIds[t.v[k]];
+            tris[nbTris] = t;
+            if(hasMaterials)
+                _mesh.trisMtlIds()[nbTris] = _mesh.trisMtlIds()[triId];
+            ++nbTris;
+        }
+        tris.resize(nbTris);
+        if(hasMaterials)
+            _mesh.trisMtlIds().resize(nbTris);
+
+        // the texture coordinates and normals of the moved points are not valid anymore
+        _mesh.uvCoords.clear();
+        _mesh.trisUvIds.clear();
+        _mesh.normals.clear();
+        _mesh.trisNormalsIds.clear();
+
+        _mesh.invalidateConnectivity();
+    }
+
+private:
+    void splitPartition(int begin, int end, int firstCellId, int nbCells)
+    {
+        if(nbCells == 1 || end - begin <= 1)
+        {
+            for(int i = begin; i < end; ++i)
+                _ptsCell[_cellsPts[i]] = firstCellId;
+            return;
+        }
+
+        Point3d bboxMin = _mesh.pts[_cellsPts[begin]];
+        Point3d bboxMax = bboxMin;
+        for(int i = begin; i < end; ++i)
+        {
+            const Point3d& p = _mesh.pts[_cellsPts[i]];
+            for(int k = 0; k < 3; ++k)
+            {
+                bboxMin.m[k] = std::min(bboxMin.m[k], p.m[k]);
+                bboxMax.m[k] = std::max(bboxMax.m[k], p.m[k]);
+            }
+        }
+
+        const Point3d extent = bboxMax - bboxMin;
+        const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+        const int nbLeftCells = nbCells / 2;
+        const int middle = begin + static_cast<int>(static_cast<long long>(end - begin) * nbLeftCells / nbCells);
+
+        std::nth_element(_cellsPts.begin() + begin, _cellsPts.begin() + middle, _cellsPts.begin() + end, [&](int a, int b) {
+            return _mesh.pts[a].m[axis] < _mesh.pts[b].m[axis];
+        });
+
+        splitPartition(begin, middle, firstCellId, nbLeftCells);
+        splitPartition(middle, end, firstCellId + nbLeftCells, nbCells - nbLeftCells);
+    }
+
+    /// points sharing a triangle with a point, in increasing order
+    void getNeighbors(int ptId, std::vector<int>& out_neighbors) const
+    {
+        out_neighbors.clear();
+        for(const int triId : _ptsTris[ptId])
+        {
+            for(int k = 0; k < 3; ++k)
+            {
+                const int neighborId = _mesh.tris[triId].v[k];
+                if(neighborId != ptId)
+                    out_neighbors.push_back(neighborId);
+            }
+        }
+        std::sort(out_neighbors.begin(), out_neighbors.end());
+        out_neighbors.erase(std::unique(out_neighbors.begin(), out_neighbors.end()), out_neighbors.end());
+    }
+
+    /// number of triangles of a point containing another point
+    int getNbSharedTriangles(int ptId, int otherPtId) const
+    {
+        int nbShared = 0;
+        for(const int triId : _ptsTris[ptId])
+        {
+            const Mesh::triangle& t = _mesh.tris[triId];
+            nbShared += static_cast<int>(t.v[0] == otherPtId || t.v[1] == otherPtId || t.v[2] == otherPtId);
+        }
+        return nbShared;
+    }
+
+    bool isBoundaryPoint(int ptId) const
+    {
+        std::vector<int> neighbors;
+        getNeighbors(ptId, neighbors);
+        for(const int neighborId : neighbors)
+        {
+            if(getNbSharedTriangles(ptId, neighborId) == 1)
+                return true;
+        }
+        return false;
+    }
+
+    /// quadric of the triangle planes around a point, with perpendicular planes on the mesh borders
+    void computeQuadric(int ptId, Quadric& out_quadric) const
+    {
+        const Point3d& p = _mesh.pts[ptId];
+
+        for(const int triId : _ptsTris[ptId])
+        {
+            const Mesh::triangle& t = _mesh.tris[triId];
+            const Point3d& p0 = _mesh.pts[t.v[0]];
+            const Point3d n = cross(_mesh.pts[t.v[1]] - p0, _mesh.pts[t.v[2]] - p0);
+            const double doubleArea = n.size();
+
+            if(doubleArea <= 0.0 || std::isnan(doubleArea))
+                continue;
+
+            const Point3d normal = n / doubleArea;
+            out_quadric.addPlane(normal, -dot(normal, p0), 0.5 * doubleArea);
+
+            for(int k = 0; k < 3; ++k)
+            {
+                const int a = t.v[k];
+                const int b = t.v[(k + 1) % 3];
+                if((a != ptId && b != ptId) || a == b)
+                    continue;
+
+                const int otherPtId = (a == ptId) ? b : a;
+                if(getNbSharedTriangles(ptId, otherPtId) != 1)
+                    continue;
+
+                const Point3d edge = _mesh.pts[otherPtId] - p;
+                const Point3d boundaryNormal = cross(edge, normal).normalize();
+                if(std::isnan(boundaryNormal.x))
+                    continue;
+                out_quadric.addPlane(boundaryNormal, -dot(boundaryNormal, p), boundaryWeight * edge.size2());
+            }
+        }
+    }
+
+    void computeCandidate(int ptA, int ptB, const Quadric& quadricA, const Quadric& quadricB, CollapseCandidate& out_candidate) const
+    {
+        const Quadric quadric = quadricA + quadricB;
+        const Point3d& pA = _mesh.pts[ptA];
+        const Point3d& pB = _mesh.pts[ptB];
+
+        Point3d point;
+        double cost;
+
+        if(quadric.getOptimalPoint(point))
+        {
+            cost = quadric.evaluate(point);
+        }
+        else
+        {
+            const Point3d middle = (pA + pB) / 2.0;
+            point = middle;
+            cost = quadric.evaluate(middle);
+            for(const Point3d& p : {pA, pB})
+            {
+                const double c = quadric.evaluate(p);
+                if(c < cost)
+                {
+                    cost = c;
+                    point = p;
+                }
+            }
+        }
+
+        // the edge length term (homogeneous to the area weighted quadric error) favors well-shaped triangles
+        const double length2 = (pB - pA).size2();
+        out_candidate.cost = std::max(0.0, cost) + edgeLengthWeight * length2 * length2;
+        out_candidate.ptA = ptA;
+        out_candidate.ptB = ptB;
+        out_candidate.versionA = _ptsVersion[ptA];
+        out_candidate.versionB = _ptsVersion[ptB];
+        out_candidate.point = point;
+    }
+
+    /// check that the triangles around a point keep their orientation if the point moves
+    bool isValidMove(int ptId, int otherPtId, const Point3d& point) const
+    {
+        for(const int triId : _ptsTris[ptId])
+        {
+            const Mesh::triangle& t = _mesh.tris[triId];
+            if(t.v[0] == otherPtId || t.v[1] == otherPtId || t.v[2] == otherPtId)
+                continue;
+
+            Point3d p[3];
+            for(int k = 0; k < 3; ++k)
+                p[k] = _mesh.pts[t.v[k]];
+
+            const Point3d oldNormal = cross(p[1] - p[0], p[2] - p[0]);
+            for(int k = 0; k < 3; ++k)
+            {
+                if(t.v[k] == ptId)
+                    p[k] = point;
+            }
+            const Point3d newNormal = cross(p[1] - p[0], p[2] - p[0]);
+
+            const double oldSize = oldNormal.size();
+            const double newSize = newNormal.size();
+            if(newSize <= 1e-12 * oldSize || newSize == 0.0)
+                return false;
+            if(oldSize > 0.0 && dot(oldNormal, newNormal) < minNormalCosine * oldSize * newSize)
+                return false;
+        }
+        return true;
+    }
+
+    /// collapse ptB into ptA moved to point
+    bool collapse(int ptA, int ptB, const Point3d& point)
+    {
+        std::vector<int>& trisA = _ptsTris[ptA];
+        std::vector<int>& trisB = _ptsTris[ptB];
+
+        std::vector<int> sharedTris;
+        for(const int triId : trisB)
+        {
+            const Mesh::triangle& t = _mesh.tris[triId];
+            if(t.v[0] == ptA || t.v[1] == ptA || t.v[2] == ptA)
+                sharedTris.push_back(triId);
+        }
+
+        // only manifold edges
+        if(sharedTris.empty() || sharedTris.size() > 2)
+            return false;
+
+        // an inner edge between two border points would pinch the mesh
+        if(sharedTris.size() == 2 && isBoundaryPoint(ptA) && isBoundaryPoint(ptB))
+            return false;
+
+        // link condition: the common neighbors are the opposite points of the shared triangles
+        {
+            std::vector<int> neighborsA;
+            std::vector<int> neighborsB;
+            getNeighbors(ptA, neighborsA);
+            getNeighbors(ptB, neighborsB);
+            std::vector<int> commonNeighbors;
+            std::set_intersection(neighborsA.begin(), neighborsA.end(), neighborsB.begin(), neighborsB.end(), std::back_inserter(commonNeighbors));
+            if(commonNeighbors.size() != sharedTris.size())
+                return false;
+
+            // valence of the resulting point (A and B are in the neighbors of each other)
+            const int valence = static_cast<int>(neighborsA.size() + neighborsB.size() - commonNeighbors.size()) - 2;
+            if(valence > maxValence)
+                return false;
+        }
+
+        if(!isValidMove(ptA, ptB, point) || !isValidMove(ptB, ptA, point))
+            return false;
+
+        // remove the shared triangles
+        for(const int triId : sharedTris)
+        {
+            Mesh::triangle& t = _mesh.tris[triId];
+            t.alive = false;
+            for(int k = 0; k < 3; ++k)
+            {
+                if(t.v[k] == ptB)
+                    continue;
+                std::vector<int>& ptTris = _ptsTris[t.v[k]];
+                ptTris.erase(std::remove(ptTris.begin(), ptTris.end(), triId), ptTris.end());
+            }
+        }
+
+        // move the other triangles of B to A
+        for(const int triId : trisB)
+        {
+            Mesh::triangle& t = _mesh.tris[triId];
+            if(!t.alive)
+                continue;
+            for(int k = 0; k < 3; ++k)
+            {
+                if(t.v[k] == ptB)
+                    t.v[k] = ptA;
+            }
+            trisA.push_back(triId);
+        }
+        std::vector<int>().swap(trisB);
+
+        _mesh.pts[ptA] = point;
+        ++_ptsVersion[ptA];
+        _ptsVersion[ptB] = -1;
+
+        if(_mesh.pointsVisibilities.size() == _mesh.pts.size())
+        {
+            PointVisibility& visibilityA = _mesh.pointsVisibilities[ptA];
+            PointVisibility& visibilityB = _mesh.pointsVisibilities[ptB];
+            for(const int camId : visibilityB)
+                visibilityA.push_back_distinct(camId);
+            visibilityB.clear();
+        }
+        return true;
+    }
+
+    Mesh& _mesh;
+    const double _maxError;
+
+    /// alive triangles of each point (empty for removed points)
+    std::vector<std::vector<int>> _ptsTris;
+    /// partition of each point
+    std::vector<int> _ptsCell;
+    /// version of each point, incremented at each collapse (-1 for removed points)
+    std::vector<int> _ptsVersion;
+    /// points with a triangle crossing their partition boundary
+    std::vector<char> _ptsLocked;
+    /// index of each point in its partition
+    std::vector<int> _ptsLocalId;
+    /// points sorted by partition
+    std::vector<int> _cellsOffsets;
+    std::vector<int> _cellsPts;
+};
+
+} // namespace
+
+int decimateMesh(Mesh& mesh, const DecimationParams& params)
+{
+    system::Timer timer;
+
+    QuadricDecimator decimator(mesh, params.maxError);
+
+    const int nbInputPts = decimator.getNbPoints();
+    const int targetNbPts = std::max(0, params.targetNbPoints);
+
+    if(nbInputPts <= targetNbPts)
+    {
+        ALICEVISION_LOG_INFO("Mesh decimation: the mesh has already " << nbInputPts << " points (target: " << targetNbPts << ").");
+        return 0;
+    }
+
+    int nbPartitions = params.nbPartitions;
+    if(nbPartitions <= 0)
+        nbPartitions = std::max(1, std::min(maxPartitionsPerThread * omp_get_max_threads(), nbInputPts / minPartitionNbPoints));
+
+    ALICEVISION_LOG_INFO("Mesh decimation:" << std::endl
+                         << "\t- # input points: " << nbInputPts << std::endl
+                         << "\t- # target points: " << targetNbPts << std::endl
+                         << "\t- # partitions: " << nbPartitions);
+
+    int nbRemovedPts = 0;
+
+    // parallel decimation inside the partitions, the partitions boundaries are locked
+    if(nbPartitions > 1)
+    {
+        decimator.setPartitions(nbPartitions);
+        const double ratio = static_cast<double>(nbInputPts - targetNbPts) / nbInputPts;
+
+        #pragma omp parallel for schedule(dynamic) reduction(+:nbRemovedPts)
+        for(int cellId = 0; cellId < nbPartitions; ++cellId)
+        {
+            // the locked points are decimated in the boundary pass with the same ratio, keeping a uniform density
+            const int nbPtsToRemove = static_cast<int>(ratio * decimator.getPartitionNbFreePoints(cellId));
+            nbRemovedPts += decimator.decimatePartition(cellId, nbPtsToRemove, false);
+        }
+
+        ALICEVISION_LOG_INFO("Mesh decimation: " << nbRemovedPts << " points removed in the partitions (" << timer.elapsed() << " s).");
+    }
+
+    // boundary pass: start from the previously locked points
+    decimator.setPartitions(1);
+    if(nbPartitions > 1)
+        nbRemovedPts += decimator.decimatePartition(0, nbInputPts - nbRemovedPts - targetNbPts, true);
+
+    // final pass over the whole mesh if the target is still not reached
+    if(nbInputPts - nbRemovedPts > targetNbPts)
+        nbRemovedPts += decimator.decimatePartition(0, nbInputPts - nbRemovedPts - targetNbPts, false);
+
+    decimator.compact();
+
+    ALICEVISION_LOG_INFO("Mesh decimation done in " << timer.elapsed() << " s:" << std::endl
+                         << "\t- # output points: " << mesh.pts.size() << std::endl
+                         << "\t- # output triangles: " << mesh.tris.size());
+
+    return nbRemovedPts;
+}
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,47 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mesh/Mesh.hpp>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+ * @brief Mesh decimation parameters
+ */
+struct DecimationParams
+{
+    /// target number of output points
+    int targetNbPoints = 0;
+    /// number of spatial partitions decimated in parallel (0: automatic)
+    int nbPartitions = 0;
+    /// maximum quadric error of an edge collapse (<= 0: no limit)
+    double maxError = 0.0;
+};
+
+/**
+ * @brief Decimate a mesh by edge collapses ordered by quadric error (Garland & Heckbert).
+ *
+ * The points are split into spatial partitions decimated in parallel: only the points whose triangles
+ * are all inside the partition can be collapsed, the partition boundaries are locked.
+ * A final pass around the locked points reaches the target number of points.
+ * The quadrics are computed from the current triangles at the beginning of each pass.
+ * A small edge length term favors well-shaped triangles where the quadric error vanishes (planar regions)
+ * and the valence of the collapsed points is bounded.
+ *
+ * The visibilities (pointsVisibilities) of a collapsed point are merged in the remaining point,
+ * which keeps its color. The UV coordinates and normals are not valid anymore and are removed.
+ *
+ * @param[in,out] mesh the mesh to decimate
+ * @param[in] params the decimation parameters
+ * @return the number of removed points
+ */
+int decimateMesh(Mesh& mesh, const DecimationParams& params);
+
+} // namespace mesh
+} // namespace aliceVision
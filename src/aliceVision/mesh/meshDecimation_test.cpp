@@ -0,0 +1,241 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/meshDecimation.hpp>
+#include <aliceVision/mesh/MeshConnectivity.hpp>
+
+#include <cmath>
+#include <set>
+#include <vector>
+
+#define BOOST_TEST_MODULE meshDecimation
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+// Test summary:
+// - Decimate a flat grid and a closed sphere, with one or several partitions
+// - Assert that:
+//   - the number of output points is close to the target
+//   - the output is manifold, without degenerate triangles, and keeps its topology (Euler characteristic)
+//   - the grid corners do not move and the grid border points stay on the border
+//   - the visibilities of the collapsed points are merged in the remaining points
+
+namespace {
+
+/**
+ * @brief Flat grid of size x size points in the z = 0 plane, each point is seen by a camera of its own index
+ */
+void getGrid(int size, Mesh& mesh)
+{
+    for(int y = 0; y < size; ++y)
+    {
+        for(int x = 0; x < size; ++x)
+        {
+            mesh.pts.push_back(Point3d(x, y, 0.0));
+            mesh.pointsVisibilities.push_back(PointVisibility());
+            mesh.pointsVisibilities.back().push_back(y * size + x);
+        }
+    }
+
+    for(int y = 0; y + 1 < size; ++y)
+    {
+        for(int x = 0; x + 1 < size; ++x)
+        {
+            const int a = y * size + x;
+            const int b = a + 1;
+            const int c = a + size;
+            const int d = c + 1;
+            mesh.tris.push_back(Mesh::triangle(a, b, d));
+            mesh.tris.push_back(Mesh::triangle(a, d, c));
+        }
+    }
+}
+
+/**
+ * @brief Unit sphere with the given number of rings and segments, each point is seen by a camera of its own index
+ */
+void getSphere(int nbRings, int nbSegments, Mesh& mesh)
+{
+    mesh.pts.push_back(Point3d(0.0, 0.0, 1.0));
+    for(int r = 1; r < nbRings; ++r)
+    {
+        const double theta = M_PI * r / nbRings;
+        for(int s = 0; s < nbSegments; ++s)
+        {
+            const double phi = 2.0 * M_PI * s / nbSegments;
+            mesh.pts.push_back(Point3d(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)));
+        }
+    }
+    mesh.pts.push_back(Point3d(0.0, 0.0, -1.0));
+
+    for(int i = 0; i < mesh.pts.size(); ++i)
+    {
+        mesh.pointsVisibilities.push_back(PointVisibility());
+        mesh.pointsVisibilities.back().push_back(i);
+    }
+
+    const int southPole = mesh.pts.size() - 1;
+    const auto ringPt = [&](int r, int s) { return 1 + (r - 1) * nbSegments + (s % nbSegments); };
+
+    for(int s = 0; s < nbSegments; ++s)
+    {
+        mesh.tris.push_back(Mesh::triangle(0, ringPt(1, s), ringPt(1, s + 1)));
+        for(int r = 1; r + 1 < nbRings; ++r)
+        {
+            mesh.tris.push_back(Mesh::triangle(ringPt(r, s), ringPt(r + 1, s), ringPt(r + 1, s + 1)));
+            mesh.tris.push_back(Mesh::triangle(ringPt(r, s), ringPt(r + 1, s + 1), ringPt(r, s + 1)));
+        }
+        mesh.tris.push_back(Mesh::triangle(ringPt(nbRings - 1, s), southPole, ringPt(nbRings - 1, s + 1)));
+    }
+}
+
+/**
+ * @brief Check that the mesh is manifold without degenerate triangles
+ * @return the Euler characteristic of the mesh
+ */
+int checkManifold(const Mesh& mesh, int& out_nbBoundaryEdges)
+{
+    for(int i = 0; i < mesh.tris.size(); ++i)
+    {
+        const Mesh::triangle& t = mesh.tris[i];
+        BOOST_CHECK(t.v[0] != t.v[1] && t.v[1] != t.v[2] && t.v[0] != t.v[2]);
+
+        const Point3d n = cross(mesh.pts[t.v[1]] - mesh.pts[t.v[0]], mesh.pts[t.v[2]] - mesh.pts[t.v[0]]);
+        BOOST_CHECK_GT(n.size(), 1e-9);
+    }
+
+    const MeshConnectivity& connectivity = mesh.getConnectivity();
+    out_nbBoundaryEdges = 0;
+    for(int edgeId = 0; edgeId < connectivity.getNbEdges(); ++edgeId)
+    {
+        BOOST_CHECK(connectivity.isManifoldEdge(edgeId) || connectivity.isBoundaryEdge(edgeId));
+        out_nbBoundaryEdges += connectivity.isBoundaryEdge(edgeId);
+    }
+
+    // no unused points
+    for(int ptId = 0; ptId < mesh.pts.size(); ++ptId)
+        BOOST_CHECK(!connectivity.getPtNeighborTriangles(ptId).empty());
+
+    return mesh.pts.size() - connectivity.getNbEdges() + mesh.tris.size();
+}
+
+/**
+ * @brief Check that each input camera is in the visibilities of exactly one output point
+ */
+void checkVisibilities(const Mesh& mesh, int nbInputPts)
+{
+    BOOST_REQUIRE_EQUAL(mesh.pointsVisibilities.size(), mesh.pts.size());
+
+    std::multiset<int> cameras;
+    for(int ptId = 0; ptId < mesh.pointsVisibilities.size(); ++ptId)
+    {
+        for(int i = 0; i < mesh.pointsVisibilities[ptId].size(); ++i)
+            cameras.insert(mesh.pointsVisibilities[ptId][i]);
+    }
+
+    BOOST_CHECK_EQUAL(cameras.size(), nbInputPts);
+    for(int camId = 0; camId < nbInputPts; ++camId)
+        BOOST_CHECK_EQUAL(cameras.count(camId), 1);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(MESH_DECIMATION_Grid)
+{
+    const int size = 60;
+    const int nbInputPts = size * size;
+
+    for(const int nbPartitions : {1, 4})
+    {
+        BOOST_TEST_CONTEXT("partitions: " << nbPartitions)
+        {
+            Mesh mesh;
+            getGrid(size, mesh);
+
+            DecimationParams params;
+            params.targetNbPoints = nbInputPts / 10;
+            params.nbPartitions = nbPartitions;
+
+            const int nbRemovedPts = decimateMesh(mesh, params);
+
+            BOOST_CHECK_EQUAL(nbRemovedPts, nbInputPts - mesh.pts.size());
+            BOOST_CHECK_LE(std::abs(mesh.pts.size() - params.targetNbPoints), params.targetNbPoints / 20);
+
+            // a disk: V - E + F = 1
+            int nbBoundaryEdges = 0;
+            BOOST_CHECK_EQUAL(checkManifold(mesh, nbBoundaryEdges), 1);
+            BOOST_CHECK_GE(nbBoundaryEdges, 4);
+
+            // the corners do not move and the border points stay on the border
+            const MeshConnectivity& connectivity = mesh.getConnectivity();
+            std::set<std::pair<int, int>> corners;
+            double borderLength = 0.0;
+            for(int edgeId = 0; edgeId < connectivity.getNbEdges(); ++edgeId)
+            {
+                if(!connectivity.isBoundaryEdge(edgeId))
+                    continue;
+
+                const Pixel& edgePts = connectivity.getEdgePoints(edgeId);
+                for(const int ptId : {edgePts.x, edgePts.y})
+                {
+                    const Point3d& p = mesh.pts[ptId];
+                    const bool onBorderX = (std::abs(p.x) < 1e-9 || std::abs(p.x - (size - 1)) < 1e-9);
+                    const bool onBorderY = (std::abs(p.y) < 1e-9 || std::abs(p.y - (size - 1)) < 1e-9);
+                    BOOST_CHECK(onBorderX || onBorderY);
+                    if(onBorderX && onBorderY)
+                        corners.emplace(static_cast<int>(std::round(p.x)), static_cast<int>(std::round(p.y)));
+                }
+                borderLength += (mesh.pts[edgePts.x] - mesh.pts[edgePts.y]).size();
+            }
+            BOOST_CHECK_EQUAL(corners.size(), 4);
+            BOOST_CHECK_CLOSE(borderLength, 4.0 * (size - 1), 1e-6);
+
+            // the grid stays flat
+            for(int ptId = 0; ptId < mesh.pts.size(); ++ptId)
+                BOOST_CHECK_SMALL(mesh.pts[ptId].z, 1e-9);
+
+            checkVisibilities(mesh, nbInputPts);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MESH_DECIMATION_Sphere)
+{
+    const int nbRings = 30;
+    const int nbSegments = 60;
+
+    for(const int nbPartitions : {1, 4})
+    {
+        BOOST_TEST_CONTEXT("partitions: " << nbPartitions)
+        {
+            Mesh mesh;
+            getSphere(nbRings, nbSegments, mesh);
+            const int nbInputPts = mesh.pts.size();
+
+            DecimationParams params;
+            params.targetNbPoints = nbInputPts / 5;
+            params.nbPartitions = nbPartitions;
+
+            decimateMesh(mesh, params);
+
+            BOOST_CHECK_LE(std::abs(mesh.pts.size() - params.targetNbPoints), params.targetNbPoints / 20);
+
+            // a closed sphere: V - E + F = 2, F = 2V - 4
+            int nbBoundaryEdges = 0;
+            BOOST_CHECK_EQUAL(checkManifold(mesh, nbBoundaryEdges), 2);
+            BOOST_CHECK_EQUAL(nbBoundaryEdges, 0);
+            BOOST_CHECK_EQUAL(mesh.tris.size(), 2 * mesh.pts.size() - 4);
+
+            // the points stay close to the sphere
+            for(int ptId = 0; ptId < mesh.pts.size(); ++ptId)
+                BOOST_CHECK_SMALL(mesh.pts[ptId].size() - 1.0, 0.02);
+
+            checkVisibilities(mesh, nbInputPts);
+        }
+    }
+}
@@ -0,0 +1,512 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "octreeLOD.hpp"
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace bfs = boost::filesystem;
+namespace bpt = boost::property_tree;
+
+namespace {
+
+/**
+ * @brief Octree node being built
+ */
+struct OctreeNode
+{
+    /// node name: "r" followed by the child index of each level
+    std::string name;
+    int depth = 0;
+    /// cube min corner
+    Point3d min;
+    /// cube side
+    double size = 0.0;
+    /// indexes of the points (or triangles) in the node cube
+    std::vector<int> items;
+};
+
+/**
+ * @brief Octree node written in the hierarchy file
+ */
+struct NodeRecord
+{
+    std::string name;
+    int depth = 0;
+    Point3d min;
+    double size = 0.0;
+    /// number of points (or triangles) stored in the node file
+    int count = 0;
+    /// children indexes (0 to 7)
+    std::vector<int> children;
+};
+
+/**
+ * @brief Bounding cube of a set of points, slightly enlarged so the points stay strictly inside
+ */
+void getBoundingCube(const std::vector<Point3d>& points, Point3d& min, double& size)
+{
+    if(points.empty())
+    {
+        min = Point3d(0.0, 0.0, 0.0);
+        size = 1.0;
+        return;
+    }
+
+    Point3d max(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+    min = Point3d(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+
+    for(const Point3d& p : points)
+    {
+        min.x = std::min(min.x, p.x);
+        min.y = std::min(min.y, p.y);
+        min.z = std::min(min.z, p.z);
+        max.x = std::max(max.x, p.x);
+        max.y = std::max(max.y, p.y);
+        max.z = std::max(max.z, p.z);
+    }
+
+    size = std::max(std::max(max.x - min.x, max.y - min.y), max.z - min.z);
+    size = (size > 0.0) ? size * 1.001 : 1.0;
+}
+
+/**
+ * @brief Index of the child cube containing a point
+ */
+inline int getChildIndex(const OctreeNode& node, const Point3d& p)
+{
+    const double halfSize = node.size * 0.5;
+    return static_cast<int>(p.x >= node.min.x + halfSize) |
+           (static_cast<int>(p.y >= node.min.y + halfSize) << 1) |
+           (static_cast<int>(p.z >= node.min.z + halfSize) << 2);
+}
+
+/**
+ * @brief Index of the sampling grid cell of a node containing a point (clamped to the node cube)
+ */
+inline std::int64_t getCellIndex(const OctreeNode& node, int gridResolution, const Point3d& p)
+{
+    const double scale = gridResolution / node.size;
+    const auto cellCoord = [&](double v, double min)
+    {
+        return std::max(0, std::min(gridResolution - 1, static_cast<int>(std::floor((v - min) * scale))));
+    };
+    return (static_cast<std::int64_t>(cellCoord(p.x, node.min.x)) * gridResolution + cellCoord(p.y, node.min.y)) * gridResolution +
+           cellCoord(p.z, node.min.z);
+}
+
+/**
+ * @brief Write a binary PLY file with points and optional colors and triangles
+ * @param[in] path the output file path
+ * @param[in] vertices the vertex positions
+ * @param[in] colors the vertex colors (same size as vertices, or empty)
+ * @param[in] triangles the triangle vertex indexes (3 per triangle, may be empty)
+ * @return false if the file cannot be written
+ */
+bool writePLY(const std::string& path, const std::vector<Point3d>& vertices, const std::vector<rgb>& colors,
+              const std::vector<int>& triangles)
+{
+    std::ofstream stream(path, std::ios::binary);
+    if(!stream.is_open())
+        return false;
+
+    const bool hasColors = !colors.empty();
+
+    stream << "ply\n"
+           << "format binary_little_endian 1.0\n"
+           << "element vertex " << vertices.size() << "\n"
+           << "property float x\n"
+           << "property float y\n"
+           << "property float z\n";
+    if(hasColors)
+    {
+        stream << "property uchar red\n"
+               << "property uchar green\n"
+               << "property uchar blue\n";
+    }
+    if(!triangles.empty())
+    {
+        stream << "element face " << triangles.size() / 3 << "\n"
+               << "property list uchar int vertex_indices\n";
+    }
+    stream << "end_header\n";
+
+    // note: binary values are written with the host byte order, which is little endian on all supported platforms
+    std::vector<char> buffer;
+    const std::size_t vertexSize = 3 * sizeof(float) + (hasColors ? 3 : 0);
+    buffer.resize(vertices.size() * vertexSize);
+    char* out = buffer.data();
+    for(std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        const float xyz[3] = {static_cast<float>(vertices[i].x), static_cast<float>(vertices[i].y), static_cast<float>(vertices[i].z)};
+        std::memcpy(out, xyz, sizeof(xyz));
+        out += sizeof(xyz);
+        if(hasColors)
+        {
+            *out++ = static_cast<char>(colors[i].r);
+            *out++ = static_cast<char>(colors[i].g);
+            *out++ = static_cast<char>(colors[i].b);
+        }
+    }
+    stream.write(buffer.data(), buffer.size());
+
+    if(!triangles.empty())
+    {
+        const std::size_t faceSize = 1 + 3 * sizeof(int);
+        buffer.resize(triangles.size() / 3 * faceSize);
+        out = buffer.data();
+        for(std::size_t i = 0; i < triangles.size(); i += 3)
+        {
+            *out++ = 3;
+            std::memcpy(out, &triangles[i], 3 * sizeof(int));
+            out += 3 * sizeof(int);
+        }
+        stream.write(buffer.data(), buffer.size());
+    }
+
+    return stream.good();
+}
+
+/**
+ * @brief Build an octree level by level and write the hierarchy file
+ * @param[in] rootMin the root cube min corner
+ * @param[in] rootSize the root cube side
+ * @param[in] nbItems the number of points (or triangles)
+ * @param[in] type the hierarchy type ("points" or "mesh")
+ * @param[in] refine the refinement mode of the children ("ADD" or "REPLACE")
+ * @param[in] outputFolder the output folder
+ * @param[in] params the octree parameters
+ * @param[in] processNode function writing the node file to the given path and filling the children items,
+ *            returns the number of written points (or triangles), or -1 if the file cannot be written
+ * @return the number of nodes
+ */
+template <class ProcessNodeFunc>
+int buildOctree(const Point3d& rootMin, double rootSize, int nbItems, const std::string& type, const std::string& refine,
+                const std::string& outputFolder, const OctreeLODParams& params, ProcessNodeFunc processNode)
+{
+    if(params.maxNodeSize <= 0 || params.gridResolution <= 0 || params.maxDepth < 0)
+        throw std::invalid_argument("Invalid octree level of detail parameters.");
+
+    const bfs::path nodesFolder = bfs::path(outputFolder) / "nodes";
+    bfs::create_directories(nodesFolder);
+
+    std::vector<NodeRecord> records;
+    std::vector<OctreeNode> level(1);
+    level[0].name = "r";
+    level[0].min = rootMin;
+    level[0].size = rootSize;
+    level[0].items.resize(nbItems);
+    for(int i = 0; i < nbItems; ++i)
+        level[0].items[i] = i;
+
+    while(!level.empty())
+    {
+        const int depth = level.front().depth;
+        const bool lastLevel = (depth >= params.maxDepth);
+
+        std::vector<std::array<std::vector<int>, 8>> levelChildrenItems(level.size());
+        std::vector<int> counts(level.size(), 0);
+
+        #pragma omp parallel for schedule(dynamic)
+        for(int i = 0; i < level.size(); ++i)
+        {
+            OctreeNode& node = level[i];
+            const bool leaf = lastLevel || (node.items.size() <= static_cast<std::size_t>(params.maxNodeSize));
+            counts[i] = processNode(node, leaf, (nodesFolder / (node.name + ".ply")).string(), levelChildrenItems[i]);
+            // release the node items, they have been dispatched to the children
+            std::vector<int>().swap(node.items);
+        }
+
+        std::vector<OctreeNode> nextLevel;
+        std::size_t nbLevelItems = 0;
+        for(int i = 0; i < level.size(); ++i)
+        {
+            const OctreeNode& node = level[i];
+            if(counts[i] < 0)
+                throw std::runtime_error("Unable to write the octree node file: " + (nodesFolder / (node.name + ".ply")).string());
+
+            NodeRecord record;
+            record.name = node.name;
+            record.depth = node.depth;
+            record.min = node.min;
+            record.size = node.size;
+            record.count = counts[i];
+            nbLevelItems += counts[i];
+
+            const double halfSize = node.size * 0.5;
+            for(int c = 0; c < 8; ++c)
+            {
+                std::vector<int>& childItems = levelChildrenItems[i][c];
+                if(childItems.empty())
+                    continue;
+
+                record.children.push_back(c);
+
+                OctreeNode child;
+                child.name = node.name + std::to_string(c);
+                child.depth = node.depth + 1;
+                child.min = node.min + Point3d((c & 1) ? halfSize : 0.0, (c & 2) ? halfSize : 0.0, (c & 4) ? halfSize : 0.0);
+                child.size = halfSize;
+                child.items.swap(childItems);
+                nextLevel.push_back(std::move(child));
+            }
+            records.push_back(std::move(record));
+        }
+
+        ALICEVISION_LOG_INFO("Octree level " << depth << ": " << level.size() << " nodes, " << nbLevelItems << " " << (type == "points" ? "points" : "triangles") << ".");
+        level.swap(nextLevel);
+    }
+
+    // write the hierarchy file
+    const auto toTree = [](const Point3d& p)
+    {
+        bpt::ptree tree;
+        for(double v : {p.x, p.y, p.z})
+        {
+            bpt::ptree value;
+            value.put("", v);
+            tree.push_back(std::make_pair("", value));
+        }
+        return tree;
+    };
+
+    bpt::ptree hierarchyTree;
+    hierarchyTree.put("version", "1.0");
+    hierarchyTree.put("type", type);
+    hierarchyTree.put("refine", refine);
+    hierarchyTree.put("nodesFolder", "nodes");
+    hierarchyTree.add_child("min", toTree(rootMin));
+    hierarchyTree.put("size", rootSize);
+    hierarchyTree.put("spacing", rootSize / params.gridResolution);
+
+    bpt::ptree nodesTree;
+    for(const NodeRecord& record : records)
+    {
+        bpt::ptree nodeTree;
+        nodeTree.put("name", record.name);
+        nodeTree.put("depth", record.depth);
+        nodeTree.add_child("min", toTree(record.min));
+        nodeTree.put("size", record.size);
+        nodeTree.put("count", record.count);
+
+        bpt::ptree childrenTree;
+        for(int c : record.children)
+        {
+            bpt::ptree childTree;
+            childTree.put("", c);
+            childrenTree.push_back(std::make_pair("", childTree));
+        }
+        nodeTree.add_child("children", childrenTree);
+        nodesTree.push_back(std::make_pair("", nodeTree));
+    }
+    hierarchyTree.add_child("nodes", nodesTree);
+
+    bpt::write_json((bfs::path(outputFolder) / "hierarchy.json").string(), hierarchyTree);
+
+    return static_cast<int>(records.size());
+}
+
+} // namespace
+
+int exportPointCloudLOD(const std::vector<Point3d>& points, const std::vector<rgb>& colors,
+                        const std::string& outputFolder, const OctreeLODParams& params)
+{
+    ALICEVISION_LOG_INFO("Exporting point cloud level of detail octree (" << points.size() << " points) to: " << outputFolder);
+
+    if(!colors.empty() && colors.size() != points.size())
+        throw std::invalid_argument("The number of colors doesn't match the number of points.");
+
+    const system::Timer timer;
+
+    Point3d rootMin;
+    double rootSize;
+    getBoundingCube(points, rootMin, rootSize);
+
+    const auto processNode = [&](const OctreeNode& node, bool leaf, const std::string& path, std::array<std::vector<int>, 8>& childrenItems) -> int
+    {
+        // keep the first point of each cell of the sampling grid, dispatch the other ones to the children
+        std::vector<int> selected;
+        if(leaf)
+        {
+            selected = node.items;
+        }
+        else
+        {
+            std::unordered_set<std::int64_t> usedCells;
+            for(int pointId : node.items)
+            {
+                const Point3d& p = points[pointId];
+                if(usedCells.insert(getCellIndex(node, params.gridResolution, p)).second)
+                    selected.push_back(pointId);
+                else
+                    childrenItems[getChildIndex(node, p)].push_back(pointId);
+            }
+        }
+
+        std::vector<Point3d> nodePoints(selected.size());
+        std::vector<rgb> nodeColors(colors.empty() ? 0 : selected.size());
+        for(std::size_t i = 0; i < selected.size(); ++i)
+        {
+            nodePoints[i] = points[selected[i]];
+            if(!colors.empty())
+                nodeColors[i] = colors[selected[i]];
+        }
+
+        if(!writePLY(path, nodePoints, nodeColors, std::vector<int>()))
+            return -1;
+        return static_cast<int>(selected.size());
+    };
+
+    const int nbNodes = buildOctree(rootMin, rootSize, static_cast<int>(points.size()), "points", "ADD", outputFolder, params, processNode);
+
+    ALICEVISION_LOG_INFO("Point cloud level of detail octree exported (" << nbNodes << " nodes) in " << system::prettyTime(timer.elapsedMs()) << ".");
+    return nbNodes;
+}
+
+int exportMeshLOD(const Mesh& mesh, const std::string& outputFolder, const OctreeLODParams& params)
+{
+    ALICEVISION_LOG_INFO("Exporting mesh level of detail octree (" << mesh.pts.size() << " points, " << mesh.tris.size() << " triangles) to: " << outputFolder);
+
+    const system::Timer timer;
+    const std::vector<rgb>& colors = mesh.colors();
+    const bool hasColors = !colors.empty() && (colors.size() == mesh.pts.size());
+
+    const std::vector<Point3d> points(mesh.pts.begin(), mesh.pts.end());
+    Point3d rootMin;
+    double rootSize;
+    getBoundingCube(points, rootMin, rootSize);
+
+    const auto getTriangleCenter = [&](int triangleId)
+    {
+        const Mesh::triangle& t = mesh.tris[triangleId];
+        return (points[t.v[0]] + points[t.v[1]] + points[t.v[2]]) / 3.0;
+    };
+
+    const auto processNode = [&](const OctreeNode& node, bool leaf, const std::string& path, std::array<std::vector<int>, 8>& childrenItems) -> int
+    {
+        std::vector<Point3d> nodePoints;
+        std::vector<rgb> nodeColors;
+        std::vector<int> nodeTriangles;
+        nodeTriangles.reserve(node.items.size() * 3);
+
+        if(leaf)
+        {
+            // original triangles, with the vertexes renumbered in the node
+            std::unordered_map<int, int> vertexIds;
+            for(int triangleId : node.items)
+            {
+                for(int k = 0; k < 3; ++k)
+                {
+                    const int pointId = mesh.tris[triangleId].v[k];
+                    const auto it = vertexIds.emplace(pointId, static_cast<int>(nodePoints.size()));
+                    if(it.second)
+                    {
+                        nodePoints.push_back(points[pointId]);
+                        if(hasColors)
+                            nodeColors.push_back(colors[pointId]);
+                    }
+                    nodeTriangles.push_back(it.first->second);
+                }
+            }
+        }
+        else
+        {
+            // vertex clustering: the vertexes of a cell of the sampling grid are merged at their mean position
+            std::unordered_map<std::int64_t, int> cellVertexIds;
+            std::vector<int> nbCellPoints;
+            std::vector<std::array<double, 3>> cellColors;
+            std::unordered_map<int, int> vertexIds;
+            std::set<std::array<int, 3>> usedTriangles;
+
+            for(int triangleId : node.items)
+            {
+                std::array<int, 3> cellTriangle;
+                for(int k = 0; k < 3; ++k)
+                {
+                    const int pointId = mesh.tris[triangleId].v[k];
+                    auto vertexIt = vertexIds.find(pointId);
+                    if(vertexIt == vertexIds.end())
+                    {
+                        const Point3d& p = points[pointId];
+                        const auto cellIt = cellVertexIds.emplace(getCellIndex(node, params.gridResolution, p), static_cast<int>(nodePoints.size()));
+                        const int cellVertexId = cellIt.first->second;
+                        if(cellIt.second)
+                        {
+                            nodePoints.push_back(Point3d(0.0, 0.0, 0.0));
+                            nbCellPoints.push_back(0);
+                            cellColors.push_back({0.0, 0.0, 0.0});
+                        }
+                        nodePoints[cellVertexId] = nodePoints[cellVertexId] + p;
+                        ++nbCellPoints[cellVertexId];
+                        if(hasColors)
+                        {
+                            cellColors[cellVertexId][0] += colors[pointId].r;
+                            cellColors[cellVertexId][1] += colors[pointId].g;
+                            cellColors[cellVertexId][2] += colors[pointId].b;
+                        }
+                        vertexIt = vertexIds.emplace(pointId, cellVertexId).first;
+                    }
+                    cellTriangle[k] = vertexIt->second;
+                }
+
+                childrenItems[getChildIndex(node, getTriangleCenter(triangleId))].push_back(triangleId);
+
+                // remove the collapsed and duplicated triangles
+                if(cellTriangle[0] == cellTriangle[1] || cellTriangle[1] == cellTriangle[2] || cellTriangle[2] == cellTriangle[0])
+                    continue;
+                std::array<int, 3> sortedTriangle = cellTriangle;
+                std::sort(sortedTriangle.begin(), sortedTriangle.end());
+                if(!usedTriangles.insert(sortedTriangle).second)
+                    continue;
+                nodeTriangles.insert(nodeTriangles.end(), cellTriangle.begin(), cellTriangle.end());
+            }
+
+            for(std::size_t i = 0; i < nodePoints.size(); ++i)
+                nodePoints[i] = nodePoints[i] / nbCellPoints[i];
+            if(hasColors)
+            {
+                nodeColors.resize(nodePoints.size());
+                for(std::size_t i = 0; i < nodePoints.size(); ++i)
+                {
+                    nodeColors[i] = rgb(static_cast<unsigned char>(cellColors[i][0] / nbCellPoints[i] + 0.5),
+                                        static_cast<unsigned char>(cellColors[i][1] / nbCellPoints[i] + 0.5),
+                                        static_cast<unsigned char>(cellColors[i][2] / nbCellPoints[i] + 0.5));
+                }
+            }
+        }
+
+        if(!writePLY(path, nodePoints, nodeColors, nodeTriangles))
+            return -1;
+        return static_cast<int>(nodeTriangles.size() / 3);
+    };
+
+    const int nbNodes = buildOctree(rootMin, rootSize, mesh.tris.size(), "mesh", "REPLACE", outputFolder, params, processNode);
+
+    ALICEVISION_LOG_INFO("Mesh level of detail octree exported (" << nbNodes << " nodes) in " << system::prettyTime(timer.elapsedMs()) << ".");
+    return nbNodes;
+}
+
+} // namespace mesh
+} // namespace aliceVision
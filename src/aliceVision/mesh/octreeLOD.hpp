@@ -0,0 +1,71 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/Rgb.hpp>
+
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+ * @brief Octree level of detail export parameters
+ */
+struct OctreeLODParams
+{
+    /// maximum number of points (point clouds) or triangles (meshes) of a node, larger nodes are subdivided
+    int maxNodeSize = 100000;
+    /// number of sampling cells along each axis of a node
+    int gridResolution = 128;
+    /// maximum depth of the octree (the root is at depth 0)
+    int maxDepth = 16;
+};
+
+/**
+ * @brief Export a colored point cloud as an additive octree level of detail hierarchy (Potree-like).
+ *
+ * Each node stores one point per cell of its sampling grid, among the points of its cube not stored
+ * by its ancestors. The remaining points are dispatched to its children. Displaying the nodes down
+ * to a given depth shows a subsampling of the point cloud, displaying all the nodes shows all the points.
+ *
+ * The octree is built level by level, the nodes of a level are processed in parallel and written
+ * as soon as they are built: besides the input, the memory used is proportional to the number of points.
+ *
+ * Output files:
+ * - outputFolder/hierarchy.json: bounding cube, spacing and node list (name, depth, cube, size, children)
+ * - outputFolder/nodes/<name>.ply: binary PLY file of each node, the root is "r" and the name of a child
+ *   is the name of its parent followed by its index (x + 2 * y + 4 * z, 1 on the upper half of an axis)
+ *
+ * @param[in] points the point positions
+ * @param[in] colors the point colors (same size as points, or empty)
+ * @param[in] outputFolder the output folder
+ * @param[in] params the octree parameters
+ * @return the number of nodes
+ */
+int exportPointCloudLOD(const std::vector<Point3d>& points, const std::vector<rgb>& colors,
+                        const std::string& outputFolder, const OctreeLODParams& params);
+
+/**
+ * @brief Export a mesh as a replacement octree level of detail hierarchy (3D Tiles-like).
+ *
+ * Each triangle belongs to the nodes containing its center. The leaves store their original triangles,
+ * the other nodes store their triangles simplified by vertex clustering on their sampling grid.
+ * A node is displayed instead of its children. Same processing and output layout as exportPointCloudLOD.
+ *
+ * @param[in] mesh the mesh, with optional per-vertex colors
+ * @param[in] outputFolder the output folder
+ * @param[in] params the octree parameters
+ * @return the number of nodes
+ */
+int exportMeshLOD(const Mesh& mesh, const std::string& outputFolder, const OctreeLODParams& params);
+
+} // namespace mesh
+} // namespace aliceVision
@@ -7,6 +7,10 @@
 
 #include "l1.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <Eigen/SparseCholesky>
+#include <Eigen/IterativeLinearSolvers>
 
 #ifdef ALICEVISION_ROTATION_AVERAGING_WITH_BOOST
 #include <boost/graph/adjacency_list.hpp>
@@ -44,6 +48,76 @@ namespace aliceVision   {
 namespace rotationAveraging  {
 namespace l1  {
 
+// Solver of the normal equations H*x=b (H symmetric positive semi-definite)
+// used by the primal-dual L1 and the IRLS iterations
+template<typename MATRIX_TYPE>
+struct NormalEquationsSolver;
+
+// dense matrix: dense Cholesky (LDLT) decomposition
+template<>
+struct NormalEquationsSolver<Eigen::Matrix<REAL, Eigen::Dynamic, Eigen::Dynamic> >
+{
+  typedef Eigen::Matrix<REAL, Eigen::Dynamic, Eigen::Dynamic> Matrix;
+  typedef Eigen::Matrix<REAL, Eigen::Dynamic, 1> Vector;
+
+  bool compute(const Matrix& H)
+  {
+    ldlt.compute(H);
+    return ldlt.info() == Eigen::Success;
+  }
+
+  bool solve(const Vector& b, Vector& x)
+  {
+    x = ldlt.solve(b);
+    return ldlt.info() == Eigen::Success;
+  }
+
+  Eigen::LDLT<Matrix> ldlt;
+};
+
+// sparse matrix: sparse Cholesky (LDLT) decomposition, the fill-reducing ordering
+// is computed once as the sparsity pattern of H is the same at each iteration.
+// If the factorization fails (e.g. rank deficient system), fallback to conjugate gradient.
+template<>
+struct NormalEquationsSolver<Eigen::SparseMatrix<REAL, Eigen::ColMajor> >
+{
+  typedef Eigen::SparseMatrix<REAL, Eigen::ColMajor> Matrix;
+  typedef Eigen::Matrix<REAL, Eigen::Dynamic, 1> Vector;
+
+  bool compute(const Matrix& H)
+  {
+    if(H.nonZeros() != analyzedNonZeros)
+    {
+      ldlt.analyzePattern(H);
+      analyzedNonZeros = H.nonZeros();
+    }
+    ldlt.factorize(H);
+    useConjugateGradient = (ldlt.info() != Eigen::Success);
+    if(!useConjugateGradient)
+      return true;
+
+    cg.setTolerance(1e-10);
+    cg.compute(H);
+    return cg.info() == Eigen::Success;
+  }
+
+  bool solve(const Vector& b, Vector& x)
+  {
+    if(useConjugateGradient)
+    {
+      x = cg.solve(b);
+      return cg.info() == Eigen::Success;
+    }
+    x = ldlt.solve(b);
+    return ldlt.info() == Eigen::Success;
+  }
+
+  Eigen::SimplicialLDLT<Matrix> ldlt;
+  Eigen::ConjugateGradient<Matrix, Eigen::Lower|Eigen::Upper> cg;
+  Eigen::Index analyzedNonZeros = -1;
+  bool useConjugateGradient = false;
+};
+
 // Minimum l1 error approximation:
 //
 // Let A be a M x N matrix with full rank. Given y of R^M, the problem
@@ -67,7 +141,6 @@ inline bool TRobustRegressionL1PD(
   Eigen::Matrix<REAL, Eigen::Dynamic, 1>& xp,
   REAL pdtol, unsigned pdmaxiter)
 {
-  typedef Eigen::Matrix<REAL, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Matrix;
   typedef Eigen::Matrix<REAL, Eigen::Dynamic, 1> Vector;
   const unsigned M = (unsigned)y.size();
   const unsigned N = (unsigned)xp.size();
@@ -98,9 +171,10 @@ inline bool TRobustRegressionL1PD(
   REAL rdualNormSq = rdual.squaredNorm();
 
   Vector w2(M), sig1(M), sig2(M), sigx(M), dx(N), up(N), Atdv(N);
-  Vector Axp(M), Atvp(M);
-  Vector &Adx(sigx), &du(w2), &w1p(dx);
-  Matrix H11p(N,N);
+  Vector Axp(M), Atvp(M), w1p(N);
+  Vector &Adx(sigx), &du(w2);
+  MATRIX_TYPE H11p(N,N);
+  NormalEquationsSolver<MATRIX_TYPE> solver;
   Vector &dlamu1(tmpM3), &dlamu2(tmpM4);
   for (unsigned pditer=0; pditer<pdmaxiter; ++pditer) {
     // surrogate duality gap
@@ -131,7 +205,10 @@ inline bool TRobustRegressionL1PD(
     w1p = At*(tmpM4 - tmpM3 - (sig2.cwiseQuotient(sig1).cwiseProduct(w2)));
 
     // optimized solver as A is positive definite and symmetric
-    dx = H11p.ldlt().solve(w1p);
+    if (!solver.compute(H11p) || !solver.solve(w1p, dx)) {
+      ALICEVISION_LOG_WARNING("error: solving linear system failed");
+      return false;
+    }
 
     Adx = A*dx;
 
@@ -232,7 +309,6 @@ inline bool TIterativelyReweightedLeastSquares(
   Eigen::Matrix<REAL, Eigen::Dynamic, 1>& x,
   REAL sigma, REAL eps)
 {
-  typedef Eigen::Matrix<REAL, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Matrix;
   typedef Eigen::Matrix<REAL, Eigen::Dynamic, 1> Vector;
   const unsigned m = (unsigned)b.size();
   const unsigned n = (unsigned)x.size();
@@ -240,6 +316,7 @@ inline bool TIterativelyReweightedLeastSquares(
 
   // iterate optimization till the desired precision is reached
   Vector xp(n), e(m);
+  NormalEquationsSolver<MATRIX_TYPE> solver;
   const REAL sigmaSq(Square(sigma));
   unsigned iter = 0;
   REAL delta = std::numeric_limits<REAL>::max(), deltap;
@@ -255,13 +332,11 @@ inline bool TIterativelyReweightedLeastSquares(
     }
     // solve the linear system using l2 norm
     const MATRIX_TYPE AtF(A.transpose()*e.asDiagonal());
-    const Eigen::LDLT<Matrix> solver(AtF*A); // compute the Cholesky decomposition
-    if (solver.info() != Eigen::Success) {
+    if (!solver.compute(AtF*A)) { // compute the Cholesky decomposition
       ALICEVISION_LOG_WARNING("error: decomposing linear system failed");
       return false;
     }
-    x = solver.solve(AtF*b);
-    if (solver.info() != Eigen::Success) {
+    if (!solver.solve(AtF*b, x)) {
       ALICEVISION_LOG_WARNING("error: solving linear system failed");
       return false;
     }
@@ -434,6 +509,7 @@ unsigned int FilterRelativeRotations(
   assert(threshold >= 0);
   // compute errors for each relative rotation
   std::vector<float> errors(RelRs.size());
+  #pragma omp parallel for
   for(int r= 0; r<RelRs.size(); ++r) {
     const RelativeRotation& relR = RelRs[r];
     const Matrix3x3& Ri = Rs[relR.i];
@@ -486,6 +562,7 @@ REAL RelRotationAvgError(const RelativeRotations& RelRs, const Matrix3x3Arr& Rs,
   return boost::accumulators::mean(acc);
 #else
   std::vector<REAL> vec_err(RelRs.size(), REAL(0.0));
+  #pragma omp parallel for
   for(int i=0; i < RelRs.size(); ++i) {
     const RelativeRotation& relR = RelRs[i];
     vec_err[i] = aliceVision::FrobeniusNorm(relR.Rij  - (Rs[relR.j]*Rs[relR.i].transpose()));
@@ -605,7 +682,8 @@ inline void _FillErrorMatrix(
   const Matrix3x3Arr& Rs,
   Eigen::Matrix<REAL,Eigen::Dynamic,1>& b)
 {
-  for (size_t r = 0; r < RelRs.size(); ++r) {
+  #pragma omp parallel for
+  for (int r = 0; r < (int)RelRs.size(); ++r) {
     const RelativeRotation& relR = RelRs[r];
     const Matrix3x3& Ri = Rs[relR.i];
     const Matrix3x3& Rj = Rs[relR.j];
@@ -623,7 +701,9 @@ inline void _CorrectMatrix(
   const size_t nMainViewID,
   Matrix3x3Arr& Rs)
 {
-  for (size_t r = 0; r < Rs.size(); ++r) {
+  #pragma omp parallel for
+  for (int ri = 0; ri < (int)Rs.size(); ++ri) {
+    const size_t r = (size_t)ri;
     if (r == nMainViewID)
       continue;
     Matrix3x3& Ri = Rs[r];
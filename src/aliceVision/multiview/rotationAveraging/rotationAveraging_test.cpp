@@ -14,6 +14,7 @@
 #include <fstream>
 #include <vector>
 #include <iterator>
+#include <random>
 #include <utility>
 
 #define BOOST_TEST_MODULE rotationAveraging
@@ -318,6 +319,66 @@ BOOST_AUTO_TEST_CASE ( rotationAveraging_RefineRotationsAvgL1IRLS_CompleteGraph_
   }
 }
 
+// Test over a large sparse view graph (sparse solvers, spanning tree initialization)
+BOOST_AUTO_TEST_CASE ( rotationAveraging_RefineRotationsAvgL1IRLS_LargeSparseGraph)
+{
+  const std::size_t nbViews = 500;
+  const std::size_t nbNeighbors = 4;
+
+  std::mt19937 randomNumberGenerator(0);
+  std::uniform_real_distribution<double> angleDistribution(-M_PI, M_PI);
+  std::normal_distribution<double> noiseDistribution(0.0, degreeToRadian(0.2));
+
+  // ground truth rotations
+  std::vector<Mat3> groundTruthR(nbViews);
+  for(std::size_t i = 0; i < nbViews; ++i)
+    groundTruthR[i] = RotationAroundX(angleDistribution(randomNumberGenerator)) *
+                      RotationAroundY(angleDistribution(randomNumberGenerator)) *
+                      RotationAroundZ(angleDistribution(randomNumberGenerator));
+
+  // link each camera to the next ones with noisy relative rotations, and add some outliers
+  RelativeRotations vec_relativeRotEstimate;
+  for(std::size_t i = 0; i < nbViews; ++i)
+  {
+    for(std::size_t n = 1; n <= nbNeighbors; ++n)
+    {
+      const std::size_t j = (i + n) % nbViews;
+      const Mat3 noise = RotationAroundX(noiseDistribution(randomNumberGenerator)) *
+                         RotationAroundY(noiseDistribution(randomNumberGenerator));
+      Mat3 Rij = noise * groundTruthR[j] * groundTruthR[i].transpose();
+
+      if((i * nbNeighbors + n) % 50 == 0)
+        Rij = RotationAroundZ(degreeToRadian(90.0)) * Rij; // outlier
+
+      vec_relativeRotEstimate.push_back(RelativeRotation(i, j, Rij, 1));
+    }
+  }
+
+  //- Solve the global rotation estimation problem :
+  Matrix3x3Arr vec_globalR(nbViews);
+  std::size_t nMainViewID = 0;
+  std::vector<bool> vec_inliers;
+  BOOST_CHECK(GlobalRotationsRobust(vec_relativeRotEstimate, vec_globalR, nMainViewID, 0.0f, &vec_inliers));
+
+  // the main view is the identity: compare with the ground truth relative to the main view
+  double maxError = 0.0;
+  for(std::size_t i = 0; i < nbViews; ++i)
+  {
+    const Mat3 expectedR = groundTruthR[i] * groundTruthR[nMainViewID].transpose();
+    maxError = std::max(maxError, FrobeniusDistance(expectedR, vec_globalR[i]));
+  }
+  BOOST_CHECK_SMALL(maxError, 0.05);
+
+  // outliers are detected
+  for(std::size_t r = 0; r < vec_relativeRotEstimate.size(); ++r)
+  {
+    const RelativeRotation& relR = vec_relativeRotEstimate[r];
+    const std::size_t n = (relR.j + nbViews - relR.i) % nbViews;
+    if((relR.i * nbNeighbors + n) % 50 == 0)
+      BOOST_CHECK(!vec_inliers[r]);
+  }
+}
+
 /*
 template<typename TYPE, int N>
 inline REAL ComputePSNR(const Eigen::Matrix<REAL, N,1>& x0, const Eigen::Matrix<REAL, N,1>& x)
@@ -9,6 +9,9 @@
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/imageAlgo.hpp>
 
+#include <algorithm>
+#include <vector>
+
 
 namespace aliceVision{
 
@@ -16,14 +19,40 @@ namespace aliceVision{
 void Image::imageDiff(const Image& inImgDownscaled, Image& outImg, unsigned int downscale) const
 {
     outImg.resize(_width, _height);
-    for(int i = 0; i < _width*_height; ++i)
-    {
-        Point2d pix(i%_width, static_cast<int>(i/_width));
-        Point2d pixd = pix/downscale;
 
-        outImg._data[i] = _data[i] - inImgDownscaled.getInterpolateColor(pixd);
+    // same bilinear interpolation as getInterpolateColor,
+    // the interpolation coordinates are computed once per column and once per row
+    const int inWidth = inImgDownscaled._width;
+    std::vector<int> xps(_width);
+    std::vector<float> uis(_width);
+    for(int x = 0; x < _width; ++x)
+    {
+        const double xd = static_cast<double>(x) / downscale;
+        xps[x] = std::min(static_cast<int>(xd), inWidth - 2);
+        uis[x] = xd - static_cast<float>(xps[x]);
     }
 
+    #pragma omp parallel for
+    for(int y = 0; y < _height; ++y)
+    {
+        const double yd = static_cast<double>(y) / downscale;
+        const int yp = std::min(static_cast<int>(yd), inImgDownscaled._height - 2);
+        const float vi = yd - static_cast<float>(yp);
+
+        const Color* upRow = &inImgDownscaled._data[yp * inWidth];
+        const Color* downRow = upRow + inWidth;
+        const Color* inRow = &_data[y * _width];
+        Color* outRow = &outImg._data[y * _width];
+
+        for(int x = 0; x < _width; ++x)
+        {
+            const int xp = xps[x];
+            const float ui = uis[x];
+            const Color u = upRow[xp] + (upRow[xp + 1] - upRow[xp]) * ui;
+            const Color d = downRow[xp] + (downRow[xp + 1] - downRow[xp]) * ui;
+            outRow[x] = inRow[x] - (u + (d - u) * vi);
+        }
+    }
 }
 
 void Image::laplacianPyramid(std::vector<Image>& out_pyramidL, int nbBand, unsigned int downscale) const
@@ -439,5 +439,194 @@ void writeImage(const std::string &path, Image &image, EImageQuality imageQualit
     writeImage(path, oiio::TypeDesc::FLOAT, image.width(), image.height(), 3, image.data(), imageQuality, colorspace, metadata);
 }
 
+/// tile size of the maps written with all their resolution levels
+static const int mapTileSize = 64;
+
+int getMapLevelSize(int size, int level)
+{
+    return std::max(1, size >> level);
+}
+
+/**
+ * @brief point subsampling of a map level to the next one
+ */
+template<typename T>
+void subsampleMapLevel(int width, int height, const std::vector<T>& buffer, int& levelWidth, int& levelHeight, std::vector<T>& levelBuffer)
+{
+    levelWidth = getMapLevelSize(width, 1);
+    levelHeight = getMapLevelSize(height, 1);
+    levelBuffer.resize(levelWidth * levelHeight);
+
+    for(int y = 0; y < levelHeight; ++y)
+        for(int x = 0; x < levelWidth; ++x)
+            levelBuffer[y * levelWidth + x] = buffer[(2 * y) * width + (2 * x)];
+}
+
+template<typename T>
+void writeMap(const std::string& path,
+              oiio::TypeDesc typeDesc,
+              int width,
+              int height,
+              const std::vector<T>& buffer,
+              EImageQuality imageQuality,
+              const oiio::ParamValueList& metadata)
+{
+    const fs::path bPath = fs::path(path);
+    const std::string extension = bPath.extension().string();
+    const std::string tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + extension;
+
+    std::unique_ptr<oiio::ImageOutput> out(oiio::ImageOutput::create(tmpPath));
+
+    if(!out)
+        throw std::runtime_error("Can't write output image file '" + path + "'.");
+
+    if(!out->supports("tiles") || !out->supports("mipmap"))
+    {
+        // the file format can't store the resolution levels, write the full resolution only
+        OutputFileColorSpace colorspace(EImageColorSpace::NO_CONVERSION);
+        writeImage(path, typeDesc, width, height, 1, buffer, imageQuality, colorspace, metadata);
+        return;
+    }
+
+    ALICEVISION_LOG_DEBUG("[IO] Write Map: " << path << std::endl
+                       << "\t- width: " << width << std::endl
+                       << "\t- height: " << height);
+
+    const bool useHalf = (imageQuality == EImageQuality::OPTIMIZED && typeDesc == oiio::TypeDesc::FLOAT);
+
+    oiio::ImageSpec imageSpec(width, height, 1, useHalf ? oiio::TypeDesc::HALF : typeDesc);
+    imageSpec.extra_attribs = metadata; // add custom metadata
+
+    imageSpec.tile_width = mapTileSize;
+    imageSpec.tile_height = mapTileSize;
+    imageSpec.attribute("oiio:ColorSpace", EImageColorSpace_enumToString(EImageColorSpace::LINEAR));
+    imageSpec.attribute("compression", "zip");                   // lossless, with a predictor for floating point values
+    imageSpec.attribute("textureformat", "Plain Texture");       // store the resolution levels
+    imageSpec.attribute("openexr:levelmode", 1);                 // MIPMAP_LEVELS
+    imageSpec.attribute("openexr:roundingmode", 0);              // ROUND_DOWN, see getMapLevelSize
+
+    if(!out->open(tmpPath, imageSpec) || !out->write_image(typeDesc, buffer.data()))
+        throw std::runtime_error("Can't write output image file '" + path + "': " + out->geterror());
+
+    int levelWidth = width;
+    int levelHeight = height;
+    std::vector<T> levelBuffer = buffer;
+    std::vector<T> nextLevelBuffer;
+
+    while(levelWidth > 1 || levelHeight > 1)
+    {
+        subsampleMapLevel(levelWidth, levelHeight, levelBuffer, levelWidth, levelHeight, nextLevelBuffer);
+        levelBuffer.swap(nextLevelBuffer);
+
+        oiio::ImageSpec levelSpec = imageSpec;
+        levelSpec.width = levelSpec.full_width = levelWidth;
+        levelSpec.height = levelSpec.full_height = levelHeight;
+
+        if(!out->open(tmpPath, levelSpec, oiio::ImageOutput::AppendMIPLevel) || !out->write_image(typeDesc, levelBuffer.data()))
+            throw std::runtime_error("Can't write output image file '" + path + "': " + out->geterror());
+    }
+
+    out->close();
+
+    // rename temporay filename
+    fs::rename(tmpPath, path);
+}
+
+void writeMap(const std::string& path, int width, int height, const std::vector<float>& buffer, EImageQuality imageQuality, const oiio::ParamValueList& metadata)
+{
+    writeMap(path, oiio::TypeDesc::FLOAT, width, height, buffer, imageQuality, metadata);
+}
+
+/**
+ * @brief read a region of a map level
+ * @param[in] wholeLevel read the whole level, the region is ignored and set to the level size
+ */
+template<typename T>
+void readMap(const std::string& path,
+             oiio::TypeDesc typeDesc,
+             int level,
+             bool wholeLevel,
+             int& x,
+             int& y,
+             int& width,
+             int& height,
+             std::vector<T>& buffer)
+{
+    ALICEVISION_LOG_DEBUG("[IO] Read Map: " << path << " (level " << level << ")");
+
+    std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path));
+
+    if(!in)
+        throw std::runtime_error("Can't find/open image file '" + path + "'.");
+
+    if(in->spec().nchannels != 1)
+        throw std::runtime_error("Map file '" + path + "' should have a single channel.");
+
+    const int fullWidth = in->spec().width;
+    const int fullHeight = in->spec().height;
+    const bool isLevelStored = (in->spec().tile_width > 0) && in->seek_subimage(0, level);
+    const int levelWidth = isLevelStored ? in->spec().width : getMapLevelSize(fullWidth, level);
+    const int levelHeight = isLevelStored ? in->spec().height : getMapLevelSize(fullHeight, level);
+
+    if(wholeLevel)
+    {
+        x = 0;
+        y = 0;
+        width = levelWidth;
+        height = levelHeight;
+    }
+    else if(x < 0 || y < 0 || width <= 0 || height <= 0 || x + width > levelWidth || y + height > levelHeight)
+    {
+        throw std::runtime_error("Region out of the level " + std::to_string(level) + " of map file '" + path + "'.");
+    }
+
+    buffer.resize(width * height);
+
+    if(isLevelStored)
+    {
+        // decode the tiles overlapping the region only
+        const int tileWidth = in->spec().tile_width;
+        const int tileHeight = in->spec().tile_height;
+        const int xBegin = (x / tileWidth) * tileWidth;
+        const int yBegin = (y / tileHeight) * tileHeight;
+        const int xEnd = std::min(levelWidth, ((x + width + tileWidth - 1) / tileWidth) * tileWidth);
+        const int yEnd = std::min(levelHeight, ((y + height + tileHeight - 1) / tileHeight) * tileHeight);
+        const int tilesWidth = xEnd - xBegin;
+
+        std::vector<T> tilesBuffer(tilesWidth * (yEnd - yBegin));
+
+        if(!in->read_tiles(xBegin, xEnd, yBegin, yEnd, 0, 1, 0, 1, typeDesc, tilesBuffer.data()))
+            throw std::runtime_error("Can't read tiles of map file '" + path + "': " + in->geterror());
+
+        for(int j = 0; j < height; ++j)
+            std::copy_n(tilesBuffer.begin() + (y + j - yBegin) * tilesWidth + (x - xBegin), width, buffer.begin() + j * width);
+    }
+    else
+    {
+        // map without stored levels (scanlines or written by a previous version), read the full resolution and subsample
+        std::vector<T> fullBuffer(fullWidth * fullHeight);
+
+        if(!in->seek_subimage(0, 0) || !in->read_image(typeDesc, fullBuffer.data()))
+            throw std::runtime_error("Can't read map file '" + path + "': " + in->geterror());
+
+        for(int j = 0; j < height; ++j)
+            for(int i = 0; i < width; ++i)
+                buffer[j * width + i] = fullBuffer[((y + j) << level) * fullWidth + ((x + i) << level)];
+    }
+
+    in->close();
+}
+
+void readMapLevel(const std::string& path, int level, int& width, int& height, std::vector<float>& buffer)
+{
+    int x, y;
+    readMap(path, oiio::TypeDesc::FLOAT, level, true, x, y, width, height, buffer);
+}
+
+void readMapRegion(const std::string& path, int level, int x, int y, int width, int height, std::vector<float>& buffer)
+{
+    readMap(path, oiio::TypeDesc::FLOAT, level, false, x, y, width, height, buffer);
+}
+
 } // namespace imageIO
 } // namespace aliceVision
@@ -209,5 +209,52 @@ void writeImage(const std::string& path, int width, int height, const std::vecto
 void writeImage(const std::string& path, int width, int height, const std::vector<Color>& buffer, EImageQuality imageQuality, OutputFileColorSpace& colorspace, const oiio::ParamValueList& metadata = oiio::ParamValueList());
 void writeImage(const std::string& path, Image& image, EImageQuality imageQuality, OutputFileColorSpace& colorspace, const oiio::ParamValueList& metadata = oiio::ParamValueList());
 
+/**
+ * @brief get the size of a resolution level of a map
+ * @param[in] size The full resolution size (width or height)
+ * @param[in] level The resolution level (0 is the full resolution)
+ * @return the level size
+ */
+int getMapLevelSize(int size, int level);
+
+/**
+ * @brief write a single channel map (depth map, similarity map, ...) with all its resolution levels
+ * @note If the file format supports it (EXR), the map is stored in losslessly compressed tiles
+ *       with all the resolution levels down to 1x1, so readers only decode the tiles and levels they need.
+ *       Level l is a point subsampling of the full resolution: pixel (x, y) is the pixel (x * 2^l, y * 2^l)
+ *       of the full resolution, so invalid values are never mixed with valid ones.
+ * @param[in] path The given path to the map
+ * @param[in] width The input map width
+ * @param[in] height The input map height
+ * @param[in] buffer The input map buffer
+ * @param[in] imageQuality The map quality (OPTIMIZED stores half floats)
+ * @param[in] metadata The map metadata
+ */
+void writeMap(const std::string& path, int width, int height, const std::vector<float>& buffer, EImageQuality imageQuality, const oiio::ParamValueList& metadata = oiio::ParamValueList());
+
+/**
+ * @brief read a resolution level of a single channel map
+ * @note maps without stored levels are read at full resolution and subsampled
+ * @param[in] path The given path to the map
+ * @param[in] level The resolution level (0 is the full resolution)
+ * @param[out] width The level width
+ * @param[out] height The level height
+ * @param[out] buffer The output level buffer
+ */
+void readMapLevel(const std::string& path, int level, int& width, int& height, std::vector<float>& buffer);
+
+/**
+ * @brief read a region of a resolution level of a single channel map, only the tiles overlapping the region are decoded
+ * @note maps without stored levels are read at full resolution and subsampled
+ * @param[in] path The given path to the map
+ * @param[in] level The resolution level (0 is the full resolution)
+ * @param[in] x The region left column in the level
+ * @param[in] y The region top row in the level
+ * @param[in] width The region width
+ * @param[in] height The region height
+ * @param[out] buffer The output region buffer
+ */
+void readMapRegion(const std::string& path, int level, int x, int y, int width, int height, std::vector<float>& buffer);
+
 } // namespace imageIO
 } // namespace aliceVision
@@ -0,0 +1,301 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CovisibilityGraph.hpp"
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <unordered_map>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const char covisibilityGraphMagic[4] = {'A', 'V', 'C', 'G'};
+const std::int32_t covisibilityGraphVersion = 2;
+
+inline std::uint64_t hashCombine(std::uint64_t seed, std::uint64_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+/**
+ * @brief Hash of the landmarks observations (landmark id, view ids and feature ids),
+ *        independent of the landmarks iteration order
+ */
+std::uint64_t getObservationsHash(const sfmData::Landmarks& landmarks)
+{
+    std::uint64_t hash = 0;
+    for(const auto& landmarkPair : landmarks)
+    {
+        std::uint64_t landmarkHash = hashCombine(0, landmarkPair.first);
+        for(const auto& observationPair : landmarkPair.second.observations)
+        {
+            landmarkHash = hashCombine(landmarkHash, observationPair.first);
+            landmarkHash = hashCombine(landmarkHash, observationPair.second.id_feat);
+        }
+        hash += landmarkHash;
+    }
+    return hash;
+}
+
+} // namespace
+
+void CovisibilityGraph::build(const MultiViewParams& mp)
+{
+    system::Timer timer;
+
+    const sfmData::SfMData& sfmData = mp.getInputSfMData();
+    const int nbCameras = mp.getNbCameras();
+
+    _minViewAngle = mp.getMinViewAngle();
+    _maxViewAngle = mp.getMaxViewAngle();
+    _neighbors.assign(nbCameras, std::vector<CovisibilityEdge>());
+    _viewIds.resize(nbCameras);
+    _nbLandmarks = sfmData.getLandmarks().size();
+    _observationsHash = getObservationsHash(sfmData.getLandmarks());
+
+    std::unordered_map<IndexT, int> camIndexPerViewId;
+    for(int camIndex = 0; camIndex < nbCameras; ++camIndex)
+    {
+        _viewIds[camIndex] = mp.getViewId(camIndex);
+        camIndexPerViewId[mp.getViewId(camIndex)] = camIndex;
+    }
+
+    // flatten the observations of the cameras, grouped per landmark
+    std::vector<std::size_t> landmarksOffset(1, 0);
+    std::vector<int> obsCamIndex;
+    std::vector<int> obsLandmarkIndex;
+    std::vector<const sfmData::Observation*> obsPtr;
+    std::vector<std::vector<std::size_t>> camObservations(nbCameras);
+
+    for(const auto& landmarkPair : sfmData.getLandmarks())
+    {
+        const int landmarkIndex = static_cast<int>(landmarksOffset.size()) - 1;
+
+        for(const auto& observationPair : landmarkPair.second.observations)
+        {
+            const auto camIt = camIndexPerViewId.find(observationPair.first);
+            if(camIt == camIndexPerViewId.end())
+                continue;
+
+            camObservations[camIt->second].push_back(obsCamIndex.size());
+            obsCamIndex.push_back(camIt->second);
+            obsLandmarkIndex.push_back(landmarkIndex);
+            obsPtr.push_back(&observationPair.second);
+        }
+        landmarksOffset.push_back(obsCamIndex.size());
+    }
+
+    // world bearing vector of each observation
+    std::vector<geometry::Pose3> poses(nbCameras);
+    std::vector<const camera::IntrinsicBase*> intrinsics(nbCameras, nullptr);
+    for(int camIndex = 0; camIndex < nbCameras; ++camIndex)
+    {
+        const sfmData::View& view = *(sfmData.getViews().at(mp.getViewId(camIndex)));
+        poses[camIndex] = sfmData.getPose(view).getTransform();
+        intrinsics[camIndex] = sfmData.getIntrinsicPtr(view.getIntrinsicId());
+    }
+
+    std::vector<Vec3> obsRays(obsCamIndex.size());
+
+    #pragma omp parallel for
+    for(int i = 0; i < static_cast<int>(obsRays.size()); ++i)
+    {
+        const int camIndex = obsCamIndex[i];
+        obsRays[i] = (poses[camIndex].rotation().transpose() * intrinsics[camIndex]->operator()(obsPtr[i]->x)).normalized();
+    }
+
+    // covisibility statistics per camera
+    #pragma omp parallel for schedule(dynamic)
+    for(int rc = 0; rc < nbCameras; ++rc)
+    {
+        std::vector<int> nbLandmarks(nbCameras, 0);
+        std::vector<int> nbValidLandmarks(nbCameras, 0);
+        std::vector<double> sumAngles(nbCameras, 0.0);
+        std::vector<int> covisibleCams;
+
+        for(const std::size_t rcObs : camObservations[rc])
+        {
+            const int landmarkIndex = obsLandmarkIndex[rcObs];
+
+            for(std::size_t tcObs = landmarksOffset[landmarkIndex]; tcObs < landmarksOffset[landmarkIndex + 1]; ++tcObs)
+            {
+                const int tc = obsCamIndex[tcObs];
+                if(tc == rc)
+                    continue;
+
+                const double angle = camera::AngleBetweenRays(obsRays[rcObs], obsRays[tcObs]);
+
+                if(nbLandmarks[tc] == 0)
+                    covisibleCams.push_back(tc);
+
+                ++nbLandmarks[tc];
+                sumAngles[tc] += angle;
+
+                if(angle >= _minViewAngle && angle <= _maxViewAngle)
+                    ++nbValidLandmarks[tc];
+            }
+        }
+
+        std::vector<CovisibilityEdge>& edges = _neighbors[rc];
+        edges.reserve(covisibleCams.size());
+
+        for(const int tc : covisibleCams)
+        {
+            CovisibilityEdge edge;
+            edge.camIndex = tc;
+            edge.nbLandmarks = nbLandmarks[tc];
+            edge.nbValidLandmarks = nbValidLandmarks[tc];
+            edge.meanAngle = static_cast<float>(sumAngles[tc] / nbLandmarks[tc]);
+            edge.baseline = static_cast<float>(dist(mp.CArr[rc], mp.CArr[tc]));
+            edges.push_back(edge);
+        }
+
+        std::sort(edges.begin(), edges.end(), [](const CovisibilityEdge& a, const CovisibilityEdge& b) {
+            return (a.nbValidLandmarks != b.nbValidLandmarks) ? (a.nbValidLandmarks > b.nbValidLandmarks) : (a.camIndex < b.camIndex);
+        });
+    }
+
+    std::size_t nbEdges = 0;
+    for(const auto& edges : _neighbors)
+        nbEdges += edges.size();
+
+    ALICEVISION_LOG_INFO("Covisibility graph built in " << timer.elapsed() << " s:" << std::endl
+                         << "\t- # cameras: " << nbCameras << std::endl
+                         << "\t- # observations: " << obsCamIndex.size() << std::endl
+                         << "\t- # edges: " << nbEdges);
+}
+
+bool CovisibilityGraph::matchesScene(const MultiViewParams& mp) const
+{
+    if(static_cast<int>(_viewIds.size()) != mp.getNbCameras())
+        return false;
+
+    for(int camIndex = 0; camIndex < mp.getNbCameras(); ++camIndex)
+    {
+        if(_viewIds[camIndex] != mp.getViewId(camIndex))
+            return false;
+    }
+
+    const sfmData::Landmarks& landmarks = mp.getInputSfMData().getLandmarks();
+    return (_nbLandmarks == landmarks.size()) && (_observationsHash == getObservationsHash(landmarks));
+}
+
+bool CovisibilityGraph::save(const std::string& filename) const
+{
+    const fs::path path(filename);
+    const std::string tmpPath = (path.parent_path() / path.stem()).string() + "." + fs::unique_path().string() + path.extension().string();
+
+    {
+        std::ofstream stream(tmpPath, std::ios::binary);
+        if(!stream.is_open())
+        {
+            ALICEVISION_LOG_WARNING("Cannot write the covisibility graph file: " << filename);
+            return false;
+        }
+
+        const std::int32_t nbCameras = getNbCameras();
+
+        stream.write(covisibilityGraphMagic, sizeof(covisibilityGraphMagic));
+        stream.write(reinterpret_cast<const char*>(&covisibilityGraphVersion), sizeof(covisibilityGraphVersion));
+        stream.write(reinterpret_cast<const char*>(&nbCameras), sizeof(nbCameras));
+        stream.write(reinterpret_cast<const char*>(&_minViewAngle), sizeof(_minViewAngle));
+        stream.write(reinterpret_cast<const char*>(&_maxViewAngle), sizeof(_maxViewAngle));
+        stream.write(reinterpret_cast<const char*>(_viewIds.data()), _viewIds.size() * sizeof(IndexT));
+        stream.write(reinterpret_cast<const char*>(&_nbLandmarks), sizeof(_nbLandmarks));
+        stream.write(reinterpret_cast<const char*>(&_observationsHash), sizeof(_observationsHash));
+
+        for(const auto& edges : _neighbors)
+        {
+            const std::int32_t nbEdges = edges.size();
+            stream.write(reinterpret_cast<const char*>(&nbEdges), sizeof(nbEdges));
+            stream.write(reinterpret_cast<const char*>(edges.data()), nbEdges * sizeof(CovisibilityEdge));
+        }
+
+        if(!stream.good())
+        {
+            ALICEVISION_LOG_WARNING("Cannot write the covisibility graph file: " << filename);
+            stream.close();
+            fs::remove(tmpPath);
+            return false;
+        }
+    }
+
+    // rename the temporary file, the graph can be shared between parallel processes
+    fs::rename(tmpPath, filename);
+    return true;
+}
+
+bool CovisibilityGraph::load(const std::string& filename)
+{
+    std::ifstream stream(filename, std::ios::binary);
+    if(!stream.is_open())
+        return false;
+
+    char magic[4];
+    std::int32_t version = 0;
+    std::int32_t nbCameras = 0;
+
+    stream.read(magic, sizeof(magic));
+    stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+
+    if(!stream.good() || !std::equal(magic, magic + 4, covisibilityGraphMagic) || version != covisibilityGraphVersion)
+    {
+        ALICEVISION_LOG_WARNING("Invalid covisibility graph file: " << filename);
+        return false;
+    }
+
+    stream.read(reinterpret_cast<char*>(&nbCameras), sizeof(nbCameras));
+    stream.read(reinterpret_cast<char*>(&_minViewAngle), sizeof(_minViewAngle));
+    stream.read(reinterpret_cast<char*>(&_maxViewAngle), sizeof(_maxViewAngle));
+
+    if(!stream.good() || nbCameras < 0)
+    {
+        ALICEVISION_LOG_WARNING("Invalid covisibility graph file: " << filename);
+        return false;
+    }
+
+    _viewIds.resize(nbCameras);
+    stream.read(reinterpret_cast<char*>(_viewIds.data()), _viewIds.size() * sizeof(IndexT));
+    stream.read(reinterpret_cast<char*>(&_nbLandmarks), sizeof(_nbLandmarks));
+    stream.read(reinterpret_cast<char*>(&_observationsHash), sizeof(_observationsHash));
+
+    _neighbors.assign(nbCameras, std::vector<CovisibilityEdge>());
+
+    for(auto& edges : _neighbors)
+    {
+        std::int32_t nbEdges = 0;
+        stream.read(reinterpret_cast<char*>(&nbEdges), sizeof(nbEdges));
+        if(!stream.good() || nbEdges < 0 || nbEdges > nbCameras)
+            break;
+        edges.resize(nbEdges);
+        stream.read(reinterpret_cast<char*>(edges.data()), nbEdges * sizeof(CovisibilityEdge));
+    }
+
+    if(!stream.good())
+    {
+        ALICEVISION_LOG_WARNING("Invalid covisibility graph file: " << filename);
+        _neighbors.clear();
+        _viewIds.clear();
+        return false;
+    }
+    return true;
+}
+
+} // namespace mvsUtils
+} // namespace aliceVision
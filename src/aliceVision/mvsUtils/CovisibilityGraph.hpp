@@ -0,0 +1,119 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+class MultiViewParams;
+
+/**
+ * @brief Covisibility statistics of a pair of cameras
+ */
+struct CovisibilityEdge
+{
+    /// other camera index
+    int camIndex = -1;
+    /// number of landmarks observed by both cameras
+    int nbLandmarks = 0;
+    /// number of shared landmarks with a view angle in [minViewAngle, maxViewAngle]
+    int nbValidLandmarks = 0;
+    /// mean view angle of the shared landmarks (in degrees)
+    float meanAngle = 0.0f;
+    /// distance between the camera centers
+    float baseline = 0.0f;
+};
+
+/**
+ * @brief Camera covisibility graph computed from the SfM landmarks.
+ *        The neighbors of each camera are sorted by decreasing number of valid shared landmarks,
+ *        so the nearest cameras queries only read the first edges.
+ */
+class CovisibilityGraph
+{
+public:
+
+    /**
+     * @brief Build the graph from the landmarks of the MultiViewParams input SfMData
+     * @param[in] mp the multi-view parameters (cameras and view angle range)
+     */
+    void build(const MultiViewParams& mp);
+
+    /**
+     * @brief Get the covisible cameras of a camera
+     * @param[in] camIndex the camera index
+     * @return the edges sorted by decreasing number of valid shared landmarks
+     */
+    inline const std::vector<CovisibilityEdge>& getNeighbors(int camIndex) const
+    {
+        return _neighbors.at(camIndex);
+    }
+
+    inline int getNbCameras() const
+    {
+        return static_cast<int>(_neighbors.size());
+    }
+
+    inline float getMinViewAngle() const
+    {
+        return _minViewAngle;
+    }
+
+    inline float getMaxViewAngle() const
+    {
+        return _maxViewAngle;
+    }
+
+    /**
+     * @brief Check if the graph has been computed for the given cameras and view angle range
+     */
+    inline bool matches(int nbCameras, float minViewAngle, float maxViewAngle) const
+    {
+        return (getNbCameras() == nbCameras) && (_minViewAngle == minViewAngle) && (_maxViewAngle == maxViewAngle);
+    }
+
+    /**
+     * @brief Check if the graph has been computed from the cameras and the landmarks observations of the given MultiViewParams
+     * @details The view ids are compared in the camera order, the observations are compared with their number of landmarks
+     *          and a hash of the landmarks observations.
+     */
+    bool matchesScene(const MultiViewParams& mp) const;
+
+    /**
+     * @brief Save the graph in a binary file
+     * @param[in] filename the output file path
+     * @return true if the graph is saved
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * @brief Load a graph from a binary file
+     * @param[in] filename the input file path
+     * @return true if the graph is loaded
+     */
+    bool load(const std::string& filename);
+
+private:
+    std::vector<std::vector<CovisibilityEdge>> _neighbors;
+    float _minViewAngle = 0.0f;
+    float _maxViewAngle = 0.0f;
+    /// view id of each camera
+    std::vector<IndexT> _viewIds;
+    /// number of landmarks of the input SfMData
+    std::uint64_t _nbLandmarks = 0;
+    /// hash of the landmarks observations of the input SfMData
+    std::uint64_t _observationsHash = 0;
+};
+
+} // namespace mvsUtils
+} // namespace aliceVision
@@ -0,0 +1,159 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "FrustaBVH.hpp"
+#include <aliceVision/mvsUtils/common.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+namespace {
+
+/// maximum number of cameras in a leaf
+constexpr int maxLeafSize = 4;
+
+void getBoundingBox(const Point3d* points, int nbPoints, Point3d& bboxMin, Point3d& bboxMax)
+{
+    const double inf = std::numeric_limits<double>::max();
+    bboxMin = Point3d(inf, inf, inf);
+    bboxMax = Point3d(-inf, -inf, -inf);
+
+    for(int i = 0; i < nbPoints; ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            bboxMin.m[k] = std::min(bboxMin.m[k], points[i].m[k]);
+            bboxMax.m[k] = std::max(bboxMax.m[k], points[i].m[k]);
+        }
+    }
+}
+
+inline bool overlaps(const Point3d& aMin, const Point3d& aMax, const Point3d& bMin, const Point3d& bMax)
+{
+    return (aMin.x <= bMax.x) && (bMin.x <= aMax.x) &&
+           (aMin.y <= bMax.y) && (bMin.y <= aMax.y) &&
+           (aMin.z <= bMax.z) && (bMin.z <= aMax.z);
+}
+
+} // namespace
+
+void FrustaBVH::build(const std::vector<Hexahedron>& frusta, const std::vector<bool>& validFrusta)
+{
+    _frusta = frusta;
+    _nodes.clear();
+    _leafCams.clear();
+    _alwaysVisibleCams.clear();
+
+    std::vector<Point3d> bboxesMin(frusta.size());
+    std::vector<Point3d> bboxesMax(frusta.size());
+
+    for(int cam = 0; cam < static_cast<int>(frusta.size()); ++cam)
+    {
+        if(!validFrusta.at(cam))
+        {
+            _alwaysVisibleCams.push_back(cam);
+            continue;
+        }
+        getBoundingBox(frusta[cam].data(), 8, bboxesMin[cam], bboxesMax[cam]);
+        _leafCams.push_back(cam);
+    }
+
+    if(!_leafCams.empty())
+    {
+        _nodes.reserve(2 * _leafCams.size());
+        buildNode(0, static_cast<int>(_leafCams.size()), bboxesMin, bboxesMax);
+    }
+}
+
+int FrustaBVH::buildNode(int begin, int end, const std::vector<Point3d>& bboxesMin, const std::vector<Point3d>& bboxesMax)
+{
+    const int nodeIndex = static_cast<int>(_nodes.size());
+    _nodes.emplace_back();
+
+    Point3d bboxMin;
+    Point3d bboxMax;
+    {
+        std::vector<Point3d> corners;
+        corners.reserve(2 * (end - begin));
+        for(int i = begin; i < end; ++i)
+        {
+            corners.push_back(bboxesMin[_leafCams[i]]);
+            corners.push_back(bboxesMax[_leafCams[i]]);
+        }
+        getBoundingBox(corners.data(), static_cast<int>(corners.size()), bboxMin, bboxMax);
+    }
+
+    _nodes[nodeIndex].bboxMin = bboxMin;
+    _nodes[nodeIndex].bboxMax = bboxMax;
+
+    if(end - begin <= maxLeafSize)
+    {
+        _nodes[nodeIndex].begin = begin;
+        _nodes[nodeIndex].end = end;
+        return nodeIndex;
+    }
+
+    // median split of the bounding box centers along the longest axis
+    const Point3d extent = bboxMax - bboxMin;
+    const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+    const int middle = begin + (end - begin) / 2;
+
+    std::nth_element(_leafCams.begin() + begin, _leafCams.begin() + middle, _leafCams.begin() + end, [&](int a, int b) {
+        return (bboxesMin[a].m[axis] + bboxesMax[a].m[axis]) < (bboxesMin[b].m[axis] + bboxesMax[b].m[axis]);
+    });
+
+    const int left = buildNode(begin, middle, bboxesMin, bboxesMax);
+    const int right = buildNode(middle, end, bboxesMin, bboxesMax);
+
+    // the nodes vector may have been reallocated
+    _nodes[nodeIndex].left = left;
+    _nodes[nodeIndex].right = right;
+    return nodeIndex;
+}
+
+void FrustaBVH::findCamsWhichIntersectsHexahedron(const Point3d hexah[8], std::vector<int>& cams) const
+{
+    cams = _alwaysVisibleCams;
+
+    if(_nodes.empty())
+        return;
+
+    Point3d hexahMin;
+    Point3d hexahMax;
+    getBoundingBox(hexah, 8, hexahMin, hexahMax);
+
+    std::vector<int> stack(1, 0);
+    while(!stack.empty())
+    {
+        const Node& node = _nodes[stack.back()];
+        stack.pop_back();
+
+        if(!overlaps(node.bboxMin, node.bboxMax, hexahMin, hexahMax))
+            continue;
+
+        if(node.left != -1)
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+            continue;
+        }
+
+        for(int i = node.begin; i < node.end; ++i)
+        {
+            const int cam = _leafCams[i];
+            if(intersectsHexahedronHexahedron(_frusta[cam].data(), hexah))
+                cams.push_back(cam);
+        }
+    }
+
+    std::sort(cams.begin(), cams.end());
+}
+
+} // namespace mvsUtils
+} // namespace aliceVision
@@ -0,0 +1,68 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+
+#include <array>
+#include <vector>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+/**
+ * @brief Bounding volume hierarchy over the camera frusta (hexahedrons between the min and max depths).
+ *        Hexahedron queries only run the exact intersection test on the cameras whose
+ *        frustum bounding box overlaps the bounding box of the query.
+ */
+class FrustaBVH
+{
+public:
+    using Hexahedron = std::array<Point3d, 8>;
+
+    /**
+     * @brief Build the hierarchy
+     * @param[in] frusta the frustum of each camera (0-3 frontal face, 4-7 back face)
+     * @param[in] validFrusta false for the cameras without depth range, they are always returned by the queries
+     */
+    void build(const std::vector<Hexahedron>& frusta, const std::vector<bool>& validFrusta);
+
+    /**
+     * @brief Find the cameras whose frustum intersects an hexahedron
+     * @param[in] hexah 0-3 frontal face, 4-7 back face
+     * @param[out] cams the camera indexes, in increasing order
+     */
+    void findCamsWhichIntersectsHexahedron(const Point3d hexah[8], std::vector<int>& cams) const;
+
+    inline int getNbCameras() const
+    {
+        return static_cast<int>(_frusta.size());
+    }
+
+private:
+    struct Node
+    {
+        Point3d bboxMin;
+        Point3d bboxMax;
+        /// children node indexes, -1 for a leaf
+        int left = -1;
+        int right = -1;
+        /// range of camera indexes in _leafCams for a leaf
+        int begin = 0;
+        int end = 0;
+    };
+
+    int buildNode(int begin, int end, const std::vector<Point3d>& bboxesMin, const std::vector<Point3d>& bboxesMax);
+
+    std::vector<Hexahedron> _frusta;
+    std::vector<Node> _nodes;
+    std::vector<int> _leafCams;
+    std::vector<int> _alwaysVisibleCams;
+};
+
+} // namespace mvsUtils
+} // namespace aliceVision
@@ -7,7 +7,10 @@
 #include "ImagesCache.hpp"
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
+#include <aliceVision/system/Timer.hpp>
 
+#include <algorithm>
 #include <future>
 
 namespace aliceVision {
@@ -47,20 +50,47 @@ ImagesCache::ImagesCache(const MultiViewParams* mp, imageIO::EImageColorSpace co
     initIC( imagesNames );
 }
 
+ImagesCache::~ImagesCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(_prefetchMutex);
+        _stopIOThreads = true;
+        _prefetchQueue.clear();
+    }
+    _prefetchCondition.notify_all();
+
+    for(std::thread& ioThread : _ioThreads)
+        ioThread.join();
+
+    system::MemoryBudget::get().track("imagesCache", -static_cast<std::int64_t>(_memSize));
+}
+
 void ImagesCache::initIC( std::vector<std::string>& imagesNames )
 {
-    float oneimagemb = (sizeof(Color) * _mp->getMaxImageWidth() * _mp->getMaxImageHeight()) / 1024.f / 1024.f;
-    float maxmbCPU = (float)_mp->userParams.get<int>("images_cache.maxmbCPU", 5000);
-    int npreload = std::max((int)(maxmbCPU / oneimagemb), 5); // image cache has a minimum size of 5
-    npreload = std::min(_mp->ncams, npreload);
+    const std::size_t oneImageSize = sizeof(Color) * _mp->getMaxImageWidth() * _mp->getMaxImageHeight();
+    std::size_t maxMemSize = static_cast<std::size_t>(_mp->userParams.get<int>("images_cache.maxmbCPU", 5000)) * 1024 * 1024;
+
+    // with a process memory budget, the cache uses at most half of the available memory
+    const system::MemoryBudget& memoryBudget = system::MemoryBudget::get();
+    if(memoryBudget.hasLimit())
+    {
+        maxMemSize = std::min(maxMemSize, memoryBudget.getAvailableMemory() / 2);
+
+        if(maxMemSize < 5 * oneImageSize)
+            ALICEVISION_LOG_WARNING("Memory budget too small for the images cache, use the minimum cache size: 5 images (" << (5 * oneImageSize) / (1024 * 1024) << " MB).");
+    }
+    _nbIOThreads = std::max(1, _mp->userParams.get<int>("images_cache.nbIOThreads", 2));
 
     for(int rc = 0; rc < _mp->ncams; rc++)
     {
         _imagesNames.push_back(imagesNames[rc]);
     }
 
-    _camIdMapId.resize( _mp->ncams, -1 );
-    setCacheSize(npreload);
+    _imgs.resize(_mp->ncams);
+    _lruPositions.resize(_mp->ncams, _lruCamIds.end());
+
+    // image cache has a minimum size of 5 images
+    setMaxMemorySize(std::max(maxMemSize, 5 * oneImageSize));
 
     {
         // Cannot resize the vector<mutex> directly, as mutex class is not move-constructible.
@@ -69,59 +99,123 @@ void ImagesCache::initIC( std::vector<std::string>& imagesNames )
         std::vector<std::mutex> imagesMutexesTmp(_mp->ncams);
         _imagesMutexes.swap(imagesMutexesTmp);
     }
+}
+
+void ImagesCache::setCacheSize(int nbPreload)
+{
+    setMaxMemorySize(nbPreload * sizeof(Color) * _mp->getMaxImageWidth() * _mp->getMaxImageHeight());
+}
 
+void ImagesCache::setMaxMemorySize(std::size_t maxMemSize)
+{
+    std::lock_guard<std::mutex> lock(_cacheMutex);
+    _maxMemSize = maxMemSize;
 
+    // evict least recently used images until the new budget is respected
+    while(_memSize > _maxMemSize && !_lruCamIds.empty())
+    {
+        const int oldCamId = _lruCamIds.back();
+        const std::size_t oldImgSize = _imgs[oldCamId]->size() * sizeof(Color);
+        _memSize -= oldImgSize;
+        system::MemoryBudget::get().track("imagesCache", -static_cast<std::int64_t>(oldImgSize));
+        _imgs[oldCamId].reset();
+        _lruPositions[oldCamId] = _lruCamIds.end();
+        _lruCamIds.pop_back();
+        ++_stats.nbEvictions;
+    }
 }
 
-void ImagesCache::setCacheSize(int nbPreload)
+void ImagesCache::touch(int camId)
 {
-    _N_PRELOADED_IMAGES = nbPreload;
-    _imgs.resize(_N_PRELOADED_IMAGES);
-    _mapIdCamId.resize( _N_PRELOADED_IMAGES, -1 );
-    _mapIdClock.resize( _N_PRELOADED_IMAGES, clock() );
+    _lruCamIds.splice(_lruCamIds.begin(), _lruCamIds, _lruPositions[camId]);
 }
 
-void ImagesCache::refreshData(int camId)
+void ImagesCache::insert(int camId, const ImgSharedPtr& img)
+{
+    const std::size_t imgSize = img->size() * sizeof(Color);
+
+    // remove the least recently used images
+    // note: an evicted image stays valid for the consumers still using it
+    while(!_lruCamIds.empty() && _memSize + imgSize > _maxMemSize)
+    {
+        const int oldCamId = _lruCamIds.back();
+        const std::size_t oldImgSize = _imgs[oldCamId]->size() * sizeof(Color);
+        _memSize -= oldImgSize;
+        system::MemoryBudget::get().track("imagesCache", -static_cast<std::int64_t>(oldImgSize));
+        _imgs[oldCamId].reset();
+        _lruPositions[oldCamId] = _lruCamIds.end();
+        _lruCamIds.pop_back();
+        ++_stats.nbEvictions;
+    }
+
+    _imgs[camId] = img;
+    _lruCamIds.push_front(camId);
+    _lruPositions[camId] = _lruCamIds.begin();
+    _memSize += imgSize;
+    system::MemoryBudget::get().track("imagesCache", static_cast<std::int64_t>(imgSize));
+}
+
+ImagesCache::ImgSharedPtr ImagesCache::getImg(int camId, bool isPrefetch)
 {
-    // printf("camId %i\n",camId);
-    // test if the image is in the memory
-    if(_camIdMapId[camId] == -1)
     {
-        // remove the oldest one
-        int mapId = _mapIdClock.minValId();
-        int oldCamId = _mapIdCamId[mapId];
-        if(oldCamId>=0)
-            _camIdMapId[oldCamId] = -1;
-            // TODO: oldCamId should be protected if already used
-
-        // replace with new new
-        _camIdMapId[camId] = mapId;
-        _mapIdCamId[mapId] = camId;
-        _mapIdClock[mapId] = clock();
-
-        // reload data from files
-        long t1 = clock();
-        if (_imgs[mapId] == nullptr)
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        if(_imgs[camId] != nullptr)
         {
-            const int maxWidth = _mp->getMaxImageWidth();
-            const int maxHeight = _mp->getMaxImageHeight();
-            _imgs[mapId] = std::make_shared<Image>(maxWidth, maxHeight);
+            if(!isPrefetch)
+            {
+                touch(camId);
+                ++_stats.nbHits;
+            }
+            ALICEVISION_LOG_DEBUG("Reuse " << _imagesNames.at(camId) << " from image cache. ");
+            return _imgs[camId];
         }
+    }
 
-        const std::string imagePath = _imagesNames.at(camId);
-        loadImage(imagePath, _mp, camId, *(_imgs[mapId]), _colorspace, _correctEV);
+    // only one thread decodes a given image, others wait for it
+    std::lock_guard<std::mutex> loadLock(_imagesMutexes[camId]);
 
-        ALICEVISION_LOG_DEBUG("Add " << imagePath << " to image cache. " << formatElapsedTime(t1));
-    }
-    else
     {
-      ALICEVISION_LOG_DEBUG("Reuse " << _imagesNames.at(camId) << " from image cache. ");
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        if(_imgs[camId] != nullptr)
+        {
+            // loaded by another thread (prefetch) in the meantime
+            if(!isPrefetch)
+            {
+                touch(camId);
+                ++_stats.nbHits;
+            }
+            return _imgs[camId];
+        }
     }
+
+    // reload data from files (without locking the cache)
+    const system::Timer timer;
+    const std::string imagePath = _imagesNames.at(camId);
+    ImgSharedPtr img = std::make_shared<Image>();
+    loadImage(imagePath, _mp, camId, *img, _colorspace, _correctEV);
+    const double decodeTimeMs = timer.elapsedMs();
+
+    ALICEVISION_LOG_DEBUG("Add " << imagePath << " to image cache" << (isPrefetch ? " (prefetch). " : ". ") << system::prettyTime(decodeTimeMs));
+
+    std::lock_guard<std::mutex> lock(_cacheMutex);
+    insert(camId, img);
+    _stats.decodeTimeMs += decodeTimeMs;
+    if(isPrefetch)
+        ++_stats.nbPrefetched;
+    else
+        ++_stats.nbMisses;
+
+    return img;
 }
+
+void ImagesCache::refreshData(int camId)
+{
+    getImg(camId, false);
+}
+
 void ImagesCache::refreshData_sync(int camId)
 {
-  std::lock_guard<std::mutex> lock(_imagesMutexes[camId]);
-  refreshData(camId);
+    getImg(camId, false);
 }
 
 std::future<void> ImagesCache::refreshData_async(int camId)
@@ -129,12 +223,94 @@ std::future<void> ImagesCache::refreshData_async(int camId)
     return std::async(&ImagesCache::refreshData_sync, this, camId);
 }
 
+void ImagesCache::prefetch(const std::vector<int>& camIds)
+{
+    // do not prefetch more images than the cache can hold (keep one slot for the image in use)
+    const std::size_t oneImageSize = sizeof(Color) * _mp->getMaxImageWidth() * _mp->getMaxImageHeight();
+    std::size_t nbMaxPrefetch;
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        nbMaxPrefetch = std::max(std::size_t(1), _maxMemSize / std::max(std::size_t(1), oneImageSize)) - 1;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_prefetchMutex);
+        startIOThreads();
+
+        for(std::size_t i = 0; i < camIds.size() && i < nbMaxPrefetch; ++i)
+        {
+            const int camId = camIds[i];
+            if(std::find(_prefetchQueue.begin(), _prefetchQueue.end(), camId) == _prefetchQueue.end())
+                _prefetchQueue.push_back(camId);
+        }
+    }
+    _prefetchCondition.notify_all();
+}
+
+void ImagesCache::startIOThreads()
+{
+    if(!_ioThreads.empty())
+        return;
+
+    for(int i = 0; i < _nbIOThreads; ++i)
+        _ioThreads.emplace_back(&ImagesCache::ioThreadLoop, this);
+}
+
+void ImagesCache::ioThreadLoop()
+{
+    while(true)
+    {
+        int camId;
+        {
+            std::unique_lock<std::mutex> lock(_prefetchMutex);
+            _prefetchCondition.wait(lock, [this]{ return _stopIOThreads || !_prefetchQueue.empty(); });
+
+            if(_stopIOThreads)
+                return;
+
+            camId = _prefetchQueue.front();
+            _prefetchQueue.pop_front();
+        }
+
+        try
+        {
+            getImg(camId, true);
+        }
+        catch(const std::exception& e)
+        {
+            // the error will be raised again when the image is requested
+            ALICEVISION_LOG_WARNING("Failed to prefetch image " << _imagesNames.at(camId) << ": " << e.what());
+        }
+    }
+}
+
+ImagesCache::Stats ImagesCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_cacheMutex);
+    return _stats;
+}
+
+void ImagesCache::logStats() const
+{
+    const Stats stats = getStats();
+    const std::size_t nbRequests = stats.nbHits + stats.nbMisses;
+    const std::size_t nbDecoded = stats.nbMisses + stats.nbPrefetched;
+
+    ALICEVISION_LOG_INFO("Images cache statistics:" << std::endl
+                         << "\t- requests: " << nbRequests << std::endl
+                         << "\t- hits: " << stats.nbHits << " (" << (nbRequests ? (100.0 * stats.nbHits / nbRequests) : 0.0) << "%)" << std::endl
+                         << "\t- misses: " << stats.nbMisses << std::endl
+                         << "\t- prefetched: " << stats.nbPrefetched << std::endl
+                         << "\t- evictions: " << stats.nbEvictions << std::endl
+                         << "\t- decode time: " << system::prettyTime(stats.decodeTimeMs)
+                         << " (" << (nbDecoded ? (stats.decodeTimeMs / nbDecoded) : 0.0) << " ms per image)");
+}
+
 Color ImagesCache::getPixelValueInterpolated(const Point2d* pix, int camId)
 {
-    // get the image index in the memory
-    const int i = _camIdMapId[camId];
-    const ImgSharedPtr& img = _imgs[i];
-    
+    // get the image from the cache
+    const ImgSharedPtr img = getImg_sync(camId);
+
     const int xp = static_cast<int>(pix->x);
     const int yp = static_cast<int>(pix->y);
 
@@ -14,12 +14,23 @@
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/Image.hpp>
 
+#include <condition_variable>
+#include <deque>
 #include <future>
+#include <list>
 #include <mutex>
+#include <thread>
 
 namespace aliceVision {
 namespace mvsUtils {
 
+/**
+ * @brief Cache of the camera images.
+ *
+ * The cache size is a memory budget in bytes. Images are evicted in least recently used order.
+ * Images can be prefetched by background I/O threads so that decoding overlaps computation.
+ * Evicted images remain valid as long as a consumer keeps a shared pointer on them.
+ */
 class ImagesCache
 {
 public:
@@ -34,37 +45,121 @@ public:
 
     typedef std::shared_ptr<Image> ImgSharedPtr;
 
+    /**
+     * @brief Cache usage statistics
+     */
+    struct Stats
+    {
+        /// number of requests served from the cache
+        std::size_t nbHits = 0;
+        /// number of requests that needed to decode the image
+        std::size_t nbMisses = 0;
+        /// number of images decoded by the prefetch threads
+        std::size_t nbPrefetched = 0;
+        /// number of images removed from the cache
+        std::size_t nbEvictions = 0;
+        /// total time spent decoding images (milliseconds)
+        double decodeTimeMs = 0.0;
+    };
+
 private:
     ImagesCache(const ImagesCache&) = delete;
 
     const MultiViewParams* _mp;
 
-    int _N_PRELOADED_IMAGES;
-    std::vector<ImgSharedPtr> _imgs;
-
-    std::vector<int> _camIdMapId;
-    std::vector<int> _mapIdCamId;
-    StaticVector<long> _mapIdClock;
+    /// maximum size of the cached images (in bytes)
+    std::size_t _maxMemSize = 0;
+    /// current size of the cached images (in bytes)
+    std::size_t _memSize = 0;
 
+    /// cached image per camera index (nullptr if not in cache)
+    std::vector<ImgSharedPtr> _imgs;
+    /// camera indexes of the cached images, most recently used first
+    std::list<int> _lruCamIds;
+    /// position of each camera index in _lruCamIds (_lruCamIds.end() if not in cache)
+    std::vector<std::list<int>::iterator> _lruPositions;
+    /// protects the cache content (_imgs, _lruCamIds, _lruPositions, _memSize, _stats)
+    mutable std::mutex _cacheMutex;
+
+    /// per camera mutex held while decoding, to avoid loading the same image twice
     std::vector<std::mutex> _imagesMutexes;
     std::vector<std::string> _imagesNames;
 
     imageIO::EImageColorSpace _colorspace{imageIO::EImageColorSpace::AUTO};
     ECorrectEV _correctEV{ECorrectEV::NO_CORRECTION};
 
+    Stats _stats;
+
+    /// number of background I/O threads
+    int _nbIOThreads = 2;
+    std::vector<std::thread> _ioThreads;
+    std::deque<int> _prefetchQueue;
+    std::mutex _prefetchMutex;
+    std::condition_variable _prefetchCondition;
+    bool _stopIOThreads = false;
+
+    /**
+     * @brief Get an image from the cache, decode it if needed
+     * @param[in] camId the camera index
+     * @param[in] isPrefetch true if called from a prefetch thread
+     * @return the image
+     */
+    ImgSharedPtr getImg(int camId, bool isPrefetch);
+
+    /**
+     * @brief Mark a cached image as the most recently used
+     * @note _cacheMutex should be locked
+     */
+    void touch(int camId);
+
+    /**
+     * @brief Add a decoded image to the cache, evicting least recently used images if needed
+     * @note _cacheMutex should be locked
+     */
+    void insert(int camId, const ImgSharedPtr& img);
+
+    /**
+     * @brief Start the I/O threads if not already running
+     * @note _prefetchMutex should be locked
+     */
+    void startIOThreads();
+
+    /**
+     * @brief I/O thread loop: decode the prefetch requests
+     */
+    void ioThreadLoop();
+
 public:
     ImagesCache( const MultiViewParams* mp, imageIO::EImageColorSpace colorspace, ECorrectEV correctEV = ECorrectEV::NO_CORRECTION);
     ImagesCache( const MultiViewParams* mp, imageIO::EImageColorSpace colorspace, std::vector<std::string>& imagesNames, ECorrectEV correctEV = ECorrectEV::NO_CORRECTION);
+    ~ImagesCache();
+
     void initIC( std::vector<std::string>& imagesNames );
+
+    /**
+     * @brief Set the cache size as a number of images of maximum resolution
+     * @param[in] nbPreload the number of images
+     */
     void setCacheSize(int nbPreload);
+
+    /**
+     * @brief Set the cache size
+     * @param[in] maxMemSize the maximum size of the cached images in bytes
+     */
+    void setMaxMemorySize(std::size_t maxMemSize);
+
+    /**
+     * @brief Set the number of background I/O threads used by prefetch
+     * @param[in] nbIOThreads the number of threads (at least 1)
+     * @note should be called before the first prefetch
+     */
+    void setNbIOThreads(int nbIOThreads) { _nbIOThreads = std::max(1, nbIOThreads); }
+
     void setCorrectEV(const ECorrectEV correctEV) { _correctEV = correctEV; }
-    ~ImagesCache() = default;
 
     inline ImgSharedPtr getImg_sync( int camId )
     {
-        refreshData_sync(camId);
-        const int imageId = _camIdMapId[camId];
-        return _imgs[imageId];
+        return getImg(camId, false);
     }
 
     void refreshData(int camId);
@@ -72,6 +167,23 @@ public:
 
     std::future<void> refreshData_async(int camId);
 
+    /**
+     * @brief Request the given cameras to be decoded in background
+     * @param[in] camIds the camera indexes, in order of future use
+     * @note only the cameras that fit in the cache budget are prefetched
+     */
+    void prefetch(const std::vector<int>& camIds);
+
+    /**
+     * @brief Get the cache usage statistics
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief Log the cache usage statistics
+     */
+    void logStats() const;
+
     Color getPixelValueInterpolated(const Point2d* pix, int camId);
 };
 
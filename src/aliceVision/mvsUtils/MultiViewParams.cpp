@@ -555,111 +555,161 @@ void MultiViewParams::decomposeProjectionMatrix(Point3d& Co, Matrix3x3& Ro, Matr
 StaticVector<int> MultiViewParams::findNearestCamsFromLandmarks(int rc, int nbNearestCams) const
 {
   StaticVector<int> out;
-  std::vector<SortedId> ids;
-  ids.reserve(getNbCameras());
 
-  for(int tc = 0; tc < getNbCameras(); ++tc)
-    ids.push_back(SortedId(tc,0));
+  // neighbors sorted by decreasing number of shared landmarks in the view angle range
+  const std::shared_ptr<const CovisibilityGraph> covisibilityGraph = getCovisibilityGraph();
+  const std::vector<CovisibilityEdge>& edges = covisibilityGraph->getNeighbors(rc);
 
-  const IndexT viewId = getViewId(rc);
-  const sfmData::View& view = *(_sfmData.getViews().at(viewId));
-  const geometry::Pose3 pose = _sfmData.getPose(view).getTransform();
-  const camera::IntrinsicBase* intrinsicPtr = _sfmData.getIntrinsicPtr(view.getIntrinsicId());
+  // ensure the ideal number of target cameras is not superior to the actual number of cameras
+  const int maxTc = std::min(std::min(getNbCameras(), nbNearestCams), static_cast<int>(edges.size()));
+  out.reserve(maxTc);
 
-  for(const auto& landmarkPair :_sfmData.getLandmarks())
+  for(int i = 0; i < maxTc; ++i)
   {
-    const auto& observations = landmarkPair.second.observations;
-
-    auto viewObsIt = observations.find(viewId);
-    if(viewObsIt == observations.end())
-      continue;
-
-    for(const auto& observationPair : observations)
-    {
-      const IndexT otherViewId = observationPair.first;
-
-      if(otherViewId == viewId)
-       continue;
+    // a minimum of 10 common points is required (10*2 because points are stored in both rc/tc combinations)
+    if(edges[i].nbValidLandmarks > (10 * 2))
+      out.push_back(edges[i].camIndex);
+  }
 
-      const sfmData::View& otherView = *(_sfmData.getViews().at(otherViewId));
-      const geometry::Pose3 otherPose = _sfmData.getPose(otherView).getTransform();
-      const camera::IntrinsicBase* otherIntrinsicPtr = _sfmData.getIntrinsicPtr(otherView.getIntrinsicId());
+  if(out.size() < nbNearestCams)
+    ALICEVISION_LOG_INFO("Found only " << out.size() << "/" << nbNearestCams << " nearest cameras for view id: " << getViewId(rc));
 
-      const double angle = camera::AngleBetweenRays(pose, intrinsicPtr, otherPose, otherIntrinsicPtr, viewObsIt->second.x, observationPair.second.x);
+  return out;
+}
 
-      if(angle < _minViewAngle || angle > _maxViewAngle)
-        continue;
+std::shared_ptr<const CovisibilityGraph> MultiViewParams::getCovisibilityGraph() const
+{
+  std::lock_guard<std::mutex> lock(_camerasStructuresMutex);
 
-      const int tc = getIndexFromViewId(otherViewId);
-      ++ids.at(tc).value;
-    }
+  if(_covisibilityGraph == nullptr || !_covisibilityGraph->matches(getNbCameras(), _minViewAngle, _maxViewAngle))
+  {
+    std::shared_ptr<CovisibilityGraph> covisibilityGraph = std::make_shared<CovisibilityGraph>();
+    covisibilityGraph->build(*this);
+    _covisibilityGraph = covisibilityGraph;
   }
+  return _covisibilityGraph;
+}
 
-  qsort(&ids[0], ids.size(), sizeof(SortedId), qsortCompareSortedIdDesc);
+bool MultiViewParams::loadCovisibilityGraph(const std::string& filename) const
+{
+  if(!fs::exists(filename))
+    return false;
 
-  // ensure the ideal number of target cameras is not superior to the actual number of cameras
-  const int maxTc = std::min(std::min(getNbCameras(), nbNearestCams), static_cast<int>(ids.size()));
-  out.reserve(maxTc);
+  std::shared_ptr<CovisibilityGraph> covisibilityGraph = std::make_shared<CovisibilityGraph>();
 
-  for(int i = 0; i < maxTc; ++i)
+  if(!covisibilityGraph->load(filename))
+    return false;
+
+  if(!covisibilityGraph->matches(getNbCameras(), _minViewAngle, _maxViewAngle) || !covisibilityGraph->matchesScene(*this))
   {
-    // a minimum of 10 common points is required (10*2 because points are stored in both rc/tc combinations)
-    if(ids[i].value > (10 * 2))
-      out.push_back(ids[i].id);
+    ALICEVISION_LOG_WARNING("The covisibility graph file does not match the current cameras, landmarks or view angle range, it is ignored: " << filename);
+    return false;
   }
 
-  if(out.size() < nbNearestCams)
-    ALICEVISION_LOG_INFO("Found only " << out.size() << "/" << nbNearestCams << " nearest cameras for view id: " << getViewId(rc));
+  std::lock_guard<std::mutex> lock(_camerasStructuresMutex);
+  _covisibilityGraph = covisibilityGraph;
+  ALICEVISION_LOG_INFO("Covisibility graph loaded: " << filename);
+  return true;
+}
 
-  return out;
+bool MultiViewParams::saveCovisibilityGraph(const std::string& filename) const
+{
+  return getCovisibilityGraph()->save(filename);
 }
 
 StaticVector<int> MultiViewParams::findCamsWhichIntersectsHexahedron(const Point3d hexah[8], const std::string& minMaxDepthsFileName) const
 {
-    StaticVector<Point2d>* minMaxDepths = loadArrayFromFile<Point2d>(minMaxDepthsFileName);
-    StaticVector<int> tcams;
-    tcams.reserve(getNbCameras());
-    for(int rc = 0; rc < getNbCameras(); rc++)
+    std::shared_ptr<const DepthsFileFrusta> depthsFileFrusta;
     {
-        const float minDepth = (*minMaxDepths)[rc].x;
-        const float maxDepth = (*minMaxDepths)[rc].y;
-        if((minDepth > 0.0f) && (maxDepth > minDepth))
+        std::lock_guard<std::mutex> lock(_camerasStructuresMutex);
+
+        // the min / max depths file is only read once
+        if(_depthsFileFrusta == nullptr || _depthsFileFrusta->minMaxDepthsFileName != minMaxDepthsFileName)
         {
-            Point3d rchex[8];
-            getCamHexahedron(CArr.at(rc), iCamArr.at(rc), getWidth(rc), getHeight(rc), minDepth, maxDepth, rchex);
-            if(intersectsHexahedronHexahedron(rchex, hexah))
-                tcams.push_back(rc);
+            std::shared_ptr<DepthsFileFrusta> newDepthsFileFrusta = std::make_shared<DepthsFileFrusta>();
+            newDepthsFileFrusta->minMaxDepthsFileName = minMaxDepthsFileName;
+
+            StaticVector<Point2d>* minMaxDepths = loadArrayFromFile<Point2d>(minMaxDepthsFileName);
+
+            // only the cameras with a valid depth range can be returned
+            std::vector<FrustaBVH::Hexahedron> frusta;
+            frusta.reserve(getNbCameras());
+            newDepthsFileFrusta->cams.reserve(getNbCameras());
+
+            for(int rc = 0; rc < getNbCameras(); rc++)
+            {
+                const float minDepth = (*minMaxDepths)[rc].x;
+                const float maxDepth = (*minMaxDepths)[rc].y;
+                if((minDepth > 0.0f) && (maxDepth > minDepth))
+                {
+                    frusta.emplace_back();
+                    getCamHexahedron(CArr.at(rc), iCamArr.at(rc), getWidth(rc), getHeight(rc), minDepth, maxDepth, frusta.back().data());
+                    newDepthsFileFrusta->cams.push_back(rc);
+                }
+            }
+            delete minMaxDepths;
+
+            newDepthsFileFrusta->frustaBVH.build(frusta, std::vector<bool>(frusta.size(), true));
+            _depthsFileFrusta = newDepthsFileFrusta;
         }
+        depthsFileFrusta = _depthsFileFrusta;
     }
-    delete minMaxDepths;
+
+    std::vector<int> cams;
+    depthsFileFrusta->frustaBVH.findCamsWhichIntersectsHexahedron(hexah, cams);
+
+    StaticVector<int> tcams;
+    tcams.reserve(cams.size());
+    for(const int cam : cams)
+        tcams.push_back(depthsFileFrusta->cams[cam]);
     return tcams;
 }
 
 StaticVector<int> MultiViewParams::findCamsWhichIntersectsHexahedron(const Point3d hexah[8]) const
 {
-    StaticVector<int> tcams;
-    tcams.reserve(getNbCameras());
-    for(int rc = 0; rc < getNbCameras(); rc++)
+    std::shared_ptr<const FrustaBVH> frustaBVH;
     {
-        oiio::ParamValueList metadata;
-        imageIO::readImageMetadata(getImagePath(rc), metadata);
+        std::lock_guard<std::mutex> lock(_camerasStructuresMutex);
 
-        const float minDepth = metadata.get_float("AliceVision:minDepth", -1);
-        const float maxDepth = metadata.get_float("AliceVision:maxDepth", -1);
-
-        if(minDepth == -1 && maxDepth == -1)
+        // the image metadata are only read once
+        if(_frustaBVH == nullptr)
         {
-            ALICEVISION_LOG_WARNING("Cannot find min / max depth metadata in image: " << getImagePath(rc) << ". Assumes that all images should be used.");
-            tcams.push_back(rc);
-        }
-        else
-        {
-            Point3d rchex[8];
-            getCamHexahedron(CArr.at(rc), iCamArr.at(rc), getWidth(rc), getHeight(rc), minDepth, maxDepth, rchex);
-            if(intersectsHexahedronHexahedron(rchex, hexah))
-                tcams.push_back(rc);
+            std::vector<FrustaBVH::Hexahedron> frusta(getNbCameras());
+            std::vector<bool> validFrusta(getNbCameras(), false);
+
+            for(int rc = 0; rc < getNbCameras(); rc++)
+            {
+                oiio::ParamValueList metadata;
+                imageIO::readImageMetadata(getImagePath(rc), metadata);
+
+                const float minDepth = metadata.get_float("AliceVision:minDepth", -1);
+                const float maxDepth = metadata.get_float("AliceVision:maxDepth", -1);
+
+                if(minDepth == -1 && maxDepth == -1)
+                {
+                    ALICEVISION_LOG_WARNING("Cannot find min / max depth metadata in image: " << getImagePath(rc) << ". Assumes that all images should be used.");
+                }
+                else
+                {
+                    getCamHexahedron(CArr.at(rc), iCamArr.at(rc), getWidth(rc), getHeight(rc), minDepth, maxDepth, frusta[rc].data());
+                    validFrusta[rc] = true;
+                }
+            }
+
+            std::shared_ptr<FrustaBVH> newFrustaBVH = std::make_shared<FrustaBVH>();
+            newFrustaBVH->build(frusta, validFrusta);
+            _frustaBVH = newFrustaBVH;
         }
+        frustaBVH = _frustaBVH;
     }
+
+    std::vector<int> cams;
+    frustaBVH->findCamsWhichIntersectsHexahedron(hexah, cams);
+
+    StaticVector<int> tcams;
+    tcams.reserve(cams.size());
+    for(const int cam : cams)
+        tcams.push_back(cam);
     return tcams;
 }
 
@@ -12,12 +12,16 @@
 #include <aliceVision/mvsData/Pixel.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsData/structures.hpp>
+#include <aliceVision/mvsUtils/CovisibilityGraph.hpp>
+#include <aliceVision/mvsUtils/FrustaBVH.hpp>
 
 #include <boost/property_tree/ptree.hpp>
 
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
 
 namespace aliceVision {
 
@@ -260,6 +264,7 @@ public:
 
     /**
      * @brief findCamsWhichIntersectsHexahedron
+     *        The frusta hierarchy is built on the first call for a given min / max depths file and reused by the next calls.
      * @param hexah 0-3 frontal face, 4-7 back face
      * @param minMaxDepthsFileName
      * @return
@@ -281,6 +286,29 @@ public:
      */
     StaticVector<int> findNearestCamsFromLandmarks(int rc, int nbNearestCams) const;
 
+    /**
+     * @brief Get the camera covisibility graph.
+     *        It is built on the first call from the SfM landmarks (or loaded with loadCovisibilityGraph)
+     *        and rebuilt if the view angle range has changed.
+     * @return the covisibility graph, it stays valid while the pointer is held even if the graph is rebuilt or loaded
+     */
+    std::shared_ptr<const CovisibilityGraph> getCovisibilityGraph() const;
+
+    /**
+     * @brief Load the covisibility graph from a file,
+     *        it is ignored if it does not match the cameras, the landmarks observations or the view angle range
+     * @param[in] filename the covisibility graph file
+     * @return true if the graph is loaded
+     */
+    bool loadCovisibilityGraph(const std::string& filename) const;
+
+    /**
+     * @brief Save the covisibility graph (built if needed) in a file
+     * @param[in] filename the covisibility graph file
+     * @return true if the graph is saved
+     */
+    bool saveCovisibilityGraph(const std::string& filename) const;
+
 
     inline void setMinViewAngle(float minViewAngle)
     {
@@ -317,6 +345,23 @@ private:
     float _maxViewAngle = 70.0f;  // WARNING: may be too low, especially when using seeds from SfM
     /// input sfmData
     const sfmData::SfMData& _sfmData;
+    /// camera frusta from a min / max depths file, only the cameras with a valid depth range
+    struct DepthsFileFrusta
+    {
+        std::string minMaxDepthsFileName;
+        FrustaBVH frustaBVH;
+        /// camera index of each frustum
+        std::vector<int> cams;
+    };
+
+    /// protect the lazy initialization of the covisibility graph and the frusta BVH
+    mutable std::mutex _camerasStructuresMutex;
+    /// camera covisibility graph (lazy initialization)
+    mutable std::shared_ptr<const CovisibilityGraph> _covisibilityGraph;
+    /// camera frusta from the images min / max depth metadata (lazy initialization)
+    mutable std::shared_ptr<const FrustaBVH> _frustaBVH;
+    /// camera frusta from the last min / max depths file (lazy initialization)
+    mutable std::shared_ptr<const DepthsFileFrusta> _depthsFileFrusta;
 
     void loadMatricesFromTxtFile(int index, const std::string& fileNameP, const std::string& fileNameD);
     void loadMatricesFromRawProjectionMatrix(int index, const double* rawProjMatix);
@@ -0,0 +1,121 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mvsUtils/common.hpp>
+#include <aliceVision/mvsUtils/FrustaBVH.hpp>
+#include <aliceVision/mvsData/Matrix3x3.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE frustaBVH
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mvsUtils;
+
+// Test summary:
+// - Build the hierarchy over random camera frusta (some without depth range)
+// - Assert that the hexahedron queries return the same cameras as the exact
+//   intersection test on all the frusta
+
+namespace {
+
+/**
+ * @brief Random camera frustum between minDepth and maxDepth
+ */
+FrustaBVH::Hexahedron getRandomFrustum(std::mt19937& generator)
+{
+    std::uniform_real_distribution<double> position(-20.0, 20.0);
+    std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+    std::uniform_real_distribution<double> depth(1.0, 10.0);
+
+    const int width = 1600;
+    const int height = 1200;
+    const double focal = std::uniform_real_distribution<double>(800.0, 2400.0)(generator);
+
+    // inverse of K
+    Matrix3x3 iK;
+    iK.m11 = 1.0 / focal; iK.m12 = 0.0;         iK.m13 = -0.5 * width / focal;
+    iK.m21 = 0.0;         iK.m22 = 1.0 / focal; iK.m23 = -0.5 * height / focal;
+    iK.m31 = 0.0;         iK.m32 = 0.0;         iK.m33 = 1.0;
+
+    // rotation from Euler angles
+    const double a = angle(generator);
+    const double b = angle(generator);
+    const double c = angle(generator);
+    Matrix3x3 Rx, Ry, Rz;
+    Rx.m11 = 1.0;         Rx.m12 = 0.0;          Rx.m13 = 0.0;
+    Rx.m21 = 0.0;         Rx.m22 = std::cos(a);  Rx.m23 = -std::sin(a);
+    Rx.m31 = 0.0;         Rx.m32 = std::sin(a);  Rx.m33 = std::cos(a);
+    Ry.m11 = std::cos(b); Ry.m12 = 0.0;          Ry.m13 = std::sin(b);
+    Ry.m21 = 0.0;         Ry.m22 = 1.0;          Ry.m23 = 0.0;
+    Ry.m31 = -std::sin(b); Ry.m32 = 0.0;         Ry.m33 = std::cos(b);
+    Rz.m11 = std::cos(c); Rz.m12 = -std::sin(c); Rz.m13 = 0.0;
+    Rz.m21 = std::sin(c); Rz.m22 = std::cos(c);  Rz.m23 = 0.0;
+    Rz.m31 = 0.0;         Rz.m32 = 0.0;          Rz.m33 = 1.0;
+
+    // camera to world rotation
+    const Matrix3x3 iCam = (Rz * Ry * Rx) * iK;
+
+    const Point3d center(position(generator), position(generator), position(generator));
+    const float minDepth = static_cast<float>(depth(generator));
+    const float maxDepth = minDepth + static_cast<float>(depth(generator));
+
+    FrustaBVH::Hexahedron frustum;
+    getCamHexahedron(center, iCam, width, height, minDepth, maxDepth, frustum.data());
+    return frustum;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(FrustaBVH_sameAsExactTest)
+{
+    std::mt19937 generator(42);
+
+    for(const int nbCameras : {1, 2, 7, 300})
+    {
+        std::vector<FrustaBVH::Hexahedron> frusta(nbCameras);
+        std::vector<bool> validFrusta(nbCameras);
+        for(int cam = 0; cam < nbCameras; ++cam)
+        {
+            frusta[cam] = getRandomFrustum(generator);
+            validFrusta[cam] = (cam % 10 != 3);
+        }
+
+        FrustaBVH frustaBVH;
+        frustaBVH.build(frusta, validFrusta);
+        BOOST_CHECK_EQUAL(frustaBVH.getNbCameras(), nbCameras);
+
+        std::size_t nbIntersections = 0;
+
+        for(int q = 0; q < 200; ++q)
+        {
+            const FrustaBVH::Hexahedron query = getRandomFrustum(generator);
+
+            std::vector<int> expectedCams;
+            for(int cam = 0; cam < nbCameras; ++cam)
+            {
+                if(!validFrusta[cam] || intersectsHexahedronHexahedron(frusta[cam].data(), query.data()))
+                    expectedCams.push_back(cam);
+            }
+
+            std::vector<int> cams;
+            frustaBVH.findCamsWhichIntersectsHexahedron(query.data(), cams);
+
+            BOOST_CHECK_EQUAL_COLLECTIONS(cams.begin(), cams.end(), expectedCams.begin(), expectedCams.end());
+            nbIntersections += expectedCams.size();
+        }
+
+        // the queries are not trivial: some frusta intersect, not all of them
+        if(nbCameras > 10)
+        {
+            BOOST_CHECK_GT(nbIntersections, 0);
+            BOOST_CHECK_LT(nbIntersections, 200 * static_cast<std::size_t>(nbCameras));
+        }
+    }
+}
@@ -5,13 +5,12 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "LocalBundleAdjustmentGraph.hpp"
-#include <aliceVision/stl/stl.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <boost/filesystem.hpp>
-#include <lemon/bfs.h>
 
 #include <fstream>
 #include <algorithm>
+#include <limits>
 
 namespace fs = boost::filesystem;
 
@@ -46,6 +45,11 @@ std::map<int, std::size_t> LocalBundleAdjustmentGraph::getDistancesHistogram() c
     else
       histogram.at(x.second)++;
   }
+
+  // views further than D+1 are not stored
+  if(!_distancePerViewId.empty() && _nodePerViewId.size() > _distancePerViewId.size())
+    histogram[-1] = _nodePerViewId.size() - _distancePerViewId.size();
+
   return histogram;
 }
 
@@ -136,7 +140,7 @@ void LocalBundleAdjustmentGraph::exportIntrinsicsHistory(const std::string& fold
 bool LocalBundleAdjustmentGraph::removeViews(const sfmData::SfMData& sfmData, const std::set<IndexT>& removedViewsId)
 {
   std::size_t numRemovedNode = 0;
-  std::map<IndexT, std::vector<int>> removedEdgesByIntrinsic;
+  std::map<IndexT, std::vector<EdgeIndex>> removedEdgesByIntrinsic;
 
   for(const IndexT& viewId : removedViewsId)
   {
@@ -147,24 +151,34 @@ bool LocalBundleAdjustmentGraph::removeViews(const sfmData::SfMData& sfmData, co
       continue;
     }
 
+    const NodeIndex node = it->second;
+
+    // get the node incident edges
+    std::vector<EdgeIndex> incidentEdges;
+    forEachIncidentEdge(node, [&](EdgeIndex edgeId, NodeIndex) { incidentEdges.push_back(edgeId); });
+
     // keep track of node incident edges that are going to be removed
     // in order to update _intrinsicEdgesId accordingly
-    { 
+    {
       const IndexT intrinsicId = sfmData.getView(viewId).getIntrinsicId();
-      const auto intrinsicIt = _intrinsicEdgesId.find(intrinsicId);
-      if(intrinsicIt != _intrinsicEdgesId.end())
+      if(_intrinsicEdgesId.find(intrinsicId) != _intrinsicEdgesId.end())
       {
-        // store incident edge ids before removal
-        for(lemon::ListGraph::IncEdgeIt e(_graph, it->second); e != lemon::INVALID; ++e)
-        {
-          removedEdgesByIntrinsic[intrinsicId].push_back(_graph.id(lemon::ListGraph::Edge(e)));
-        }
+        std::vector<EdgeIndex>& removedEdges = removedEdgesByIntrinsic[intrinsicId];
+        removedEdges.insert(removedEdges.end(), incidentEdges.begin(), incidentEdges.end());
       }
     }
-    
-    _graph.erase(it->second); // this function erase a node with its incident arcs
-    _viewIdPerNode.erase(it->second);
-    _nodePerViewId.erase(it->first); // warning: invalidates the iterator "it", so it can not be used after this line
+
+    // erase the node with its incident edges
+    for(const EdgeIndex edgeId : incidentEdges)
+      removeEdge(edgeId);
+
+    std::vector<NodeIndex>& poseNodes = _nodesPerPoseId.at(_poseIdPerNode[node]);
+    poseNodes.erase(std::find(poseNodes.begin(), poseNodes.end(), node));
+    if(poseNodes.empty())
+      _nodesPerPoseId.erase(_poseIdPerNode[node]);
+
+    _viewIdPerNode[node] = UndefinedIndexT;
+    _nodePerViewId.erase(it);
 
     ++numRemovedNode;
     ALICEVISION_LOG_DEBUG("The view #" << viewId << " has been successfully removed to the distance graph.");
@@ -174,10 +188,10 @@ bool LocalBundleAdjustmentGraph::removeViews(const sfmData::SfMData& sfmData, co
   for(auto& edgesIt : removedEdgesByIntrinsic)
   {
     const IndexT intrinsicId =  edgesIt.first;
-    std::vector<int>& edgeIds = _intrinsicEdgesId[intrinsicId];
-    std::vector<int>& removedEdges = edgesIt.second;
+    std::vector<EdgeIndex>& edgeIds = _intrinsicEdgesId[intrinsicId];
+    std::vector<EdgeIndex>& removedEdges = edgesIt.second;
 
-    std::vector<int> newEdgeIds;
+    std::vector<EdgeIndex> newEdgeIds;
     // sort before using set_difference
     std::sort(edgeIds.begin(), edgeIds.end());
     std::sort(removedEdges.begin(), removedEdges.end());
@@ -199,22 +213,20 @@ bool LocalBundleAdjustmentGraph::removeViews(const sfmData::SfMData& sfmData, co
 
 int LocalBundleAdjustmentGraph::getPoseDistance(const IndexT poseId) const
 {
-  if(_distancePerPoseId.find(poseId) == _distancePerPoseId.end())
-  {
-    ALICEVISION_LOG_DEBUG("The pose #" << poseId << " does not exist in the '_mapDistancePerPoseId' (map size: " << _distancePerPoseId.size() << ") \n");
+  // poses further than D+1 are not stored
+  const auto it = _distancePerPoseId.find(poseId);
+  if(it == _distancePerPoseId.end())
     return -1;
-  }
-  return _distancePerPoseId.at(poseId);
+  return it->second;
 }
 
 int LocalBundleAdjustmentGraph::getViewDistance(const IndexT viewId) const
 {
-  if(_distancePerViewId.find(viewId) == _distancePerViewId.end())
-  {
-    ALICEVISION_LOG_DEBUG("Cannot get the graph-distance of the view #" << viewId << ": does not exist in the '_mapDistancePerViewId':\n");
+  // views further than D+1 are not stored
+  const auto it = _distancePerViewId.find(viewId);
+  if(it == _distancePerViewId.end())
     return -1;
-  }
-  return _distancePerViewId.at(viewId);
+  return it->second;
 }
 
 BundleAdjustment::EParameterState LocalBundleAdjustmentGraph::getStateFromDistance(int distance) const
@@ -246,7 +258,7 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
   // identify the views we need to add to the graph:
   std::set<IndexT> addedViewsId;
   
-  if(_graph.maxNodeId() + 1 == 0) // the graph is empty: add all the poses of the scene
+  if(_nodePerViewId.empty()) // the graph is empty: add all the poses of the scene
   {
     ALICEVISION_LOG_DEBUG("The graph is empty: initial pair & new view(s) added.");
     for(const auto & x : sfmData.getViews())
@@ -276,10 +288,8 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
       ALICEVISION_LOG_WARNING("Cannot add the view id: " << viewId << " to the graph, its pose & intrinsic are not defined.");
       continue;
     }
-     
-    lemon::ListGraph::Node newNode = _graph.addNode();
-    _nodePerViewId[viewId] = newNode;
-    _viewIdPerNode[newNode] = viewId;
+
+    addNode(viewId, sfmData.getView(viewId).getPoseId());
     ++nbAddedNodes;
   }
 
@@ -294,13 +304,13 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
     numAddedEdges = newEdges.size();
 
     for(const Pair& edge: newEdges)
-      _graph.addEdge(_nodePerViewId.at(edge.first), _nodePerViewId.at(edge.second));
+      addEdge(edge.first, edge.second);
 
     numAddedEdges += addIntrinsicEdgesToTheGraph(sfmData, addedViewsId);
   }
   
   ALICEVISION_LOG_DEBUG("The distances graph has been completed with " << nbAddedNodes<< " nodes & " << numAddedEdges << " edges.");
-  ALICEVISION_LOG_DEBUG("It contains " << _graph.maxNodeId() + 1 << " nodes & " << _graph.maxEdgeId() + 1 << " edges");
+  ALICEVISION_LOG_DEBUG("It contains " << countNodes() << " nodes & " << countEdges() << " edges");
 }
 
 void LocalBundleAdjustmentGraph::computeGraphDistances(const sfmData::SfMData& sfmData, const std::set<IndexT>& newReconstructedViews)
@@ -310,50 +320,85 @@ void LocalBundleAdjustmentGraph::computeGraphDistances(const sfmData::SfMData& s
   // reset the maps
   _distancePerViewId.clear();
   _distancePerPoseId.clear();
-  
-  // setup Breadth First Search using Lemon
-  lemon::Bfs<lemon::ListGraph> bfs(_graph);
-  bfs.init();
-  
-  // add source views for the bfs visit of the _graph
+
+  // compress the graph when the edges added or removed since the last compression
+  // represent a significant part of the graph
+  {
+    const std::size_t nbAppendedEdges = _edges.size() - _nbCompressedEdges;
+    const std::size_t nbRemovedNodes = _viewIdPerNode.size() - _nodePerViewId.size();
+    if(2 * (nbAppendedEdges + _nbRemovedEdges) > _nbCompressedEdges || 2 * nbRemovedNodes > _nbCompressedNodes)
+      compressGraph();
+  }
+
+  // add source views for the bfs visit of the graph
+  std::vector<NodeIndex> reachedNodes; // in visit order
   for(const IndexT viewId: newReconstructedViews)
   {
     auto it = _nodePerViewId.find(viewId);
     if(it == _nodePerViewId.end())
+    {
       ALICEVISION_LOG_WARNING("The reconstructed view #" << viewId << " cannot be added as source for the BFS: does not exist in the graph.");
-    else
-      bfs.addSource(it->second);
+    }
+    else if(_distancePerNode[it->second] < 0)
+    {
+      _distancePerNode[it->second] = 0;
+      reachedNodes.push_back(it->second);
+    }
   }
-  bfs.start();
-  
-  // handle bfs results (distances)
-  for(const auto& x : _nodePerViewId) // each node in the graph
+
+  // breadth first search, up to the distance D+1:
+  // further views are ignored by the Local BA, as the views not connected to the new views
+  const int maxDistance = static_cast<int>(_graphDistanceLimit) + 1;
+  std::size_t levelBegin = 0;
+  for(int distance = 1; distance <= maxDistance && levelBegin < reachedNodes.size(); ++distance)
   {
-    auto& node = x.second;
-    int d = -1; 
-    
-    if(bfs.reached(node))
+    const std::size_t levelEnd = reachedNodes.size();
+    for(std::size_t i = levelBegin; i < levelEnd; ++i)
     {
-      d = bfs.dist(node);
-      // dist(): "If node v is not reached from the root(s), then the return value of this function is undefined."
-      // this is why the distance is previously set to -1.
+      forEachIncidentEdge(reachedNodes[i], [&](EdgeIndex, NodeIndex neighbor)
+      {
+        if(_distancePerNode[neighbor] < 0)
+        {
+          _distancePerNode[neighbor] = distance;
+          reachedNodes.push_back(neighbor);
+        }
+      });
     }
-    _distancePerViewId[x.first] = d;
+    levelBegin = levelEnd;
   }
-  
+
+  // handle bfs results (distances)
+  for(const NodeIndex node : reachedNodes)
+    _distancePerViewId[_viewIdPerNode[node]] = _distancePerNode[node];
+
   // re-mapping from <ViewId, distance> to <PoseId, distance>:
-  for(auto x: _distancePerViewId)
+  // if multiple views share the same pose, keep the min. distance
+  // (-1 if one of the views is not connected to the new views)
+  for(const NodeIndex node : reachedNodes)
   {
-    // get the poseId of the camera no. viewId
-    const IndexT idPose = sfmData.getViews().at(x.first)->getPoseId(); // PoseId of a resected camera
-    
-    auto poseIt = _distancePerPoseId.find(idPose);
-    // if multiple views share the same pose
-    if(poseIt != _distancePerPoseId.end())
-      poseIt->second = std::min(poseIt->second, x.second);
-    else
-      _distancePerPoseId[idPose] = x.second;
-  } 
+    const IndexT poseId = _poseIdPerNode[node];
+    if(_distancePerPoseId.find(poseId) != _distancePerPoseId.end())
+      continue;
+
+    int poseDistance = _distancePerNode[node];
+    for(const NodeIndex poseNode : _nodesPerPoseId.at(poseId))
+    {
+      if(_distancePerNode[poseNode] >= 0)
+      {
+        poseDistance = std::min(poseDistance, _distancePerNode[poseNode]);
+      }
+      else if(!isConnectedToReachedNode(poseNode))
+      {
+        poseDistance = -1;
+        break;
+      }
+    }
+    _distancePerPoseId[poseId] = poseDistance;
+  }
+
+  // reset the distances of the visited nodes for the next bfs
+  for(const NodeIndex node : reachedNodes)
+    _distancePerNode[node] = -1;
 }
 
 void LocalBundleAdjustmentGraph::convertDistancesToStates(const sfmData::SfMData& sfmData)
@@ -440,44 +485,33 @@ std::vector<Pair> LocalBundleAdjustmentGraph::getNewEdges(
     const std::size_t minNbOfEdgesPerView)
 {
   std::vector<Pair> newEdges;
-  
-  // get landmarks id. of all the reconstructed 3D points (: landmarks)
-  // TODO: avoid copy and use boost::transform_iterator
-  std::set<IndexT> landmarkIds;
-  std::transform(sfmData.getLandmarks().begin(), sfmData.getLandmarks().end(),
-                 std::inserter(landmarkIds, landmarkIds.begin()),
-                 stl::RetrieveKey());
-  
+
+  // all the reconstructed 3D points (: landmarks)
+  const sfmData::Landmarks& landmarks = sfmData.getLandmarks();
+
   for(IndexT viewId: newViewsId)
   {
     std::map<IndexT, std::size_t> sharedLandmarksPerView;
 
     // get all the tracks of the new added view
     const aliceVision::track::TrackIdSet& newViewTrackIds = tracksPerView.at(viewId);
-    
-    // keep the reconstructed tracks (with an associated landmark)
-    std::vector<IndexT> newViewLandmarks; // all landmarks (already reconstructed) visible from the new view
-    
-    newViewLandmarks.reserve(newViewTrackIds.size());
-    std::set_intersection(newViewTrackIds.begin(), newViewTrackIds.end(),
-                          landmarkIds.begin(), landmarkIds.end(),
-                          std::back_inserter(newViewLandmarks));
-    
-    // retrieve the common track Ids
-    for(IndexT landmarkId: newViewLandmarks)
+
+    // retrieve the common track Ids:
+    // only the observations of the reconstructed tracks (with an associated landmark) of the new view are visited
+    for(const std::size_t trackId : newViewTrackIds)
     {
-      for(const auto& observations: sfmData.getLandmarks().at(landmarkId).observations)
+      const auto landmarkIt = landmarks.find(static_cast<IndexT>(trackId));
+      if(landmarkIt == landmarks.end())
+        continue; // not reconstructed
+
+      for(const auto& observations: landmarkIt->second.observations)
       {
         if(observations.first == viewId)
           continue; // do not compare an observation with itself
-        
+
         // increment the number of common landmarks between the new view and the already
         // reconstructed cameras (observations).
-        auto it = sharedLandmarksPerView.find(observations.first);
-        if(it == sharedLandmarksPerView.end())  // the first common landmark
-          sharedLandmarksPerView[observations.first] = 1;
-        else
-          ++it->second;
+        ++sharedLandmarksPerView[observations.first];
       }
     }
 
@@ -603,39 +637,50 @@ void LocalBundleAdjustmentGraph::drawGraph(const sfmData::SfMData& sfmData, cons
 {
   if(!fs::exists(folder))
     fs::create_directory(folder);
-  
+
+  std::set<EdgeIndex> intrinsicEdges;
+  for(const auto& intrinsicEdgesPair : _intrinsicEdgesId)
+    intrinsicEdges.insert(intrinsicEdgesPair.second.begin(), intrinsicEdgesPair.second.end());
+
   std::stringstream dotStream;
   dotStream << "digraph lemon_dot_example {" << "\n";
   
   // node
   dotStream << "  node [ shape=ellipse, penwidth=5.0, fontname=Helvetica, fontsize=40 ];" << "\n";
-  for(lemon::ListGraph::NodeIt n(_graph); n!=lemon::INVALID; ++n)
+  for(NodeIndex n = 0; n < _viewIdPerNode.size(); ++n)
   {
     const IndexT viewId = _viewIdPerNode[n];
-    const int viewDist = _distancePerViewId[viewId];
+    if(viewId == UndefinedIndexT)
+      continue; // removed node
+
+    const int viewDist = getViewDistance(viewId);
     
     std::string color = ", color=";
     if(viewDist == 0) color += "red";
     else if(viewDist == 1 ) color += "green";
     else if(viewDist == 2 ) color += "blue";
     else color += "black";
-    dotStream << "  n" << _graph.id(n)
+    dotStream << "  n" << n
               << " [ label=\"" << viewId << ": D" << viewDist << " K" << sfmData.getViews().at(viewId)->getIntrinsicId() << "\"" << color << "]; " << "\n";
   }
   
   // edge
   dotStream << "  edge [ shape=ellipse, fontname=Helvetica, fontsize=5, color=black ];" << "\n";
-  for(lemon::ListGraph::EdgeIt e(_graph); e!=lemon::INVALID; ++e)
+  for(EdgeIndex e = 0; e < _edges.size(); ++e)
   {
-    dotStream << "  n" << _graph.id(_graph.u(e)) << " -> " << " n" << _graph.id(_graph.v(e));
-    if(_intrinsicEdgesId.find(static_cast<IndexT>(_graph.id(e))) != _intrinsicEdgesId.end())
+    const GraphEdge& edge = _edges[e];
+    if(edge.removed)
+      continue;
+
+    dotStream << "  n" << edge.nodeA << " -> " << " n" << edge.nodeB;
+    if(intrinsicEdges.find(e) != intrinsicEdges.end())
       dotStream << " [color=red]\n";
     else
       dotStream << "\n";
   }
   dotStream << "}" << "\n";
   
-  const std::string dotFilepath = (fs::path(folder) / ("graph_" + std::to_string(_viewIdPerNode.size())  + "_" + nameComplement + ".dot")).string();
+  const std::string dotFilepath = (fs::path(folder) / ("graph_" + std::to_string(countNodes())  + "_" + nameComplement + ".dot")).string();
   std::ofstream dotFile;
   dotFile.open(dotFilepath);
   dotFile.write(dotStream.str().c_str(), dotStream.str().length());
@@ -672,12 +717,12 @@ std::size_t LocalBundleAdjustmentGraph::addIntrinsicEdgesToTheGraph(const sfmDat
     }
   }
 
-  // create registered intrinsic edges in lemon graph 
+  // create registered intrinsic edges in the graph
   // and update _intrinsicEdgesId accordingly
   for(const auto& newEdge : newIntrinsicEdges)
   {
-    const lemon::ListGraph::Edge edge = _graph.addEdge(_nodePerViewId[newEdge.first.first], _nodePerViewId[newEdge.first.second]);
-    _intrinsicEdgesId[newEdge.second].push_back(_graph.id(edge));
+    const EdgeIndex edgeId = addEdge(newEdge.first.first, newEdge.first.second);
+    _intrinsicEdgesId[newEdge.second].push_back(edgeId);
   }
   return newIntrinsicEdges.size();
 }
@@ -686,12 +731,8 @@ void LocalBundleAdjustmentGraph::removeIntrinsicEdgesFromTheGraph(IndexT intrins
 {
   if(_intrinsicEdgesId.count(intrinsicId) == 0)
     return;
-  for(const int edgeId : _intrinsicEdgesId.at(intrinsicId))
-  {
-    const auto& edge = _graph.edgeFromId(edgeId);
-    assert(_graph.valid(edge));
-    _graph.erase(edge);
-  }
+  for(const EdgeIndex edgeId : _intrinsicEdgesId.at(intrinsicId))
+    removeEdge(edgeId);
   _intrinsicEdgesId.erase(intrinsicId);
 }
 
@@ -703,12 +744,8 @@ std::size_t LocalBundleAdjustmentGraph::updateRigEdgesToTheGraph(const sfmData::
   // remove all rig edges
   for(auto& edgesPerRid: _rigEdgesId)
   {
-    for(const int edgeId : edgesPerRid.second)
-    {
-      const auto& edge = _graph.edgeFromId(edgeId);
-      assert(_graph.valid(edge));
-      _graph.erase(edge);
-    }
+    for(const EdgeIndex edgeId : edgesPerRid.second)
+      removeEdge(edgeId);
   }
   _rigEdgesId.clear();
 
@@ -736,8 +773,8 @@ std::size_t LocalBundleAdjustmentGraph::updateRigEdgesToTheGraph(const sfmData::
     {
       for(int j = i; j < views.size(); ++j)
       {
-        lemon::ListGraph::Edge edge = _graph.addEdge(_nodePerViewId[views[i]], _nodePerViewId[views[j]]);
-        _rigEdgesId[rigId].push_back(_graph.id(edge));
+        const EdgeIndex edgeId = addEdge(views[i], views[j]);
+        _rigEdgesId[rigId].push_back(edgeId);
         numAddedEdges++;
       }
     }
@@ -748,19 +785,191 @@ std::size_t LocalBundleAdjustmentGraph::updateRigEdgesToTheGraph(const sfmData::
 
 unsigned int LocalBundleAdjustmentGraph::countNodes() const
 {
-  unsigned int count = 0;
-  for(lemon::ListGraph::NodeIt n(_graph); n != lemon::INVALID; ++n)
-    ++count;
-  return count;
+  return static_cast<unsigned int>(_nodePerViewId.size());
 }
 
 unsigned int LocalBundleAdjustmentGraph::countEdges() const
 {
-  unsigned int count = 0;
-  for(lemon::ListGraph::EdgeIt e(_graph); e != lemon::INVALID; ++e)
-    ++count;
-  return count;
+  return static_cast<unsigned int>(_edges.size() - _nbRemovedEdges);
+}
+
+void LocalBundleAdjustmentGraph::addNode(IndexT viewId, IndexT poseId)
+{
+  const NodeIndex node = static_cast<NodeIndex>(_viewIdPerNode.size());
+
+  _viewIdPerNode.push_back(viewId);
+  _poseIdPerNode.push_back(poseId);
+  _appendedEdgesPerNode.emplace_back();
+  _distancePerNode.push_back(-1);
+  _visitedPerNode.push_back(false);
+  _nodePerViewId[viewId] = node;
+  _nodesPerPoseId[poseId].push_back(node);
+}
+
+LocalBundleAdjustmentGraph::EdgeIndex LocalBundleAdjustmentGraph::addEdge(IndexT viewIdA, IndexT viewIdB)
+{
+  const EdgeIndex edgeId = static_cast<EdgeIndex>(_edges.size());
+
+  GraphEdge edge;
+  edge.nodeA = _nodePerViewId.at(viewIdA);
+  edge.nodeB = _nodePerViewId.at(viewIdB);
+  _edges.push_back(edge);
+
+  _appendedEdgesPerNode[edge.nodeA].push_back(edgeId);
+  if(edge.nodeB != edge.nodeA)
+    _appendedEdgesPerNode[edge.nodeB].push_back(edgeId);
+
+  return edgeId;
+}
+
+void LocalBundleAdjustmentGraph::removeEdge(EdgeIndex edgeId)
+{
+  GraphEdge& edge = _edges.at(edgeId);
+  if(edge.removed)
+    return; // already removed with one of its nodes
+  edge.removed = true;
+  ++_nbRemovedEdges;
+}
+
+void LocalBundleAdjustmentGraph::compressGraph()
+{
+  const NodeIndex invalidNode = std::numeric_limits<NodeIndex>::max();
+  const EdgeIndex invalidEdge = std::numeric_limits<EdgeIndex>::max();
+
+  // renumber the valid nodes
+  std::vector<NodeIndex> newIndexPerNode(_viewIdPerNode.size(), invalidNode);
+  std::vector<IndexT> viewIdPerNode;
+  std::vector<IndexT> poseIdPerNode;
+  viewIdPerNode.reserve(_nodePerViewId.size());
+  poseIdPerNode.reserve(_nodePerViewId.size());
+
+  for(NodeIndex n = 0; n < _viewIdPerNode.size(); ++n)
+  {
+    if(_viewIdPerNode[n] == UndefinedIndexT)
+      continue;
+    newIndexPerNode[n] = static_cast<NodeIndex>(viewIdPerNode.size());
+    viewIdPerNode.push_back(_viewIdPerNode[n]);
+    poseIdPerNode.push_back(_poseIdPerNode[n]);
+  }
+
+  // renumber the valid edges
+  std::vector<EdgeIndex> newIndexPerEdge(_edges.size(), invalidEdge);
+  std::vector<GraphEdge> edges;
+  edges.reserve(_edges.size() - _nbRemovedEdges);
+
+  for(EdgeIndex e = 0; e < _edges.size(); ++e)
+  {
+    const GraphEdge& edge = _edges[e];
+    if(edge.removed)
+      continue;
+    assert(newIndexPerNode[edge.nodeA] != invalidNode && newIndexPerNode[edge.nodeB] != invalidNode);
+
+    GraphEdge newEdge;
+    newEdge.nodeA = newIndexPerNode[edge.nodeA];
+    newEdge.nodeB = newIndexPerNode[edge.nodeB];
+    newIndexPerEdge[e] = static_cast<EdgeIndex>(edges.size());
+    edges.push_back(newEdge);
+  }
+
+  const auto remapEdges = [&](std::map<IndexT, std::vector<EdgeIndex>>& edgesPerId)
+  {
+    for(auto it = edgesPerId.begin(); it != edgesPerId.end();)
+    {
+      std::vector<EdgeIndex> newEdgeIds;
+      for(const EdgeIndex edgeId : it->second)
+      {
+        if(newIndexPerEdge[edgeId] != invalidEdge)
+          newEdgeIds.push_back(newIndexPerEdge[edgeId]);
+      }
+      if(newEdgeIds.empty())
+      {
+        it = edgesPerId.erase(it);
+      }
+      else
+      {
+        it->second.swap(newEdgeIds);
+        ++it;
+      }
+    }
+  };
+
+  remapEdges(_intrinsicEdgesId);
+  remapEdges(_rigEdgesId);
+
+  for(auto& viewNode : _nodePerViewId)
+    viewNode.second = newIndexPerNode[viewNode.second];
+
+  _nodesPerPoseId.clear();
+  for(NodeIndex n = 0; n < poseIdPerNode.size(); ++n)
+    _nodesPerPoseId[poseIdPerNode[n]].push_back(n);
+
+  _viewIdPerNode.swap(viewIdPerNode);
+  _poseIdPerNode.swap(poseIdPerNode);
+  _edges.swap(edges);
+  _nbRemovedEdges = 0;
+
+  // build the compressed adjacency
+  const std::size_t nbNodes = _viewIdPerNode.size();
+
+  _adjacencyOffsets.assign(nbNodes + 1, 0);
+  for(const GraphEdge& edge : _edges)
+  {
+    ++_adjacencyOffsets[edge.nodeA + 1];
+    if(edge.nodeB != edge.nodeA)
+      ++_adjacencyOffsets[edge.nodeB + 1];
+  }
+  for(std::size_t n = 0; n < nbNodes; ++n)
+    _adjacencyOffsets[n + 1] += _adjacencyOffsets[n];
+
+  _adjacency.resize(_adjacencyOffsets[nbNodes]);
+  std::vector<std::size_t> cursors(_adjacencyOffsets.begin(), _adjacencyOffsets.end() - 1);
+  for(EdgeIndex e = 0; e < _edges.size(); ++e)
+  {
+    const GraphEdge& edge = _edges[e];
+    _adjacency[cursors[edge.nodeA]++] = e;
+    if(edge.nodeB != edge.nodeA)
+      _adjacency[cursors[edge.nodeB]++] = e;
+  }
+
+  _appendedEdgesPerNode.assign(nbNodes, std::vector<EdgeIndex>());
+  _distancePerNode.assign(nbNodes, -1);
+  _visitedPerNode.assign(nbNodes, false);
+  _nbCompressedNodes = nbNodes;
+  _nbCompressedEdges = _edges.size();
+}
+
+bool LocalBundleAdjustmentGraph::isConnectedToReachedNode(NodeIndex node)
+{
+  std::vector<NodeIndex> visitedNodes(1, node); // the first nodes remain to be visited
+  std::size_t nbVisitedNodes = 0;
+  _visitedPerNode[node] = true;
+
+  bool reached = false;
+  while(!reached && nbVisitedNodes < visitedNodes.size())
+  {
+    const NodeIndex current = visitedNodes[nbVisitedNodes++];
+
+    forEachIncidentEdge(current, [&](EdgeIndex, NodeIndex neighbor)
+    {
+      if(_distancePerNode[neighbor] >= 0)
+      {
+        reached = true;
+      }
+      else if(!_visitedPerNode[neighbor])
+      {
+        _visitedPerNode[neighbor] = true;
+        visitedNodes.push_back(neighbor);
+      }
+    });
+  }
+
+  // reset the visit marks for the next search
+  for(const NodeIndex visitedNode : visitedNodes)
+    _visitedPerNode[visitedNode] = false;
+
+  return reached;
 }
 
 } // namespace sfm
 } // namespace aliceVision
+
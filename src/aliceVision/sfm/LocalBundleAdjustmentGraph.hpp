@@ -10,6 +10,10 @@
 #include <aliceVision/track/Track.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 namespace aliceVision {
 
 namespace sfmData {
@@ -168,6 +172,8 @@ public:
   /**
    * @brief Compute the intragraph-distance between all the nodes of the graph (posed views) and the newly resected views.
    * @details The graph-distances are computed using a Breadth-first Search (BFS) method.
+   * The search stops at the distance D+1 (\c _graphDistanceLimit + 1): further views are considered as not connected,
+   * as they are ignored by the Local BA in both cases.
    * @param[in] sfmData contains all the information about the reconstruction, notably the posed views
    * @param[in] newReconstructedViews The list of the newly resected views used (used as source in the BFS algorithm)
    */
@@ -204,18 +210,89 @@ public:
   std::size_t updateRigEdgesToTheGraph(const sfmData::SfMData& sfmData);
 
   /**
-   * @brief Count and return the number of nodes in the underlying lemon graph.
+   * @brief Count and return the number of nodes in the graph.
    * @return The number of nodes in the graph.
    */
   unsigned int countNodes() const;
 
   /**
-   * @brief Count and return the number of edges in the underlying lemon graph.
+   * @brief Count and return the number of edges in the graph.
+   * @note Multiple edges between two nodes are counted separately.
    * @return The number of edges in the graph.
    */
   unsigned int countEdges() const;
 
 private:
+
+  using NodeIndex = std::uint32_t;
+  using EdgeIndex = std::uint32_t;
+
+  struct GraphEdge
+  {
+    NodeIndex nodeA;
+    NodeIndex nodeB;
+    bool removed = false;
+  };
+
+  /**
+   * @brief Add a node to the graph.
+   * @param[in] viewId The view index of the new node
+   * @param[in] poseId The pose index of the new node
+   */
+  void addNode(IndexT viewId, IndexT poseId);
+
+  /**
+   * @brief Add an edge to the graph, without updating the compressed adjacency.
+   * @param[in] viewIdA The view index of the first node
+   * @param[in] viewIdB The view index of the second node
+   * @return The edge index
+   */
+  EdgeIndex addEdge(IndexT viewIdA, IndexT viewIdB);
+
+  /**
+   * @brief Flag an edge as removed.
+   * @param[in] edgeId The edge index
+   */
+  void removeEdge(EdgeIndex edgeId);
+
+  /**
+   * @brief Call \p func for each valid edge incident to the given node.
+   * @param[in] node The node index
+   * @param[in] func The function to call with the edge index and the opposite node index
+   */
+  template<typename Func>
+  void forEachIncidentEdge(NodeIndex node, Func func) const
+  {
+    if(node < _nbCompressedNodes)
+    {
+      for(std::size_t i = _adjacencyOffsets[node]; i < _adjacencyOffsets[node + 1]; ++i)
+      {
+        const GraphEdge& edge = _edges[_adjacency[i]];
+        if(!edge.removed)
+          func(_adjacency[i], edge.nodeA == node ? edge.nodeB : edge.nodeA);
+      }
+    }
+    for(const EdgeIndex edgeId : _appendedEdgesPerNode[node])
+    {
+      const GraphEdge& edge = _edges[edgeId];
+      if(!edge.removed)
+        func(edgeId, edge.nodeA == node ? edge.nodeB : edge.nodeA);
+    }
+  }
+
+  /**
+   * @brief Rebuild the compressed adjacency (CSR) of the graph.
+   * @details Removed nodes and edges are dropped: node and edge indexes are renumbered.
+   */
+  void compressGraph();
+
+  /**
+   * @brief Check if a node is connected to a node reached by the last graph-distances computation.
+   * @details Only the nodes of the search are visited: its cost does not depend on the graph size.
+   * @param[in] node The node index
+   * @return true if a reached node can be found from the given node
+   */
+  bool isConnectedToReachedNode(NodeIndex node);
   
   /**
    * @brief Return the distance between a specific pose and the new posed views.
@@ -313,17 +390,44 @@ private:
   // - Local BA needs to know the distance of all the old posed views to the new resected views.
   // - The bundle adjustment will be processed on the closest poses only.
 
-  /// A graph where nodes are poses and an edge exists when 2 poses shared at least 'kMinNbOfMatches' matches.
-  lemon::ListGraph _graph; 
+  // A graph where nodes are posed views and an edge exists when 2 views shared at least 'kMinNbOfMatches' matches.
+  // - the adjacency is stored in a compressed sparse row (CSR) structure, completed by per-node lists
+  //   for the edges added since the last compression.
+  // - removed nodes and edges are flagged and dropped at the next compression.
+
   /// The graph-distance limit setting the Active region (default value: 1)
   std::size_t _graphDistanceLimit = 1;
   /// Associates each view (indexed by its viewId) to its corresponding node in the graph.
-  std::map<IndexT, lemon::ListGraph::Node> _nodePerViewId;
-  /// Associates each node (in the graph) to its corresponding view.
-  std::map<lemon::ListGraph::Node, IndexT> _viewIdPerNode;
-  /// Store the graph-distances from the new views (0: is a new view, -1: is not connected to the new views)
+  std::unordered_map<IndexT, NodeIndex> _nodePerViewId;
+  /// Associates each node (in the graph) to its corresponding view (UndefinedIndexT if removed).
+  std::vector<IndexT> _viewIdPerNode;
+  /// Associates each node (in the graph) to the pose of its corresponding view.
+  std::vector<IndexT> _poseIdPerNode;
+  /// Associates each pose to the nodes of its views.
+  std::unordered_map<IndexT, std::vector<NodeIndex>> _nodesPerPoseId;
+  /// All the edges of the graph, indexed by edge id.
+  std::vector<GraphEdge> _edges;
+  /// Number of edges flagged as removed in \c _edges.
+  std::size_t _nbRemovedEdges = 0;
+  /// Number of nodes in the compressed adjacency.
+  std::size_t _nbCompressedNodes = 0;
+  /// Number of edges in the compressed adjacency.
+  std::size_t _nbCompressedEdges = 0;
+  /// Compressed adjacency: incident edges of the node i are in [_adjacencyOffsets[i], _adjacencyOffsets[i+1][.
+  std::vector<std::size_t> _adjacencyOffsets;
+  /// Compressed adjacency: incident edge ids.
+  std::vector<EdgeIndex> _adjacency;
+  /// Incident edges added to each node since the last compression.
+  std::vector<std::vector<EdgeIndex>> _appendedEdgesPerNode;
+  /// Graph-distance of each node computed by the last BFS (-1: not reached), reset after use.
+  std::vector<int> _distancePerNode;
+  /// Visit mark of each node used by isConnectedToReachedNode, reset after use.
+  std::vector<bool> _visitedPerNode;
+  /// Store the graph-distances from the new views (0: is a new view)
+  /// @note only the views up to the distance D+1 are stored, other views are considered as not connected (-1).
   std::map<IndexT, int> _distancePerViewId;
-  /// Store the graph-distances from the new poses (0: is a new pose, -1: is not connected to the new poses)
+  /// Store the graph-distances from the new poses (0: is a new pose)
+  /// @note only the poses up to the distance D+1 are stored, other poses are considered as not connected (-1).
   std::map<IndexT, int> _distancePerPoseId;
   /// Store the \c EParameterState of each pose in the scene.
   std::map<IndexT, BundleAdjustment::EParameterState> _statePerPoseId;
@@ -365,16 +469,16 @@ private:
   std::map<IndexT, bool> _mapFocalIsConstant;
 
   /**
-   * @brief Store the Lemon index of the edges added for the intrinsic links "the intrinsic-edges"
+   * @brief Store the index of the edges added for the intrinsic links "the intrinsic-edges"
    * <IntrinsicId, [edgeId]>
    */
-  std::map<IndexT, std::vector<int>> _intrinsicEdgesId;
+  std::map<IndexT, std::vector<EdgeIndex>> _intrinsicEdgesId;
 
   /**
-   * @brief Store the Lemon index of the edges added for the rig links "the intrinsic-edges"
+   * @brief Store the index of the edges added for the rig links "the rig-edges"
    * <rigId, [edgeId]>
    */
-  std::map<IndexT, std::vector<int>> _rigEdgesId;
+  std::map<IndexT, std::vector<EdgeIndex>> _rigEdgesId;
 };
 
 } // namespace sfm
@@ -0,0 +1,122 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/camera.hpp>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#define BOOST_TEST_MODULE localBundleAdjustmentGraph
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+using EState = BundleAdjustment::EParameterState;
+
+// Test summary:
+// - Build a small scene whose views graph has two connected components:
+//   - a chain of views 0-1-2-3-4, view 7 connected to view 1
+//   - a pair of views 5-6
+//   - the views 1 and 4 share a pose, the views 2 and 6 share a pose
+// - Compute the graph distances from a new view of each component
+// - Assert that the poses states follow the distances between the poses and the new views:
+//   - a pose is as close as its closest view, even if another view is beyond the distance limit
+//   - a pose with a view not connected to the new views is ignored
+
+/**
+ * @brief Build the test scene
+ * @param[out] sfmData the scene, with one locked intrinsic (no intrinsic edges in the graph)
+ * @param[out] tracksPerView the tracks of each view, one landmark per views graph edge
+ */
+void getDisconnectedScene(SfMData& sfmData, track::TracksPerView& tracksPerView)
+{
+  auto intrinsic = std::make_shared<camera::Pinhole>(1000, 1000, 1000.0, 500.0, 500.0);
+  intrinsic->lock();
+  sfmData.intrinsics[0] = intrinsic;
+
+  const std::map<IndexT, IndexT> poseIdPerViewId = {{0, 0}, {1, 10}, {2, 20}, {3, 3}, {4, 10}, {5, 5}, {6, 20}, {7, 7}};
+  for(const auto& viewPose : poseIdPerViewId)
+  {
+    sfmData.views[viewPose.first] = std::make_shared<View>("", viewPose.first, 0, viewPose.second, 1000, 1000);
+    sfmData.setPose(*sfmData.views.at(viewPose.first), CameraPose());
+    tracksPerView[viewPose.first];
+  }
+
+  const std::vector<std::pair<IndexT, IndexT>> edges = {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {1, 7}, {5, 6}};
+  for(std::size_t trackId = 0; trackId < edges.size(); ++trackId)
+  {
+    Landmark landmark(feature::EImageDescriberType::UNKNOWN);
+    landmark.observations[edges.at(trackId).first] = Observation(Vec2(0.0, 0.0), trackId);
+    landmark.observations[edges.at(trackId).second] = Observation(Vec2(0.0, 0.0), trackId);
+    sfmData.structure[trackId] = landmark;
+
+    tracksPerView[edges.at(trackId).first].push_back(trackId);
+    tracksPerView[edges.at(trackId).second].push_back(trackId);
+  }
+}
+
+void checkPoseStates(const LocalBundleAdjustmentGraph& graph, const std::map<IndexT, EState>& expectedStatePerPoseId)
+{
+  for(const auto& poseState : expectedStatePerPoseId)
+  {
+    BOOST_TEST_CONTEXT("pose " << poseState.first)
+    {
+      BOOST_CHECK(graph.getPoseState(poseState.first) == poseState.second);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(LOCAL_BUNDLE_ADJUSTMENT_GRAPH_DisconnectedPoses)
+{
+  SfMData sfmData;
+  track::TracksPerView tracksPerView;
+  getDisconnectedScene(sfmData, tracksPerView);
+
+  LocalBundleAdjustmentGraph graph(sfmData);
+  graph.setGraphDistanceLimit(1);
+  graph.updateGraphWithNewViews(sfmData, tracksPerView, {});
+
+  // distances from the view 0: {0: 0, 1: 1, 7: 2, 2: 2, 3: 3, 4: 4}, the views 5 and 6 are not connected
+  graph.computeGraphDistances(sfmData, {0});
+  graph.convertDistancesToStates(sfmData);
+
+  checkPoseStates(graph, {{0, EState::REFINED},   // distance 0
+                          {10, EState::REFINED},  // views at the distances 1 and 4
+                          {7, EState::CONSTANT},  // distance 2
+                          {20, EState::IGNORED},  // views at the distance 2 and not connected
+                          {3, EState::IGNORED},   // distance 3
+                          {5, EState::IGNORED}}); // not connected
+
+  // the next computation is independent of the previous one
+  graph.computeGraphDistances(sfmData, {5});
+  graph.convertDistancesToStates(sfmData);
+
+  checkPoseStates(graph, {{5, EState::REFINED},   // distance 0
+                          {20, EState::IGNORED},  // views at the distance 1 and not connected
+                          {0, EState::IGNORED},
+                          {10, EState::IGNORED},
+                          {7, EState::IGNORED},
+                          {3, EState::IGNORED}});
+
+  // a larger distance limit reaches the view 4
+  graph.setGraphDistanceLimit(3);
+  graph.computeGraphDistances(sfmData, {0});
+  graph.convertDistancesToStates(sfmData);
+
+  checkPoseStates(graph, {{0, EState::REFINED},
+                          {10, EState::REFINED},
+                          {7, EState::REFINED},
+                          {20, EState::IGNORED},
+                          {3, EState::REFINED},
+                          {5, EState::IGNORED}});
+}
@@ -10,6 +10,7 @@
 #include <aliceVision/graph/graph.hpp>
 #include <aliceVision/multiview/rotationAveraging/rotationAveraging.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <dependencies/histogram/histogram.hpp>
 
@@ -178,16 +179,15 @@ void GlobalSfMRotationAveragingSolver::TripletRotationRejection(
   std::vector< graph::Triplet > vec_triplets_validated;
   vec_triplets_validated.reserve(vec_triplets.size());
 
-  std::vector<float> vec_errToIdentityPerTriplet;
-  vec_errToIdentityPerTriplet.reserve(vec_triplets.size());
+  std::vector<float> vec_errToIdentityPerTriplet(vec_triplets.size());
+
   // Compute the composition error for each length 3 cycles
-  for (size_t i = 0; i < vec_triplets.size(); ++i)
+  #pragma omp parallel for
+  for (int i = 0; i < vec_triplets.size(); ++i)
   {
     const graph::Triplet & triplet = vec_triplets[i];
     const IndexT I = triplet.i, J = triplet.j , K = triplet.k;
 
-    ALICEVISION_LOG_DEBUG("GlobalSfMRotationAveragingSolver::TripletRotationRejection: i: " << i << ", (" << I << ", " << J << ", " << K << ").");
-
     //-- Find the three relative rotations
     const Pair ij(I,J), ji(J,I);
     const Mat3 RIJ = (map_relatives.count(ij)) ?
@@ -202,8 +202,18 @@ void GlobalSfMRotationAveragingSolver::TripletRotationRejection(
       map_relatives.at(ki).Rij : Mat3(map_relatives.at(ik).Rij.transpose());
 
     const Mat3 Rot_To_Identity = RIJ * RJK * RKI; // motion composition
-    const float angularErrorDegree = static_cast<float>(radianToDegree(getRotationMagnitude(Rot_To_Identity)));
-    vec_errToIdentityPerTriplet.push_back(angularErrorDegree);
+    vec_errToIdentityPerTriplet[i] = static_cast<float>(radianToDegree(getRotationMagnitude(Rot_To_Identity)));
+  }
+
+  // Keep the relative rotations of the valid triplets
+  for (size_t i = 0; i < vec_triplets.size(); ++i)
+  {
+    const graph::Triplet & triplet = vec_triplets[i];
+    const IndexT I = triplet.i, J = triplet.j , K = triplet.k;
+    const Pair ij(I,J), ji(J,I);
+    const Pair jk(J,K), kj(K,J);
+    const Pair ki(K,I), ik(I,K);
+    const float angularErrorDegree = vec_errToIdentityPerTriplet[i];
 
     if (angularErrorDegree < max_angular_error)
     {
@@ -11,7 +11,6 @@
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
 #include <aliceVision/sfm/pipeline/global/reindexGlobalSfM.hpp>
-#include <aliceVision/sfm/pipeline/global/MutexSet.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/multiview/translationAveraging/common.hpp>
 #include <aliceVision/multiview/translationAveraging/solver.hpp>
@@ -32,6 +31,10 @@
 
 #include <boost/progress.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 namespace aliceVision {
 namespace sfm {
 
@@ -297,6 +300,24 @@ void GlobalSfMTranslationAveragingSolver::Compute_translations(const SfMData& sf
     tripletWise_matches);
 }
 
+void GlobalSfMTranslationAveragingSolver::getTripletMatches(const PosePairMatches& posePairMatches,
+  const graph::Triplet& triplet,
+  matching::PairwiseMatches& tripletMatches)
+{
+  // triplet pose ids are sorted: edges are (i,j), (i,k), (j,k)
+  const Pair edges[3] = {Pair(triplet.i, triplet.j), Pair(triplet.i, triplet.k), Pair(triplet.j, triplet.k)};
+
+  for (const Pair& edge : edges)
+  {
+    const auto it = posePairMatches.find(edge);
+    if (it == posePairMatches.end())
+      continue;
+
+    for (const auto& match_iterator : it->second)
+      tripletMatches.insert(*match_iterator);
+  }
+}
+
 //-- Perform a trifocal estimation of the graph contained in vec_triplets with an
 // edge coverage algorithm. Its complexity is sub-linear in term of edges count.
 void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCoverage(const SfMData & sfmData,
@@ -320,9 +341,11 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
   std::transform(map_globalR.begin(), map_globalR.end(),
     std::inserter(set_pose_ids, set_pose_ids.begin()), stl::RetrieveKey());
   // List shared correspondences (pairs) between poses
-  for (const auto & match_iterator : pairwiseMatches)
+  // and index the matches per pose pair, so the matches of a triplet are retrieved without scanning all the pairs
+  PosePairMatches posePairMatches;
+  for (auto match_iterator = pairwiseMatches.begin(); match_iterator != pairwiseMatches.end(); ++match_iterator)
   {
-    const Pair pair = match_iterator.first;
+    const Pair pair = match_iterator->first;
     const View * v1 = sfmData.getViews().at(pair.first).get();
     const View * v2 = sfmData.getViews().at(pair.second).get();
 
@@ -333,6 +356,9 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
     {
       rotation_pose_id_graph.insert(
         std::make_pair(v1->getPoseId(), v2->getPoseId()));
+
+      const Pair posePair = std::minmax(v1->getPoseId(), v2->getPoseId());
+      posePairMatches[posePair].push_back(match_iterator);
     }
   }
   // List putative triplets (from global rotations Ids)
@@ -346,38 +372,20 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
     // An estimated triplets of translation mark three edges as estimated.
 
     //-- precompute the number of track per triplet:
-    HashMap<IndexT, IndexT> map_tracksPerTriplets;
+    std::vector<std::size_t> vec_tracksPerTriplets(vec_triplets.size(), 0);
 
     #pragma omp parallel for schedule(dynamic)
     for (int i = 0; i < (int)vec_triplets.size(); ++i)
     {
       // List matches that belong to the triplet of poses
-      const graph::Triplet & triplet = vec_triplets[i];
       matching::PairwiseMatches map_triplet_matches;
-      const std::set<IndexT> set_triplet_pose_ids = {triplet.i, triplet.j, triplet.k};
-      // List shared correspondences (pairs) between the triplet poses
-      for (const auto & match_iterator : pairwiseMatches)
-      {
-        const Pair pair = match_iterator.first;
-        const View * v1 = sfmData.getViews().at(pair.first).get();
-        const View * v2 = sfmData.getViews().at(pair.second).get();
-        if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-            (v1->getPoseId() != v2->getPoseId())
-            && set_triplet_pose_ids.count(v1->getPoseId())
-            && set_triplet_pose_ids.count(v2->getPoseId()))
-        {
-          map_triplet_matches.insert( match_iterator );
-        }
-      }
-      // Compute tracks:
-      {
-        aliceVision::track::TracksBuilder tracksBuilder;
-        tracksBuilder.build(map_triplet_matches);
-        tracksBuilder.filter(3);
+      getTripletMatches(posePairMatches, vec_triplets[i], map_triplet_matches);
 
-        #pragma omp critical
-        map_tracksPerTriplets[i] = tracksBuilder.nbTracks(); //count the # of matches in the UF tree
-      }
+      // Compute tracks:
+      aliceVision::track::TracksBuilder tracksBuilder;
+      tracksBuilder.build(map_triplet_matches);
+      tracksBuilder.filter(3);
+      vec_tracksPerTriplets[i] = tracksBuilder.nbTracks(); //count the # of matches in the UF tree
     }
 
     typedef Pair myEdge;
@@ -396,26 +404,50 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
     std::vector<myEdge > vec_edges;
     std::transform(map_tripletIds_perEdge.begin(), map_tripletIds_perEdge.end(), std::back_inserter(vec_edges), stl::RetrieveKey());
 
-    aliceVision::sfm::MutexSet<myEdge> m_mutexSet;
+    // estimated state per edge (vec_edges is sorted)
+    std::unique_ptr<std::atomic<bool>[]> vec_edgeEstimated(new std::atomic<bool>[vec_edges.size()]);
+    for (std::size_t k = 0; k < vec_edges.size(); ++k)
+      vec_edgeEstimated[k] = false;
+    std::atomic<std::size_t> nbEstimatedEdges(0);
+
+    const auto isEstimated = [&](const myEdge & edge) -> bool
+    {
+      const auto it = std::lower_bound(vec_edges.begin(), vec_edges.end(), edge);
+      return vec_edgeEstimated[std::distance(vec_edges.begin(), it)];
+    };
+    const auto setEstimated = [&](const myEdge & edge)
+    {
+      const auto it = std::lower_bound(vec_edges.begin(), vec_edges.end(), edge);
+      if (!vec_edgeEstimated[std::distance(vec_edges.begin(), it)].exchange(true))
+        ++nbEstimatedEdges;
+    };
 
     boost::progress_display my_progress_bar(
       vec_edges.size(),
       std::cout,
       "\nRelative translations computation (edge coverage algorithm)\n");
+    std::atomic<std::size_t> nbProcessedEdges(0);
 
-    // set number of threads, 1 if openMP is not enabled  
+    // set number of threads, 1 if openMP is not enabled
+    // estimates and matches are accumulated per thread and merged at the end
     std::vector<translationAveraging::RelativeInfoVec> initial_estimates(omp_get_max_threads());
+    std::vector<matching::PairwiseMatches> newpairMatchesPerThread(omp_get_max_threads());
     const bool bVerbose = false;
 
     #pragma omp parallel for schedule(dynamic)
     for (int k = 0; k < vec_edges.size(); ++k)
     {
       const myEdge & edge = vec_edges[k];
-      #pragma omp critical
+
+      // only the master thread updates the progress bar
+      ++nbProcessedEdges;
+      if (omp_get_thread_num() == 0)
       {
-        ++my_progress_bar;
+        while (my_progress_bar.count() < nbProcessedEdges)
+          ++my_progress_bar;
       }
-      if (m_mutexSet.count(edge) == 0 && m_mutexSet.size() != vec_edges.size())
+
+      if (!vec_edgeEstimated[k] && nbEstimatedEdges != vec_edges.size())
       {
         // Find the triplets that support the given edge
         const auto & vec_possibleTripletIndexes = map_tripletIds_perEdge.at(edge);
@@ -424,7 +456,7 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
         std::vector<size_t> vec_commonTracksPerTriplets;
         for (const size_t triplet_index : vec_possibleTripletIndexes)
         {
-          vec_commonTracksPerTriplets.push_back(map_tracksPerTriplets[triplet_index]);
+          vec_commonTracksPerTriplets.push_back(vec_tracksPerTriplets[triplet_index]);
         }
 
         using namespace stl::indexed_sort;
@@ -442,9 +474,9 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
           const graph::Triplet & triplet = vec_triplets[triplet_index];
 
           // If the triplet is already estimated by another thread; try the next one
-          if (m_mutexSet.count(Pair(triplet.i, triplet.j)) &&
-              m_mutexSet.count(Pair(triplet.i, triplet.k)) &&
-              m_mutexSet.count(Pair(triplet.j, triplet.k)))
+          if (isEstimated(Pair(triplet.i, triplet.j)) &&
+              isEstimated(Pair(triplet.i, triplet.k)) &&
+              isEstimated(Pair(triplet.j, triplet.k)))
           {
             break;
           }
@@ -458,12 +490,15 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
           std::vector<size_t> vec_inliers;
           aliceVision::track::TracksMap pose_triplet_tracks;
 
+          matching::PairwiseMatches map_triplet_matches;
+          getTripletMatches(posePairMatches, triplet, map_triplet_matches);
+
           const std::string sOutDirectory = "./";
           const bool bTriplet_estimation = Estimate_T_triplet(
               sfmData,
               map_globalR,
               normalizedFeaturesPerView,
-              pairwiseMatches,
+              map_triplet_matches,
               triplet,
               vec_tis,
               dPrecision,
@@ -474,9 +509,9 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
           if (bTriplet_estimation)
           {
             // Since new translation edges have been computed, mark their corresponding edges as estimated
-            m_mutexSet.insert(std::make_pair(triplet.i, triplet.j));
-            m_mutexSet.insert(std::make_pair(triplet.j, triplet.k));
-            m_mutexSet.insert(std::make_pair(triplet.i, triplet.k));
+            setEstimated(std::make_pair(triplet.i, triplet.j));
+            setEstimated(std::make_pair(triplet.j, triplet.k));
+            setEstimated(std::make_pair(triplet.i, triplet.k));
 
             // Compute the triplet relative motions (IJ, JK, IK)
             {
@@ -511,8 +546,7 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
               initial_estimates[thread_id].emplace_back(
                 std::make_pair(triplet.i, triplet.k), std::make_pair(Rik, tik));
 
-              //--- ATOMIC
-              #pragma omp critical
+              matching::PairwiseMatches & threadNewpairMatches = newpairMatchesPerThread[thread_id];
               {
                 // Add inliers as valid pairwise matches
                 for (std::vector<size_t>::const_iterator iterInliers = vec_inliers.begin();
@@ -543,7 +577,7 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
                       const size_t id_view_J = iter_J->first;
                       const size_t id_feat_J = iter_J->second;
 
-                      newpairMatches[std::make_pair(id_view_I, id_view_J)][track.descType].emplace_back(id_feat_I, id_feat_J);
+                      threadNewpairMatches[std::make_pair(id_view_I, id_view_J)][track.descType].emplace_back(id_feat_I, id_feat_J);
                     }
                   }
                 }
@@ -556,14 +590,31 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
         }
       }
     }
+    // finish the progress bar
+    while (my_progress_bar.count() < vec_edges.size())
+      ++my_progress_bar;
+
     // Merge thread estimates
-    for(const auto vec : initial_estimates)
+    for(const auto& vec : initial_estimates)
     {
-      for(const auto val : vec)
+      for(const auto& val : vec)
       {
         vec_initialEstimates.emplace_back(val);
       }
     }
+
+    // Merge thread matches
+    for(const auto& threadMatches : newpairMatchesPerThread)
+    {
+      for(const auto& pairMatches : threadMatches)
+      {
+        for(const auto& descMatches : pairMatches.second)
+        {
+          matching::IndMatches& matches = newpairMatches[pairMatches.first][descMatches.first];
+          matches.insert(matches.end(), descMatches.second.begin(), descMatches.second.end());
+        }
+      }
+    }
   }
 
 
@@ -584,7 +635,7 @@ bool GlobalSfMTranslationAveragingSolver::Estimate_T_triplet(
   const SfMData& sfmData,
   const HashMap<IndexT, Mat3>& map_globalR,
   const feature::FeaturesPerView& normalizedFeaturesPerView,
-  const matching::PairwiseMatches& pairwiseMatches,
+  const matching::PairwiseMatches& map_triplet_matches,
   const graph::Triplet& poses_id,
   std::vector<Vec3>& vec_tis,
   double& precision, // UpperBound of the precision found by the AContrario estimator
@@ -592,24 +643,6 @@ bool GlobalSfMTranslationAveragingSolver::Estimate_T_triplet(
   aliceVision::track::TracksMap& tracks,
   const std::string& outDirectory) const
 {
-  // List matches that belong to the triplet of poses
-  matching::PairwiseMatches map_triplet_matches;
-  const std::set<IndexT> set_pose_ids = {poses_id.i, poses_id.j, poses_id.k};
-  // List shared correspondences (pairs) between poses
-  for (const auto & match_iterator : pairwiseMatches)
-  {
-    const Pair& pair = match_iterator.first;
-    const View* v1 = sfmData.getViews().at(pair.first).get();
-    const View* v2 = sfmData.getViews().at(pair.second).get();
-    if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-        (v1->getPoseId() != v2->getPoseId())
-        && set_pose_ids.count(v1->getPoseId())
-        && set_pose_ids.count(v2->getPoseId()))
-    {
-      map_triplet_matches.insert( match_iterator );
-    }
-  }
-
   aliceVision::track::TracksBuilder tracksBuilder;
   tracksBuilder.build(map_triplet_matches);
   tracksBuilder.filter(3);
@@ -62,6 +62,9 @@ inline std::istream& operator>>(std::istream& in, ETranslationAveragingMethod& t
 
 class GlobalSfMTranslationAveragingSolver
 {
+  /// matches per pose pair (ordered pose ids)
+  typedef std::map<Pair, std::vector<matching::PairwiseMatches::const_iterator>> PosePairMatches;
+
   translationAveraging::RelativeInfoVec m_vec_initialRijTijEstimates;
 
 public:
@@ -100,13 +103,24 @@ private:
            translationAveraging::RelativeInfoVec& vec_initialEstimates,
            matching::PairwiseMatches& newpairMatches);
 
+  /**
+   * @brief List the matches that belong to a triplet of poses.
+   * @param[in] posePairMatches the matches per pose pair
+   * @param[in] triplet the triplet of poses (sorted pose ids)
+   * @param[out] tripletMatches the matches between the views of the triplet
+   */
+  static void getTripletMatches(const PosePairMatches& posePairMatches,
+           const graph::Triplet& triplet,
+           matching::PairwiseMatches& tripletMatches);
+
   /**
    * @brief Robust estimation and refinement of a translation and 3D points of an image triplets.
+   * @param[in] map_triplet_matches the matches between the views of the triplet
    */
   bool Estimate_T_triplet(const sfmData::SfMData& sfmData,
            const HashMap<IndexT, Mat3>& map_globalR,
            const feature::FeaturesPerView& normalizedFeaturesPerView,
-           const matching::PairwiseMatches& pairwiseMatches,
+           const matching::PairwiseMatches& map_triplet_matches,
            const graph::Triplet& poses_id,
            std::vector<Vec3>& vec_tis,
            double& precision, // UpperBound of the precision found by the AContrario estimator
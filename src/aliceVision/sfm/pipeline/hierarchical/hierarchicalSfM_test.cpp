@@ -0,0 +1,287 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/sfm/sfm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+
+#define BOOST_TEST_MODULE HIERARCHICAL_SFM
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+// Test summary:
+// - Partition the view graph of a synthetic ring dataset in overlapping clusters
+// - Split the ground truth scene in overlapping sub-reconstructions expressed
+//   in different coordinate systems and merge them
+// - Assert that:
+//   - all the views are part of a cluster, with overlap between the clusters
+//   - unsplittable subsets (a pose with most of the views, two poses) are kept as clusters
+//   - the merged poses and landmarks are the ground truth ones
+
+/**
+ * @brief Extract a sub-reconstruction with the given views
+ */
+SfMData getSubReconstruction(const SfMData& sfmData, const std::set<IndexT>& viewIds)
+{
+  SfMData subSfmData = sfmData;
+
+  for(auto it = subSfmData.views.begin(); it != subSfmData.views.end();)
+  {
+    if(viewIds.count(it->first))
+    {
+      ++it;
+      continue;
+    }
+    subSfmData.erasePose(it->second->getPoseId(), true);
+    it = subSfmData.views.erase(it);
+  }
+
+  for(auto it = subSfmData.structure.begin(); it != subSfmData.structure.end();)
+  {
+    Observations observations;
+    for(const auto& observationPair : it->second.observations)
+    {
+      if(viewIds.count(observationPair.first))
+        observations[observationPair.first] = observationPair.second;
+    }
+    it->second.observations = observations;
+
+    if(observations.size() < 2)
+      it = subSfmData.structure.erase(it);
+    else
+      ++it;
+  }
+  return subSfmData;
+}
+
+BOOST_AUTO_TEST_CASE(HIERARCHICAL_SFM_Partitioning)
+{
+  const int nviews = 40;
+  const int npoints = 32;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+  const SfMData sfmData = getInputScene(d, config, PINHOLE_CAMERA);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  ViewGraphPartitioningParams params;
+  params.maxClusterSize = 10;
+  params.overlapRatio = 0.2;
+  params.minOverlapSize = 3;
+
+  std::vector<std::set<IndexT>> clusters;
+  partitionViewGraph(sfmData, pairwiseMatches, params, clusters);
+
+  BOOST_CHECK_GE(clusters.size(), 4);
+
+  std::set<IndexT> clusteredViews;
+  for(std::size_t c = 0; c < clusters.size(); ++c)
+  {
+    clusteredViews.insert(clusters.at(c).begin(), clusters.at(c).end());
+    BOOST_CHECK_LE(clusters.at(c).size(), 2 * params.maxClusterSize);
+
+    // each cluster shares enough views with another one to be aligned
+    std::size_t maxNbCommonViews = 0;
+    for(std::size_t o = 0; o < clusters.size(); ++o)
+    {
+      if(o == c)
+        continue;
+      std::vector<IndexT> commonViews;
+      std::set_intersection(clusters.at(c).begin(), clusters.at(c).end(),
+                            clusters.at(o).begin(), clusters.at(o).end(),
+                            std::back_inserter(commonViews));
+      maxNbCommonViews = std::max(maxNbCommonViews, commonViews.size());
+    }
+    BOOST_CHECK_GE(maxNbCommonViews, params.minOverlapSize);
+  }
+  BOOST_CHECK_EQUAL(clusteredViews.size(), nviews);
+}
+
+BOOST_AUTO_TEST_CASE(HIERARCHICAL_SFM_Partitioning_Rig)
+{
+  const int nbPoses = 20;
+  const int npoints = 32;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nbPoses, npoints, config);
+  const SfMData sfmData = getInputRigScene(d, config, PINHOLE_CAMERA);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  ViewGraphPartitioningParams params;
+  params.maxClusterSize = 10;
+
+  std::vector<std::set<IndexT>> clusters;
+  partitionViewGraph(sfmData, pairwiseMatches, params, clusters);
+
+  BOOST_CHECK_GE(clusters.size(), 2);
+
+  // the views of a rig pose are always in the same cluster
+  for(const std::set<IndexT>& cluster : clusters)
+  {
+    for(const IndexT viewId : cluster)
+    {
+      for(const auto& viewPair : sfmData.getViews())
+      {
+        if(viewPair.second->getPoseId() == sfmData.getView(viewId).getPoseId())
+          BOOST_CHECK(cluster.count(viewPair.first));
+      }
+    }
+  }
+}
+
+/**
+ * @brief Build a scene with the given number of views per pose and matches between consecutive poses
+ */
+void getPoseChainScene(const std::vector<std::size_t>& nbViewsPerPose, SfMData& sfmData, matching::PairwiseMatches& pairwiseMatches)
+{
+  IndexT viewId = 0;
+  std::vector<IndexT> firstViewPerPose;
+
+  for(IndexT poseId = 0; poseId < nbViewsPerPose.size(); ++poseId)
+  {
+    firstViewPerPose.push_back(viewId);
+    for(std::size_t i = 0; i < nbViewsPerPose.at(poseId); ++i, ++viewId)
+      sfmData.views[viewId] = std::make_shared<View>("", viewId, 0, poseId);
+  }
+
+  matching::IndMatches matches;
+  for(IndexT i = 0; i < 50; ++i)
+    matches.emplace_back(i, i);
+
+  for(std::size_t poseId = 1; poseId < firstViewPerPose.size(); ++poseId)
+    pairwiseMatches[std::make_pair(firstViewPerPose.at(poseId - 1), firstViewPerPose.at(poseId))][feature::EImageDescriberType::UNKNOWN] = matches;
+}
+
+/**
+ * @brief Check that each view is in exactly one cluster and each pose is in a single cluster
+ */
+void checkPartition(const SfMData& sfmData, const std::vector<std::set<IndexT>>& clusters)
+{
+  std::map<IndexT, std::size_t> clusterPerPose;
+  std::size_t nbViews = 0;
+
+  for(std::size_t c = 0; c < clusters.size(); ++c)
+  {
+    BOOST_CHECK(!clusters.at(c).empty());
+    nbViews += clusters.at(c).size();
+    for(const IndexT viewId : clusters.at(c))
+    {
+      const auto it = clusterPerPose.emplace(sfmData.getView(viewId).getPoseId(), c).first;
+      BOOST_CHECK_EQUAL(it->second, c);
+    }
+  }
+  BOOST_CHECK_EQUAL(nbViews, sfmData.getViews().size());
+}
+
+BOOST_AUTO_TEST_CASE(HIERARCHICAL_SFM_Partitioning_HeavyNode)
+{
+  // one pose carries most of the views
+  SfMData sfmData;
+  matching::PairwiseMatches pairwiseMatches;
+  getPoseChainScene({1, 50, 1, 1, 1}, sfmData, pairwiseMatches);
+
+  ViewGraphPartitioningParams params;
+  params.maxClusterSize = 10;
+  params.overlapRatio = 0.0;
+  params.minOverlapSize = 0;
+
+  std::vector<std::set<IndexT>> clusters;
+  partitionViewGraph(sfmData, pairwiseMatches, params, clusters);
+
+  BOOST_CHECK_GE(clusters.size(), 2);
+  checkPartition(sfmData, clusters);
+
+  // the heavy pose cannot be split and is a cluster by itself
+  BOOST_CHECK(std::any_of(clusters.begin(), clusters.end(), [](const std::set<IndexT>& cluster) { return cluster.size() == 50; }));
+}
+
+BOOST_AUTO_TEST_CASE(HIERARCHICAL_SFM_Partitioning_TwoNodes)
+{
+  for(const std::vector<std::size_t>& nbViewsPerPose : {std::vector<std::size_t>{20, 20}, std::vector<std::size_t>{30, 1}, std::vector<std::size_t>{1, 30}})
+  {
+    SfMData sfmData;
+    matching::PairwiseMatches pairwiseMatches;
+    getPoseChainScene(nbViewsPerPose, sfmData, pairwiseMatches);
+
+    ViewGraphPartitioningParams params;
+    params.maxClusterSize = 10;
+    params.overlapRatio = 0.0;
+    params.minOverlapSize = 0;
+
+    std::vector<std::set<IndexT>> clusters;
+    partitionViewGraph(sfmData, pairwiseMatches, params, clusters);
+
+    BOOST_CHECK_EQUAL(clusters.size(), 2);
+    checkPartition(sfmData, clusters);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(HIERARCHICAL_SFM_Merging)
+{
+  const int nviews = 12;
+  const int npoints = 64;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+  const SfMData gtSfmData = getInputScene(d, config, PINHOLE_CAMERA);
+
+  std::vector<SfMData> reconstructions;
+  reconstructions.push_back(getSubReconstruction(gtSfmData, {0, 1, 2, 3, 4, 5, 6, 7, 8}));
+  reconstructions.push_back(getSubReconstruction(gtSfmData, {4, 5, 6, 7, 8, 9, 10, 11}));
+
+  // express the second sub-reconstruction in another coordinate system
+  {
+    const double S = 2.5;
+    const Mat3 R = Eigen::AngleAxisd(0.3, Vec3(0.2, 1.0, 0.1).normalized()).toRotationMatrix();
+    const Vec3 t(1.0, -2.0, 0.5);
+
+    SfMData& reconstruction = reconstructions.back();
+    for(auto& posePair : reconstruction.getPoses())
+      posePair.second.setTransform(posePair.second.getTransform().transformSRt(S, R, t));
+    for(auto& landmarkPair : reconstruction.getLandmarks())
+      landmarkPair.second.X = S * R * landmarkPair.second.X + t;
+  }
+
+  SfMData sfmData = gtSfmData;
+  sfmData.getPoses().clear();
+  sfmData.getLandmarks().clear();
+
+  ReconstructionMergingParams params;
+  BOOST_CHECK_EQUAL(mergeReconstructions(sfmData, reconstructions, params), 2);
+
+  BOOST_CHECK_EQUAL(sfmData.getPoses().size(), nviews);
+  for(const auto& posePair : gtSfmData.getPoses())
+  {
+    const geometry::Pose3& gtPose = posePair.second.getTransform();
+    const geometry::Pose3& pose = sfmData.getAbsolutePose(posePair.first).getTransform();
+    BOOST_CHECK_SMALL((gtPose.center() - pose.center()).norm(), 1e-6);
+    BOOST_CHECK_SMALL((gtPose.rotation() - pose.rotation()).norm(), 1e-6);
+  }
+
+  // landmarks observed in both sub-reconstructions are fused
+  BOOST_CHECK_EQUAL(sfmData.getLandmarks().size(), npoints);
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    const Landmark& landmark = landmarkPair.second;
+    BOOST_CHECK_EQUAL(landmark.observations.size(), nviews);
+
+    const IndexT featId = landmark.observations.begin()->second.id_feat;
+    BOOST_CHECK_SMALL((landmark.X - gtSfmData.getLandmarks().at(featId).X).norm(), 1e-6);
+  }
+}
@@ -0,0 +1,249 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "reconstructionMerging.hpp"
+#include <aliceVision/sfm/utils/alignment.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <tuple>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+/// observation key: describer type, view id, feature id
+using ObservationKey = std::tuple<feature::EImageDescriberType, IndexT, IndexT>;
+using LandmarkPerObservation = std::map<ObservationKey, IndexT>;
+
+/**
+ * @brief Apply a similarity to a reconstruction, rig sub-poses are scaled
+ */
+void transformReconstruction(sfmData::SfMData& sfmData, double S, const Mat3& R, const Vec3& t)
+{
+  for(auto& posePair : sfmData.getPoses())
+    posePair.second.setTransform(posePair.second.getTransform().transformSRt(S, R, t));
+
+  for(auto& rigPair : sfmData.getRigs())
+  {
+    for(IndexT subPoseId = 0; subPoseId < rigPair.second.getNbSubPoses(); ++subPoseId)
+    {
+      sfmData::RigSubPose& subPose = rigPair.second.getSubPose(subPoseId);
+      subPose.pose = geometry::Pose3(subPose.pose.rotation(), S * subPose.pose.center());
+    }
+  }
+
+  for(auto& landmarkPair : sfmData.getLandmarks())
+    landmarkPair.second.X = S * R * landmarkPair.second.X + t;
+
+  for(auto& landmarkPair : sfmData.getControlPoints())
+    landmarkPair.second.X = S * R * landmarkPair.second.X + t;
+}
+
+/**
+ * @brief Fuse landmarks: a landmark is fused with the first merged landmark sharing one of its observations,
+ *        otherwise it is added with a new id
+ */
+void fuseLandmarks(const sfmData::Landmarks& landmarks,
+                   sfmData::Landmarks& mergedLandmarks,
+                   LandmarkPerObservation& landmarkPerObservation,
+                   IndexT& nextLandmarkId,
+                   std::size_t& nbFusedLandmarks)
+{
+  for(const auto& landmarkPair : landmarks)
+  {
+    const sfmData::Landmark& landmark = landmarkPair.second;
+    IndexT mergedLandmarkId = UndefinedIndexT;
+
+    for(const auto& observationPair : landmark.observations)
+    {
+      const auto it = landmarkPerObservation.find(ObservationKey(landmark.descType, observationPair.first, observationPair.second.id_feat));
+      if(it != landmarkPerObservation.end())
+      {
+        mergedLandmarkId = it->second;
+        break;
+      }
+    }
+
+    if(mergedLandmarkId == UndefinedIndexT)
+    {
+      mergedLandmarkId = nextLandmarkId++;
+      mergedLandmarks[mergedLandmarkId] = landmark;
+
+      for(const auto& observationPair : landmark.observations)
+        landmarkPerObservation.emplace(ObservationKey(landmark.descType, observationPair.first, observationPair.second.id_feat), mergedLandmarkId);
+      continue;
+    }
+
+    ++nbFusedLandmarks;
+
+    // add the observations in the views not observing the merged landmark yet
+    sfmData::Landmark& mergedLandmark = mergedLandmarks.at(mergedLandmarkId);
+    for(const auto& observationPair : landmark.observations)
+    {
+      if(mergedLandmark.observations.count(observationPair.first))
+        continue;
+
+      mergedLandmark.observations[observationPair.first] = observationPair.second;
+      landmarkPerObservation.emplace(ObservationKey(landmark.descType, observationPair.first, observationPair.second.id_feat), mergedLandmarkId);
+    }
+  }
+}
+
+IndexT getNextLandmarkId(const sfmData::Landmarks& landmarks)
+{
+  IndexT nextLandmarkId = 0;
+  for(const auto& landmarkPair : landmarks)
+    nextLandmarkId = std::max(nextLandmarkId, landmarkPair.first + 1);
+  return nextLandmarkId;
+}
+
+/**
+ * @brief Fuse an aligned reconstruction in the merged scene.
+ *        Poses, intrinsics and rigs already estimated by a previous reconstruction are kept.
+ */
+void fuseReconstruction(const sfmData::SfMData& reconstruction,
+                        sfmData::SfMData& sfmData,
+                        std::set<IndexT>& mergedIntrinsics,
+                        std::set<IndexT>& mergedRigs,
+                        LandmarkPerObservation& landmarkPerObservation,
+                        LandmarkPerObservation& controlPointPerObservation)
+{
+  for(const auto& viewPair : reconstruction.getViews())
+  {
+    const sfmData::View& view = *viewPair.second;
+
+    if(!reconstruction.isPoseAndIntrinsicDefined(&view))
+      continue;
+
+    if(sfmData.getViews().find(view.getViewId()) == sfmData.getViews().end())
+      sfmData.views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
+
+    if(!sfmData.existsPose(view))
+      sfmData.setAbsolutePose(view.getPoseId(), reconstruction.getAbsolutePose(view.getPoseId()));
+
+    if(mergedIntrinsics.insert(view.getIntrinsicId()).second)
+      sfmData.intrinsics[view.getIntrinsicId()] = std::shared_ptr<camera::IntrinsicBase>(reconstruction.intrinsics.at(view.getIntrinsicId())->clone());
+
+    if(view.isPartOfRig() && mergedRigs.insert(view.getRigId()).second)
+      sfmData.getRigs()[view.getRigId()] = reconstruction.getRigs().at(view.getRigId());
+  }
+
+  std::size_t nbFusedLandmarks = 0;
+  std::size_t nbFusedControlPoints = 0;
+  IndexT nextLandmarkId = getNextLandmarkId(sfmData.getLandmarks());
+  IndexT nextControlPointId = getNextLandmarkId(sfmData.getControlPoints());
+
+  fuseLandmarks(reconstruction.getLandmarks(), sfmData.getLandmarks(), landmarkPerObservation, nextLandmarkId, nbFusedLandmarks);
+  fuseLandmarks(reconstruction.getControlPoints(), sfmData.getControlPoints(), controlPointPerObservation, nextControlPointId, nbFusedControlPoints);
+
+  ALICEVISION_LOG_DEBUG("\t- # fused landmarks: " << nbFusedLandmarks << " / " << reconstruction.getLandmarks().size());
+}
+
+} // namespace
+
+std::size_t mergeReconstructions(sfmData::SfMData& sfmData,
+                                 std::vector<sfmData::SfMData>& reconstructions,
+                                 const ReconstructionMergingParams& params)
+{
+  sfmData.getPoses().clear();
+  sfmData.getLandmarks().clear();
+  sfmData.getControlPoints().clear();
+
+  // the largest reconstruction defines the coordinate system
+  std::size_t referenceIndex = reconstructions.size();
+  std::size_t referenceNbPoses = 0;
+
+  for(std::size_t i = 0; i < reconstructions.size(); ++i)
+  {
+    if(reconstructions[i].getPoses().size() > referenceNbPoses)
+    {
+      referenceIndex = i;
+      referenceNbPoses = reconstructions[i].getPoses().size();
+    }
+  }
+
+  if(referenceIndex == reconstructions.size())
+  {
+    ALICEVISION_LOG_WARNING("No sub-reconstruction to merge.");
+    return 0;
+  }
+
+  std::set<IndexT> mergedIntrinsics;
+  std::set<IndexT> mergedRigs;
+  LandmarkPerObservation landmarkPerObservation;
+  LandmarkPerObservation controlPointPerObservation;
+  std::vector<bool> processed(reconstructions.size(), false);
+
+  ALICEVISION_LOG_INFO("Reference sub-reconstruction: " << referenceIndex << " (" << referenceNbPoses << " poses)");
+  fuseReconstruction(reconstructions[referenceIndex], sfmData, mergedIntrinsics, mergedRigs, landmarkPerObservation, controlPointPerObservation);
+  processed[referenceIndex] = true;
+
+  std::size_t nbMerged = 1;
+
+  while(true)
+  {
+    // the reconstruction sharing the most reconstructed views with the merged scene is merged first
+    std::size_t bestIndex = reconstructions.size();
+    std::size_t bestNbCommonViews = 0;
+
+    for(std::size_t i = 0; i < reconstructions.size(); ++i)
+    {
+      if(processed[i] || reconstructions[i].getPoses().empty())
+        continue;
+
+      std::vector<IndexT> commonViewIds;
+      getCommonViewsWithPoses(reconstructions[i], sfmData, commonViewIds);
+
+      if(commonViewIds.size() > bestNbCommonViews)
+      {
+        bestIndex = i;
+        bestNbCommonViews = commonViewIds.size();
+      }
+    }
+
+    if(bestIndex == reconstructions.size() || bestNbCommonViews < params.minNbCommonViews)
+      break;
+
+    processed[bestIndex] = true;
+    sfmData::SfMData& reconstruction = reconstructions[bestIndex];
+
+    double S;
+    Mat3 R;
+    Vec3 t;
+
+    if(!computeSimilarityFromCommonCameras_viewId(reconstruction, sfmData, &S, &R, &t))
+    {
+      ALICEVISION_LOG_WARNING("Failed to align sub-reconstruction " << bestIndex << " (" << bestNbCommonViews << " common views).");
+      continue;
+    }
+
+    ALICEVISION_LOG_INFO("Merge sub-reconstruction " << bestIndex << ":" << std::endl
+                         << "\t- # common views: " << bestNbCommonViews << std::endl
+                         << "\t- scale: " << S);
+
+    transformReconstruction(reconstruction, S, R, t);
+    fuseReconstruction(reconstruction, sfmData, mergedIntrinsics, mergedRigs, landmarkPerObservation, controlPointPerObservation);
+    ++nbMerged;
+  }
+
+  if(nbMerged < reconstructions.size())
+    ALICEVISION_LOG_WARNING((reconstructions.size() - nbMerged) << " sub-reconstruction(s) cannot be merged (less than " << params.minNbCommonViews << " common views or alignment failure).");
+
+  ALICEVISION_LOG_INFO("Merged reconstruction:" << std::endl
+                       << "\t- # merged sub-reconstructions: " << nbMerged << " / " << reconstructions.size() << std::endl
+                       << "\t- # poses: " << sfmData.getPoses().size() << std::endl
+                       << "\t- # landmarks: " << sfmData.getLandmarks().size());
+
+  return nbMerged;
+}
+
+} // namespace sfm
+} // namespace aliceVision
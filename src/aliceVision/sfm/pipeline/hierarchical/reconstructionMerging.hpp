@@ -0,0 +1,46 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Sub-reconstructions merging parameters
+ */
+struct ReconstructionMergingParams
+{
+  /// minimum number of reconstructed views shared with the merged scene to align a sub-reconstruction
+  std::size_t minNbCommonViews = 5;
+};
+
+/**
+ * @brief Merge sub-reconstructions of the same scene (e.g. reconstructed from overlapping clusters of views).
+ *
+ * The largest sub-reconstruction defines the coordinate system. The other ones are merged greedily,
+ * the one sharing the most reconstructed views with the merged scene first: it is aligned with a robust
+ * similarity estimated from the common camera centers, then its poses, intrinsics, rigs and landmarks
+ * are fused in the merged scene. Landmarks sharing an observation (same view and feature) are fused.
+ * Sub-reconstructions which cannot be aligned are ignored.
+ *
+ * @param[in,out] sfmData the scene with all the views, receives the merged reconstruction
+ * @param[in,out] reconstructions the sub-reconstructions, aligned in place
+ * @param[in] params the merging parameters
+ * @return the number of merged sub-reconstructions
+ */
+std::size_t mergeReconstructions(sfmData::SfMData& sfmData,
+                                 std::vector<sfmData::SfMData>& reconstructions,
+                                 const ReconstructionMergingParams& params);
+
+} // namespace sfm
+} // namespace aliceVision
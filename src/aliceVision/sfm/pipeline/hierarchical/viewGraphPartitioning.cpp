@@ -0,0 +1,364 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "viewGraphPartitioning.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <queue>
+#include <utility>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+using NodeIndex = std::size_t;
+
+/**
+ * @brief Weighted pose graph: one node per pose, edges weighted by the number of matches.
+ */
+struct PoseGraph
+{
+  std::vector<std::vector<IndexT>> viewsPerNode;
+  std::vector<std::vector<std::pair<NodeIndex, std::size_t>>> adjacency;
+
+  std::size_t nbNodes() const { return viewsPerNode.size(); }
+
+  std::size_t getWeight(const std::vector<NodeIndex>& nodes) const
+  {
+    std::size_t weight = 0;
+    for(const NodeIndex node : nodes)
+      weight += viewsPerNode[node].size();
+    return weight;
+  }
+};
+
+void buildPoseGraph(const sfmData::SfMData& sfmData,
+                    const matching::PairwiseMatches& pairwiseMatches,
+                    std::size_t minNbMatches,
+                    PoseGraph& graph)
+{
+  // views sharing the same pose (rig) are grouped in the same node
+  std::map<IndexT, NodeIndex> nodePerPoseId;
+  std::map<IndexT, NodeIndex> nodePerViewId;
+
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    const sfmData::View& view = *viewPair.second;
+    const IndexT poseId = (view.getPoseId() != UndefinedIndexT) ? view.getPoseId() : view.getViewId();
+    const auto it = nodePerPoseId.emplace(poseId, graph.viewsPerNode.size()).first;
+
+    if(it->second == graph.viewsPerNode.size())
+      graph.viewsPerNode.emplace_back();
+
+    graph.viewsPerNode[it->second].push_back(view.getViewId());
+    nodePerViewId[view.getViewId()] = it->second;
+  }
+
+  std::map<std::pair<NodeIndex, NodeIndex>, std::size_t> edges;
+
+  for(const auto& matchesPair : pairwiseMatches)
+  {
+    const auto itI = nodePerViewId.find(matchesPair.first.first);
+    const auto itJ = nodePerViewId.find(matchesPair.first.second);
+
+    if(itI == nodePerViewId.end() || itJ == nodePerViewId.end() || itI->second == itJ->second)
+      continue;
+
+    std::size_t nbMatches = 0;
+    for(const auto& matchesPerDesc : matchesPair.second)
+      nbMatches += matchesPerDesc.second.size();
+
+    if(nbMatches == 0 || nbMatches < minNbMatches)
+      continue;
+
+    edges[std::minmax(itI->second, itJ->second)] += nbMatches;
+  }
+
+  graph.adjacency.resize(graph.nbNodes());
+  for(const auto& edge : edges)
+  {
+    graph.adjacency[edge.first.first].emplace_back(edge.first.second, edge.second);
+    graph.adjacency[edge.first.second].emplace_back(edge.first.first, edge.second);
+  }
+}
+
+/**
+ * @brief Split a subset of nodes into connected components, sorted by decreasing size
+ */
+std::vector<std::vector<NodeIndex>> getConnectedComponents(const PoseGraph& graph, const std::vector<NodeIndex>& nodes)
+{
+  // 0: not in the subset, 1: not visited, 2: visited
+  std::vector<char> state(graph.nbNodes(), 0);
+  for(const NodeIndex node : nodes)
+    state[node] = 1;
+
+  std::vector<std::vector<NodeIndex>> components;
+
+  for(const NodeIndex node : nodes)
+  {
+    if(state[node] != 1)
+      continue;
+
+    components.emplace_back();
+    std::vector<NodeIndex>& component = components.back();
+    component.push_back(node);
+    state[node] = 2;
+
+    for(std::size_t i = 0; i < component.size(); ++i)
+    {
+      for(const auto& neighbor : graph.adjacency[component[i]])
+      {
+        if(state[neighbor.first] == 1)
+        {
+          state[neighbor.first] = 2;
+          component.push_back(neighbor.first);
+        }
+      }
+    }
+  }
+
+  std::stable_sort(components.begin(), components.end(), [](const std::vector<NodeIndex>& a, const std::vector<NodeIndex>& b) {
+    return a.size() > b.size();
+  });
+  return components;
+}
+
+/**
+ * @brief Breadth-first search in a subset of nodes, returns the last reached node
+ */
+NodeIndex getFarthestNode(const PoseGraph& graph, const std::vector<char>& inSubset, NodeIndex source)
+{
+  std::vector<char> visited(graph.nbNodes(), 0);
+  std::queue<NodeIndex> queue;
+  NodeIndex last = source;
+
+  visited[source] = 1;
+  queue.push(source);
+
+  while(!queue.empty())
+  {
+    last = queue.front();
+    queue.pop();
+
+    for(const auto& neighbor : graph.adjacency[last])
+    {
+      if(inSubset[neighbor.first] && !visited[neighbor.first])
+      {
+        visited[neighbor.first] = 1;
+        queue.push(neighbor.first);
+      }
+    }
+  }
+  return last;
+}
+
+/**
+ * @brief Recursive bisection of a connected subset of nodes by greedy graph growing
+ */
+void bisect(const PoseGraph& graph,
+            const std::vector<NodeIndex>& nodes,
+            std::size_t maxClusterSize,
+            std::vector<std::vector<NodeIndex>>& outClusters)
+{
+  const std::size_t weight = graph.getWeight(nodes);
+
+  if(weight <= maxClusterSize || nodes.size() < 2)
+  {
+    outClusters.push_back(nodes);
+    return;
+  }
+
+  std::vector<char> inSubset(graph.nbNodes(), 0);
+  for(const NodeIndex node : nodes)
+    inSubset[node] = 1;
+
+  // grow the first part from a pseudo-peripheral node
+  const NodeIndex seed = getFarthestNode(graph, inSubset, getFarthestNode(graph, inSubset, nodes.front()));
+
+  // the node with the strongest connection to the grown part is added first
+  std::vector<std::size_t> gain(graph.nbNodes(), 0);
+  std::vector<char> inPartA(graph.nbNodes(), 0);
+  std::priority_queue<std::pair<std::size_t, NodeIndex>> queue;
+  std::vector<NodeIndex> partA;
+  std::size_t weightA = 0;
+
+  queue.emplace(0, seed);
+
+  // at least one node is left to the second part, even if a node carries most of the weight
+  while(2 * weightA < weight && partA.size() + 1 < nodes.size() && !queue.empty())
+  {
+    const std::pair<std::size_t, NodeIndex> top = queue.top();
+    queue.pop();
+
+    const NodeIndex node = top.second;
+
+    // skip outdated entries
+    if(inPartA[node] || gain[node] != top.first)
+      continue;
+
+    inPartA[node] = 1;
+    partA.push_back(node);
+    weightA += graph.viewsPerNode[node].size();
+
+    for(const auto& neighbor : graph.adjacency[node])
+    {
+      if(inSubset[neighbor.first] && !inPartA[neighbor.first])
+      {
+        gain[neighbor.first] += neighbor.second;
+        queue.emplace(gain[neighbor.first], neighbor.first);
+      }
+    }
+  }
+
+  std::vector<NodeIndex> partB;
+  for(const NodeIndex node : nodes)
+  {
+    if(!inPartA[node])
+      partB.push_back(node);
+  }
+
+  // keep both parts connected: the remaining part may be split by the grown part,
+  // its smaller components are connected to the grown part and moved to it
+  std::vector<std::vector<NodeIndex>> componentsB = getConnectedComponents(graph, partB);
+  for(std::size_t i = 1; i < componentsB.size(); ++i)
+    partA.insert(partA.end(), componentsB[i].begin(), componentsB[i].end());
+
+  // the subset cannot be split: keep it as a single cluster
+  if(componentsB.empty() || partA.empty() || partA.size() >= nodes.size())
+  {
+    outClusters.push_back(nodes);
+    return;
+  }
+
+  bisect(graph, partA, maxClusterSize, outClusters);
+  bisect(graph, componentsB.front(), maxClusterSize, outClusters);
+}
+
+/**
+ * @brief Extend each cluster with the nodes of its neighbor clusters which are the most connected to it
+ */
+void expandClusters(const PoseGraph& graph,
+                    const ViewGraphPartitioningParams& params,
+                    std::vector<std::vector<NodeIndex>>& clusters)
+{
+  std::vector<std::size_t> clusterPerNode(graph.nbNodes(), clusters.size());
+  for(std::size_t c = 0; c < clusters.size(); ++c)
+  {
+    for(const NodeIndex node : clusters[c])
+      clusterPerNode[node] = c;
+  }
+
+  std::vector<std::vector<NodeIndex>> extensions(clusters.size());
+
+  for(std::size_t c = 0; c < clusters.size(); ++c)
+  {
+    // connection of each neighbor cluster node to the current cluster
+    std::map<std::size_t, std::map<NodeIndex, std::size_t>> connectionsPerCluster;
+    std::map<std::size_t, std::size_t> cutPerCluster;
+    std::size_t totalCut = 0;
+
+    for(const NodeIndex node : clusters[c])
+    {
+      for(const auto& neighbor : graph.adjacency[node])
+      {
+        const std::size_t neighborCluster = clusterPerNode[neighbor.first];
+        if(neighborCluster == c || neighborCluster == clusters.size())
+          continue;
+
+        connectionsPerCluster[neighborCluster][neighbor.first] += neighbor.second;
+        cutPerCluster[neighborCluster] += neighbor.second;
+        totalCut += neighbor.second;
+      }
+    }
+
+    if(totalCut == 0)
+      continue;
+
+    // the overlap budget is shared between the neighbor clusters according to their connection
+    const double budget = std::ceil(params.overlapRatio * clusters[c].size());
+
+    for(const auto& connections : connectionsPerCluster)
+    {
+      const double share = static_cast<double>(cutPerCluster.at(connections.first)) / static_cast<double>(totalCut);
+      const std::size_t quota = std::max(params.minOverlapSize, static_cast<std::size_t>(std::round(budget * share)));
+
+      std::vector<std::pair<std::size_t, NodeIndex>> candidates;
+      candidates.reserve(connections.second.size());
+      for(const auto& connection : connections.second)
+        candidates.emplace_back(connection.second, connection.first);
+
+      std::sort(candidates.begin(), candidates.end(), [](const std::pair<std::size_t, NodeIndex>& a, const std::pair<std::size_t, NodeIndex>& b) {
+        return (a.first != b.first) ? a.first > b.first : a.second < b.second;
+      });
+
+      const std::size_t nbAdded = std::min(quota, candidates.size());
+      for(std::size_t i = 0; i < nbAdded; ++i)
+        extensions[c].push_back(candidates[i].second);
+    }
+  }
+
+  for(std::size_t c = 0; c < clusters.size(); ++c)
+    clusters[c].insert(clusters[c].end(), extensions[c].begin(), extensions[c].end());
+}
+
+} // namespace
+
+void partitionViewGraph(const sfmData::SfMData& sfmData,
+                        const matching::PairwiseMatches& pairwiseMatches,
+                        const ViewGraphPartitioningParams& params,
+                        std::vector<std::set<IndexT>>& outClusters)
+{
+  outClusters.clear();
+
+  PoseGraph graph;
+  buildPoseGraph(sfmData, pairwiseMatches, params.minNbMatches, graph);
+
+  std::vector<NodeIndex> allNodes(graph.nbNodes());
+  for(NodeIndex node = 0; node < graph.nbNodes(); ++node)
+    allNodes[node] = node;
+
+  const std::vector<std::vector<NodeIndex>> components = getConnectedComponents(graph, allNodes);
+
+  std::vector<std::vector<NodeIndex>> clusters;
+  std::size_t nbDiscardedViews = 0;
+
+  for(const std::vector<NodeIndex>& component : components)
+  {
+    if(component.size() < params.minClusterSize)
+    {
+      nbDiscardedViews += graph.getWeight(component);
+      continue;
+    }
+    bisect(graph, component, std::max<std::size_t>(params.maxClusterSize, 1), clusters);
+  }
+
+  if(nbDiscardedViews > 0)
+    ALICEVISION_LOG_WARNING(nbDiscardedViews << " views are not connected to a component of at least " << params.minClusterSize << " poses and are not part of any cluster.");
+
+  if(clusters.size() > 1)
+    expandClusters(graph, params, clusters);
+
+  outClusters.resize(clusters.size());
+  for(std::size_t c = 0; c < clusters.size(); ++c)
+  {
+    for(const NodeIndex node : clusters[c])
+      outClusters[c].insert(graph.viewsPerNode[node].begin(), graph.viewsPerNode[node].end());
+  }
+
+  ALICEVISION_LOG_INFO("View graph partitioning:" << std::endl
+                       << "\t- # connected components: " << components.size() << std::endl
+                       << "\t- # clusters: " << outClusters.size());
+
+  for(std::size_t c = 0; c < outClusters.size(); ++c)
+    ALICEVISION_LOG_DEBUG("\t- cluster " << c << ": " << outClusters[c].size() << " views");
+}
+
+} // namespace sfm
+} // namespace aliceVision
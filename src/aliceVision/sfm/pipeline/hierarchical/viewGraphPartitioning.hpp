@@ -0,0 +1,57 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+
+#include <cstddef>
+#include <set>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief View graph partitioning parameters
+ */
+struct ViewGraphPartitioningParams
+{
+  /// maximum number of views per cluster (before overlap expansion)
+  std::size_t maxClusterSize = 500;
+  /// ratio of poses added to each cluster from its neighbor clusters
+  double overlapRatio = 0.2;
+  /// minimum number of poses shared with each connected neighbor cluster
+  std::size_t minOverlapSize = 10;
+  /// minimum number of matches for an image pair to be an edge of the view graph
+  std::size_t minNbMatches = 0;
+  /// connected components with less poses are discarded
+  std::size_t minClusterSize = 2;
+};
+
+/**
+ * @brief Partition the view graph into overlapping clusters of views.
+ *
+ * The graph nodes are the poses (views of a rig sharing the same pose are always in the same cluster),
+ * edges are weighted by the number of matches between their views.
+ * Each connected component is recursively bisected by greedy graph growing until the clusters
+ * have at most maxClusterSize views. Then each cluster is extended with the poses of its neighbor
+ * clusters which are the most connected to it, so that the sub-reconstructions can be aligned.
+ *
+ * @param[in] sfmData the input scene (views)
+ * @param[in] pairwiseMatches the putative or geometric matches between views
+ * @param[in] params the partitioning parameters
+ * @param[out] outClusters the view ids of each cluster
+ */
+void partitionViewGraph(const sfmData::SfMData& sfmData,
+                        const matching::PairwiseMatches& pairwiseMatches,
+                        const ViewGraphPartitioningParams& params,
+                        std::vector<std::set<IndexT>>& outClusters);
+
+} // namespace sfm
+} // namespace aliceVision
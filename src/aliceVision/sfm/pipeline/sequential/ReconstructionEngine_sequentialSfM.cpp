@@ -25,6 +25,7 @@
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/cpu.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/config.hpp>
 
 #include <dependencies/htmlDoc/htmlDoc.hpp>
@@ -226,6 +227,8 @@ void ReconstructionEngine_sequentialSfM::initializePyramidScoring()
 
 std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
 {
+  ALICEVISION_TRACE_ZONE("sfm::fuseMatchesIntoTracks");
+
   // compute tracks from matches
   track::TracksBuilder tracksBuilder;
 
@@ -423,6 +426,8 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
   std::size_t globalIteration = 0;
   do
   {
+    ALICEVISION_TRACE_ZONE("sfm::globalIteration");
+
     nbValidPoses = _sfmData.getPoses().size();
     ALICEVISION_LOG_INFO("Incremental Reconstruction start iteration " << globalIteration << ":" << std::endl
                          << "\t- # number of resection groups: " << resectionId << std::endl
@@ -433,6 +438,8 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
     // compute robust resection of remaining images
     while(findNextBestViews(bestViewCandidates, remainingViewIds))
     {
+      ALICEVISION_TRACE_ZONE("sfm::resectionIteration");
+
       ALICEVISION_LOG_INFO("Update Reconstruction:" << std::endl
         << "\t- resection id: " << resectionId << std::endl
         << "\t- # images in the resection group: " << bestViewCandidates.size() << std::endl
@@ -503,6 +510,8 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
                                                                 const std::set<IndexT>& prevReconstructedViews,
                                                                 std::set<IndexT>& remainingViewIds)
 {
+  ALICEVISION_TRACE_ZONE("sfm::resection");
+
   auto chrono_start = std::chrono::steady_clock::now();
 
   // add images to the 3D reconstruction
@@ -591,6 +600,8 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
 
 void ReconstructionEngine_sequentialSfM::triangulate(const std::set<IndexT>& prevReconstructedViews, const std::set<IndexT>& newReconstructedViews)
 {
+  ALICEVISION_TRACE_ZONE("sfm::triangulate");
+
   auto chrono_start = std::chrono::steady_clock::now();
 
   // allow to use to the old triangulatation algorithm (using 2 views only)
@@ -604,6 +615,8 @@ void ReconstructionEngine_sequentialSfM::triangulate(const std::set<IndexT>& pre
 
 bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newReconstructedViews, bool isInitialPair)
 {
+  ALICEVISION_TRACE_ZONE("sfm::bundleAdjustment");
+
   ALICEVISION_LOG_INFO("Bundle adjustment start.");
   auto chronoStart = std::chrono::steady_clock::now();
 
@@ -1020,6 +1033,8 @@ bool ReconstructionEngine_sequentialSfM::findNextBestViews(
 
 bool ReconstructionEngine_sequentialSfM::makeInitialPair3D(const Pair& currentPair)
 {
+  ALICEVISION_TRACE_ZONE("sfm::makeInitialPair3D");
+
   // compute robust Essential matrix for ImageId [I,J]
   // use min max to have I < J
   const std::size_t I = std::min(currentPair.first, currentPair.second);
@@ -7,6 +7,7 @@
 
 #include "AlembicExporter.hpp"
 #include <aliceVision/version.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <Alembic/AbcGeom/All.h>
 #include <Alembic/AbcCoreOgawa/All.h>
@@ -50,6 +51,63 @@ struct AlembicExporter::DataImpl
     Alembic::AbcGeom::CreateVisibilityProperty(_mvgCamerasUndefined, 0).set(Alembic::AbcGeom::kVisibilityHidden);
   }
 
+  /**
+   * @brief Alembic samples and properties of a camera, computed before writing
+   *        so that the preparation of several cameras can run in parallel
+   */
+  struct CameraData
+  {
+    const sfmData::View* view = nullptr;
+    std::string label;
+    bool hasPose = false;
+    bool poseLocked = false;
+    XformSample xformSample;
+    bool isIntrinsicValid = false;
+    CameraSample cameraSample;
+    std::vector<::uint32_t> sensorSizePix;
+    std::string intrinsicType;
+    std::string intrinsicInitializationMode;
+    double initialFocalLengthPix = -1.0;
+    std::vector<double> intrinsicParams;
+    bool intrinsicLocked = false;
+    std::vector<std::string> rawMetadata;
+    std::vector<double> uncertaintyParams;
+  };
+
+  /**
+   * @brief Compute the samples and properties of a camera (thread safe, no Alembic write)
+   * @param[in] name The camera identifier
+   * @param[in] view The corresponding view
+   * @param[in] pose The camera pose (nullptr if undefined)
+   * @param[in] intrinsic The camera intrinsic (nullptr if undefined)
+   * @param[in] uncertainty The camera uncertainty values (nullptr if undefined)
+   * @param[out] cameraData The camera samples and properties
+   */
+  static void prepareCamera(const std::string& name,
+                            const sfmData::View& view,
+                            const sfmData::CameraPose* pose,
+                            const camera::IntrinsicBase* intrinsic,
+                            const Vec6* uncertainty,
+                            CameraData& cameraData);
+
+  /**
+   * @brief Compute the samples and properties of a view that is not part of a rig (thread safe)
+   * @param[in] sfmData The corresponding view scene
+   * @param[in] view The corresponding view
+   * @param[out] cameraData The camera samples and properties
+   * @return true if the pose and the intrinsic of the view are defined
+   */
+  static bool prepareSfMSingleCamera(const sfmData::SfMData& sfmData,
+                                     const sfmData::View& view,
+                                     CameraData& cameraData);
+
+  /**
+   * @brief Write a prepared camera in the archive
+   * @param[in] cameraData The camera samples and properties
+   * @param[in,out] parent The Alembic parent node
+   */
+  void writeCamera(const CameraData& cameraData, Alembic::Abc::OObject& parent);
+
   /**
    * @brief Add a camera
    * @param[in] name The camera identifier
@@ -83,32 +141,25 @@ struct AlembicExporter::DataImpl
 };
 
 
-void AlembicExporter::DataImpl::addCamera(const std::string& name,
+void AlembicExporter::DataImpl::prepareCamera(const std::string& name,
                const sfmData::View& view,
                const sfmData::CameraPose* pose,
                const camera::IntrinsicBase* intrinsic,
                const Vec6* uncertainty,
-               Alembic::Abc::OObject* parent)
+               CameraData& cameraData)
 {
-  if(parent == nullptr)
-    parent = &_mvgCameras;
-
+  cameraData.view = &view;
 
   std::stringstream ssLabel;
   ssLabel << "camxform_" << std::setfill('0') << std::setw(5) << view.getResectionId() << "_" << view.getPoseId();
   ssLabel << "_" << name << "_" << view.getViewId();
-
-  Alembic::AbcGeom::OXform xform(*parent, ssLabel.str());
-  OCamera camObj(xform, "camera_" + ssLabel.str());
-
-  auto userProps = camObj.getSchema().getUserProperties();
-
-  XformSample xformsample;
+  cameraData.label = ssLabel.str();
 
   // set camera pose
   if(pose != nullptr)
   {
-    OBoolProperty(userProps, "mvg_poseLocked").set(pose->isLocked());
+    cameraData.hasPose = true;
+    cameraData.poseLocked = pose->isLocked();
 
     const Mat3& R = pose->getTransform().rotation();
     const Vec3& center = pose->getTransform().center();
@@ -137,35 +188,13 @@ void AlembicExporter::DataImpl::addCamera(const std::string& name,
     scale[2][2] = -1;
 
     xformMatrix = scale * xformMatrix;
-    xformsample.setMatrix(xformMatrix);
+    cameraData.xformSample.setMatrix(xformMatrix);
   }
 
-  xform.getSchema().set(xformsample);
-
-  // set view custom properties
-  if(!view.getImagePath().empty())
-    OStringProperty(userProps, "mvg_imagePath").set(view.getImagePath());
-
-  OUInt32Property(userProps, "mvg_viewId").set(view.getViewId());
-  OUInt32Property(userProps, "mvg_poseId").set(view.getPoseId());
-  OUInt32Property(userProps, "mvg_intrinsicId").set(view.getIntrinsicId());
-  OUInt32Property(userProps, "mvg_resectionId").set(view.getResectionId());
-
-  if(view.isPartOfRig())
-  {
-    OUInt32Property(userProps, "mvg_rigId").set(view.getRigId());
-    OUInt32Property(userProps, "mvg_subPoseId").set(view.getSubPoseId());
-  }
-
-  if(view.getFrameId() != UndefinedIndexT)
-    OUInt32Property(userProps, "mvg_frameId").set(view.getFrameId());
-
-  if(view.isPoseIndependant() == false)
-    OBoolProperty(userProps, "mvg_poseIndependant").set(view.isPoseIndependant());
-
   // set view metadata
   {
-    std::vector<std::string> rawMetadata(view.getMetadata().size() * 2);
+    std::vector<std::string>& rawMetadata = cameraData.rawMetadata;
+    rawMetadata.resize(view.getMetadata().size() * 2);
     auto it = view.getMetadata().cbegin();
 
     for(std::size_t i = 0; i < rawMetadata.size(); i+=2)
@@ -174,18 +203,17 @@ void AlembicExporter::DataImpl::addCamera(const std::string& name,
       rawMetadata.at(i + 1) = it->second;
       std::advance(it,1);
     }
-    OStringArrayProperty(userProps, "mvg_metadata").set(rawMetadata);
   }
 
   // set intrinsic properties
-  const bool isIntrinsicValid = (intrinsic != nullptr &&
+  cameraData.isIntrinsicValid = (intrinsic != nullptr &&
                                  intrinsic->isValid() &&
                                  camera::isPinhole(intrinsic->getType()));
 
-  if(isIntrinsicValid)
+  if(cameraData.isIntrinsicValid)
   {
     const auto* pinhole = dynamic_cast<const camera::Pinhole*>(intrinsic);
-    CameraSample camSample;
+    CameraSample& camSample = cameraData.cameraSample;
 
     // Use a common sensor width if we don't have this information.
     // We chose a full frame 24x36 camera
@@ -213,32 +241,109 @@ void AlembicExporter::DataImpl::addCamera(const std::string& name,
     camSample.setVerticalAperture(vaperture_cm);
 
     // Add sensor width (largest image side) in pixels as custom property
-    std::vector<::uint32_t> sensorSize_pix = {pinhole->w(), pinhole->h()};
+    cameraData.sensorSizePix = {pinhole->w(), pinhole->h()};
+    cameraData.intrinsicType = pinhole->getTypeStr();
+    cameraData.intrinsicInitializationMode = camera::EIntrinsicInitMode_enumToString(pinhole->getInitializationMode());
+    cameraData.initialFocalLengthPix = pinhole->initialFocalLengthPix();
+    cameraData.intrinsicParams = pinhole->getParams();
+    cameraData.intrinsicLocked = pinhole->isLocked();
+  }
+
+  if(uncertainty)
+    cameraData.uncertaintyParams.assign(uncertainty->data(), uncertainty->data() + 6);
+}
+
+bool AlembicExporter::DataImpl::prepareSfMSingleCamera(const sfmData::SfMData& sfmData,
+                                                       const sfmData::View& view,
+                                                       CameraData& cameraData)
+{
+  const std::string name = fs::path(view.getImagePath()).stem().string();
+  const sfmData::CameraPose* pose = (sfmData.existsPose(view)) ? &(sfmData.getPoses().at(view.getPoseId())) :  nullptr;
+  const camera::IntrinsicBase* intrinsic = sfmData.getIntrinsicPtr(view.getIntrinsicId());
+
+  prepareCamera(name, view, pose, intrinsic, nullptr, cameraData);
+  return sfmData.isPoseAndIntrinsicDefined(&view);
+}
+
+void AlembicExporter::DataImpl::writeCamera(const CameraData& cameraData, Alembic::Abc::OObject& parent)
+{
+  const sfmData::View& view = *cameraData.view;
+
+  Alembic::AbcGeom::OXform xform(parent, cameraData.label);
+  OCamera camObj(xform, "camera_" + cameraData.label);
+
+  auto userProps = camObj.getSchema().getUserProperties();
+
+  if(cameraData.hasPose)
+    OBoolProperty(userProps, "mvg_poseLocked").set(cameraData.poseLocked);
+
+  // the xform sample is an identity matrix without pose
+  XformSample xformSample = cameraData.xformSample;
+  xform.getSchema().set(xformSample);
+
+  // set view custom properties
+  if(!view.getImagePath().empty())
+    OStringProperty(userProps, "mvg_imagePath").set(view.getImagePath());
 
-    OUInt32ArrayProperty(userProps, "mvg_sensorSizePix").set(sensorSize_pix);
-    OStringProperty(userProps, "mvg_intrinsicType").set(pinhole->getTypeStr());
-    OStringProperty(userProps, "mvg_intrinsicInitializationMode").set(camera::EIntrinsicInitMode_enumToString(pinhole->getInitializationMode()));
-    ODoubleProperty(userProps, "mvg_initialFocalLengthPix").set(pinhole->initialFocalLengthPix());
-    ODoubleArrayProperty(userProps, "mvg_intrinsicParams").set(pinhole->getParams());
-    OBoolProperty(userProps, "mvg_intrinsicLocked").set(pinhole->isLocked());
+  OUInt32Property(userProps, "mvg_viewId").set(view.getViewId());
+  OUInt32Property(userProps, "mvg_poseId").set(view.getPoseId());
+  OUInt32Property(userProps, "mvg_intrinsicId").set(view.getIntrinsicId());
+  OUInt32Property(userProps, "mvg_resectionId").set(view.getResectionId());
 
-    camObj.getSchema().set(camSample);
+  if(view.isPartOfRig())
+  {
+    OUInt32Property(userProps, "mvg_rigId").set(view.getRigId());
+    OUInt32Property(userProps, "mvg_subPoseId").set(view.getSubPoseId());
   }
 
-  if(uncertainty)
+  if(view.getFrameId() != UndefinedIndexT)
+    OUInt32Property(userProps, "mvg_frameId").set(view.getFrameId());
+
+  if(view.isPoseIndependant() == false)
+    OBoolProperty(userProps, "mvg_poseIndependant").set(view.isPoseIndependant());
+
+  OStringArrayProperty(userProps, "mvg_metadata").set(cameraData.rawMetadata);
+
+  if(cameraData.isIntrinsicValid)
+  {
+    OUInt32ArrayProperty(userProps, "mvg_sensorSizePix").set(cameraData.sensorSizePix);
+    OStringProperty(userProps, "mvg_intrinsicType").set(cameraData.intrinsicType);
+    OStringProperty(userProps, "mvg_intrinsicInitializationMode").set(cameraData.intrinsicInitializationMode);
+    ODoubleProperty(userProps, "mvg_initialFocalLengthPix").set(cameraData.initialFocalLengthPix);
+    ODoubleArrayProperty(userProps, "mvg_intrinsicParams").set(cameraData.intrinsicParams);
+    OBoolProperty(userProps, "mvg_intrinsicLocked").set(cameraData.intrinsicLocked);
+
+    camObj.getSchema().set(cameraData.cameraSample);
+  }
+
+  if(!cameraData.uncertaintyParams.empty())
   {
-     std::vector<double> uncertaintyParams(uncertainty->data(), uncertainty->data()+6);
-     ODoubleArrayProperty mvg_uncertaintyParams(userProps, "mvg_uncertaintyEigenValues");
-     mvg_uncertaintyParams.set(uncertaintyParams);
+    ODoubleArrayProperty mvg_uncertaintyParams(userProps, "mvg_uncertaintyEigenValues");
+    mvg_uncertaintyParams.set(cameraData.uncertaintyParams);
   }
 
-  if(pose == nullptr || !isIntrinsicValid)
+  if(!cameraData.hasPose || !cameraData.isIntrinsicValid)
   {
     // hide camera
     Alembic::AbcGeom::CreateVisibilityProperty(xform, 0).set(Alembic::AbcGeom::kVisibilityHidden);
   }
 }
 
+void AlembicExporter::DataImpl::addCamera(const std::string& name,
+               const sfmData::View& view,
+               const sfmData::CameraPose* pose,
+               const camera::IntrinsicBase* intrinsic,
+               const Vec6* uncertainty,
+               Alembic::Abc::OObject* parent)
+{
+  if(parent == nullptr)
+    parent = &_mvgCameras;
+
+  CameraData cameraData;
+  prepareCamera(name, view, pose, intrinsic, uncertainty, cameraData);
+  writeCamera(cameraData, *parent);
+}
+
 AlembicExporter::AlembicExporter(const std::string& filename)
   : _dataImpl(new DataImpl(filename))
 {}
@@ -270,8 +375,9 @@ void AlembicExporter::addSfM(const sfmData::SfMData& sfmData, ESfMData flagsPart
      flagsPart & ESfMData::EXTRINSICS)
   {
     std::map<IndexT, std::map<IndexT, std::vector<IndexT>>> rigsViewIds; //map<rigId,map<poseId,viewId>>
+    std::vector<const sfmData::View*> singleViews;
+    singleViews.reserve(sfmData.getViews().size());
 
-    // save all single views
     for(const auto& viewPair : sfmData.getViews())
     {
       const sfmData::View& view = *(viewPair.second);
@@ -282,9 +388,21 @@ void AlembicExporter::addSfM(const sfmData::SfMData& sfmData, ESfMData flagsPart
         rigsViewIds[view.getRigId()][view.getPoseId()].push_back(view.getViewId());
         continue;
       }
-      addSfMSingleCamera(sfmData, view);
+      singleViews.push_back(&view);
     }
 
+    // prepare all single views in parallel, the archive is written sequentially
+    std::vector<DataImpl::CameraData> camerasData(singleViews.size());
+    std::vector<char> camerasDefined(singleViews.size(), 0);
+
+    #pragma omp parallel for
+    for(int i = 0; i < static_cast<int>(singleViews.size()); ++i)
+      camerasDefined[i] = DataImpl::prepareSfMSingleCamera(sfmData, *singleViews[i], camerasData[i]);
+
+    // save all single views
+    for(std::size_t i = 0; i < camerasData.size(); ++i)
+      _dataImpl->writeCamera(camerasData[i], camerasDefined[i] ? _dataImpl->_mvgCameras : _dataImpl->_mvgCamerasUndefined);
+
     // save rigs views
     for(const auto& rigPair : rigsViewIds)
     {
@@ -296,14 +414,9 @@ void AlembicExporter::addSfM(const sfmData::SfMData& sfmData, ESfMData flagsPart
 
 void AlembicExporter::addSfMSingleCamera(const sfmData::SfMData& sfmData, const sfmData::View& view)
 {
-  const std::string name = fs::path(view.getImagePath()).stem().string();
-  const sfmData::CameraPose* pose = (sfmData.existsPose(view)) ? &(sfmData.getPoses().at(view.getPoseId())) :  nullptr;
-  const camera::IntrinsicBase* intrinsic = sfmData.getIntrinsicPtr(view.getIntrinsicId()); 
-
-  if(sfmData.isPoseAndIntrinsicDefined(&view))
-    _dataImpl->addCamera(name, view, pose, intrinsic, nullptr, &_dataImpl->_mvgCameras);
-  else
-    _dataImpl->addCamera(name, view, pose, intrinsic, nullptr, &_dataImpl->_mvgCamerasUndefined);
+  DataImpl::CameraData cameraData;
+  const bool isDefined = DataImpl::prepareSfMSingleCamera(sfmData, view, cameraData);
+  _dataImpl->writeCamera(cameraData, isDefined ? _dataImpl->_mvgCameras : _dataImpl->_mvgCamerasUndefined);
 }
 
 void AlembicExporter::addSfMCameraRig(const sfmData::SfMData& sfmData, IndexT rigId, const std::vector<IndexT>& viewIds)
@@ -351,10 +464,14 @@ void AlembicExporter::addSfMCameraRig(const sfmData::SfMData& sfmData, IndexT ri
   std::stringstream ssLabel;
   ssLabel << "rigxform_" << std::setfill('0') << std::setw(5) << rigId << "_" << rigPoseId;
 
-  std::map<bool, Alembic::AbcGeom::OXform> rigObj;
-  for(const IndexT viewId : viewIds)
+  // prepare the sub-pose cameras in parallel, the archive is written sequentially
+  std::vector<DataImpl::CameraData> camerasData(viewIds.size());
+  std::vector<char> camerasReconstructed(viewIds.size(), 0);
+
+  #pragma omp parallel for
+  for(int i = 0; i < static_cast<int>(viewIds.size()); ++i)
   {
-    const sfmData::View& view = *(sfmData.getViews().at(viewId));
+    const sfmData::View& view = *(sfmData.getViews().at(viewIds[i]));
     const sfmData::RigSubPose& rigSubPose = rig.getSubPose(view.getSubPoseId());
     const bool isReconstructed = (rigSubPose.status != sfmData::ERigSubPoseStatus::UNINITIALIZED);
     const std::string name = fs::path(view.getImagePath()).stem().string();
@@ -366,6 +483,14 @@ void AlembicExporter::addSfMCameraRig(const sfmData::SfMData& sfmData, IndexT ri
       subPosePtr = std::unique_ptr<sfmData::CameraPose>(new sfmData::CameraPose(rigSubPose.pose));
     }
 
+    DataImpl::prepareCamera(name, view, subPosePtr.get(), intrinsic, nullptr, camerasData[i]);
+    camerasReconstructed[i] = isReconstructed;
+  }
+
+  std::map<bool, Alembic::AbcGeom::OXform> rigObj;
+  for(std::size_t i = 0; i < camerasData.size(); ++i)
+  {
+    const bool isReconstructed = camerasReconstructed[i];
     Alembic::Abc::OObject& parent = isReconstructed ? _dataImpl->_mvgCameras : _dataImpl->_mvgCamerasUndefined;
 
     if(rigObj.find(isReconstructed) == rigObj.end())
@@ -383,7 +508,7 @@ void AlembicExporter::addSfMCameraRig(const sfmData::SfMData& sfmData, IndexT ri
         OBoolProperty(userProps, "mvg_rigPoseLocked").set(rigPoseLocked);
       }
     }
-    _dataImpl->addCamera(name, view, subPosePtr.get(), intrinsic, nullptr, &(rigObj.at(isReconstructed)));
+    _dataImpl->writeCamera(camerasData[i], rigObj.at(isReconstructed));
   }
 }
 
@@ -392,24 +517,88 @@ void AlembicExporter::addLandmarks(const sfmData::Landmarks& landmarks, const sf
   if(landmarks.empty())
     return;
 
-  // Fill vector with the values taken from AliceVision
-  std::vector<V3f> positions;
-  std::vector<Imath::C3f> colors;
-  std::vector<Alembic::Util::uint32_t> descTypes;
-  positions.reserve(landmarks.size());
-  descTypes.reserve(landmarks.size());
+  const bool withUncertainty = !landmarksUncertainty.empty();
+  const std::size_t nbLandmarks = landmarks.size();
+
+  // index the landmarks and compute the offset of their observations in the visibility arrays
+  std::vector<const sfmData::Landmark*> landmarksPtr;
+  std::vector<const Vec3*> uncertaintiesPtr;
+  std::vector<std::size_t> observationsOffset(nbLandmarks + 1, 0);
+  landmarksPtr.reserve(nbLandmarks);
+
+  if(withUncertainty)
+    uncertaintiesPtr.reserve(nbLandmarks);
 
-  // For all the 3d points in the hash_map
   for(const auto& landmark : landmarks)
   {
-    const Vec3& pt = landmark.second.X;
-    const image::RGBColor& color = landmark.second.rgb;
-    positions.emplace_back(pt[0], pt[1], pt[2]);
-    colors.emplace_back(color.r()/255.f, color.g()/255.f, color.b()/255.f);
-    descTypes.emplace_back(static_cast<Alembic::Util::uint8_t>(landmark.second.descType));
+    const std::size_t landmarkIndex = landmarksPtr.size();
+    landmarksPtr.push_back(&landmark.second);
+    observationsOffset.at(landmarkIndex + 1) = observationsOffset.at(landmarkIndex) + (withVisibility ? landmark.second.observations.size() : 0);
+
+    if(withUncertainty)
+      uncertaintiesPtr.push_back(&landmarksUncertainty.at(landmark.first));
+  }
+
+  const std::size_t nbObservations = observationsOffset.back();
+
+  // Fill vectors with the values taken from AliceVision
+  std::vector<V3f> positions(nbLandmarks);
+  std::vector<Imath::C3f> colors(nbLandmarks);
+  std::vector<Alembic::Util::uint32_t> descTypes(nbLandmarks);
+  std::vector<V3d> uncertainties(withUncertainty ? nbLandmarks : 0);
+
+  // Use std::vector<::uint32_t> and std::vector<float> instead of std::vector<V2i> and std::vector<V2f>
+  // Because Maya don't import them correctly
+  std::vector<::uint32_t> visibilitySize(withVisibility ? nbLandmarks : 0);
+  std::vector<::uint32_t> visibilityViewId(nbObservations);
+  std::vector<::uint32_t> visibilityFeatId(withFeatures ? nbObservations : 0);
+  std::vector<float> featPos2d(withFeatures ? 2 * nbObservations : 0);
+
+  #pragma omp parallel for
+  for(int i = 0; i < static_cast<int>(nbLandmarks); ++i)
+  {
+    const sfmData::Landmark& landmark = *landmarksPtr[i];
+    const Vec3& pt = landmark.X;
+    const image::RGBColor& color = landmark.rgb;
+
+    positions[i] = V3f(pt[0], pt[1], pt[2]);
+    colors[i] = Imath::C3f(color.r()/255.f, color.g()/255.f, color.b()/255.f);
+    descTypes[i] = static_cast<Alembic::Util::uint8_t>(landmark.descType);
+
+    if(withUncertainty)
+    {
+      // Uncertainty eigen values (x,y,z)
+      const Vec3& u = *uncertaintiesPtr[i];
+      uncertainties[i] = V3d(u[0], u[1], u[2]);
+    }
+
+    if(!withVisibility)
+      continue;
+
+    visibilitySize[i] = landmark.observations.size();
+
+    std::size_t observationIndex = observationsOffset[i];
+    for(const auto& vObs : landmark.observations)
+    {
+      const sfmData::Observation& obs = vObs.second;
+
+      // viewId
+      visibilityViewId[observationIndex] = vObs.first;
+
+      if(withFeatures)
+      {
+        // featureId
+        visibilityFeatId[observationIndex] = obs.id_feat;
+
+        // feature 2D position (x, y))
+        featPos2d[2 * observationIndex] = obs.x[0];
+        featPos2d[2 * observationIndex + 1] = obs.x[1];
+      }
+      ++observationIndex;
+    }
   }
 
-  std::vector<Alembic::Util::uint64_t> ids(positions.size());
+  std::vector<Alembic::Util::uint64_t> ids(nbLandmarks);
   std::iota(begin(ids), end(ids), 0);
 
   OPoints partsOut(_dataImpl->_mvgPointCloud, "particleShape1");
@@ -432,49 +621,6 @@ void AlembicExporter::addLandmarks(const sfmData::Landmarks& landmarks, const sf
 
   if(withVisibility)
   {
-    std::vector<::uint32_t> visibilitySize;
-    visibilitySize.reserve(positions.size());
-    for(const auto& landmark : landmarks)
-    {
-      visibilitySize.emplace_back(landmark.second.observations.size());
-    }
-    std::size_t nbObservations = std::accumulate(visibilitySize.begin(), visibilitySize.end(), 0);
-
-    // Use std::vector<::uint32_t> and std::vector<float> instead of std::vector<V2i> and std::vector<V2f>
-    // Because Maya don't import them correctly
-    std::vector<::uint32_t> visibilityViewId;
-    std::vector<::uint32_t> visibilityFeatId;
-    visibilityViewId.reserve(nbObservations);
-
-    std::vector<float>featPos2d;
-    if(withFeatures)
-    {
-      featPos2d.reserve(nbObservations*2);
-      visibilityFeatId.reserve(nbObservations);
-    }
-
-    for (const auto& landmark : landmarks)
-    {
-      const sfmData::Observations& observations = landmark.second.observations;
-      for(const auto& vObs: observations )
-      {
-        const sfmData::Observation& obs = vObs.second;
-
-        // viewId
-        visibilityViewId.emplace_back(vObs.first);
-
-        if(withFeatures)
-        {
-          // featureId
-          visibilityFeatId.emplace_back(obs.id_feat);
-
-          // feature 2D position (x, y))
-          featPos2d.emplace_back(obs.x[0]);
-          featPos2d.emplace_back(obs.x[1]);
-        }
-      }
-    }
-
     OUInt32ArrayProperty(userProps, "mvg_visibilitySize" ).set(visibilitySize);
     OUInt32ArrayProperty(userProps, "mvg_visibilityViewId" ).set(visibilityViewId);
 
@@ -484,17 +630,8 @@ void AlembicExporter::addLandmarks(const sfmData::Landmarks& landmarks, const sf
       OFloatArrayProperty(userProps, "mvg_visibilityFeatPos" ).set(featPos2d); // feature position (x,y)
     }
   }
-  if(!landmarksUncertainty.empty())
+  if(withUncertainty)
   {
-    std::vector<V3d> uncertainties;
-
-    std::size_t indexLandmark = 0;
-    for(sfmData::Landmarks::const_iterator itLandmark = landmarks.begin(); itLandmark != landmarks.end(); ++itLandmark, ++indexLandmark)
-    {
-      const IndexT idLandmark = itLandmark->first;
-      const Vec3& u = landmarksUncertainty.at(idLandmark);
-      uncertainties.emplace_back(u[0], u[1], u[2]);
-    }
     // Uncertainty eigen values (x,y,z)
     OV3dArrayProperty propUncertainty(userProps, "mvg_uncertaintyEigenValues");
     propUncertainty.set(uncertainties);
@@ -6,6 +6,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "AlembicImporter.hpp"
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <Alembic/AbcGeom/All.h>
 #include <Alembic/AbcCoreFactory/All.h>
@@ -113,12 +114,16 @@ bool readPointCloud(IObject iObj, M44d mat, sfmData::SfMData &sfmdata, ESfMData
 
   // Number of points before adding the Alembic data
   const std::size_t nbPointsInit = sfmdata.structure.size();
+  // new landmarks, to fill their observations in parallel
+  std::vector<sfmData::Landmark*> landmarksPtr(positions->size(), nullptr);
+
   for(std::size_t point3d_i = 0;
       point3d_i < positions->size();
       ++point3d_i)
   {
     const P3fArraySamplePtr::element_type::value_type & pos_i = positions->get()[point3d_i];
     sfmData::Landmark& landmark = sfmdata.structure[nbPointsInit + point3d_i] = sfmData::Landmark(Vec3(pos_i.x, pos_i.y, pos_i.z), feature::EImageDescriberType::UNKNOWN);
+    landmarksPtr[point3d_i] = &landmark;
 
     if(sampleColors)
     {
@@ -243,16 +248,32 @@ bool readPointCloud(IObject iObj, M44d mat, sfmData::SfMData &sfmdata, ESfMData
       }
     }
 
-    const bool hasFeatures = (sampleVisibilityFeatId != nullptr) && (sampleVisibilityFeatId->size() > 0);
-    std::size_t obsGlobalIndex = 0;
+    // offset of the observations of each 3D point in the visibility arrays
+    std::vector<std::size_t> observationsOffset(positions->size() + 1, 0);
     for(std::size_t point3d_i = 0; point3d_i < positions->size(); ++point3d_i)
+      observationsOffset[point3d_i + 1] = observationsOffset[point3d_i] + (*sampleVisibilitySize)[point3d_i];
+
+    if(observationsOffset.back() != sampleVisibilityViewId->size())
     {
-      sfmData::Landmark& landmark = sfmdata.structure[nbPointsInit + point3d_i];
+      ALICEVISION_LOG_ERROR("Alembic Error: the sum of the visibility sizes should be identical to the number of observations.\n"
+                            "# sum of visibility sizes: " << observationsOffset.back() << ".\n"
+                            "# view Ids: " << sampleVisibilityViewId->size() << ".");
+      return false;
+    }
+
+    const bool hasFeatures = (sampleVisibilityFeatId != nullptr) && (sampleVisibilityFeatId->size() > 0);
+
+    // each 3D point owns its observations, they can be filled in parallel
+    #pragma omp parallel for
+    for(int point3d_i = 0; point3d_i < static_cast<int>(positions->size()); ++point3d_i)
+    {
+      sfmData::Landmark& landmark = *landmarksPtr[point3d_i];
 
       // Number of observation for this 3d point
       const std::size_t visibilitySize = (*sampleVisibilitySize)[point3d_i];
+      landmark.observations.reserve(visibilitySize);
 
-      for(std::size_t obs_i = 0; obs_i < visibilitySize; ++obs_i, ++obsGlobalIndex)
+      for(std::size_t obsGlobalIndex = observationsOffset[point3d_i]; obsGlobalIndex < observationsOffset[point3d_i + 1]; ++obsGlobalIndex)
       {
         const int viewId = (*sampleVisibilityViewId)[obsGlobalIndex];
 
@@ -271,7 +292,6 @@ bool readPointCloud(IObject iObj, M44d mat, sfmData::SfMData &sfmdata, ESfMData
         {
           landmark.observations[viewId] = sfmData::Observation();
         }
-
       }
     }
   }
@@ -555,6 +575,11 @@ bool readXform(IXform& xform, M44d& mat, sfmData::SfMData& sfmData, ESfMData fla
   // If we have an animated camera we handle it with the xform here
   if(xform.getSchema().getNumSamples() != 1)
   {
+    if(!(flagsPart & ESfMData::VIEWS) &&
+       !(flagsPart & ESfMData::INTRINSICS) &&
+       !(flagsPart & ESfMData::EXTRINSICS))
+      return true;
+
     ALICEVISION_LOG_DEBUG(xform.getSchema().getNumSamples() << " samples found in this animated xform.");
     for(index_t frame = 0; frame < xform.getSchema().getNumSamples(); ++frame)
     {
@@ -661,7 +686,19 @@ bool readXform(IXform& xform, M44d& mat, sfmData::SfMData& sfmData, ESfMData fla
 void visitObject(IObject iObj, M44d mat, sfmData::SfMData& sfmdata, ESfMData flagsPart, bool isReconstructed = true)
 {
   // ALICEVISION_LOG_DEBUG("ABC visit: " << iObj.getFullName());
-  if(iObj.getName() == "mvgCamerasUndefined")
+  const std::string& name = iObj.getName();
+
+  // lazy import: skip the hierarchies that are not requested
+  if(name == "mvgCloud" && !(flagsPart & ESfMData::STRUCTURE))
+    return;
+
+  if((name == "mvgCameras" || name == "mvgCamerasUndefined") &&
+     !(flagsPart & ESfMData::VIEWS) &&
+     !(flagsPart & ESfMData::INTRINSICS) &&
+     !(flagsPart & ESfMData::EXTRINSICS))
+    return;
+
+  if(name == "mvgCamerasUndefined")
     isReconstructed = false;
   
   const MetaData& md = iObj.getMetaData();
@@ -13,7 +13,10 @@
 #include <boost/test/included/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <tuple>
+#include <vector>
 
 using namespace aliceVision;
 using namespace aliceVision::sfmData;
@@ -272,3 +275,93 @@ BOOST_AUTO_TEST_CASE(AlembicImporter_importExport) {
     }
 
 }
+
+// Landmarks are renumbered by the Alembic import: compare them by content
+std::vector<std::tuple<double, double, double, std::size_t, IndexT, double>> getLandmarksSignature(const SfMData& sfmData)
+{
+  std::vector<std::tuple<double, double, double, std::size_t, IndexT, double>> signature;
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    const Landmark& landmark = landmarkPair.second;
+    IndexT sumFeatIds = 0;
+    double sumPos = 0.0;
+    for(const auto& obsPair : landmark.observations)
+    {
+      sumFeatIds += obsPair.first + obsPair.second.id_feat;
+      sumPos += obsPair.second.x.sum();
+    }
+    signature.emplace_back(landmark.X(0), landmark.X(1), landmark.X(2), landmark.observations.size(), sumFeatIds, sumPos);
+  }
+  std::sort(signature.begin(), signature.end());
+  return signature;
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a scene with many landmarks and observations
+// - Export to Alembic and import it again (full and partial imports)
+// - Check the round trip gives the same scene
+//-----------------
+BOOST_AUTO_TEST_CASE(AlembicImporter_roundTripPartialImport)
+{
+  SfMData sfmData = createTestScene(20, 0, 1, 2, false);
+
+  // landmarks with a variable number of observations
+  const IndexT nbViews = sfmData.getViews().size();
+  for(IndexT i = 0; i < 2000; ++i)
+  {
+    Landmark& landmark = sfmData.structure[i];
+    landmark.X = Vec3(i, 2.0 * i, 3.0 * i);
+    landmark.descType = feature::EImageDescriberType::SIFT;
+    for(IndexT v = 0; v < 2 + (i % 7); ++v)
+      landmark.observations[(i + 3 * v) % nbViews] = Observation(Vec2(i + v, i - v), i * 10 + v);
+  }
+
+  const std::string abcFile = "roundTrip.abc";
+  BOOST_CHECK(Save(sfmData, abcFile, ESfMData(ALL)));
+
+  // full import
+  SfMData sfmDataFull;
+  BOOST_CHECK(Load(sfmDataFull, abcFile, ESfMData(ALL)));
+  BOOST_CHECK_EQUAL(sfmData.getViews().size(), sfmDataFull.getViews().size());
+  BOOST_CHECK_EQUAL(sfmData.getPoses().size(), sfmDataFull.getPoses().size());
+  BOOST_CHECK_EQUAL(sfmData.getIntrinsics().size(), sfmDataFull.getIntrinsics().size());
+  BOOST_CHECK(getLandmarksSignature(sfmData) == getLandmarksSignature(sfmDataFull));
+
+  // export of the imported scene gives the same scene
+  const std::string abcFile2 = "roundTrip2.abc";
+  BOOST_CHECK(Save(sfmDataFull, abcFile2, ESfMData(ALL)));
+  SfMData sfmDataFull2;
+  BOOST_CHECK(Load(sfmDataFull2, abcFile2, ESfMData(ALL)));
+  BOOST_CHECK(sfmDataFull2.getViews().size() == sfmDataFull.getViews().size());
+  BOOST_CHECK(sfmDataFull2.getPoses() == sfmDataFull.getPoses());
+  BOOST_CHECK(sfmDataFull2.getRigs() == sfmDataFull.getRigs());
+  BOOST_CHECK(getLandmarksSignature(sfmDataFull2) == getLandmarksSignature(sfmDataFull));
+
+  // cameras only: the point cloud is not read
+  SfMData sfmDataCameras;
+  BOOST_CHECK(Load(sfmDataCameras, abcFile, ESfMData(VIEWS | INTRINSICS | EXTRINSICS)));
+  BOOST_CHECK_EQUAL(sfmData.getViews().size(), sfmDataCameras.getViews().size());
+  BOOST_CHECK_EQUAL(sfmData.getPoses().size(), sfmDataCameras.getPoses().size());
+  BOOST_CHECK(sfmDataCameras.getLandmarks().empty());
+
+  // structure without observations: the visibility arrays are not read
+  SfMData sfmDataStructure;
+  BOOST_CHECK(Load(sfmDataStructure, abcFile, ESfMData(STRUCTURE)));
+  BOOST_CHECK(sfmDataStructure.getViews().empty());
+  BOOST_CHECK_EQUAL(sfmData.getLandmarks().size(), sfmDataStructure.getLandmarks().size());
+  for(const auto& landmarkPair : sfmDataStructure.getLandmarks())
+    BOOST_CHECK(landmarkPair.second.observations.empty());
+
+  // observations without features: only the view ids are read
+  SfMData sfmDataObservations;
+  BOOST_CHECK(Load(sfmDataObservations, abcFile, ESfMData(STRUCTURE | OBSERVATIONS)));
+  std::size_t nbObservations = 0;
+  std::size_t nbObservationsExpected = 0;
+  for(const auto& landmarkPair : sfmDataObservations.getLandmarks())
+    nbObservations += landmarkPair.second.observations.size();
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+    nbObservationsExpected += landmarkPair.second.observations.size();
+  BOOST_CHECK_EQUAL(nbObservations, nbObservationsExpected);
+}
@@ -0,0 +1,824 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "binaryIO.hpp"
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace bip = boost::interprocess;
+
+namespace {
+
+const char fileMagic[8] = {'A', 'V', 'S', 'F', 'M', 'B', 'I', 'N'};
+const std::uint32_t fileVersionMajor = 1;
+const std::uint32_t fileVersionMinor = 1;
+/// written with the host byte order: the values read in place need the same byte order
+const std::uint32_t byteOrderMark = 0x01020304;
+
+enum class ESection : std::uint32_t
+{
+  FOLDERS = 0,
+  VIEWS = 1,
+  INTRINSICS = 2,
+  POSES = 3,
+  RIGS = 4,
+  STRUCTURE = 5,
+  STRUCTURE_OBSERVATIONS = 6,
+  CONTROL_POINTS = 7,
+  CONTROL_POINTS_OBSERVATIONS = 8
+};
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t versionMajor;
+  std::uint32_t versionMinor;
+  std::uint32_t nbSections;
+  std::uint32_t byteOrder;
+};
+
+struct SectionEntry
+{
+  std::uint32_t type;
+  std::uint32_t reserved;
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+static_assert(sizeof(FileHeader) == 24, "Invalid binary SfMData header size.");
+static_assert(sizeof(SectionEntry) == 24, "Invalid binary SfMData section entry size.");
+
+inline std::size_t alignedSize(std::size_t size)
+{
+  return (size + 7) & ~std::size_t(7);
+}
+
+/**
+ * @brief Binary section writer
+ */
+class SectionWriter
+{
+public:
+  template<typename T>
+  void write(const T& value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written.");
+    _data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void writeString(const std::string& value)
+  {
+    write<std::uint64_t>(value.size());
+    _data.append(value);
+  }
+
+  template<typename Derived>
+  void writeMatrix(const Eigen::MatrixBase<Derived>& matrix)
+  {
+    for(int i = 0; i < matrix.size(); ++i)
+      write<double>(matrix(i));
+  }
+
+  /// write a column, 8 bytes aligned to be read in place
+  template<typename T>
+  void writeColumn(const std::vector<T>& column)
+  {
+    align();
+    _data.append(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+    align();
+  }
+
+  void align()
+  {
+    _data.resize(alignedSize(_data.size()), '\0');
+  }
+
+  const std::string& data() const { return _data; }
+
+private:
+  std::string _data;
+};
+
+/**
+ * @brief Binary section reader on the memory mapped file
+ */
+class SectionReader
+{
+public:
+  SectionReader(const char* data, std::size_t size)
+    : _data(data)
+    , _size(size)
+  {}
+
+  template<typename T>
+  T read()
+  {
+    T value;
+    std::memcpy(&value, get(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string readString()
+  {
+    const std::size_t size = static_cast<std::size_t>(read<std::uint64_t>());
+    return std::string(get(size), size);
+  }
+
+  template<typename Derived>
+  void readMatrix(Eigen::MatrixBase<Derived>& matrix)
+  {
+    for(int i = 0; i < matrix.size(); ++i)
+      matrix(i) = read<double>();
+  }
+
+  /// get a column in place (no copy)
+  template<typename T>
+  const T* readColumn(std::size_t count)
+  {
+    align();
+    // the count comes from the file: check it before computing the column size
+    if(count > _size / sizeof(T))
+      throw std::runtime_error("Invalid binary SfMData section: unexpected end of section.");
+    const T* column = reinterpret_cast<const T*>(get(count * sizeof(T)));
+    align();
+    return column;
+  }
+
+  void align()
+  {
+    _position = std::min(alignedSize(_position), _size);
+  }
+
+  std::size_t size() const { return _size; }
+
+private:
+  const char* get(std::size_t size)
+  {
+    if(size > _size - _position)
+      throw std::runtime_error("Invalid binary SfMData section: unexpected end of section.");
+    const char* data = _data + _position;
+    _position += size;
+    return data;
+  }
+
+  const char* _data;
+  std::size_t _size;
+  std::size_t _position = 0;
+};
+
+void writeFolders(const sfmData::SfMData& sfmData, SectionWriter& section)
+{
+  section.write<std::uint64_t>(sfmData.getRelativeFeaturesFolders().size());
+  for(const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
+    section.writeString(featuresFolder);
+
+  section.write<std::uint64_t>(sfmData.getRelativeMatchesFolders().size());
+  for(const std::string& matchesFolder : sfmData.getRelativeMatchesFolders())
+    section.writeString(matchesFolder);
+}
+
+void readFolders(SectionReader& section, sfmData::SfMData& sfmData)
+{
+  const std::size_t nbFeaturesFolders = section.read<std::uint64_t>();
+  for(std::size_t i = 0; i < nbFeaturesFolders; ++i)
+    sfmData.addFeaturesFolder(section.readString());
+
+  const std::size_t nbMatchesFolders = section.read<std::uint64_t>();
+  for(std::size_t i = 0; i < nbMatchesFolders; ++i)
+    sfmData.addMatchesFolder(section.readString());
+}
+
+void writeViews(const sfmData::Views& views, SectionWriter& section)
+{
+  section.write<std::uint64_t>(views.size());
+
+  for(const auto& viewPair : views)
+  {
+    const sfmData::View& view = *(viewPair.second);
+
+    section.write<std::uint32_t>(view.getViewId());
+    section.write<std::uint32_t>(view.getPoseId());
+    section.write<std::uint32_t>(view.getIntrinsicId());
+    section.write<std::uint32_t>(view.getRigId());
+    section.write<std::uint32_t>(view.getSubPoseId());
+    section.write<std::uint32_t>(view.getFrameId());
+    section.write<std::uint32_t>(view.getResectionId());
+    section.write<std::uint8_t>(view.isPoseIndependant());
+    section.writeString(view.getImagePath());
+    section.write<std::uint64_t>(view.getWidth());
+    section.write<std::uint64_t>(view.getHeight());
+
+    // metadata
+    section.write<std::uint64_t>(view.getMetadata().size());
+    for(const auto& metadataPair : view.getMetadata())
+    {
+      section.writeString(metadataPair.first);
+      section.writeString(metadataPair.second);
+    }
+  }
+}
+
+void readViews(SectionReader& section, sfmData::Views& views)
+{
+  const std::size_t nbViews = section.read<std::uint64_t>();
+
+  for(std::size_t i = 0; i < nbViews; ++i)
+  {
+    std::shared_ptr<sfmData::View> view = std::make_shared<sfmData::View>();
+
+    view->setViewId(section.read<std::uint32_t>());
+    view->setPoseId(section.read<std::uint32_t>());
+    view->setIntrinsicId(section.read<std::uint32_t>());
+    const IndexT rigId = section.read<std::uint32_t>();
+    const IndexT subPoseId = section.read<std::uint32_t>();
+    view->setRigAndSubPoseId(rigId, subPoseId);
+    view->setFrameId(section.read<std::uint32_t>());
+    view->setResectionId(section.read<std::uint32_t>());
+    view->setIndependantPose(section.read<std::uint8_t>() != 0);
+    view->setImagePath(section.readString());
+    view->setWidth(section.read<std::uint64_t>());
+    view->setHeight(section.read<std::uint64_t>());
+
+    // metadata
+    const std::size_t nbMetadata = section.read<std::uint64_t>();
+    for(std::size_t m = 0; m < nbMetadata; ++m)
+    {
+      const std::string key = section.readString();
+      view->addMetadata(key, section.readString());
+    }
+
+    views.emplace(view->getViewId(), view);
+  }
+}
+
+void writeIntrinsics(const sfmData::Intrinsics& intrinsics, SectionWriter& section)
+{
+  section.write<std::uint64_t>(intrinsics.size());
+
+  for(const auto& intrinsicPair : intrinsics)
+  {
+    const camera::IntrinsicBase& intrinsic = *(intrinsicPair.second);
+    const camera::EINTRINSIC intrinsicType = intrinsic.getType();
+
+    section.write<std::uint32_t>(intrinsicPair.first);
+    section.writeString(camera::EINTRINSIC_enumToString(intrinsicType));
+    section.write<std::uint32_t>(intrinsic.w());
+    section.write<std::uint32_t>(intrinsic.h());
+    section.writeString(intrinsic.serialNumber());
+    section.writeString(camera::EIntrinsicInitMode_enumToString(intrinsic.getInitializationMode()));
+    section.write<double>(intrinsic.initialFocalLengthPix());
+    section.write<std::uint8_t>(intrinsic.isLocked());
+    section.write<std::uint8_t>(camera::isPinhole(intrinsicType));
+
+    if(camera::isPinhole(intrinsicType))
+    {
+      const camera::Pinhole& pinholeIntrinsic = dynamic_cast<const camera::Pinhole&>(intrinsic);
+
+      section.write<double>(pinholeIntrinsic.getFocalLengthPix());
+      section.writeMatrix(pinholeIntrinsic.getPrincipalPoint());
+
+      const std::vector<double> distortionParams = pinholeIntrinsic.getDistortionParams();
+      section.write<std::uint64_t>(distortionParams.size());
+      for(double param : distortionParams)
+        section.write<double>(param);
+    }
+  }
+}
+
+void readIntrinsics(SectionReader& section, sfmData::Intrinsics& intrinsics)
+{
+  const std::size_t nbIntrinsics = section.read<std::uint64_t>();
+
+  for(std::size_t i = 0; i < nbIntrinsics; ++i)
+  {
+    const IndexT intrinsicId = section.read<std::uint32_t>();
+    const std::string intrinsicTypeName = section.readString();
+    camera::EINTRINSIC intrinsicType;
+    try
+    {
+      intrinsicType = camera::EINTRINSIC_stringToEnum(intrinsicTypeName);
+    }
+    catch(const std::out_of_range&)
+    {
+      throw std::runtime_error("Invalid binary SfMData: unknown intrinsic type '" + intrinsicTypeName + "'.");
+    }
+    const unsigned int width = section.read<std::uint32_t>();
+    const unsigned int height = section.read<std::uint32_t>();
+    const std::string serialNumber = section.readString();
+    const camera::EIntrinsicInitMode initializationMode = camera::EIntrinsicInitMode_stringToEnum(section.readString());
+    const double initialFocalLengthPix = section.read<double>();
+    const bool locked = (section.read<std::uint8_t>() != 0);
+    const bool isPinhole = (section.read<std::uint8_t>() != 0);
+
+    // check if the camera is a Pinhole model
+    if(!isPinhole)
+      throw std::runtime_error("Invalid binary SfMData: only Pinhole camera models are supported.");
+
+    const double pxFocalLength = section.read<double>();
+    Vec2 principalPoint;
+    section.readMatrix(principalPoint);
+
+    std::vector<double> distortionParams(static_cast<std::size_t>(section.read<std::uint64_t>()));
+    for(double& param : distortionParams)
+      param = section.read<double>();
+
+    // pinhole parameters
+    std::shared_ptr<camera::Pinhole> pinholeIntrinsic = camera::createPinholeIntrinsic(intrinsicType, width, height, pxFocalLength, principalPoint(0), principalPoint(1));
+    pinholeIntrinsic->setInitialFocalLengthPix(initialFocalLengthPix);
+    pinholeIntrinsic->setSerialNumber(serialNumber);
+    pinholeIntrinsic->setInitializationMode(initializationMode);
+
+    // ensure that we have the right number of params
+    distortionParams.resize(pinholeIntrinsic->getDistortionParams().size(), 0.0);
+    pinholeIntrinsic->setDistortionParams(distortionParams);
+
+    // intrinsic lock
+    if(locked)
+      pinholeIntrinsic->lock();
+    else
+      pinholeIntrinsic->unlock();
+
+    intrinsics.emplace(intrinsicId, std::static_pointer_cast<camera::IntrinsicBase>(pinholeIntrinsic));
+  }
+}
+
+void writePoses(const sfmData::Poses& poses, SectionWriter& section)
+{
+  section.write<std::uint64_t>(poses.size());
+
+  for(const auto& posePair : poses)
+  {
+    section.write<std::uint32_t>(posePair.first);
+    section.writeMatrix(posePair.second.getTransform().rotation());
+    section.writeMatrix(posePair.second.getTransform().center());
+    section.write<std::uint8_t>(posePair.second.isLocked());
+  }
+}
+
+void readPoses(SectionReader& section, sfmData::Poses& poses)
+{
+  const std::size_t nbPoses = section.read<std::uint64_t>();
+
+  for(std::size_t i = 0; i < nbPoses; ++i)
+  {
+    const IndexT poseId = section.read<std::uint32_t>();
+    Mat3 rotation;
+    Vec3 center;
+    section.readMatrix(rotation);
+    section.readMatrix(center);
+    const bool locked = (section.read<std::uint8_t>() != 0);
+
+    poses.emplace(poseId, sfmData::CameraPose(geometry::Pose3(rotation, center), locked));
+  }
+}
+
+void writeRigs(const sfmData::Rigs& rigs, SectionWriter& section)
+{
+  section.write<std::uint64_t>(rigs.size());
+
+  for(const auto& rigPair : rigs)
+  {
+    section.write<std::uint32_t>(rigPair.first);
+    section.write<std::uint64_t>(rigPair.second.getSubPoses().size());
+
+    for(const sfmData::RigSubPose& subPose : rigPair.second.getSubPoses())
+    {
+      section.write<std::uint32_t>(static_cast<std::uint32_t>(subPose.status));
+      section.writeMatrix(subPose.pose.rotation());
+      section.writeMatrix(subPose.pose.center());
+    }
+  }
+}
+
+void readRigs(SectionReader& section, sfmData::Rigs& rigs)
+{
+  const std::size_t nbRigs = section.read<std::uint64_t>();
+
+  for(std::size_t i = 0; i < nbRigs; ++i)
+  {
+    const IndexT rigId = section.read<std::uint32_t>();
+    const std::size_t nbSubPoses = section.read<std::uint64_t>();
+    sfmData::Rig rig(nbSubPoses);
+
+    for(std::size_t s = 0; s < nbSubPoses; ++s)
+    {
+      const sfmData::ERigSubPoseStatus status = static_cast<sfmData::ERigSubPoseStatus>(section.read<std::uint32_t>());
+      Mat3 rotation;
+      Vec3 center;
+      section.readMatrix(rotation);
+      section.readMatrix(center);
+
+      rig.setSubPose(s, sfmData::RigSubPose(geometry::Pose3(rotation, center), status));
+    }
+
+    rigs.emplace(rigId, rig);
+  }
+}
+
+/**
+ * @brief Write landmarks and their observations as columns
+ */
+void writeLandmarks(const sfmData::Landmarks& landmarks, bool saveObservations, bool saveFeatures,
+                    SectionWriter& landmarksSection, SectionWriter& observationsSection)
+{
+  const std::size_t nbLandmarks = landmarks.size();
+
+  std::vector<double> X;
+  std::vector<std::uint64_t> observationsOffsets;
+  std::vector<std::uint32_t> landmarkIds;
+  std::vector<std::int32_t> descTypes;
+  std::vector<std::uint8_t> colors;
+
+  X.reserve(3 * nbLandmarks);
+  observationsOffsets.reserve(nbLandmarks + 1);
+  landmarkIds.reserve(nbLandmarks);
+  descTypes.reserve(nbLandmarks);
+  colors.reserve(3 * nbLandmarks);
+
+  std::vector<std::uint32_t> viewIds;
+  std::vector<std::uint32_t> featureIds;
+  std::vector<double> x;
+
+  observationsOffsets.push_back(0);
+
+  for(const auto& landmarkPair : landmarks)
+  {
+    const sfmData::Landmark& landmark = landmarkPair.second;
+
+    landmarkIds.push_back(landmarkPair.first);
+    descTypes.push_back(static_cast<std::int32_t>(landmark.descType));
+    X.insert(X.end(), landmark.X.data(), landmark.X.data() + 3);
+    colors.insert(colors.end(), {landmark.rgb.r(), landmark.rgb.g(), landmark.rgb.b()});
+
+    if(saveObservations)
+    {
+      for(const auto& observationPair : landmark.observations)
+      {
+        viewIds.push_back(observationPair.first);
+
+        if(saveFeatures)
+        {
+          featureIds.push_back(observationPair.second.id_feat);
+          x.insert(x.end(), observationPair.second.x.data(), observationPair.second.x.data() + 2);
+        }
+      }
+    }
+    observationsOffsets.push_back(viewIds.size());
+  }
+
+  landmarksSection.write<std::uint64_t>(nbLandmarks);
+  landmarksSection.write<std::uint64_t>(viewIds.size());
+  landmarksSection.writeColumn(X);
+  landmarksSection.writeColumn(observationsOffsets);
+  landmarksSection.writeColumn(landmarkIds);
+  landmarksSection.writeColumn(descTypes);
+  landmarksSection.writeColumn(colors);
+
+  if(!saveObservations)
+    return;
+
+  observationsSection.write<std::uint64_t>(viewIds.size());
+  observationsSection.write<std::uint32_t>(saveFeatures);
+  observationsSection.write<std::uint32_t>(0);
+  observationsSection.writeColumn(viewIds);
+
+  if(saveFeatures)
+  {
+    observationsSection.writeColumn(featureIds);
+    observationsSection.writeColumn(x);
+  }
+}
+
+/**
+ * @brief Read landmarks and their observations from the columns
+ * @param[in] observationsSection the observations section (nullptr to skip the observations)
+ */
+void readLandmarks(SectionReader& landmarksSection, SectionReader* observationsSection, bool loadFeatures, sfmData::Landmarks& landmarks)
+{
+  const std::size_t nbLandmarks = landmarksSection.read<std::uint64_t>();
+  const std::size_t nbObservations = landmarksSection.read<std::uint64_t>();
+
+  // larger counts cannot fit in the sections and would overflow the columns sizes
+  if(nbLandmarks >= landmarksSection.size() ||
+     (observationsSection != nullptr && nbObservations >= observationsSection->size()))
+    throw std::runtime_error("Invalid binary SfMData: invalid number of landmarks or observations.");
+
+  const double* X = landmarksSection.readColumn<double>(3 * nbLandmarks);
+  const std::uint64_t* observationsOffsets = landmarksSection.readColumn<std::uint64_t>(nbLandmarks + 1);
+  const std::uint32_t* landmarkIds = landmarksSection.readColumn<std::uint32_t>(nbLandmarks);
+  const std::int32_t* descTypes = landmarksSection.readColumn<std::int32_t>(nbLandmarks);
+  const std::uint8_t* colors = landmarksSection.readColumn<std::uint8_t>(3 * nbLandmarks);
+
+  const std::uint32_t* viewIds = nullptr;
+  const std::uint32_t* featureIds = nullptr;
+  const double* x = nullptr;
+
+  if(observationsSection != nullptr)
+  {
+    if(observationsSection->read<std::uint64_t>() != nbObservations)
+      throw std::runtime_error("Invalid binary SfMData: inconsistent number of observations.");
+
+    const bool hasFeatures = (observationsSection->read<std::uint32_t>() != 0);
+    observationsSection->read<std::uint32_t>();
+    viewIds = observationsSection->readColumn<std::uint32_t>(nbObservations);
+
+    if(hasFeatures && loadFeatures)
+    {
+      featureIds = observationsSection->readColumn<std::uint32_t>(nbObservations);
+      x = observationsSection->readColumn<double>(2 * nbObservations);
+    }
+  }
+
+  // landmarks are stored in the map order: insert with a hint
+  auto hint = landmarks.end();
+  for(std::size_t i = 0; i < nbLandmarks; ++i)
+  {
+    hint = landmarks.emplace_hint(hint, landmarkIds[i], sfmData::Landmark());
+    sfmData::Landmark& landmark = hint->second;
+
+    landmark.X = Vec3(X[3 * i], X[3 * i + 1], X[3 * i + 2]);
+    landmark.descType = static_cast<feature::EImageDescriberType>(descTypes[i]);
+    landmark.rgb = image::RGBColor(colors[3 * i], colors[3 * i + 1], colors[3 * i + 2]);
+
+    if(viewIds == nullptr)
+      continue;
+
+    const std::size_t begin = observationsOffsets[i];
+    const std::size_t end = observationsOffsets[i + 1];
+
+    if(begin > end || end > nbObservations)
+      throw std::runtime_error("Invalid binary SfMData: invalid observations offsets.");
+
+    auto observationHint = landmark.observations.end();
+    for(std::size_t o = begin; o < end; ++o)
+    {
+      sfmData::Observation observation;
+      if(featureIds != nullptr)
+      {
+        observation.id_feat = featureIds[o];
+        observation.x = Vec2(x[2 * o], x[2 * o + 1]);
+      }
+      observationHint = landmark.observations.emplace_hint(observationHint, viewIds[o], observation);
+    }
+  }
+}
+
+} // namespace
+
+bool saveBinary(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  // save flags
+  const bool saveViews = (partFlag & VIEWS) == VIEWS;
+  const bool saveIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool saveExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool saveStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool saveControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+  std::vector<std::pair<ESection, SectionWriter>> sections;
+
+  const auto addSection = [&sections](ESection type) -> SectionWriter&
+  {
+    sections.emplace_back(type, SectionWriter());
+    return sections.back().second;
+  };
+
+  writeFolders(sfmData, addSection(ESection::FOLDERS));
+
+  if(saveViews)
+    writeViews(sfmData.getViews(), addSection(ESection::VIEWS));
+
+  if(saveIntrinsics)
+    writeIntrinsics(sfmData.getIntrinsics(), addSection(ESection::INTRINSICS));
+
+  if(saveExtrinsics)
+  {
+    writePoses(sfmData.getPoses(), addSection(ESection::POSES));
+    writeRigs(sfmData.getRigs(), addSection(ESection::RIGS));
+  }
+
+  if(saveStructure)
+  {
+    SectionWriter landmarksSection;
+    SectionWriter observationsSection;
+    writeLandmarks(sfmData.getLandmarks(), saveObservations, saveFeatures, landmarksSection, observationsSection);
+
+    sections.emplace_back(ESection::STRUCTURE, std::move(landmarksSection));
+    if(saveObservations)
+      sections.emplace_back(ESection::STRUCTURE_OBSERVATIONS, std::move(observationsSection));
+  }
+
+  if(saveControlPoints)
+  {
+    SectionWriter landmarksSection;
+    SectionWriter observationsSection;
+    writeLandmarks(sfmData.getControlPoints(), true, true, landmarksSection, observationsSection);
+
+    sections.emplace_back(ESection::CONTROL_POINTS, std::move(landmarksSection));
+    sections.emplace_back(ESection::CONTROL_POINTS_OBSERVATIONS, std::move(observationsSection));
+  }
+
+  // header and section table
+  FileHeader header;
+  std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+  header.versionMajor = fileVersionMajor;
+  header.versionMinor = fileVersionMinor;
+  header.nbSections = static_cast<std::uint32_t>(sections.size());
+  header.byteOrder = byteOrderMark;
+
+  std::vector<SectionEntry> sectionTable(sections.size());
+  std::uint64_t offset = alignedSize(sizeof(FileHeader) + sections.size() * sizeof(SectionEntry));
+
+  for(std::size_t i = 0; i < sections.size(); ++i)
+  {
+    SectionEntry& entry = sectionTable.at(i);
+    entry.type = static_cast<std::uint32_t>(sections.at(i).first);
+    entry.reserved = 0;
+    entry.offset = offset;
+    entry.size = sections.at(i).second.data().size();
+    offset += alignedSize(entry.size);
+  }
+
+  std::ofstream stream(filename, std::ios::binary);
+  if(!stream.is_open())
+    return false;
+
+  const std::size_t tableSize = sizeof(FileHeader) + sectionTable.size() * sizeof(SectionEntry);
+  const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+  stream.write(reinterpret_cast<const char*>(sectionTable.data()), sectionTable.size() * sizeof(SectionEntry));
+  stream.write(padding, alignedSize(tableSize) - tableSize);
+
+  for(const auto& section : sections)
+  {
+    const std::string& data = section.second.data();
+    stream.write(data.data(), data.size());
+    stream.write(padding, alignedSize(data.size()) - data.size());
+  }
+
+  return stream.good();
+}
+
+bool loadBinary(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  // load flags
+  const bool loadViews = (partFlag & VIEWS) == VIEWS;
+  const bool loadIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool loadExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool loadStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool loadControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+  // memory map the file: only the pages of the requested sections are read
+  bip::file_mapping mapping;
+  bip::mapped_region region;
+  try
+  {
+    mapping = bip::file_mapping(filename.c_str(), bip::read_only);
+    region = bip::mapped_region(mapping, bip::read_only);
+  }
+  catch(const bip::interprocess_exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Cannot open the binary SfMData file '" << filename << "': " << e.what());
+    return false;
+  }
+
+  const char* data = static_cast<const char*>(region.get_address());
+  const std::size_t size = region.get_size();
+
+  // header
+  FileHeader header;
+  if(size < sizeof(FileHeader))
+  {
+    ALICEVISION_LOG_ERROR("Invalid binary SfMData file '" << filename << "'.");
+    return false;
+  }
+
+  std::memcpy(&header, data, sizeof(FileHeader));
+
+  if(std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0)
+  {
+    ALICEVISION_LOG_ERROR("Invalid binary SfMData file '" << filename << "'.");
+    return false;
+  }
+
+  if(header.versionMajor != fileVersionMajor)
+  {
+    ALICEVISION_LOG_ERROR("Unsupported binary SfMData file version " << header.versionMajor << "." << header.versionMinor
+                          << " (supported: " << fileVersionMajor << ".x): '" << filename << "'.");
+    return false;
+  }
+
+  // files without byte order mark (version 1.0) were written in little endian
+  const bool hostIsLittleEndian = (*reinterpret_cast<const unsigned char*>(&byteOrderMark) == 0x04);
+  const bool sameByteOrder = (header.byteOrder == 0 && header.versionMinor == 0) ? hostIsLittleEndian : (header.byteOrder == byteOrderMark);
+
+  if(!sameByteOrder)
+  {
+    ALICEVISION_LOG_ERROR("Unsupported binary SfMData file '" << filename << "': written with another byte order.");
+    return false;
+  }
+
+  if(header.nbSections > (size - sizeof(FileHeader)) / sizeof(SectionEntry))
+  {
+    ALICEVISION_LOG_ERROR("Invalid binary SfMData file '" << filename << "': truncated section table.");
+    return false;
+  }
+
+  // section table
+  std::vector<SectionEntry> sectionTable(header.nbSections);
+  std::memcpy(sectionTable.data(), data + sizeof(FileHeader), sectionTable.size() * sizeof(SectionEntry));
+
+  for(const SectionEntry& entry : sectionTable)
+  {
+    if(entry.offset > size || entry.size > size - entry.offset)
+    {
+      ALICEVISION_LOG_ERROR("Invalid binary SfMData file '" << filename << "': truncated section.");
+      return false;
+    }
+  }
+
+  const auto getSection = [&](ESection type) -> std::unique_ptr<SectionReader>
+  {
+    for(const SectionEntry& entry : sectionTable)
+    {
+      // unknown sections (newer minor versions) are ignored
+      if(entry.type == static_cast<std::uint32_t>(type))
+        return std::unique_ptr<SectionReader>(new SectionReader(data + entry.offset, entry.size));
+    }
+    return nullptr;
+  };
+
+  // the section readers throw on malformed content (truncated section, inconsistent counts, unknown enum values)
+  try
+  {
+    if(std::unique_ptr<SectionReader> section = getSection(ESection::FOLDERS))
+      readFolders(*section, sfmData);
+
+    if(loadViews)
+      if(std::unique_ptr<SectionReader> section = getSection(ESection::VIEWS))
+        readViews(*section, sfmData.getViews());
+
+    if(loadIntrinsics)
+      if(std::unique_ptr<SectionReader> section = getSection(ESection::INTRINSICS))
+        readIntrinsics(*section, sfmData.getIntrinsics());
+
+    if(loadExtrinsics)
+    {
+      if(std::unique_ptr<SectionReader> section = getSection(ESection::POSES))
+        readPoses(*section, sfmData.getPoses());
+
+      if(std::unique_ptr<SectionReader> section = getSection(ESection::RIGS))
+        readRigs(*section, sfmData.getRigs());
+    }
+
+    if(loadStructure)
+    {
+      if(std::unique_ptr<SectionReader> section = getSection(ESection::STRUCTURE))
+      {
+        std::unique_ptr<SectionReader> observationsSection = loadObservations ? getSection(ESection::STRUCTURE_OBSERVATIONS) : nullptr;
+        readLandmarks(*section, observationsSection.get(), loadFeatures, sfmData.getLandmarks());
+      }
+    }
+
+    if(loadControlPoints)
+    {
+      if(std::unique_ptr<SectionReader> section = getSection(ESection::CONTROL_POINTS))
+      {
+        std::unique_ptr<SectionReader> observationsSection = getSection(ESection::CONTROL_POINTS_OBSERVATIONS);
+        readLandmarks(*section, observationsSection.get(), true, sfmData.getControlPoints());
+      }
+    }
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Cannot read the binary SfMData file '" << filename << "': " << e.what());
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -0,0 +1,50 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+
+#include <string>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+// AliceVision binary SfMData file (.sfmb):
+// -- Header
+// magic "AVSFMBIN", version major / minor, number of sections, byte order mark
+// -- Section table
+// [section type, offset, size] per section
+// -- Sections (8 bytes aligned, host byte order)
+// folders, views, intrinsics, poses, rigs: serialized records
+// structure, control points: landmark columns [X, observations offsets, ids, descTypes, colors]
+// structure / control points observations: observation columns [x, view ids, feature ids]
+// --
+// Sections are independent: only the sections requested by the ESfMData flags are read,
+// the file is memory mapped and the landmark / observation columns are read in place.
+// Values are stored with the byte order of the host which wrote the file, recorded in the header:
+// a file written with another byte order is rejected.
+
+/**
+ * @brief Save an SfMData in a binary file.
+ * @param[in] sfmData The input SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData save flag
+ * @return true if completed
+ */
+bool saveBinary(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+
+/**
+ * @brief Load a binary SfMData file.
+ * @param[out] sfmData The output SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData load flag, only the corresponding sections are read
+ * @return true if completed, false if the file cannot be read or is malformed (the reason is logged)
+ */
+bool loadBinary(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -6,12 +6,16 @@
 
 #include "jsonIO.hpp"
 #include <aliceVision/camera/camera.hpp>
+#include <aliceVision/sfmDataIO/jsonStream.hpp>
 #include <aliceVision/sfmDataIO/viewIO.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
-#include <boost/property_tree/json_parser.hpp>
-
+#include <algorithm>
+#include <fstream>
 #include <memory>
 #include <cassert>
+#include <stdexcept>
+#include <utility>
 
 namespace aliceVision {
 namespace sfmDataIO {
@@ -276,6 +280,154 @@ void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, bpt::ptree& l
   }
 }
 
+namespace {
+
+/**
+ * @brief Write a Landmark with a JsonWriter (same layout as saveLandmark)
+ */
+void writeLandmark(JsonWriter& writer, IndexT landmarkId, const sfmData::Landmark& landmark, bool saveObservations, bool saveFeatures)
+{
+  writer.beginObject();
+  writer.write("landmarkId", landmarkId);
+  writer.write("descType", feature::EImageDescriberType_enumToString(landmark.descType));
+  writer.writeMatrix("color", landmark.rgb);
+  writer.writeMatrix("X", landmark.X);
+
+  // observations
+  if(saveObservations)
+  {
+    writer.beginArray("observations");
+    for(const auto& obsPair : landmark.observations)
+    {
+      const sfmData::Observation& observation = obsPair.second;
+
+      writer.beginObject();
+      writer.write("observationId", obsPair.first);
+
+      // features
+      if(saveFeatures)
+      {
+        writer.write("featureId", observation.id_feat);
+        writer.writeMatrix("x", observation.x);
+      }
+      writer.endObject();
+    }
+    writer.endArray();
+  }
+
+  writer.endObject();
+}
+
+/**
+ * @brief Write Landmarks in a JSON array.
+ *        Landmarks are formatted in parallel by chunks and written in order.
+ */
+void writeLandmarks(JsonWriter& writer, const std::string& name, const sfmData::Landmarks& landmarks, bool saveObservations, bool saveFeatures)
+{
+  const std::size_t chunkSize = 1024;
+  const std::size_t nbChunksPerBatch = 4 * omp_get_max_threads();
+
+  std::vector<sfmData::Landmarks::const_iterator> landmarkIts;
+  landmarkIts.reserve(landmarks.size());
+  for(auto it = landmarks.begin(); it != landmarks.end(); ++it)
+    landmarkIts.push_back(it);
+
+  const std::size_t nbChunks = (landmarkIts.size() + chunkSize - 1) / chunkSize;
+  std::vector<std::string> chunks(std::min(nbChunks, nbChunksPerBatch));
+
+  writer.beginArray(name);
+
+  // format a batch of chunks in parallel to bound the memory usage
+  for(std::size_t batchStart = 0; batchStart < nbChunks; batchStart += nbChunksPerBatch)
+  {
+    const int nbBatchChunks = static_cast<int>(std::min(nbChunksPerBatch, nbChunks - batchStart));
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int c = 0; c < nbBatchChunks; ++c)
+    {
+      const std::size_t begin = (batchStart + c) * chunkSize;
+      const std::size_t end = std::min(begin + chunkSize, landmarkIts.size());
+
+      chunks[c].clear();
+      JsonWriter chunkWriter(chunks[c], 2);
+
+      for(std::size_t i = begin; i < end; ++i)
+        writeLandmark(chunkWriter, landmarkIts[i]->first, landmarkIts[i]->second, saveObservations, saveFeatures);
+    }
+
+    for(int c = 0; c < nbBatchChunks; ++c)
+    {
+      const std::size_t begin = (batchStart + c) * chunkSize;
+      writer.writeRawElements(chunks[c], std::min(chunkSize, landmarkIts.size() - begin));
+    }
+  }
+
+  writer.endArray();
+}
+
+/**
+ * @brief Read a Landmark with a JsonReader (same layout as loadLandmark)
+ */
+void readLandmark(JsonReader& reader, IndexT& landmarkId, sfmData::Landmark& landmark, bool loadObservations, bool loadFeatures)
+{
+  bool hasLandmarkId = false;
+  std::string key;
+
+  reader.beginObject();
+  while(reader.nextMember(key))
+  {
+    if(key == "landmarkId")
+    {
+      landmarkId = reader.read<IndexT>();
+      hasLandmarkId = true;
+    }
+    else if(key == "descType")
+    {
+      landmark.descType = feature::EImageDescriberType_stringToEnum(reader.readString());
+    }
+    else if(key == "color")
+    {
+      reader.readMatrix(landmark.rgb);
+    }
+    else if(key == "X")
+    {
+      reader.readMatrix(landmark.X);
+    }
+    else if(key == "observations" && loadObservations)
+    {
+      reader.beginArray();
+      while(reader.nextElement())
+      {
+        IndexT observationId = UndefinedIndexT;
+        sfmData::Observation observation;
+
+        reader.beginObject();
+        while(reader.nextMember(key))
+        {
+          if(key == "observationId")
+            observationId = reader.read<IndexT>();
+          else if(key == "featureId" && loadFeatures)
+            observation.id_feat = reader.read<IndexT>();
+          else if(key == "x" && loadFeatures)
+            reader.readMatrix(observation.x);
+          else
+            reader.skipValue();
+        }
+
+        landmark.observations.emplace(observationId, observation);
+      }
+    }
+    else
+    {
+      reader.skipValue();
+    }
+  }
+
+  if(!hasLandmarkId)
+    throw std::runtime_error("Invalid landmark: no landmarkId.");
+}
+
+} // namespace
 
 bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
 {
@@ -290,62 +442,59 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
   const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
   const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
+  std::ofstream stream(filename, std::ios::binary);
+  if(!stream.is_open())
+    throw std::runtime_error("Unable to open " + filename);
 
-  // main tree
-  bpt::ptree fileTree;
+  // the output is the same as boost::property_tree::write_json
+  JsonWriter writer(stream);
+
+  writer.beginObject();
 
   // file version
-  saveMatrix("version", version, fileTree);
+  writer.writeMatrix("version", version);
 
   // folders
   if(!sfmData.getRelativeFeaturesFolders().empty())
   {
-    bpt::ptree featureFoldersTree;
-
+    writer.beginArray("featuresFolders");
     for(const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
-    {
-      bpt::ptree featureFolderTree;
-      featureFolderTree.put("", featuresFolder);
-      featureFoldersTree.push_back(std::make_pair("", featureFolderTree));
-    }
-
-    fileTree.add_child("featuresFolders", featureFoldersTree);
+      writer.write("", featuresFolder);
+    writer.endArray();
   }
 
   if(!sfmData.getRelativeMatchesFolders().empty())
   {
-    bpt::ptree matchingFoldersTree;
-
+    writer.beginArray("matchesFolders");
     for(const std::string& matchesFolder : sfmData.getRelativeMatchesFolders())
-    {
-      bpt::ptree matchingFolderTree;
-      matchingFolderTree.put("", matchesFolder);
-      matchingFoldersTree.push_back(std::make_pair("", matchingFolderTree));
-    }
-
-    fileTree.add_child("matchesFolders", matchingFoldersTree);
+      writer.write("", matchesFolder);
+    writer.endArray();
   }
 
   // views
   if(saveViews && !sfmData.getViews().empty())
   {
-    bpt::ptree viewsTree;
-
+    writer.beginArray("views");
     for(const auto& viewPair : sfmData.getViews())
+    {
+      bpt::ptree viewsTree;
       saveView("", *(viewPair.second), viewsTree);
-
-    fileTree.add_child("views", viewsTree);
+      writer.writePtree("", viewsTree.front().second);
+    }
+    writer.endArray();
   }
 
   // intrinsics
   if(saveIntrinsics && !sfmData.getIntrinsics().empty())
   {
-    bpt::ptree intrinsicsTree;
-
+    writer.beginArray("intrinsics");
     for(const auto& intrinsicPair : sfmData.getIntrinsics())
+    {
+      bpt::ptree intrinsicsTree;
       saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
-
-    fileTree.add_child("intrinsics", intrinsicsTree);
+      writer.writePtree("", intrinsicsTree.front().second);
+    }
+    writer.endArray();
   }
 
   //extrinsics
@@ -354,57 +503,44 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
     // poses
     if(!sfmData.getPoses().empty())
     {
-      bpt::ptree posesTree;
-
+      writer.beginArray("poses");
       for(const auto& posePair : sfmData.getPoses())
       {
         bpt::ptree poseTree;
 
         poseTree.put("poseId", posePair.first);
         saveCameraPose("pose", posePair.second, poseTree);
-        posesTree.push_back(std::make_pair("", poseTree));
+        writer.writePtree("", poseTree);
       }
-
-      fileTree.add_child("poses", posesTree);
+      writer.endArray();
     }
 
     // rigs
     if(!sfmData.getRigs().empty())
     {
-      bpt::ptree rigsTree;
-
+      writer.beginArray("rigs");
       for(const auto& rigPair : sfmData.getRigs())
+      {
+        bpt::ptree rigsTree;
         saveRig("", rigPair.first, rigPair.second, rigsTree);
-
-      fileTree.add_child("rigs", rigsTree);
+        writer.writePtree("", rigsTree.front().second);
+      }
+      writer.endArray();
     }
   }
 
   // structure
   if(saveStructure && !sfmData.getLandmarks().empty())
-  {
-    bpt::ptree structureTree;
-
-    for(const auto& structurePair : sfmData.getLandmarks())
-      saveLandmark("", structurePair.first, structurePair.second, structureTree, saveObservations, saveFeatures);
-
-    fileTree.add_child("structure", structureTree);
-  }
+    writeLandmarks(writer, "structure", sfmData.getLandmarks(), saveObservations, saveFeatures);
 
   // control points
   if(saveControlPoints && !sfmData.getControlPoints().empty())
-  {
-    bpt::ptree controlPointTree;
+    writeLandmarks(writer, "controlPoints", sfmData.getControlPoints(), true, true);
 
-    for(const auto& controlPointPair : sfmData.getControlPoints())
-      saveLandmark("", controlPointPair.first, controlPointPair.second, controlPointTree);
+  writer.endObject();
 
-    fileTree.add_child("controlPoints", controlPointTree);
-  }
-
-  // write the json file with the tree
-
-  bpt::write_json(filename, fileTree);
+  if(!stream.good())
+    throw std::runtime_error("Unable to write " + filename);
 
   return true;
 }
@@ -422,164 +558,174 @@ bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData p
   const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
   const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
-  // main tree
-  bpt::ptree fileTree;
+  // read the whole json file
+  std::string data;
+  {
+    std::ifstream stream(filename, std::ios::binary);
+    if(!stream.is_open())
+      throw std::runtime_error("Unable to open " + filename);
 
-  // read the json file and initialize the tree
-  bpt::read_json(filename, fileTree);
+    stream.seekg(0, std::ios::end);
+    data.resize(static_cast<std::size_t>(stream.tellg()));
+    stream.seekg(0, std::ios::beg);
+    stream.read(&data[0], data.size());
 
-  // version
-  loadMatrix("version", version, fileTree);
+    if(!stream)
+      throw std::runtime_error("Unable to read " + filename);
+  }
 
-  // folders
-  if(fileTree.count("featuresFolders"))
-    for(bpt::ptree::value_type& featureFolderNode : fileTree.get_child("featuresFolders"))
-      sfmData.addFeaturesFolder(featureFolderNode.second.get_value<std::string>());
+  // parse the document in order, without building a tree for the whole file
+  JsonReader reader(std::move(data), filename);
+  std::string key;
 
-  if(fileTree.count("matchesFolders"))
-    for(bpt::ptree::value_type& matchingFolderNode : fileTree.get_child("matchesFolders"))
-      sfmData.addMatchesFolder(matchingFolderNode.second.get_value<std::string>());
+  // views to update once the intrinsics are loaded
+  std::vector<sfmData::View> incompleteViewsToUpdate;
 
-  // intrinsics
-  if(loadIntrinsics && fileTree.count("intrinsics"))
+  reader.beginObject();
+  while(reader.nextMember(key))
   {
-    sfmData::Intrinsics& intrinsics = sfmData.getIntrinsics();
-
-    for(bpt::ptree::value_type &intrinsicNode : fileTree.get_child("intrinsics"))
+    if(key == "version")
     {
-      IndexT intrinsicId;
-      std::shared_ptr<camera::IntrinsicBase> intrinsic;
-
-      loadIntrinsic(intrinsicId, intrinsic, intrinsicNode.second);
-
-      intrinsics.emplace(intrinsicId, intrinsic);
+      reader.readMatrix(version);
     }
-  }
-
-  // views
-  if(loadViews && fileTree.count("views"))
-  {
-    sfmData::Views& views = sfmData.getViews();
-
-    if(incompleteViews)
+    else if(key == "featuresFolders")
+    {
+      reader.beginArray();
+      while(reader.nextElement())
+        sfmData.addFeaturesFolder(reader.readString());
+    }
+    else if(key == "matchesFolders")
     {
-      // store incomplete views in a vector
-      std::vector<sfmData::View> incompleteViews(fileTree.get_child("views").size());
+      reader.beginArray();
+      while(reader.nextElement())
+        sfmData.addMatchesFolder(reader.readString());
+    }
+    else if(key == "intrinsics" && loadIntrinsics)
+    {
+      sfmData::Intrinsics& intrinsics = sfmData.getIntrinsics();
 
-      int viewIndex = 0;
-      for(bpt::ptree::value_type &viewNode : fileTree.get_child("views"))
+      reader.beginArray();
+      while(reader.nextElement())
       {
-        loadView(incompleteViews.at(viewIndex), viewNode.second);
-        ++viewIndex;
-      }
+        bpt::ptree intrinsicTree;
+        IndexT intrinsicId;
+        std::shared_ptr<camera::IntrinsicBase> intrinsic;
 
-      // update incomplete views
-      #pragma omp parallel for
-      for(int i = 0; i < incompleteViews.size(); ++i)
-      {
-        sfmData::View& v = incompleteViews.at(i);
-        // if we have the intrinsics and the view has an valid associated intrinsics
-        // update the width and height field of View (they are mirrored)
-        if (loadIntrinsics && v.getIntrinsicId() != UndefinedIndexT)
-        {
-          const auto intrinsics = sfmData.getIntrinsicPtr(v.getIntrinsicId());
-
-          if(intrinsics == nullptr)
-          {
-            throw std::logic_error("View " + std::to_string(v.getViewId())
-                                   + " has a intrinsics id " +std::to_string(v.getIntrinsicId())
-                                   + " that cannot be found or the intrinsics are not correctly "
-                                     "loaded from the json file.");
-          }
-
-          v.setWidth(intrinsics->w());
-          v.setHeight(intrinsics->h());
-        }
-        updateIncompleteView(incompleteViews.at(i));
-      }
+        reader.readPtree(intrinsicTree);
+        loadIntrinsic(intrinsicId, intrinsic, intrinsicTree);
 
-      // copy complete views in the SfMData views map
-      for(const sfmData::View& view : incompleteViews)
-        views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
+        intrinsics.emplace(intrinsicId, intrinsic);
+      }
     }
-    else
+    else if(key == "views" && loadViews)
     {
-      // store directly in the SfMData views map
-      for(bpt::ptree::value_type &viewNode : fileTree.get_child("views"))
+      sfmData::Views& views = sfmData.getViews();
+
+      reader.beginArray();
+      while(reader.nextElement())
       {
+        bpt::ptree viewTree;
         sfmData::View view;
-        loadView(view, viewNode.second);
-        views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
+
+        reader.readPtree(viewTree);
+        loadView(view, viewTree);
+
+        if(incompleteViews)
+          incompleteViewsToUpdate.push_back(view);
+        else
+          views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
       }
     }
-  }
-
-  // extrinsics
-  if(loadExtrinsics)
-  {
-    // poses
-    if(fileTree.count("poses"))
+    else if(key == "poses" && loadExtrinsics)
     {
       sfmData::Poses& poses = sfmData.getPoses();
 
-      for(bpt::ptree::value_type &poseNode : fileTree.get_child("poses"))
+      reader.beginArray();
+      while(reader.nextElement())
       {
-        bpt::ptree& poseTree = poseNode.second;
+        bpt::ptree poseTree;
         sfmData::CameraPose pose;
 
+        reader.readPtree(poseTree);
         loadCameraPose("pose", pose, poseTree);
 
         poses.emplace(poseTree.get<IndexT>("poseId"), pose);
       }
     }
-
-    // rigs
-    if(fileTree.count("rigs"))
+    else if(key == "rigs" && loadExtrinsics)
     {
       sfmData::Rigs& rigs = sfmData.getRigs();
 
-      for(bpt::ptree::value_type &rigNode : fileTree.get_child("rigs"))
+      reader.beginArray();
+      while(reader.nextElement())
       {
+        bpt::ptree rigTree;
         IndexT rigId;
         sfmData::Rig rig;
 
-        loadRig(rigId, rig, rigNode.second);
+        reader.readPtree(rigTree);
+        loadRig(rigId, rig, rigTree);
 
         rigs.emplace(rigId, rig);
       }
     }
-  }
-
-  // structure
-  if(loadStructure && fileTree.count("structure"))
-  {
-    sfmData::Landmarks& structure = sfmData.getLandmarks();
-
-    for(bpt::ptree::value_type &landmarkNode : fileTree.get_child("structure"))
+    else if((key == "structure" && loadStructure) || (key == "controlPoints" && loadControlPoints))
     {
-      IndexT landmarkId;
-      sfmData::Landmark landmark;
+      const bool isStructure = (key == "structure");
+      sfmData::Landmarks& landmarks = isStructure ? sfmData.getLandmarks() : sfmData.getControlPoints();
 
-      loadLandmark(landmarkId, landmark, landmarkNode.second, loadObservations, loadFeatures);
+      reader.beginArray();
+      while(reader.nextElement())
+      {
+        IndexT landmarkId;
+        sfmData::Landmark landmark;
+
+        if(isStructure)
+          readLandmark(reader, landmarkId, landmark, loadObservations, loadFeatures);
+        else
+          readLandmark(reader, landmarkId, landmark, true, true);
 
-      structure.emplace(landmarkId, landmark);
+        landmarks.emplace(landmarkId, std::move(landmark));
+      }
+    }
+    else
+    {
+      reader.skipValue();
     }
   }
 
-  // control points
-  if(loadControlPoints && fileTree.count("controlPoints"))
+  if(incompleteViews)
   {
-    sfmData::Landmarks& controlPoints = sfmData.getControlPoints();
+    sfmData::Views& views = sfmData.getViews();
 
-    for(bpt::ptree::value_type &landmarkNode : fileTree.get_child("controlPoints"))
+    // update incomplete views
+    #pragma omp parallel for
+    for(int i = 0; i < incompleteViewsToUpdate.size(); ++i)
     {
-      IndexT landmarkId;
-      sfmData::Landmark landmark;
+      sfmData::View& v = incompleteViewsToUpdate.at(i);
+      // if we have the intrinsics and the view has an valid associated intrinsics
+      // update the width and height field of View (they are mirrored)
+      if (loadIntrinsics && v.getIntrinsicId() != UndefinedIndexT)
+      {
+        const auto intrinsics = sfmData.getIntrinsicPtr(v.getIntrinsicId());
 
-      loadLandmark(landmarkId, landmark, landmarkNode.second);
+        if(intrinsics == nullptr)
+        {
+          throw std::logic_error("View " + std::to_string(v.getViewId())
+                                 + " has a intrinsics id " +std::to_string(v.getIntrinsicId())
+                                 + " that cannot be found or the intrinsics are not correctly "
+                                   "loaded from the json file.");
+        }
 
-      controlPoints.emplace(landmarkId, landmark);
+        v.setWidth(intrinsics->w());
+        v.setHeight(intrinsics->h());
+      }
+      updateIncompleteView(incompleteViewsToUpdate.at(i));
     }
+
+    // copy complete views in the SfMData views map
+    for(const sfmData::View& view : incompleteViewsToUpdate)
+      views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
   }
 
   return true;
@@ -204,7 +204,8 @@ void saveLandmark(const std::string& name, IndexT landmarkId, const sfmData::Lan
 void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, bpt::ptree& landmarkTree, bool loadObservations = true, bool loadFeatures = true);
 
 /**
- * @brief Save an SfMData in a JSON file with a boost property tree.
+ * @brief Save an SfMData in a JSON file.
+ *        The file is streamed (landmarks are formatted in parallel), the output is the same as boost::property_tree::write_json.
  * @param[in] sfmData The input SfMData
  * @param[in] filename The filename
  * @param[in] partFlag The ESfMData save flag
@@ -214,6 +215,7 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
 
 /**
  * @brief Load a JSON SfMData file.
+ *        The document is parsed in order without building a property tree of the whole file.
  * @param[out] sfmData The output SfMData
  * @param[in] filename The filename
  * @param[in] partFlag The ESfMData load flag
@@ -0,0 +1,641 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "jsonStream.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace {
+
+/// size of the output buffer flushed to the stream
+const std::size_t writerBufferSize = 1 << 20;
+
+inline bool isWhitespace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline bool isDelimiter(char c)
+{
+  return isWhitespace(c) || c == ',' || c == '}' || c == ']' || c == ':' || c == '\0';
+}
+
+/// append a unicode code point in UTF-8
+void appendUtf8(unsigned long codePoint, std::string& out)
+{
+  if(codePoint < 0x80)
+  {
+    out += static_cast<char>(codePoint);
+  }
+  else if(codePoint < 0x800)
+  {
+    out += static_cast<char>(0xC0 | (codePoint >> 6));
+    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+  }
+  else if(codePoint < 0x10000)
+  {
+    out += static_cast<char>(0xE0 | (codePoint >> 12));
+    out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+  }
+  else
+  {
+    out += static_cast<char>(0xF0 | (codePoint >> 18));
+    out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+  }
+}
+
+} // namespace
+
+std::string toJsonText(float value)
+{
+  // same precision as boost::property_tree (max_digits10)
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.9g", value);
+  return text;
+}
+
+std::string toJsonText(double value)
+{
+  // same precision as boost::property_tree (max_digits10)
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.17g", value);
+  return text;
+}
+
+void appendJsonEscaped(const std::string& value, std::string& out)
+{
+  for(const char ch : value)
+  {
+    const unsigned char c = static_cast<unsigned char>(ch);
+
+    if(c == 0x20 || c == 0x21 || (c >= 0x23 && c <= 0x2E) ||
+       (c >= 0x30 && c <= 0x5B) || (c >= 0x5D))
+    {
+      out += ch;
+    }
+    else
+    {
+      switch(ch)
+      {
+        case '\b': out += "\\b";  break;
+        case '\f': out += "\\f";  break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+        case '/':  out += "\\/";  break;
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        default:
+        {
+          const char* hexdigits = "0123456789ABCDEF";
+          out += "\\u00";
+          out += hexdigits[c / 16];
+          out += hexdigits[c % 16];
+        }
+      }
+    }
+  }
+}
+
+JsonWriter::JsonWriter(std::ostream& stream)
+  : _stream(&stream)
+  , _buffer(&_localBuffer)
+{
+  _localBuffer.reserve(writerBufferSize + 4096);
+}
+
+JsonWriter::JsonWriter(std::string& buffer, int depth)
+  : _buffer(&buffer)
+{
+  // elements of an already opened array
+  _frames.assign(std::max(1, depth), Frame{true, true, 0});
+}
+
+JsonWriter::~JsonWriter()
+{
+  flush();
+}
+
+void JsonWriter::beginObject(const std::string& key)
+{
+  beginContainer(key, false);
+}
+
+void JsonWriter::endObject()
+{
+  endContainer();
+}
+
+void JsonWriter::beginArray(const std::string& key)
+{
+  beginContainer(key, true);
+}
+
+void JsonWriter::endArray()
+{
+  endContainer();
+}
+
+void JsonWriter::writeText(const std::string& key, const std::string& value)
+{
+  beginChild(key);
+  *_buffer += '"';
+  appendJsonEscaped(value, *_buffer);
+  *_buffer += '"';
+
+  if(_stream != nullptr && _buffer->size() > writerBufferSize)
+    flush();
+}
+
+void JsonWriter::writePtree(const std::string& key, const bpt::ptree& tree)
+{
+  // same structure as boost::property_tree::write_json
+  if(tree.empty())
+  {
+    writeText(key, tree.data());
+  }
+  else if(tree.count("") == tree.size())
+  {
+    beginArray(key);
+    for(const auto& child : tree)
+      writePtree("", child.second);
+    endArray();
+  }
+  else
+  {
+    beginObject(key);
+    for(const auto& child : tree)
+      writePtree(child.first, child.second);
+    endObject();
+  }
+}
+
+void JsonWriter::writeRawElements(const std::string& elements, std::size_t nbElements)
+{
+  if(nbElements == 0)
+    return;
+
+  Frame& parent = _frames.back();
+
+  if(parent.nbChildren == 0 && !parent.isOpen)
+  {
+    *_buffer += parent.isArray ? "[\n" : "{\n";
+    parent.isOpen = true;
+  }
+  else if(parent.nbChildren > 0)
+  {
+    *_buffer += ",\n";
+  }
+
+  parent.nbChildren += nbElements;
+
+  if(_stream != nullptr)
+  {
+    flush();
+    _stream->write(elements.data(), elements.size());
+  }
+  else
+  {
+    *_buffer += elements;
+  }
+}
+
+void JsonWriter::beginChild(const std::string& key)
+{
+  Frame& parent = _frames.back();
+
+  // containers are opened with their first child: empty containers are written as ""
+  if(parent.nbChildren == 0 && !parent.isOpen)
+  {
+    *_buffer += parent.isArray ? "[\n" : "{\n";
+    parent.isOpen = true;
+  }
+  else if(parent.nbChildren > 0)
+  {
+    *_buffer += ",\n";
+  }
+
+  ++parent.nbChildren;
+  _buffer->append(4 * _frames.size(), ' ');
+
+  if(!parent.isArray)
+  {
+    *_buffer += '"';
+    appendJsonEscaped(key, *_buffer);
+    *_buffer += "\": ";
+  }
+}
+
+void JsonWriter::beginContainer(const std::string& key, bool isArray)
+{
+  if(!_frames.empty())
+    beginChild(key);
+
+  _frames.push_back(Frame{isArray, false, 0});
+}
+
+void JsonWriter::endContainer()
+{
+  const Frame frame = _frames.back();
+  _frames.pop_back();
+
+  if(frame.nbChildren > 0)
+  {
+    *_buffer += '\n';
+    _buffer->append(4 * _frames.size(), ' ');
+    *_buffer += frame.isArray ? ']' : '}';
+  }
+  else if(_frames.empty())
+  {
+    *_buffer += "{\n}";
+  }
+  else
+  {
+    *_buffer += "\"\"";
+  }
+
+  // end of the document
+  if(_frames.empty())
+  {
+    *_buffer += '\n';
+    flush();
+  }
+}
+
+void JsonWriter::flush()
+{
+  if(_stream == nullptr || _buffer->empty())
+    return;
+
+  _stream->write(_buffer->data(), _buffer->size());
+  _buffer->clear();
+}
+
+JsonReader::JsonReader(std::string data, const std::string& name)
+  : _data(std::move(data))
+  , _begin(_data.c_str())
+  , _current(_data.c_str())
+  , _end(_data.c_str() + _data.size())
+  , _name(name)
+{}
+
+void JsonReader::beginObject()
+{
+  expect('{');
+  _firstChild.push_back(true);
+}
+
+bool JsonReader::nextMember(std::string& key)
+{
+  skipWhitespaces();
+
+  if(peek() == '}')
+  {
+    ++_current;
+    _firstChild.pop_back();
+    return false;
+  }
+
+  if(!_firstChild.back())
+    expect(',');
+  _firstChild.back() = false;
+
+  skipWhitespaces();
+  if(peek() != '"')
+    error("expected member name");
+
+  key = readString();
+  expect(':');
+  return true;
+}
+
+void JsonReader::beginArray()
+{
+  skipWhitespaces();
+
+  // empty arrays are written as ""
+  if(peek() == '"')
+  {
+    if(readString().empty())
+    {
+      _emptyArray = true;
+      return;
+    }
+    error("expected array");
+  }
+
+  expect('[');
+  _firstChild.push_back(true);
+}
+
+bool JsonReader::nextElement()
+{
+  if(_emptyArray)
+  {
+    _emptyArray = false;
+    return false;
+  }
+
+  skipWhitespaces();
+
+  if(peek() == ']')
+  {
+    ++_current;
+    _firstChild.pop_back();
+    return false;
+  }
+
+  if(!_firstChild.back())
+    expect(',');
+  _firstChild.back() = false;
+
+  return true;
+}
+
+std::string JsonReader::readString()
+{
+  std::string value;
+  readToken(value);
+  return value;
+}
+
+double JsonReader::readDouble()
+{
+  const char* begin;
+  const char* end;
+  readNumberToken(begin, end);
+
+  char* parseEnd;
+  const double value = std::strtod(begin, &parseEnd);
+  if(begin == end || parseEnd != end)
+    error("invalid number");
+  return value;
+}
+
+unsigned long long JsonReader::readUnsigned()
+{
+  const char* begin;
+  const char* end;
+  readNumberToken(begin, end);
+
+  char* parseEnd;
+  const unsigned long long value = std::strtoull(begin, &parseEnd, 10);
+  if(begin == end || parseEnd != end)
+    error("invalid integer");
+  return value;
+}
+
+long long JsonReader::readInteger()
+{
+  const char* begin;
+  const char* end;
+  readNumberToken(begin, end);
+
+  char* parseEnd;
+  const long long value = std::strtoll(begin, &parseEnd, 10);
+  if(begin == end || parseEnd != end)
+    error("invalid integer");
+  return value;
+}
+
+bool JsonReader::readBool()
+{
+  const std::string value = readString();
+
+  if(value == "true" || value == "1")
+    return true;
+  if(value == "false" || value == "0")
+    return false;
+
+  error("invalid boolean");
+}
+
+void JsonReader::readPtree(bpt::ptree& tree)
+{
+  // same structure as boost::property_tree::read_json
+  skipWhitespaces();
+
+  const char c = peek();
+  if(c == '{')
+  {
+    std::string key;
+    beginObject();
+    while(nextMember(key))
+    {
+      auto it = tree.push_back(std::make_pair(key, bpt::ptree()));
+      readPtree(it->second);
+    }
+  }
+  else if(c == '[')
+  {
+    beginArray();
+    while(nextElement())
+    {
+      auto it = tree.push_back(std::make_pair(std::string(), bpt::ptree()));
+      readPtree(it->second);
+    }
+  }
+  else
+  {
+    tree.data() = readString();
+  }
+}
+
+void JsonReader::skipValue()
+{
+  skipWhitespaces();
+
+  const char c = peek();
+  if(c == '"')
+  {
+    skipString();
+  }
+  else if(c == '{' || c == '[')
+  {
+    int depth = 0;
+    do
+    {
+      skipWhitespaces();
+      const char ch = peek();
+      if(ch == '"')
+      {
+        skipString();
+        continue;
+      }
+      if(ch == '{' || ch == '[')
+        ++depth;
+      else if(ch == '}' || ch == ']')
+        --depth;
+      ++_current;
+    }
+    while(depth > 0);
+  }
+  else
+  {
+    while(_current < _end && !isDelimiter(*_current))
+      ++_current;
+  }
+}
+
+void JsonReader::skipWhitespaces()
+{
+  while(_current < _end && isWhitespace(*_current))
+    ++_current;
+}
+
+char JsonReader::peek()
+{
+  if(_current >= _end)
+    error("unexpected end of file");
+  return *_current;
+}
+
+void JsonReader::expect(char c)
+{
+  skipWhitespaces();
+  if(peek() != c)
+    error(std::string("expected '") + c + "'");
+  ++_current;
+}
+
+void JsonReader::readToken(std::string& token)
+{
+  skipWhitespaces();
+
+  if(peek() != '"')
+  {
+    // literal: number, true, false, null
+    const char* begin = _current;
+    while(_current < _end && !isDelimiter(*_current))
+      ++_current;
+    if(begin == _current)
+      error("expected value");
+    token.assign(begin, _current);
+    return;
+  }
+
+  ++_current;
+  token.clear();
+
+  while(true)
+  {
+    // copy the characters until the next escape sequence or the end of the string
+    const char* begin = _current;
+    while(_current < _end && *_current != '"' && *_current != '\\')
+      ++_current;
+    token.append(begin, _current);
+
+    if(peek() == '"')
+    {
+      ++_current;
+      return;
+    }
+
+    // escape sequence
+    ++_current;
+    const char c = peek();
+    ++_current;
+
+    switch(c)
+    {
+      case '"':  token += '"';  break;
+      case '\\': token += '\\'; break;
+      case '/':  token += '/';  break;
+      case 'b':  token += '\b'; break;
+      case 'f':  token += '\f'; break;
+      case 'n':  token += '\n'; break;
+      case 'r':  token += '\r'; break;
+      case 't':  token += '\t'; break;
+      case 'u':
+      {
+        const auto readCodeUnit = [this]() -> unsigned long
+        {
+          if(_end - _current < 4)
+            error("invalid unicode escape sequence");
+          char hex[5] = {_current[0], _current[1], _current[2], _current[3], '\0'};
+          char* hexEnd;
+          const unsigned long codeUnit = std::strtoul(hex, &hexEnd, 16);
+          if(hexEnd != hex + 4)
+            error("invalid unicode escape sequence");
+          _current += 4;
+          return codeUnit;
+        };
+
+        unsigned long codePoint = readCodeUnit();
+
+        // surrogate pair
+        if(codePoint >= 0xD800 && codePoint <= 0xDBFF && _end - _current >= 6 && _current[0] == '\\' && _current[1] == 'u')
+        {
+          _current += 2;
+          const unsigned long low = readCodeUnit();
+          codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        }
+        appendUtf8(codePoint, token);
+        break;
+      }
+      default:
+        error("invalid escape sequence");
+    }
+  }
+}
+
+void JsonReader::readNumberToken(const char*& begin, const char*& end)
+{
+  skipWhitespaces();
+
+  if(peek() == '"')
+  {
+    // number written as a string
+    begin = _current + 1;
+    end = static_cast<const char*>(std::memchr(begin, '"', _end - begin));
+    if(end == nullptr)
+      error("unexpected end of file");
+    _current = end + 1;
+    return;
+  }
+
+  begin = _current;
+  while(_current < _end && !isDelimiter(*_current))
+    ++_current;
+  end = _current;
+}
+
+void JsonReader::skipString()
+{
+  ++_current; // opening quote
+  while(true)
+  {
+    const char c = peek();
+    ++_current;
+    if(c == '"')
+      return;
+    if(c == '\\')
+    {
+      peek();
+      ++_current;
+    }
+  }
+}
+
+void JsonReader::error(const std::string& message) const
+{
+  const std::size_t line = 1 + std::count(_begin, std::min(_current, _end), '\n');
+  throw std::runtime_error((_name.empty() ? std::string("JSON") : _name) + "(" + std::to_string(line) + "): " + message);
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
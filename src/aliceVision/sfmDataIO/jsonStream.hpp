@@ -0,0 +1,274 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace bpt = boost::property_tree;
+
+/**
+ * @brief Convert a value to its JSON text, as boost::property_tree does.
+ */
+inline std::string toJsonText(const std::string& value) { return value; }
+inline std::string toJsonText(bool value) { return value ? "true" : "false"; }
+inline std::string toJsonText(unsigned char value) { return std::to_string(static_cast<unsigned int>(value)); }
+inline std::string toJsonText(int value) { return std::to_string(value); }
+inline std::string toJsonText(unsigned int value) { return std::to_string(value); }
+inline std::string toJsonText(long value) { return std::to_string(value); }
+inline std::string toJsonText(unsigned long value) { return std::to_string(value); }
+inline std::string toJsonText(long long value) { return std::to_string(value); }
+inline std::string toJsonText(unsigned long long value) { return std::to_string(value); }
+std::string toJsonText(float value);
+std::string toJsonText(double value);
+
+/**
+ * @brief Escape a string for JSON, as boost::property_tree::json_parser does.
+ * @param[in] value the string to escape
+ * @param[in,out] out the escaped string is appended to out
+ */
+void appendJsonEscaped(const std::string& value, std::string& out);
+
+/**
+ * @brief Streaming JSON writer.
+ *
+ * The output is identical to boost::property_tree::write_json (pretty printed):
+ * 4 spaces indentation, all values written as strings and empty objects / arrays written as "".
+ */
+class JsonWriter
+{
+public:
+
+  /**
+   * @brief Write a JSON document in a stream
+   * @param[in] stream the output stream
+   */
+  explicit JsonWriter(std::ostream& stream);
+
+  /**
+   * @brief Write array elements in a string, to be inserted in a JsonWriter with writeRawElements()
+   * @param[out] buffer the output string
+   * @param[in] depth the depth of the elements in the document
+   */
+  JsonWriter(std::string& buffer, int depth);
+
+  ~JsonWriter();
+
+  /**
+   * @brief Start an object
+   * @param[in] key the object name in the parent object ("" in an array or for the root)
+   */
+  void beginObject(const std::string& key = "");
+  void endObject();
+
+  /**
+   * @brief Start an array
+   * @param[in] key the array name in the parent object ("" in an array)
+   */
+  void beginArray(const std::string& key = "");
+  void endArray();
+
+  /**
+   * @brief Write a value
+   * @param[in] key the value name in the parent object ("" in an array)
+   * @param[in] value the value
+   */
+  template<typename T>
+  void write(const std::string& key, const T& value)
+  {
+    writeText(key, toJsonText(value));
+  }
+
+  void write(const std::string& key, const char* value)
+  {
+    writeText(key, value);
+  }
+
+  /**
+   * @brief Write an Eigen Matrix (or Vector) as an array
+   * @param[in] key the matrix name in the parent object
+   * @param[in] matrix the matrix
+   */
+  template<typename Derived>
+  void writeMatrix(const std::string& key, const Derived& matrix)
+  {
+    beginArray(key);
+    for(int i = 0; i < matrix.size(); ++i)
+      write("", matrix(i));
+    endArray();
+  }
+
+  /**
+   * @brief Write a property tree
+   * @param[in] key the tree name in the parent object ("" in an array)
+   * @param[in] tree the property tree
+   */
+  void writePtree(const std::string& key, const bpt::ptree& tree);
+
+  /**
+   * @brief Insert array elements written by a JsonWriter in a string buffer
+   * @param[in] elements the formatted elements
+   * @param[in] nbElements the number of elements
+   */
+  void writeRawElements(const std::string& elements, std::size_t nbElements);
+
+private:
+  struct Frame
+  {
+    bool isArray;
+    bool isOpen;
+    std::size_t nbChildren;
+  };
+
+  void writeText(const std::string& key, const std::string& value);
+  void beginChild(const std::string& key);
+  void beginContainer(const std::string& key, bool isArray);
+  void endContainer();
+  void flush();
+
+  std::ostream* _stream = nullptr;
+  std::string* _buffer = nullptr;
+  std::string _localBuffer;
+  std::vector<Frame> _frames;
+};
+
+/**
+ * @brief Pull JSON reader, reading the document in order without building a tree.
+ *
+ * Values can be read as strings or numbers whether they are written as JSON strings
+ * (as boost::property_tree does) or as JSON numbers / literals.
+ */
+class JsonReader
+{
+public:
+
+  /**
+   * @brief JsonReader constructor
+   * @param[in] data the JSON document, owned by the reader (move it to avoid a copy)
+   * @param[in] name the document name (for error messages)
+   */
+  explicit JsonReader(std::string data, const std::string& name = "");
+
+  // the read positions point into the owned document
+  JsonReader(const JsonReader&) = delete;
+  JsonReader& operator=(const JsonReader&) = delete;
+
+  /**
+   * @brief Start reading an object
+   */
+  void beginObject();
+
+  /**
+   * @brief Go to the next member of the current object
+   * @param[out] key the member name
+   * @return false at the end of the object
+   */
+  bool nextMember(std::string& key);
+
+  /**
+   * @brief Start reading an array
+   * @note an empty string value is read as an empty array (empty arrays are written as "")
+   */
+  void beginArray();
+
+  /**
+   * @brief Go to the next element of the current array
+   * @return false at the end of the array
+   */
+  bool nextElement();
+
+  /**
+   * @brief Read a value as a string
+   */
+  std::string readString();
+
+  /**
+   * @brief Read a numeric value
+   */
+  double readDouble();
+  unsigned long long readUnsigned();
+  long long readInteger();
+  bool readBool();
+
+  template<typename T>
+  T read();
+
+  /**
+   * @brief Read an array of numbers in an Eigen Matrix (or Vector)
+   * @param[out] matrix the matrix
+   */
+  template<typename Derived>
+  void readMatrix(Derived& matrix)
+  {
+    beginArray();
+    int i = 0;
+    while(nextElement())
+    {
+      if(i >= matrix.size())
+        error("too many values in matrix / vector");
+      matrix(i++) = read<typename Derived::Scalar>();
+    }
+  }
+
+  /**
+   * @brief Read a value in a property tree (as boost::property_tree::read_json)
+   * @param[out] tree the property tree
+   */
+  void readPtree(bpt::ptree& tree);
+
+  /**
+   * @brief Skip a value
+   */
+  void skipValue();
+
+private:
+  void skipWhitespaces();
+  char peek();
+  void expect(char c);
+  /// read a string or a literal (number, true, false, null)
+  void readToken(std::string& token);
+  /// get the raw token of a number: begin and end pointers
+  void readNumberToken(const char*& begin, const char*& end);
+  void skipString();
+  [[noreturn]] void error(const std::string& message) const;
+
+  std::string _data;
+  const char* _begin;
+  const char* _current;
+  const char* _end;
+  std::string _name;
+  /// true if the current array is an empty string value
+  bool _emptyArray = false;
+  std::vector<bool> _firstChild;
+};
+
+template<> inline double JsonReader::read<double>() { return readDouble(); }
+template<> inline float JsonReader::read<float>() { return static_cast<float>(readDouble()); }
+template<> inline bool JsonReader::read<bool>() { return readBool(); }
+template<> inline int JsonReader::read<int>() { return static_cast<int>(readInteger()); }
+template<> inline unsigned int JsonReader::read<unsigned int>() { return static_cast<unsigned int>(readUnsigned()); }
+template<> inline unsigned long JsonReader::read<unsigned long>() { return static_cast<unsigned long>(readUnsigned()); }
+template<> inline unsigned long long JsonReader::read<unsigned long long>() { return readUnsigned(); }
+template<> inline std::string JsonReader::read<std::string>() { return readString(); }
+
+template<> inline unsigned char JsonReader::read<unsigned char>()
+{
+  const unsigned long long value = readUnsigned();
+  if(value > 255)
+    error("value out of range");
+  return static_cast<unsigned char>(value);
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -9,9 +9,11 @@
 #include <aliceVision/config.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
 #include <aliceVision/sfmDataIO/jsonIO.hpp>
+#include <aliceVision/sfmDataIO/binaryIO.hpp>
 #include <aliceVision/sfmDataIO/plyIO.hpp>
 #include <aliceVision/sfmDataIO/bafIO.hpp>
 #include <aliceVision/sfmDataIO/gtIO.hpp>
+#include <aliceVision/system/Tracer.hpp>
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
 #include <aliceVision/sfmDataIO/AlembicExporter.hpp>
@@ -94,6 +96,8 @@ bool ValidIds(const sfmData::SfMData& sfmData, ESfMData partFlag)
 
 bool Load(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
 {
+  ALICEVISION_TRACE_ZONE("sfmDataIO::Load");
+
   const std::string extension = fs::extension(filename);
   bool status = false;
 
@@ -101,6 +105,10 @@ bool Load(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partF
   {
     status = loadJSON(sfmData, filename, partFlag);
   }
+  else if(extension == ".sfmb") // Binary File
+  {
+    status = loadBinary(sfmData, filename, partFlag);
+  }
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
   else if(extension == ".abc") // Alembic
   {
@@ -119,8 +127,13 @@ bool Load(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partF
   }
 
   if(status)
+  {
     sfmData.setAbsolutePath(filename);
 
+    if(fs::is_regular_file(filename))
+      ALICEVISION_TRACE_COUNTER(system::traceCounter::bytesRead, fs::file_size(filename));
+  }
+
   // Assert that loaded intrinsics | extrinsics are linked to valid view
   if(status && (partFlag & VIEWS) && ((partFlag & INTRINSICS) || (partFlag & EXTRINSICS)))
     return ValidIds(sfmData, partFlag);
@@ -130,6 +143,8 @@ bool Load(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partF
 
 bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
 {
+  ALICEVISION_TRACE_ZONE("sfmDataIO::Save");
+
   const fs::path bPath = fs::path(filename);
   const std::string extension = bPath.extension().string();
   const std::string tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + extension;
@@ -139,6 +154,10 @@ bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData
   {
     status = saveJSON(sfmData, tmpPath, partFlag);
   }
+  else if(extension == ".sfmb") // Binary File
+  {
+    status = saveBinary(sfmData, tmpPath, partFlag);
+  }
   else if(extension == ".ply") // Polygon File
   {
     status = savePLY(sfmData, tmpPath, partFlag);
@@ -163,7 +182,10 @@ bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData
 
   // rename temporay filename
   if(status)
+  {
+    ALICEVISION_TRACE_COUNTER(system::traceCounter::bytesWritten, fs::file_size(tmpPath));
     fs::rename(tmpPath, filename);
+  }
 
   return status;
 }
@@ -7,9 +7,17 @@
 
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/sfm/sfm.hpp>
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
+#include <aliceVision/sfmDataIO/jsonStream.hpp>
 
 #include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <sstream>
 
 #define BOOST_TEST_MODULE sfmDataIO
@@ -175,6 +183,285 @@ BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD_JSON) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(SfMData_IO_JSON_sameAsPropertyTree) {
+
+  sfmData::SfMData sfmData = createTestScene(3, 5, false);
+
+  sfmData.addFeaturesFolder("features/sift");
+  sfmData.addMatchesFolder("matches");
+  sfmData.getViews().at(0)->addMetadata("Exif:Make", "Camera \"Make\"\t/\\");
+  sfmData.getViews().at(1)->addMetadata("Exif:Model", "Mod\u00e8le\x01");
+  sfmData.getViews().at(2)->setRigAndSubPoseId(0, 0);
+  sfmData.getRigs().emplace(0, sfmData::Rig(1));
+
+  // more landmarks than a serialization chunk
+  for(IndexT i = 1; i < 3000; ++i)
+  {
+    sfmData::Landmark& landmark = sfmData.structure[i];
+    landmark.X = Vec3(i * 0.1, -1.0 / (i + 1), 1e-20 * i);
+    landmark.rgb = image::RGBColor(i % 256, 255, 0);
+    landmark.descType = feature::EImageDescriberType::AKAZE;
+
+    // landmark without observation
+    if(i % 100 == 0)
+      continue;
+
+    for(IndexT viewId = 0; viewId < 3; ++viewId)
+      landmark.observations[viewId] = sfmData::Observation(Vec2(i / 3.0, viewId + 0.5), i * 3 + viewId);
+  }
+  sfmData.control_points[42].X = Vec3(1, 2, 3);
+  sfmData.control_points[42].descType = feature::EImageDescriberType::SIFT;
+  sfmData.control_points[42].observations[1] = sfmData::Observation(Vec2(10.5, 20.5), UndefinedIndexT);
+
+  // reference: boost::property_tree
+  std::string reference;
+  {
+    bpt::ptree fileTree;
+    saveMatrix("version", Vec3(1, 0, 0), fileTree);
+
+    bpt::ptree featureFoldersTree;
+    for(const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
+    {
+      bpt::ptree featureFolderTree;
+      featureFolderTree.put("", featuresFolder);
+      featureFoldersTree.push_back(std::make_pair("", featureFolderTree));
+    }
+    fileTree.add_child("featuresFolders", featureFoldersTree);
+
+    bpt::ptree matchingFoldersTree;
+    for(const std::string& matchesFolder : sfmData.getRelativeMatchesFolders())
+    {
+      bpt::ptree matchingFolderTree;
+      matchingFolderTree.put("", matchesFolder);
+      matchingFoldersTree.push_back(std::make_pair("", matchingFolderTree));
+    }
+    fileTree.add_child("matchesFolders", matchingFoldersTree);
+
+    bpt::ptree viewsTree;
+    for(const auto& viewPair : sfmData.getViews())
+      saveView("", *(viewPair.second), viewsTree);
+    fileTree.add_child("views", viewsTree);
+
+    bpt::ptree intrinsicsTree;
+    for(const auto& intrinsicPair : sfmData.getIntrinsics())
+      saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
+    fileTree.add_child("intrinsics", intrinsicsTree);
+
+    bpt::ptree posesTree;
+    for(const auto& posePair : sfmData.getPoses())
+    {
+      bpt::ptree poseTree;
+      poseTree.put("poseId", posePair.first);
+      saveCameraPose("pose", posePair.second, poseTree);
+      posesTree.push_back(std::make_pair("", poseTree));
+    }
+    fileTree.add_child("poses", posesTree);
+
+    bpt::ptree rigsTree;
+    for(const auto& rigPair : sfmData.getRigs())
+      saveRig("", rigPair.first, rigPair.second, rigsTree);
+    fileTree.add_child("rigs", rigsTree);
+
+    bpt::ptree structureTree;
+    for(const auto& structurePair : sfmData.getLandmarks())
+      saveLandmark("", structurePair.first, structurePair.second, structureTree);
+    fileTree.add_child("structure", structureTree);
+
+    bpt::ptree controlPointTree;
+    for(const auto& controlPointPair : sfmData.getControlPoints())
+      saveLandmark("", controlPointPair.first, controlPointPair.second, controlPointTree);
+    fileTree.add_child("controlPoints", controlPointTree);
+
+    std::ostringstream stream;
+    bpt::write_json(stream, fileTree);
+    reference = stream.str();
+  }
+
+  const std::string filename = "SAVE_LOAD_STREAM.sfm";
+  BOOST_CHECK(Save(sfmData, filename, ALL));
+
+  std::string output;
+  {
+    std::ifstream stream(filename, std::ios::binary);
+    std::ostringstream content;
+    content << stream.rdbuf();
+    output = content.str();
+  }
+
+  BOOST_CHECK(output == reference);
+
+  sfmData::SfMData sfmDataLoad;
+  BOOST_CHECK(Load(sfmDataLoad, filename, ALL));
+
+  BOOST_CHECK_EQUAL(sfmDataLoad.getRelativeFeaturesFolders().size(), 1);
+  BOOST_CHECK_EQUAL(sfmDataLoad.getRigs().size(), 1);
+  BOOST_CHECK_EQUAL(sfmDataLoad.getView(0).getMetadata().at("Exif:Make"), sfmData.getView(0).getMetadata().at("Exif:Make"));
+  BOOST_CHECK_EQUAL(sfmDataLoad.getView(1).getMetadata().at("Exif:Model"), sfmData.getView(1).getMetadata().at("Exif:Model"));
+  BOOST_CHECK(sfmDataLoad.getLandmarks() == sfmData.getLandmarks());
+  BOOST_CHECK(sfmDataLoad.getControlPoints() == sfmData.getControlPoints());
+  BOOST_CHECK(sfmDataLoad.getLandmarks().at(100).observations.empty());
+  BOOST_CHECK_EQUAL(sfmDataLoad.getLandmarks().at(7).X(2), sfmData.getLandmarks().at(7).X(2));
+
+  // the file written by boost::property_tree is read the same way
+  {
+    std::ofstream stream(filename, std::ios::binary);
+    stream << reference;
+  }
+  sfmData::SfMData sfmDataLoadReference;
+  BOOST_CHECK(Load(sfmDataLoadReference, filename, ALL));
+  BOOST_CHECK(sfmDataLoadReference.getLandmarks() == sfmData.getLandmarks());
+  BOOST_CHECK_EQUAL(sfmDataLoadReference.getViews().size(), sfmData.getViews().size());
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_JSON_readerOwnsDocument) {
+
+  // the document is a temporary: the reader keeps its own copy
+  JsonReader reader(std::string("{\"a\": \"1.5\", \"b\": [1, 2], \"c\": \"text\"}"), "temporary");
+
+  std::string key;
+  reader.beginObject();
+
+  BOOST_CHECK(reader.nextMember(key));
+  BOOST_CHECK_EQUAL(key, "a");
+  BOOST_CHECK_EQUAL(reader.readDouble(), 1.5);
+
+  BOOST_CHECK(reader.nextMember(key));
+  BOOST_CHECK_EQUAL(key, "b");
+  Vec2 b;
+  reader.readMatrix(b);
+  BOOST_CHECK_EQUAL(b(1), 2.0);
+
+  BOOST_CHECK(reader.nextMember(key));
+  BOOST_CHECK_EQUAL(reader.readString(), "text");
+  BOOST_CHECK(!reader.nextMember(key));
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD_BINARY) {
+
+  sfmData::SfMData sfmData = createTestScene(3, 5, false);
+  sfmData.addFeaturesFolder("features");
+  sfmData.getViews().at(0)->addMetadata("Exif:Make", "Make");
+  sfmData.getViews().at(2)->setRigAndSubPoseId(0, 0);
+  sfmData.getRigs().emplace(0, sfmData::Rig(1));
+  sfmData.getPoses().at(1).lock();
+  sfmData.structure[1].X = Vec3(1, 2, 3);
+  sfmData.structure[1].descType = feature::EImageDescriberType::AKAZE;
+  sfmData.control_points[42].X = Vec3(4, 5, 6);
+  sfmData.control_points[42].descType = feature::EImageDescriberType::SIFT;
+  sfmData.control_points[42].observations[1] = sfmData::Observation(Vec2(10.5, 20.5), UndefinedIndexT);
+
+  const std::string filename = "SAVE_LOAD.sfmb";
+  BOOST_CHECK(Save(sfmData, filename, ALL));
+
+  // LOAD
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(Load(sfmDataLoad, filename, ALL));
+    BOOST_CHECK(sfmDataLoad == sfmData);
+    BOOST_CHECK(sfmDataLoad.getControlPoints() == sfmData.getControlPoints());
+    BOOST_CHECK_EQUAL(sfmDataLoad.getRelativeFeaturesFolders().size(), 1);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getView(0).getMetadata().at("Exif:Make"), "Make");
+  }
+
+  // LOAD (only a subpart: VIEWS)
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(Load(sfmDataLoad, filename, VIEWS));
+    BOOST_CHECK_EQUAL(sfmDataLoad.views.size(), sfmData.views.size());
+    BOOST_CHECK_EQUAL(sfmDataLoad.getPoses().size(), 0);
+    BOOST_CHECK_EQUAL(sfmDataLoad.intrinsics.size(), 0);
+    BOOST_CHECK_EQUAL(sfmDataLoad.structure.size(), 0);
+  }
+
+  // LOAD (only a subpart: STRUCTURE without observations)
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(Load(sfmDataLoad, filename, STRUCTURE));
+    BOOST_CHECK_EQUAL(sfmDataLoad.structure.size(), sfmData.structure.size());
+    BOOST_CHECK(sfmDataLoad.structure.at(0).observations.empty());
+    BOOST_CHECK_EQUAL(sfmDataLoad.structure.at(1).X(2), 3.0);
+  }
+
+  // JSON -> binary -> JSON conversion
+  {
+    BOOST_CHECK(Save(sfmData, "SAVE_LOAD_CONVERSION.sfm", ALL));
+    sfmData::SfMData sfmDataJSON;
+    BOOST_CHECK(Load(sfmDataJSON, "SAVE_LOAD_CONVERSION.sfm", ALL));
+    BOOST_CHECK(Save(sfmDataJSON, filename, ALL));
+    sfmData::SfMData sfmDataBinary;
+    BOOST_CHECK(Load(sfmDataBinary, filename, ALL));
+    BOOST_CHECK(sfmDataBinary == sfmDataJSON);
+  }
+
+  // corrupted files
+  {
+    std::string data;
+    {
+      std::ifstream stream(filename, std::ios::binary);
+      data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+    const auto saveCorrupted = [&](const std::string& corruptedData) {
+      std::ofstream stream("SAVE_LOAD_CORRUPTED.sfmb", std::ios::binary);
+      stream.write(corruptedData.data(), corruptedData.size());
+    };
+
+    // byte order mark (last header field)
+    std::string corruptedData = data;
+    std::reverse(corruptedData.begin() + 20, corruptedData.begin() + 24);
+    saveCorrupted(corruptedData);
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(!Load(sfmDataLoad, "SAVE_LOAD_CORRUPTED.sfmb", ALL));
+
+    // offset of a section in the file
+    const auto getSectionOffset = [&](std::uint32_t sectionType) -> std::uint64_t
+    {
+      std::uint32_t nbSections;
+      std::memcpy(&nbSections, data.data() + 16, sizeof(nbSections));
+      for(std::uint32_t i = 0; i < nbSections; ++i)
+      {
+        const char* entry = data.data() + 24 + 24 * i;
+        std::uint32_t type;
+        std::uint64_t offset;
+        std::memcpy(&type, entry, sizeof(type));
+        std::memcpy(&offset, entry + 8, sizeof(offset));
+        if(type == sectionType)
+          return offset;
+      }
+      return 0;
+    };
+
+    // number of landmarks: 3 * nbLandmarks overflows
+    const std::uint64_t structureOffset = getSectionOffset(5);
+    BOOST_REQUIRE_NE(structureOffset, 0);
+    corruptedData = data;
+    const std::uint64_t nbLandmarks = 0x5555555555555556ull;
+    std::memcpy(&corruptedData[structureOffset], &nbLandmarks, sizeof(nbLandmarks));
+    saveCorrupted(corruptedData);
+    sfmData::SfMData sfmDataLoadStructure;
+    BOOST_CHECK(!Load(sfmDataLoadStructure, "SAVE_LOAD_CORRUPTED.sfmb", ALL));
+
+    // unknown intrinsic type: first character of the type string of the first intrinsic
+    // (number of intrinsics, intrinsic id, string size)
+    const std::uint64_t intrinsicsOffset = getSectionOffset(2);
+    BOOST_REQUIRE_NE(intrinsicsOffset, 0);
+    corruptedData = data;
+    corruptedData[intrinsicsOffset + 8 + 4 + 8] = '#';
+    saveCorrupted(corruptedData);
+    sfmData::SfMData sfmDataLoadIntrinsics;
+    BOOST_CHECK(!Load(sfmDataLoadIntrinsics, "SAVE_LOAD_CORRUPTED.sfmb", ALL));
+
+    // truncated section: the views section ends before its content
+    const std::uint64_t viewsOffset = getSectionOffset(1);
+    BOOST_REQUIRE_NE(viewsOffset, 0);
+    corruptedData = data;
+    const std::uint64_t nbViews = 1000000;
+    std::memcpy(&corruptedData[viewsOffset], &nbViews, sizeof(nbViews));
+    saveCorrupted(corruptedData);
+    sfmData::SfMData sfmDataLoadViews;
+    BOOST_CHECK(!Load(sfmDataLoadViews, "SAVE_LOAD_CORRUPTED.sfmb", ALL));
+  }
+}
+
 /*
 BOOST_AUTO_TEST_CASE(SfMData_IO_BigFile) {
   const int nbViews = 1000;
@@ -0,0 +1,142 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MemoryBudget.hpp"
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+constexpr std::size_t oneMB = 1024 * 1024;
+
+} // namespace
+
+MemoryBudget& MemoryBudget::get()
+{
+  static MemoryBudget budget;
+  return budget;
+}
+
+void MemoryBudget::setMaxMemory(std::size_t maxMemory)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _maxMemory = maxMemory;
+  _overflowLogged = false;
+}
+
+std::size_t MemoryBudget::getMaxMemory() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _maxMemory;
+}
+
+std::size_t MemoryBudget::getAvailableMemory() const
+{
+  // the free RAM already excludes the tracked memory
+  const std::size_t freeRam = getMemoryInfo().freeRam;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if(_maxMemory == 0)
+    return freeRam;
+
+  const std::size_t budgetAvailable = (_maxMemory > _trackedMemory) ? _maxMemory - _trackedMemory : 0;
+
+  // the free RAM can be unknown (0) on some systems
+  if(freeRam == 0)
+    return budgetAvailable;
+
+  return std::min(budgetAvailable, freeRam);
+}
+
+void MemoryBudget::track(const std::string& category, std::int64_t delta)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  CategoryStats& stats = _categories[category];
+
+  if(delta >= 0)
+  {
+    stats.current += static_cast<std::size_t>(delta);
+    _trackedMemory += static_cast<std::size_t>(delta);
+  }
+  else
+  {
+    const std::size_t released = std::min(stats.current, static_cast<std::size_t>(-delta));
+    stats.current -= released;
+    _trackedMemory -= released;
+  }
+
+  stats.peak = std::max(stats.peak, stats.current);
+  _peakTrackedMemory = std::max(_peakTrackedMemory, _trackedMemory);
+
+  if(_maxMemory != 0 && _trackedMemory > _maxMemory && !_overflowLogged)
+  {
+    _overflowLogged = true;
+    ALICEVISION_LOG_WARNING("Memory budget exceeded: " << _trackedMemory / oneMB << " MB tracked for a budget of "
+                            << _maxMemory / oneMB << " MB (last allocation: " << category << ").");
+  }
+}
+
+std::size_t MemoryBudget::getTrackedMemory() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _trackedMemory;
+}
+
+std::size_t MemoryBudget::getPeakTrackedMemory() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _peakTrackedMemory;
+}
+
+std::map<std::string, MemoryBudget::CategoryStats> MemoryBudget::getCategoriesStats() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _categories;
+}
+
+void MemoryBudget::logReport() const
+{
+  const std::size_t peakRSS = getPeakResidentSetSize();
+  const std::size_t maxMemory = getMaxMemory();
+
+  std::stringstream ss;
+  ss << "Memory report:" << std::endl
+     << "\t- budget: " << (maxMemory == 0 ? std::string("no limit") : std::to_string(maxMemory / oneMB) + " MB") << std::endl
+     << "\t- peak resident set size: " << peakRSS / oneMB << " MB" << std::endl
+     << "\t- peak tracked memory: " << getPeakTrackedMemory() / oneMB << " MB";
+
+  for(const auto& categoryPair : getCategoriesStats())
+    ss << std::endl << "\t\t- " << categoryPair.first << ": " << categoryPair.second.peak / oneMB << " MB";
+
+  ALICEVISION_LOG_INFO(ss.str());
+
+  if(maxMemory != 0 && peakRSS > maxMemory)
+    ALICEVISION_LOG_WARNING("The peak resident set size (" << peakRSS / oneMB << " MB) exceeds the memory budget (" << maxMemory / oneMB << " MB).");
+}
+
+MemoryBudgetScope::MemoryBudgetScope(std::size_t maxMemoryMB)
+{
+  MemoryBudget::get().setMaxMemory(maxMemoryMB * oneMB);
+
+  if(maxMemoryMB != 0)
+    ALICEVISION_LOG_INFO("Memory budget: " << maxMemoryMB << " MB.");
+}
+
+MemoryBudgetScope::~MemoryBudgetScope()
+{
+  MemoryBudget::get().logReport();
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,157 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Process memory budget.
+ *
+ * The caches and the chunked algorithms query the available memory to size themselves,
+ * and declare their large allocations per category (e.g. "imagesCache") so that the
+ * tracked memory is subtracted from the budget and reported at exit.
+ * Without limit (the default), the available memory is the free RAM.
+ */
+class MemoryBudget
+{
+public:
+
+  /**
+   * @brief Tracked memory of a category
+   */
+  struct CategoryStats
+  {
+    /// currently tracked size (in bytes)
+    std::size_t current = 0;
+    /// maximum tracked size (in bytes)
+    std::size_t peak = 0;
+  };
+
+  /**
+   * @brief Get the memory budget instance
+   */
+  static MemoryBudget& get();
+
+  /**
+   * @brief Set the maximum memory usage
+   * @param[in] maxMemory the maximum memory in bytes, 0 for no limit
+   */
+  void setMaxMemory(std::size_t maxMemory);
+
+  /**
+   * @brief Get the maximum memory usage
+   * @return the maximum memory in bytes, 0 if there is no limit
+   */
+  std::size_t getMaxMemory() const;
+
+  /**
+   * @brief Check if a maximum memory usage is set
+   */
+  bool hasLimit() const
+  {
+    return getMaxMemory() != 0;
+  }
+
+  /**
+   * @brief Get the memory that can still be used by a new allocation:
+   *        the budget minus the tracked memory, bounded by the free RAM
+   * @return the available memory in bytes
+   */
+  std::size_t getAvailableMemory() const;
+
+  /**
+   * @brief Add an allocation (positive delta) or a release (negative delta) to a category
+   * @param[in] category the category name
+   * @param[in] delta the size variation in bytes
+   */
+  void track(const std::string& category, std::int64_t delta);
+
+  /**
+   * @brief Get the total tracked memory
+   * @return the tracked memory in bytes
+   */
+  std::size_t getTrackedMemory() const;
+
+  /**
+   * @brief Get the maximum total tracked memory
+   * @return the tracked memory in bytes
+   */
+  std::size_t getPeakTrackedMemory() const;
+
+  /**
+   * @brief Get the tracked memory of each category
+   */
+  std::map<std::string, CategoryStats> getCategoriesStats() const;
+
+  /**
+   * @brief Log the budget, the peak resident set size and the tracked memory per category
+   */
+  void logReport() const;
+
+private:
+  MemoryBudget() = default;
+
+  mutable std::mutex _mutex;
+  std::size_t _maxMemory = 0;
+  std::size_t _trackedMemory = 0;
+  std::size_t _peakTrackedMemory = 0;
+  std::map<std::string, CategoryStats> _categories;
+  /// the budget overflow warning is logged only once
+  bool _overflowLogged = false;
+};
+
+/**
+ * @brief Track an allocation in the memory budget during the lifetime of the object
+ */
+class MemoryReservation
+{
+public:
+  MemoryReservation(const std::string& category, std::size_t size)
+    : _category(category)
+    , _size(size)
+  {
+    MemoryBudget::get().track(_category, static_cast<std::int64_t>(_size));
+  }
+
+  ~MemoryReservation()
+  {
+    MemoryBudget::get().track(_category, -static_cast<std::int64_t>(_size));
+  }
+
+  MemoryReservation(const MemoryReservation&) = delete;
+  MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+private:
+  const std::string _category;
+  const std::size_t _size;
+};
+
+/**
+ * @brief Set the memory budget from the --maxMemory option and log the memory report on destruction
+ */
+class MemoryBudgetScope
+{
+public:
+  /**
+   * @param[in] maxMemoryMB the maximum memory in MB, 0 for no limit
+   */
+  explicit MemoryBudgetScope(std::size_t maxMemoryMB);
+  ~MemoryBudgetScope();
+
+  MemoryBudgetScope(const MemoryBudgetScope&) = delete;
+  MemoryBudgetScope& operator=(const MemoryBudgetScope&) = delete;
+};
+
+} // namespace system
+} // namespace aliceVision
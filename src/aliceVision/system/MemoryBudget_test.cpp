@@ -0,0 +1,74 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/MemoryBudget.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+
+#define BOOST_TEST_MODULE MemoryBudget
+#include <boost/test/included/unit_test.hpp>
+
+#include <vector>
+
+using namespace aliceVision::system;
+
+BOOST_AUTO_TEST_CASE(MemoryBudget_tracking)
+{
+  MemoryBudget& budget = MemoryBudget::get();
+  budget.setMaxMemory(1000);
+
+  BOOST_CHECK(budget.hasLimit());
+  BOOST_CHECK_EQUAL(budget.getTrackedMemory(), 0);
+
+  {
+    MemoryReservation reservationA("a", 300);
+    BOOST_CHECK_EQUAL(budget.getTrackedMemory(), 300);
+    BOOST_CHECK(budget.getAvailableMemory() <= 700);
+
+    {
+      MemoryReservation reservationB("b", 500);
+      BOOST_CHECK_EQUAL(budget.getTrackedMemory(), 800);
+      BOOST_CHECK(budget.getAvailableMemory() <= 200);
+    }
+
+    budget.track("a", 100);
+    budget.track("a", -100);
+    BOOST_CHECK_EQUAL(budget.getTrackedMemory(), 300);
+  }
+
+  BOOST_CHECK_EQUAL(budget.getTrackedMemory(), 0);
+  BOOST_CHECK_EQUAL(budget.getPeakTrackedMemory(), 800);
+
+  const auto stats = budget.getCategoriesStats();
+  BOOST_CHECK_EQUAL(stats.at("a").peak, 400);
+  BOOST_CHECK_EQUAL(stats.at("a").current, 0);
+  BOOST_CHECK_EQUAL(stats.at("b").peak, 500);
+
+  // releasing more than tracked does not underflow
+  budget.track("b", -1000);
+  BOOST_CHECK_EQUAL(budget.getTrackedMemory(), 0);
+
+  // over budget: no memory available
+  {
+    MemoryReservation reservation("c", 2000);
+    BOOST_CHECK_EQUAL(budget.getAvailableMemory(), 0);
+  }
+
+  // no limit: the available memory is the free RAM
+  budget.setMaxMemory(0);
+  BOOST_CHECK(!budget.hasLimit());
+}
+
+BOOST_AUTO_TEST_CASE(MemoryBudget_peakResidentSetSize)
+{
+  const std::size_t size = 64 * 1024 * 1024;
+  std::vector<char> buffer(size, 1);
+
+  const std::size_t peakRSS = getPeakResidentSetSize();
+#if defined(__linux__) || defined(__APPLE__) || defined(_WIN32)
+  BOOST_CHECK_GE(peakRSS, size);
+#endif
+  BOOST_CHECK_EQUAL(buffer.back(), 1);
+}
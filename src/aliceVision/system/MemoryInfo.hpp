@@ -24,6 +24,12 @@ struct MemoryInfo
 
 MemoryInfo getMemoryInfo();
 
+/**
+ * @brief Get the maximum resident set size of the current process
+ * @return the peak RSS in bytes, 0 if unknown
+ */
+std::size_t getPeakResidentSetSize();
+
 std::ostream& operator<<(std::ostream& os, const MemoryInfo& infos);
 
 }
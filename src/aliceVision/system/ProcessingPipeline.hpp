@@ -0,0 +1,258 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Multi-stage processing pipeline with a bounded number of items in flight.
+ *
+ * Each item goes through all the stages in order. Each stage has its own worker threads,
+ * so that I/O bound stages (e.g. decode, encode) and compute bound stages run at the same time.
+ * At most maxInFlight items are alive in the pipeline, which bounds the memory usage.
+ *
+ * The first exception thrown by a stage stops the pipeline and is rethrown by run().
+ *
+ * @tparam T item type, default constructed when the item enters the pipeline
+ */
+template<typename T>
+class ProcessingPipeline
+{
+public:
+  typedef std::function<void(std::size_t index, T& item)> StageFunction;
+  typedef std::function<void(std::size_t index)> ItemDoneCallback;
+
+  /**
+   * @brief ProcessingPipeline constructor
+   * @param[in] maxInFlight maximum number of items alive in the pipeline
+   */
+  explicit ProcessingPipeline(std::size_t maxInFlight)
+    : _maxInFlight(std::max(std::size_t(1), maxInFlight))
+  {}
+
+  /**
+   * @brief Add a stage at the end of the pipeline
+   * @param[in] name the stage name (for logging)
+   * @param[in] nbThreads the number of worker threads of this stage
+   * @param[in] function the stage function, called once per item
+   */
+  void addStage(const std::string& name, int nbThreads, const StageFunction& function)
+  {
+    std::unique_ptr<Stage> stage(new Stage);
+    stage->name = name;
+    stage->nbThreads = std::max(1, nbThreads);
+    stage->function = function;
+    _stages.push_back(std::move(stage));
+  }
+
+  /**
+   * @brief Set a callback called when an item leaves the pipeline
+   * @note the callback is called under the pipeline lock, it doesn't need to be thread-safe
+   */
+  void setItemDoneCallback(const ItemDoneCallback& callback)
+  {
+    _itemDoneCallback = callback;
+  }
+
+  /**
+   * @brief Process the items [0, nbItems) through all the stages
+   * @param[in] nbItems the number of items
+   */
+  void run(std::size_t nbItems)
+  {
+    if(_stages.empty())
+      return;
+
+    _nbItems = nbItems;
+    _nextItem = 0;
+    _nbInFlight = 0;
+    _nbDone = 0;
+    _abort = false;
+    _error = nullptr;
+
+    for(auto& stage : _stages)
+    {
+      stage->queue.clear();
+      stage->nbFinishedThreads = 0;
+      stage->busyTimeMs = 0.0;
+    }
+
+    const Timer timer;
+    std::vector<std::thread> threads;
+
+    for(std::size_t s = 0; s < _stages.size(); ++s)
+      for(int t = 0; t < _stages[s]->nbThreads; ++t)
+        threads.emplace_back(&ProcessingPipeline::workerLoop, this, s);
+
+    for(std::thread& thread : threads)
+      thread.join();
+
+    _elapsedMs = timer.elapsedMs();
+
+    if(_error)
+      std::rethrow_exception(_error);
+  }
+
+  /**
+   * @brief Log the elapsed time, the throughput and the occupancy of each stage of the last run
+   */
+  void logStats() const
+  {
+    std::ostringstream os;
+    os << "Pipeline processed " << _nbDone << " items in " << prettyTime(_elapsedMs)
+       << " (" << (_elapsedMs > 0.0 ? (1000.0 * _nbDone / _elapsedMs) : 0.0) << " items/s)";
+
+    for(const auto& stage : _stages)
+    {
+      const double occupancy = (_elapsedMs > 0.0) ? (100.0 * stage->busyTimeMs / (_elapsedMs * stage->nbThreads)) : 0.0;
+      os << std::endl << "\t- " << stage->name << " (" << stage->nbThreads << " threads): "
+         << (_nbDone > 0 ? (stage->busyTimeMs / _nbDone) : 0.0) << " ms per item, "
+         << occupancy << "% busy";
+    }
+    ALICEVISION_LOG_INFO(os.str());
+  }
+
+private:
+  typedef std::pair<std::size_t, std::unique_ptr<T>> Item;
+
+  struct Stage
+  {
+    std::string name;
+    int nbThreads = 1;
+    StageFunction function;
+    /// items waiting to be processed by this stage
+    std::deque<Item> queue;
+    std::condition_variable condition;
+    int nbFinishedThreads = 0;
+    double busyTimeMs = 0.0;
+  };
+
+  /**
+   * @brief Wait for the next item of the given stage
+   * @return false if there is nothing left to do
+   * @note _mutex should be locked
+   */
+  bool waitItem(std::size_t s, std::unique_lock<std::mutex>& lock, Item& item)
+  {
+    Stage& stage = *_stages[s];
+
+    if(s == 0)
+    {
+      // new items enter the pipeline as long as the in-flight budget allows it
+      stage.condition.wait(lock, [&]{ return _abort || _nextItem >= _nbItems || _nbInFlight < _maxInFlight; });
+
+      if(_abort || _nextItem >= _nbItems)
+        return false;
+
+      item.first = _nextItem++;
+      item.second.reset(new T);
+      ++_nbInFlight;
+      return true;
+    }
+
+    const Stage& previousStage = *_stages[s - 1];
+    stage.condition.wait(lock, [&]{ return _abort || !stage.queue.empty() || previousStage.nbFinishedThreads == previousStage.nbThreads; });
+
+    if(_abort || stage.queue.empty())
+      return false;
+
+    item = std::move(stage.queue.front());
+    stage.queue.pop_front();
+    return true;
+  }
+
+  void workerLoop(std::size_t s)
+  {
+    Stage& stage = *_stages[s];
+    const bool isLastStage = (s + 1 == _stages.size());
+
+    while(true)
+    {
+      Item item;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if(!waitItem(s, lock, item))
+          break;
+      }
+
+      const Timer timer;
+      try
+      {
+        stage.function(item.first, *item.second);
+      }
+      catch(...)
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(!_error)
+          _error = std::current_exception();
+        _abort = true;
+        for(auto& otherStage : _stages)
+          otherStage->condition.notify_all();
+        break;
+      }
+      const double busyTimeMs = timer.elapsedMs();
+
+      std::lock_guard<std::mutex> lock(_mutex);
+      stage.busyTimeMs += busyTimeMs;
+
+      if(isLastStage)
+      {
+        // release the item memory before admitting a new one
+        item.second.reset();
+        --_nbInFlight;
+        ++_nbDone;
+        if(_itemDoneCallback)
+          _itemDoneCallback(item.first);
+        _stages.front()->condition.notify_one();
+      }
+      else
+      {
+        _stages[s + 1]->queue.push_back(std::move(item));
+        _stages[s + 1]->condition.notify_one();
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++stage.nbFinishedThreads;
+    if(!isLastStage && stage.nbFinishedThreads == stage.nbThreads)
+      _stages[s + 1]->condition.notify_all();
+  }
+
+  std::vector<std::unique_ptr<Stage>> _stages;
+  ItemDoneCallback _itemDoneCallback;
+
+  /// protects the stage queues and the pipeline state
+  std::mutex _mutex;
+  std::size_t _maxInFlight;
+  std::size_t _nbItems = 0;
+  std::size_t _nextItem = 0;
+  std::size_t _nbInFlight = 0;
+  std::size_t _nbDone = 0;
+  bool _abort = false;
+  std::exception_ptr _error;
+  double _elapsedMs = 0.0;
+};
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,74 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/ProcessingPipeline.hpp>
+
+#define BOOST_TEST_MODULE ProcessingPipeline
+#include <boost/test/included/unit_test.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace aliceVision;
+
+struct PipelineItem
+{
+  int value = 0;
+};
+
+BOOST_AUTO_TEST_CASE(ProcessingPipeline_allItemsGoThroughAllStages)
+{
+  const std::size_t nbItems = 100;
+  const std::size_t maxInFlight = 4;
+
+  std::vector<int> results(nbItems, 0);
+  std::atomic<int> nbAlive(0);
+  std::atomic<int> maxAlive(0);
+  std::size_t nbDone = 0;
+
+  system::ProcessingPipeline<PipelineItem> pipeline(maxInFlight);
+
+  pipeline.addStage("load", 2, [&](std::size_t index, PipelineItem& item)
+  {
+    const int alive = ++nbAlive;
+    int previousMax = maxAlive;
+    while(alive > previousMax && !maxAlive.compare_exchange_weak(previousMax, alive)) {}
+    item.value = static_cast<int>(index);
+  });
+  pipeline.addStage("process", 3, [](std::size_t index, PipelineItem& item)
+  {
+    item.value = item.value * 2 + 1;
+  });
+  pipeline.addStage("save", 2, [&](std::size_t index, PipelineItem& item)
+  {
+    results[index] = item.value;
+    --nbAlive;
+  });
+  pipeline.setItemDoneCallback([&](std::size_t index) { ++nbDone; });
+
+  pipeline.run(nbItems);
+
+  BOOST_CHECK_EQUAL(nbDone, nbItems);
+  BOOST_CHECK_LE(maxAlive, static_cast<int>(maxInFlight));
+  for(std::size_t i = 0; i < nbItems; ++i)
+    BOOST_CHECK_EQUAL(results[i], 2 * static_cast<int>(i) + 1);
+}
+
+BOOST_AUTO_TEST_CASE(ProcessingPipeline_exceptionStopsThePipeline)
+{
+  system::ProcessingPipeline<PipelineItem> pipeline(2);
+
+  pipeline.addStage("load", 1, [](std::size_t index, PipelineItem& item) { item.value = static_cast<int>(index); });
+  pipeline.addStage("process", 2, [](std::size_t index, PipelineItem& item)
+  {
+    if(index == 10)
+      throw std::runtime_error("invalid item");
+  });
+  pipeline.addStage("save", 1, [](std::size_t index, PipelineItem& item) {});
+
+  BOOST_CHECK_THROW(pipeline.run(1000), std::runtime_error);
+}
@@ -0,0 +1,276 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Tracer.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+enum class ETraceEventType : std::uint8_t
+{
+  ZONE,
+  COUNTER
+};
+
+struct TraceEvent
+{
+  /// zone or counter name
+  const char* name;
+  /// zone start time or counter sample time (ns)
+  std::int64_t timestamp;
+  /// zone duration (ns) or counter value
+  std::int64_t value;
+  ETraceEventType type;
+};
+
+/**
+ * @brief Ring buffer of the events of one thread.
+ *        Only the owner thread writes in it, the mutex is locked by the export.
+ */
+struct ThreadBuffer
+{
+  std::mutex mutex;
+  std::vector<TraceEvent> events;
+  std::uint64_t nbRecorded = 0;
+  std::size_t threadIndex = 0;
+
+  void push(const TraceEvent& event)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    events[nbRecorded % events.size()] = event;
+    ++nbRecorded;
+  }
+};
+
+struct TracerState
+{
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  std::map<std::string, std::int64_t> counters;
+  std::size_t nbEventsPerThread = 65536;
+  /// incremented at each start, the thread buffers of a previous recording are replaced
+  std::atomic<std::uint64_t> generation{0};
+  /// start time (steady clock, ns)
+  std::atomic<std::int64_t> startTime{0};
+};
+
+TracerState& getState()
+{
+  static TracerState state;
+  return state;
+}
+
+thread_local std::shared_ptr<ThreadBuffer> threadBuffer;
+thread_local std::uint64_t threadBufferGeneration = 0;
+
+ThreadBuffer& getThreadBuffer()
+{
+  TracerState& state = getState();
+  const std::uint64_t generation = state.generation.load(std::memory_order_acquire);
+
+  if(threadBuffer == nullptr || threadBufferGeneration != generation)
+  {
+    std::shared_ptr<ThreadBuffer> buffer = std::make_shared<ThreadBuffer>();
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    buffer->events.resize(std::max<std::size_t>(state.nbEventsPerThread, 1));
+    buffer->threadIndex = state.buffers.size();
+    state.buffers.push_back(buffer);
+
+    threadBuffer = buffer;
+    threadBufferGeneration = generation;
+  }
+  return *threadBuffer;
+}
+
+std::int64_t getSteadyClockTime()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void writeJsonString(std::ostream& stream, const char* str)
+{
+  stream << '"';
+  for(const char* c = str; *c != '\0'; ++c)
+  {
+    if(*c == '"' || *c == '\\')
+      stream << '\\' << *c;
+    else if(static_cast<unsigned char>(*c) < 0x20)
+      stream << ' ';
+    else
+      stream << *c;
+  }
+  stream << '"';
+}
+
+/// write a time in microseconds (Chrome trace unit) from nanoseconds
+void writeMicroseconds(std::ostream& stream, std::int64_t ns)
+{
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.3f", static_cast<double>(ns) / 1000.0);
+  stream << buffer;
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::_enabled{false};
+
+Tracer& Tracer::get()
+{
+  static Tracer tracer;
+  return tracer;
+}
+
+void Tracer::start(std::size_t nbEventsPerThread)
+{
+  TracerState& state = getState();
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.buffers.clear();
+    state.counters.clear();
+    state.nbEventsPerThread = nbEventsPerThread;
+    state.startTime.store(getSteadyClockTime());
+    state.generation.fetch_add(1, std::memory_order_release);
+  }
+  _enabled.store(true);
+}
+
+void Tracer::stop()
+{
+  _enabled.store(false);
+}
+
+std::int64_t Tracer::now() const
+{
+  return getSteadyClockTime() - getState().startTime.load(std::memory_order_relaxed);
+}
+
+void Tracer::addZone(const char* name, std::int64_t begin, std::int64_t end)
+{
+  getThreadBuffer().push({name, begin, end - begin, ETraceEventType::ZONE});
+}
+
+void Tracer::addToCounter(const char* name, std::int64_t delta)
+{
+  TracerState& state = getState();
+  std::int64_t value;
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    value = (state.counters[name] += delta);
+  }
+  getThreadBuffer().push({name, now(), value, ETraceEventType::COUNTER});
+}
+
+bool Tracer::exportChromeTrace(const std::string& filename) const
+{
+  std::ofstream stream(filename);
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Unable to write the trace file: " << filename);
+    return false;
+  }
+
+  TracerState& state = getState();
+  std::lock_guard<std::mutex> stateLock(state.mutex);
+
+  std::uint64_t nbEvents = 0;
+  std::uint64_t nbOverwrittenEvents = 0;
+
+  stream << "{\"traceEvents\":[\n";
+  stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"AliceVision\"}}";
+
+  for(const std::shared_ptr<ThreadBuffer>& buffer : state.buffers)
+  {
+    std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+    const std::size_t tid = buffer->threadIndex;
+    stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid
+           << ",\"args\":{\"name\":\"thread " << tid << "\"}}";
+
+    const std::size_t capacity = buffer->events.size();
+    const std::uint64_t nbBufferEvents = std::min<std::uint64_t>(buffer->nbRecorded, capacity);
+    const std::uint64_t first = buffer->nbRecorded - nbBufferEvents;
+
+    for(std::uint64_t i = first; i < buffer->nbRecorded; ++i)
+    {
+      const TraceEvent& event = buffer->events[i % capacity];
+
+      stream << ",\n{\"name\":";
+      writeJsonString(stream, event.name);
+      stream << ",\"cat\":\"aliceVision\",\"pid\":0,\"tid\":" << tid << ",\"ts\":";
+      writeMicroseconds(stream, event.timestamp);
+
+      if(event.type == ETraceEventType::ZONE)
+      {
+        stream << ",\"ph\":\"X\",\"dur\":";
+        writeMicroseconds(stream, event.value);
+        stream << "}";
+      }
+      else
+      {
+        stream << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+      }
+    }
+
+    nbEvents += nbBufferEvents;
+    nbOverwrittenEvents += first;
+  }
+
+  stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+  if(!stream.good())
+  {
+    ALICEVISION_LOG_ERROR("Unable to write the trace file: " << filename);
+    return false;
+  }
+
+  ALICEVISION_LOG_INFO("Trace exported: " << filename << std::endl
+                       << "\t- # threads: " << state.buffers.size() << std::endl
+                       << "\t- # events: " << nbEvents);
+
+  if(nbOverwrittenEvents > 0)
+    ALICEVISION_LOG_WARNING("Trace: " << nbOverwrittenEvents << " events were overwritten (ring buffers full).");
+
+  return true;
+}
+
+TraceFile::TraceFile(const std::string& filename)
+  : _filename(filename)
+{
+  if(_filename.empty())
+    return;
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_TRACING)
+  Tracer::get().start();
+#else
+  ALICEVISION_LOG_WARNING("Tracing is disabled in this build (ALICEVISION_USE_TRACING), the trace file will be empty.");
+#endif
+}
+
+TraceFile::~TraceFile()
+{
+  if(_filename.empty())
+    return;
+
+  Tracer& tracer = Tracer::get();
+  tracer.stop();
+  tracer.exportChromeTrace(_filename);
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,174 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/config.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Names of the counters shared by the instrumented modules
+ */
+namespace traceCounter {
+
+/// bytes read from files (images, features, matches, sfmData, ...)
+constexpr const char* bytesRead = "bytesRead";
+/// bytes written in files
+constexpr const char* bytesWritten = "bytesWritten";
+/// number of large buffer allocations (images, depth maps, volumes, ...)
+constexpr const char* allocations = "allocations";
+/// size of the large buffer allocations
+constexpr const char* allocatedBytes = "allocatedBytes";
+
+} // namespace traceCounter
+
+/**
+ * @brief CPU tracer: records scoped zones and counters in per-thread ring buffers
+ *        and exports them in the Chrome trace event format (chrome://tracing, Perfetto).
+ *
+ * Recording is disabled until start() is called, a disabled zone only costs an atomic load.
+ * Zone and counter names must be string literals (only the pointer is recorded).
+ * The instrumentation macros are removed at compile time if ALICEVISION_USE_TRACING is OFF.
+ */
+class Tracer
+{
+public:
+
+  /**
+   * @brief Get the tracer instance
+   */
+  static Tracer& get();
+
+  /**
+   * @brief Check if the events are recorded
+   */
+  static bool isEnabled()
+  {
+    return _enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Start recording, previously recorded events are discarded
+   * @param[in] nbEventsPerThread the ring buffer size of each thread, the oldest events are overwritten
+   */
+  void start(std::size_t nbEventsPerThread = 65536);
+
+  /**
+   * @brief Stop recording, recorded events are kept until the next start()
+   */
+  void stop();
+
+  /**
+   * @brief Get the time since the tracer start
+   * @return time in nanoseconds
+   */
+  std::int64_t now() const;
+
+  /**
+   * @brief Record a zone in the current thread
+   * @param[in] name the zone name (string literal)
+   * @param[in] begin the zone start time, from now()
+   * @param[in] end the zone end time, from now()
+   */
+  void addZone(const char* name, std::int64_t begin, std::int64_t end);
+
+  /**
+   * @brief Increment a counter and record its new value in the current thread
+   * @param[in] name the counter name (string literal)
+   * @param[in] delta the increment
+   */
+  void addToCounter(const char* name, std::int64_t delta);
+
+  /**
+   * @brief Export the recorded events in a Chrome trace JSON file
+   * @param[in] filename the output filename
+   * @return true if the file is written
+   */
+  bool exportChromeTrace(const std::string& filename) const;
+
+private:
+  Tracer() = default;
+
+  static std::atomic<bool> _enabled;
+};
+
+/**
+ * @brief Record a zone from the object construction to its destruction
+ */
+class TraceZone
+{
+public:
+  explicit TraceZone(const char* name)
+    : _name(name)
+    , _begin(Tracer::isEnabled() ? Tracer::get().now() : -1)
+  {}
+
+  ~TraceZone()
+  {
+    if(_begin >= 0 && Tracer::isEnabled())
+    {
+      Tracer& tracer = Tracer::get();
+      tracer.addZone(_name, _begin, tracer.now());
+    }
+  }
+
+  TraceZone(const TraceZone&) = delete;
+  TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+  const char* _name;
+  const std::int64_t _begin;
+};
+
+/**
+ * @brief Record a trace during the lifetime of the object and export it on destruction.
+ *        Nothing is recorded if the filename is empty (e.g. the --traceFile option is not set).
+ */
+class TraceFile
+{
+public:
+  explicit TraceFile(const std::string& filename);
+  ~TraceFile();
+
+  TraceFile(const TraceFile&) = delete;
+  TraceFile& operator=(const TraceFile&) = delete;
+
+private:
+  std::string _filename;
+};
+
+} // namespace system
+} // namespace aliceVision
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_TRACING)
+
+#define ALICEVISION_TRACE_CONCAT_IMPL(a, b) a##b
+#define ALICEVISION_TRACE_CONCAT(a, b) ALICEVISION_TRACE_CONCAT_IMPL(a, b)
+
+/// record a zone until the end of the current scope
+#define ALICEVISION_TRACE_ZONE(name) \
+  const ::aliceVision::system::TraceZone ALICEVISION_TRACE_CONCAT(aliceVisionTraceZone, __LINE__)(name)
+
+/// increment a counter, the delta expression is only evaluated if the tracer is enabled
+#define ALICEVISION_TRACE_COUNTER(name, delta) \
+  do { \
+    if(::aliceVision::system::Tracer::isEnabled()) \
+      ::aliceVision::system::Tracer::get().addToCounter(name, static_cast<std::int64_t>(delta)); \
+  } while(0)
+
+#else
+
+#define ALICEVISION_TRACE_ZONE(name) do {} while(0)
+#define ALICEVISION_TRACE_COUNTER(name, delta) do {} while(0)
+
+#endif
@@ -0,0 +1,119 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Tracer.hpp>
+
+#define BOOST_TEST_MODULE Tracer
+#include <boost/test/included/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aliceVision::system;
+
+namespace bpt = boost::property_tree;
+
+namespace {
+
+/// count the exported events per phase ("X", "C", "M") and get the final value of each counter
+void readTrace(const std::string& filename, std::map<std::string, int>& nbEventsPerPhase, std::map<std::string, long long>& counters)
+{
+  bpt::ptree tree;
+  bpt::read_json(filename, tree);
+
+  for(const auto& eventNode : tree.get_child("traceEvents"))
+  {
+    const std::string phase = eventNode.second.get<std::string>("ph");
+    ++nbEventsPerPhase[phase];
+
+    if(phase == "C")
+    {
+      long long& value = counters[eventNode.second.get<std::string>("name")];
+      value = std::max(value, eventNode.second.get<long long>("args.value"));
+    }
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Tracer_zonesAndCounters)
+{
+  const std::string filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("trace_%%%%%%.json")).string();
+
+  {
+    TraceFile traceFile(filename);
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; ++t)
+    {
+      threads.emplace_back([]() {
+        for(int i = 0; i < 10; ++i)
+        {
+          ALICEVISION_TRACE_ZONE("zone");
+          ALICEVISION_TRACE_COUNTER(traceCounter::bytesRead, 100);
+        }
+      });
+    }
+    for(std::thread& thread : threads)
+      thread.join();
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_TRACING)
+    BOOST_CHECK(Tracer::isEnabled());
+#else
+    BOOST_CHECK(!Tracer::isEnabled());
+#endif
+  }
+
+  BOOST_CHECK(!Tracer::isEnabled());
+
+  std::map<std::string, int> nbEventsPerPhase;
+  std::map<std::string, long long> counters;
+  readTrace(filename, nbEventsPerPhase, counters);
+  boost::filesystem::remove(filename);
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_TRACING)
+  BOOST_CHECK_EQUAL(nbEventsPerPhase["X"], 40);
+  BOOST_CHECK_EQUAL(nbEventsPerPhase["C"], 40);
+  // the counter is a total over all the threads
+  BOOST_CHECK_EQUAL(counters[traceCounter::bytesRead], 4000);
+#else
+  BOOST_CHECK_EQUAL(nbEventsPerPhase["X"], 0);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(Tracer_ringBuffer)
+{
+  const std::string filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("trace_%%%%%%.json")).string();
+
+  Tracer& tracer = Tracer::get();
+  tracer.start(8);
+
+  // only the most recent events are kept
+  for(int i = 0; i < 20; ++i)
+    tracer.addZone("zone", tracer.now(), tracer.now());
+
+  tracer.stop();
+
+  // nothing is recorded once stopped
+  {
+    ALICEVISION_TRACE_ZONE("stopped");
+  }
+
+  BOOST_CHECK(tracer.exportChromeTrace(filename));
+
+  std::map<std::string, int> nbEventsPerPhase;
+  std::map<std::string, long long> counters;
+  readTrace(filename, nbEventsPerPhase, counters);
+  boost::filesystem::remove(filename);
+
+  BOOST_CHECK_EQUAL(nbEventsPerPhase["X"], 8);
+}
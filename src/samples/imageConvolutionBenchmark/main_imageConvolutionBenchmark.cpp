@@ -0,0 +1,296 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/all.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Reference single-threaded horizontal convolution
+ *        (former implementation: one conv_buffer_ call per padded row)
+ */
+template<typename ImageT, typename Kernel>
+void referenceHorizontalConvolution(const ImageT& img, const Kernel& kernel, ImageT& out)
+{
+  typedef typename ImageT::Tpixel pix_t;
+  const int rows = img.rows();
+  const int cols = img.cols();
+  const int kernelWidth = kernel.size();
+  const int halfKernelWidth = kernelWidth / 2;
+
+  out.resize(cols, rows);
+  std::vector<pix_t> line(cols + kernelWidth);
+
+  for(int row = 0; row < rows; ++row)
+  {
+    for(int k = 0; k < halfKernelWidth; ++k)
+      line[k] = img(row, 0);
+    for(int col = 0; col < cols; ++col)
+      line[col + halfKernelWidth] = img(row, col);
+    for(int k = 0; k < halfKernelWidth; ++k)
+      line[k + halfKernelWidth + cols] = img(row, cols - 1);
+
+    conv_buffer_(&line[0], kernel.data(), cols, kernelWidth);
+
+    for(int col = 0; col < cols; ++col)
+      out(row, col) = line[col];
+  }
+}
+
+/**
+ * @brief Reference single-threaded vertical convolution
+ *        (former implementation: one conv_buffer_ call per padded column)
+ */
+template<typename ImageT, typename Kernel>
+void referenceVerticalConvolution(const ImageT& img, const Kernel& kernel, ImageT& out)
+{
+  typedef typename ImageT::Tpixel pix_t;
+  const int rows = img.rows();
+  const int cols = img.cols();
+  const int kernelWidth = kernel.size();
+  const int halfKernelWidth = kernelWidth / 2;
+
+  out.resize(cols, rows);
+  std::vector<pix_t> line(rows + kernelWidth);
+
+  for(int col = 0; col < cols; ++col)
+  {
+    for(int k = 0; k < halfKernelWidth; ++k)
+      line[k] = img(0, col);
+    for(int row = 0; row < rows; ++row)
+      line[row + halfKernelWidth] = img(row, col);
+    for(int k = 0; k < halfKernelWidth; ++k)
+      line[k + halfKernelWidth + rows] = img(rows - 1, col);
+
+    conv_buffer_(&line[0], kernel.data(), rows, kernelWidth);
+
+    for(int row = 0; row < rows; ++row)
+      out(row, col) = line[row];
+  }
+}
+
+/**
+ * @brief Reference separable convolution of a float image
+ */
+void referenceSeparableConvolution(const Image<float>& img, const Eigen::VectorXf& kernel, Image<float>& out)
+{
+  Image<float> tmp;
+  referenceHorizontalConvolution(img, kernel, tmp);
+  referenceVerticalConvolution(tmp, kernel, out);
+}
+
+/**
+ * @brief Reference separable convolution of a RGBf image
+ *        (the former templates do not support color pixels: each channel is convolved separately)
+ */
+void referenceSeparableConvolution(const Image<RGBfColor>& img, const Eigen::VectorXf& kernel, Image<RGBfColor>& out)
+{
+  out.resize(img.Width(), img.Height());
+  Image<float> channel(img.Width(), img.Height());
+  Image<float> channelOut;
+
+  for(int c = 0; c < 3; ++c)
+  {
+    for(int i = 0; i < img.size(); ++i)
+      channel(i) = img(i)(c);
+
+    referenceSeparableConvolution(channel, kernel, channelOut);
+
+    for(int i = 0; i < img.size(); ++i)
+      out(i)(c) = channelOut(i);
+  }
+}
+
+inline float getPixelAbsDiff(float a, float b)
+{
+  return std::abs(a - b);
+}
+
+inline float getPixelAbsDiff(const RGBfColor& a, const RGBfColor& b)
+{
+  return std::max({std::abs(a.r() - b.r()), std::abs(a.g() - b.g()), std::abs(a.b() - b.b())});
+}
+
+/**
+ * @brief Maximum absolute difference between two images of the same size
+ * @param[in] border the number of pixels ignored along each image border
+ */
+template<typename ImageT>
+float getMaxAbsDiff(const ImageT& imageA, const ImageT& imageB, int border = 0)
+{
+  float maxAbsDiff = 0.f;
+  for(int row = border; row < imageA.rows() - border; ++row)
+    for(int col = border; col < imageA.cols() - border; ++col)
+      maxAbsDiff = std::max(maxAbsDiff, getPixelAbsDiff(imageA(row, col), imageB(row, col)));
+  return maxAbsDiff;
+}
+
+/**
+ * @brief Time a function over several iterations
+ * @return average time in milliseconds
+ */
+template<typename Function>
+double benchmark(const Function& function, int nbIterations)
+{
+  function(); // warm-up
+  system::Timer timer;
+  for(int i = 0; i < nbIterations; ++i)
+    function();
+  return timer.elapsedMs() / nbIterations;
+}
+
+/**
+ * @brief Benchmark the generic separable convolution (ImageHorizontalConvolution / ImageVerticalConvolution)
+ *        and check it against the reference
+ * @return false if the results differ
+ */
+template<typename ImageT>
+bool benchmarkImageType(const std::string& name, const ImageT& image, const Eigen::VectorXf& kernel, int nbIterations, float tolerance)
+{
+  typedef typename ConvolutionKernel<typename ImageT::Tpixel>::Type kernel_t;
+  const Eigen::Matrix<kernel_t, Eigen::Dynamic, 1> kernelCast = kernel.cast<kernel_t>();
+
+  ImageT outReference, outCurrent, outHalf;
+
+  const double referenceMs = benchmark([&]{ referenceSeparableConvolution(image, kernel, outReference); }, nbIterations);
+  const double currentMs = benchmark([&]{
+    ImageT tmp;
+    ImageHorizontalConvolution(image, kernelCast, tmp);
+    ImageVerticalConvolution(tmp, kernelCast, outCurrent);
+  }, nbIterations);
+  const double halfSampleMs = benchmark([&]{ ImageHalfSample(image, outHalf); }, nbIterations);
+
+  const float maxAbsDiff = getMaxAbsDiff(outReference, outCurrent);
+
+  ALICEVISION_LOG_INFO(name << " separable convolution (" << image.Width() << "x" << image.Height() << ", kernel size " << kernel.size() << "):" << std::endl
+                       << "\t- reference: " << referenceMs << " ms" << std::endl
+                       << "\t- current: " << currentMs << " ms (x" << referenceMs / currentMs << "), max abs diff: " << maxAbsDiff << std::endl
+                       << "\t- half sample: " << halfSampleMs << " ms");
+
+  if(maxAbsDiff > tolerance)
+  {
+    ALICEVISION_LOG_ERROR(name << " separable convolution differs from the reference (max abs diff: " << maxAbsDiff << ").");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Benchmark the float separable convolution used by the SIFT and image pyramids code
+ *        (SeparableConvolution2d, called by ImageSeparableConvolution on Image<float>) and check it against the reference.
+ *        SeparableConvolution2d mirrors the image borders instead of copying the border pixels,
+ *        so the results are only compared away from the borders.
+ * @return false if the results differ
+ */
+bool benchmarkSeparableConvolution2d(const Image<float>& image, const Eigen::VectorXf& kernel, int nbIterations, float tolerance)
+{
+  const Eigen::RowVectorXf kernelRow = kernel.transpose();
+
+  Image<float> outReference, outCurrent;
+
+  const double referenceMs = benchmark([&]{ referenceSeparableConvolution(image, kernel, outReference); }, nbIterations);
+  const double currentMs = benchmark([&]{
+    outCurrent.resize(image.Width(), image.Height());
+    SeparableConvolution2d(image.GetMat(), kernelRow, kernelRow, &((Image<float>::Base&)outCurrent));
+  }, nbIterations);
+
+  const float maxAbsDiff = getMaxAbsDiff(outReference, outCurrent, kernel.size() / 2);
+
+  ALICEVISION_LOG_INFO("float SeparableConvolution2d (" << image.Width() << "x" << image.Height() << ", kernel size " << kernel.size() << "):" << std::endl
+                       << "\t- reference: " << referenceMs << " ms" << std::endl
+                       << "\t- current: " << currentMs << " ms (x" << referenceMs / currentMs << "), max abs diff (without borders): " << maxAbsDiff);
+
+  if(maxAbsDiff > tolerance)
+  {
+    ALICEVISION_LOG_ERROR("float SeparableConvolution2d differs from the reference (max abs diff: " << maxAbsDiff << ").");
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  int width = 6000;
+  int height = 4000;
+  double sigma = 1.6;
+  int nbIterations = 5;
+  int nbThreads = 0;
+
+  po::options_description allParams("AliceVision Sample imageConvolutionBenchmark\n"
+                                    "Compare image convolution and resampling primitives against the reference scalar implementation.");
+  allParams.add_options()
+    ("width", po::value<int>(&width)->default_value(width),
+      "Image width.")
+    ("height", po::value<int>(&height)->default_value(height),
+      "Image height.")
+    ("sigma", po::value<double>(&sigma)->default_value(sigma),
+      "Gaussian kernel sigma.")
+    ("iterations", po::value<int>(&nbIterations)->default_value(nbIterations),
+      "Number of timed iterations.")
+    ("maxThreads", po::value<int>(&nbThreads)->default_value(nbThreads),
+      "Maximum number of threads (0: automatic).");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  if(nbThreads > 0)
+    omp_set_num_threads(nbThreads);
+
+  const Eigen::VectorXf kernel = ComputeGaussianKernel(0, sigma).cast<float>();
+
+  Image<float> imageFloat(width, height);
+  imageFloat.setRandom();
+
+  Image<RGBfColor> imageRGBf(width, height);
+  for(int i = 0; i < imageRGBf.size(); ++i)
+    imageRGBf(i) = RGBfColor(imageFloat(i), 0.5f * imageFloat(i), 1.f - imageFloat(i));
+
+  ALICEVISION_LOG_INFO("Number of threads: " << omp_get_max_threads());
+
+  // the implementations only differ by the float summation order
+  const float tolerance = 1e-4f;
+
+  bool valid = benchmarkImageType("float", imageFloat, kernel, nbIterations, tolerance);
+  valid = benchmarkSeparableConvolution2d(imageFloat, kernel, nbIterations, tolerance) && valid;
+  valid = benchmarkImageType("RGBf", imageRGBf, kernel, nbIterations, tolerance) && valid;
+
+  return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,219 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/MeshConnectivity.hpp>
+#include <aliceVision/mvsData/structures.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Reference vertex -> triangles adjacency
+ *        (former implementation: qsort of <vertex, triangle> voxels)
+ */
+void referencePtsNeighborTriangles(const mesh::Mesh& mesh, std::vector<std::vector<int>>& out_ptsNeighTris)
+{
+    StaticVector<Voxel> vertexNeighborhoodPairs;
+    vertexNeighborhoodPairs.reserve(mesh.tris.size() * 3);
+    for(int i = 0; i < mesh.tris.size(); ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+            vertexNeighborhoodPairs.push_back(Voxel(mesh.tris[i].v[k], i, 0));
+    }
+    qsort(&vertexNeighborhoodPairs[0], vertexNeighborhoodPairs.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
+
+    out_ptsNeighTris.assign(mesh.pts.size(), std::vector<int>());
+    for(const Voxel& pair : vertexNeighborhoodPairs)
+        out_ptsNeighTris[pair.x].push_back(pair.y);
+}
+
+/**
+ * @brief Reference non-oriented edges table
+ *        (former implementation: qsort of <lowest point, highest point, triangle> voxels, then per lowest point)
+ */
+void referenceNotOrientedEdges(const mesh::Mesh& mesh, std::vector<Pixel>& out_edgesPointsPairs, std::vector<std::vector<int>>& out_edgesNeighTris)
+{
+    StaticVector<Voxel> edges;
+    edges.reserve(mesh.tris.size() * 3);
+    for(int i = 0; i < mesh.tris.size(); ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            const int a = mesh.tris[i].v[k];
+            const int b = mesh.tris[i].v[(k + 1) % 3];
+            edges.push_back(Voxel(std::min(a, b), std::max(a, b), i));
+        }
+    }
+    qsort(&edges[0], edges.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
+
+    int i0 = 0;
+    for(int i = 0; i < edges.size(); ++i)
+    {
+        if((i == edges.size() - 1) || (edges[i].x != edges[i + 1].x))
+        {
+            qsort(&edges[i0], i - i0 + 1, sizeof(Voxel), qSortCompareVoxelByYAsc);
+            for(int j = i0; j <= i; ++j)
+            {
+                if((j == i0) || (edges[j].y != edges[j - 1].y))
+                {
+                    out_edgesPointsPairs.push_back(Pixel(edges[j].x, edges[j].y));
+                    out_edgesNeighTris.emplace_back();
+                }
+                out_edgesNeighTris.back().push_back(edges[j].z);
+            }
+            i0 = i + 1;
+        }
+    }
+}
+
+/**
+ * @brief Create a regular grid mesh with shuffled point ids
+ */
+void createGridMesh(int nbTriangles, mesh::Mesh& mesh)
+{
+    const int size = std::max(2, static_cast<int>(std::sqrt(nbTriangles / 2.0)) + 1);
+
+    std::vector<int> ptIds(size * size);
+    std::iota(ptIds.begin(), ptIds.end(), 0);
+    std::shuffle(ptIds.begin(), ptIds.end(), std::mt19937(0));
+
+    mesh.pts.resize(size * size);
+    for(int y = 0; y < size; ++y)
+        for(int x = 0; x < size; ++x)
+            mesh.pts[ptIds[y * size + x]] = Point3d(x, y, 0.0);
+
+    mesh.tris.reserve(2 * (size - 1) * (size - 1));
+    for(int y = 0; y < size - 1; ++y)
+    {
+        for(int x = 0; x < size - 1; ++x)
+        {
+            const int a = ptIds[y * size + x];
+            const int b = ptIds[y * size + x + 1];
+            const int c = ptIds[(y + 1) * size + x];
+            const int d = ptIds[(y + 1) * size + x + 1];
+            mesh.tris.push_back(mesh::Mesh::triangle(a, b, c));
+            mesh.tris.push_back(mesh::Mesh::triangle(b, d, c));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int nbTriangles = 20000000;
+    int nbThreads = 0;
+    bool skipReference = false;
+
+    po::options_description allParams("AliceVision Sample meshConnectivityBenchmark\n"
+                                      "Compare the mesh connectivity against the reference qsort-based adjacency computation.");
+    allParams.add_options()
+      ("nbTriangles", po::value<int>(&nbTriangles)->default_value(nbTriangles),
+        "Number of triangles of the generated mesh.")
+      ("skipReference", po::value<bool>(&skipReference)->default_value(skipReference),
+        "Skip the reference implementation.")
+      ("maxThreads", po::value<int>(&nbThreads)->default_value(nbThreads),
+        "Maximum number of threads (0: automatic).");
+
+    po::variables_map vm;
+    try
+    {
+      po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+      if(vm.count("help"))
+      {
+        ALICEVISION_COUT(allParams);
+        return EXIT_SUCCESS;
+      }
+      po::notify(vm);
+    }
+    catch(boost::program_options::error& e)
+    {
+      ALICEVISION_CERR("ERROR: " << e.what());
+      ALICEVISION_COUT("Usage:\n\n" << allParams);
+      return EXIT_FAILURE;
+    }
+
+    if(nbThreads > 0)
+      omp_set_num_threads(nbThreads);
+
+    ALICEVISION_LOG_INFO("Number of threads: " << omp_get_max_threads());
+
+    mesh::Mesh mesh;
+    createGridMesh(nbTriangles, mesh);
+
+    ALICEVISION_LOG_INFO("Mesh: " << mesh.pts.size() << " points, " << mesh.tris.size() << " triangles.");
+
+    system::Timer timer;
+    const mesh::MeshConnectivity& connectivity = mesh.getConnectivity();
+    const double connectivityMs = timer.elapsedMs();
+
+    ALICEVISION_LOG_INFO("Connectivity: " << connectivityMs << " ms (" << connectivity.getNbEdges() << " edges)");
+
+    if(skipReference)
+      return EXIT_SUCCESS;
+
+    timer.reset();
+    std::vector<std::vector<int>> ptsNeighTris;
+    referencePtsNeighborTriangles(mesh, ptsNeighTris);
+    std::vector<Pixel> edgesPointsPairs;
+    std::vector<std::vector<int>> edgesNeighTris;
+    referenceNotOrientedEdges(mesh, edgesPointsPairs, edgesNeighTris);
+    const double referenceMs = timer.elapsedMs();
+
+    ALICEVISION_LOG_INFO("Reference: " << referenceMs << " ms (x" << referenceMs / connectivityMs << ")");
+
+    // check the results
+    bool valid = (static_cast<int>(edgesPointsPairs.size()) == connectivity.getNbEdges());
+
+    for(int ptId = 0; valid && ptId < mesh.pts.size(); ++ptId)
+    {
+      std::vector<int>& refTris = ptsNeighTris[ptId];
+      std::sort(refTris.begin(), refTris.end());
+      const mesh::MeshConnectivity::IndexRange ptTris = connectivity.getPtNeighborTriangles(ptId);
+      valid = std::equal(refTris.begin(), refTris.end(), ptTris.begin(), ptTris.end());
+    }
+
+    for(int edgeId = 0; valid && edgeId < connectivity.getNbEdges(); ++edgeId)
+    {
+      const Pixel& edgePts = connectivity.getEdgePoints(edgeId);
+      std::vector<int>& refTris = edgesNeighTris[edgeId];
+      std::sort(refTris.begin(), refTris.end());
+
+      std::vector<int> edgeTris;
+      for(const int halfEdgeId : connectivity.getEdgeHalfEdges(edgeId))
+        edgeTris.push_back(mesh::MeshConnectivity::getHalfEdgeTriangle(halfEdgeId));
+
+      valid = (edgePts.x == edgesPointsPairs[edgeId].x) && (edgePts.y == edgesPointsPairs[edgeId].y) && (edgeTris == refTris);
+    }
+
+    if(!valid)
+    {
+      ALICEVISION_LOG_ERROR("The connectivity does not match the reference adjacency.");
+      return EXIT_FAILURE;
+    }
+
+    ALICEVISION_LOG_INFO("The connectivity matches the reference adjacency.");
+    return EXIT_SUCCESS;
+}
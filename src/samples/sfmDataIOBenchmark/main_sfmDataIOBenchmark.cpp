@@ -0,0 +1,288 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <random>
+#include <cstdlib>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::sfmDataIO;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+/**
+ * @brief Create a synthetic SfMData
+ */
+void createScene(sfmData::SfMData& sfmData, int nbViews, int nbLandmarks, int nbObservationsPerLandmark)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(-100.0, 100.0);
+  std::uniform_int_distribution<int> viewDistribution(0, nbViews - 1);
+
+  sfmData.getIntrinsics().emplace(0, std::make_shared<camera::PinholeRadialK3>(6000, 4000, 5000, 3000, 2000, 0.01, -0.002, 0.0001));
+
+  for(int i = 0; i < nbViews; ++i)
+  {
+    const std::shared_ptr<sfmData::View> view = std::make_shared<sfmData::View>("dataset/IMG_" + std::to_string(i) + ".JPG", i, 0, i, 6000, 4000);
+    view->addMetadata("Exif:Make", "Make");
+    view->addMetadata("Exif:Model", "Model");
+    view->addMetadata("Exif:FocalLength", "35");
+    sfmData.getViews().emplace(i, view);
+    sfmData.getPoses().emplace(i, sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(distribution(generator), distribution(generator), distribution(generator)))));
+  }
+
+  for(int i = 0; i < nbLandmarks; ++i)
+  {
+    sfmData::Landmark& landmark = sfmData.getLandmarks()[i];
+    landmark.X = Vec3(distribution(generator), distribution(generator), distribution(generator));
+    landmark.descType = feature::EImageDescriberType::SIFT;
+    landmark.rgb = image::RGBColor(i % 256, (i / 256) % 256, 128);
+
+    for(int j = 0; j < nbObservationsPerLandmark; ++j)
+      landmark.observations[viewDistribution(generator)] = sfmData::Observation(Vec2(std::abs(distribution(generator)) * 30.0, std::abs(distribution(generator)) * 20.0), i);
+  }
+}
+
+/**
+ * @brief Reference SfMData JSON export with a boost property tree
+ *        (former implementation of saveJSON with ESfMData::ALL)
+ */
+void referenceSaveJSON(const sfmData::SfMData& sfmData, const std::string& filename)
+{
+  bpt::ptree fileTree;
+
+  saveMatrix("version", Vec3(1, 0, 0), fileTree);
+
+  bpt::ptree viewsTree;
+  for(const auto& viewPair : sfmData.getViews())
+    saveView("", *(viewPair.second), viewsTree);
+  fileTree.add_child("views", viewsTree);
+
+  bpt::ptree intrinsicsTree;
+  for(const auto& intrinsicPair : sfmData.getIntrinsics())
+    saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
+  fileTree.add_child("intrinsics", intrinsicsTree);
+
+  bpt::ptree posesTree;
+  for(const auto& posePair : sfmData.getPoses())
+  {
+    bpt::ptree poseTree;
+    poseTree.put("poseId", posePair.first);
+    saveCameraPose("pose", posePair.second, poseTree);
+    posesTree.push_back(std::make_pair("", poseTree));
+  }
+  fileTree.add_child("poses", posesTree);
+
+  bpt::ptree structureTree;
+  for(const auto& structurePair : sfmData.getLandmarks())
+    saveLandmark("", structurePair.first, structurePair.second, structureTree);
+  fileTree.add_child("structure", structureTree);
+
+  bpt::write_json(filename, fileTree);
+}
+
+/**
+ * @brief Reference SfMData JSON import with a boost property tree
+ *        (former implementation of loadJSON with ESfMData::ALL)
+ */
+void referenceLoadJSON(sfmData::SfMData& sfmData, const std::string& filename)
+{
+  bpt::ptree fileTree;
+  bpt::read_json(filename, fileTree);
+
+  for(bpt::ptree::value_type& intrinsicNode : fileTree.get_child("intrinsics"))
+  {
+    IndexT intrinsicId;
+    std::shared_ptr<camera::IntrinsicBase> intrinsic;
+    loadIntrinsic(intrinsicId, intrinsic, intrinsicNode.second);
+    sfmData.getIntrinsics().emplace(intrinsicId, intrinsic);
+  }
+
+  for(bpt::ptree::value_type& viewNode : fileTree.get_child("views"))
+  {
+    sfmData::View view;
+    loadView(view, viewNode.second);
+    sfmData.getViews().emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
+  }
+
+  for(bpt::ptree::value_type& poseNode : fileTree.get_child("poses"))
+  {
+    sfmData::CameraPose pose;
+    loadCameraPose("pose", pose, poseNode.second);
+    sfmData.getPoses().emplace(poseNode.second.get<IndexT>("poseId"), pose);
+  }
+
+  for(bpt::ptree::value_type& landmarkNode : fileTree.get_child("structure"))
+  {
+    IndexT landmarkId;
+    sfmData::Landmark landmark;
+    loadLandmark(landmarkId, landmark, landmarkNode.second);
+    sfmData.getLandmarks().emplace(landmarkId, landmark);
+  }
+}
+
+std::string readFile(const std::string& filename)
+{
+  std::ifstream stream(filename, std::ios::binary);
+  std::ostringstream content;
+  content << stream.rdbuf();
+  return content.str();
+}
+
+int main(int argc, char **argv)
+{
+  std::string outputFolder = fs::temp_directory_path().string();
+  int nbViews = 1000;
+  int nbLandmarks = 100000;
+  int nbObservationsPerLandmark = 4;
+  int nbThreads = 0;
+
+  po::options_description allParams("AliceVision Sample sfmDataIOBenchmark\n"
+                                    "Compare the SfMData JSON export / import against the reference boost::property_tree implementation\n"
+                                    "and the binary SfMData format.");
+  allParams.add_options()
+    ("output,o", po::value<std::string>(&outputFolder)->default_value(outputFolder),
+      "Folder of the temporary SfMData files.")
+    ("nbViews", po::value<int>(&nbViews)->default_value(nbViews),
+      "Number of views.")
+    ("nbLandmarks", po::value<int>(&nbLandmarks)->default_value(nbLandmarks),
+      "Number of landmarks.")
+    ("nbObservationsPerLandmark", po::value<int>(&nbObservationsPerLandmark)->default_value(nbObservationsPerLandmark),
+      "Number of observations per landmark.")
+    ("maxThreads", po::value<int>(&nbThreads)->default_value(nbThreads),
+      "Maximum number of threads (0: automatic).");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  if(nbThreads > 0)
+    omp_set_num_threads(nbThreads);
+
+  sfmData::SfMData sfmData;
+  createScene(sfmData, nbViews, nbLandmarks, nbObservationsPerLandmark);
+
+  const std::string referenceFilename = (fs::path(outputFolder) / "sfmDataIOBenchmark_reference.sfm").string();
+  const std::string filename = (fs::path(outputFolder) / "sfmDataIOBenchmark.sfm").string();
+
+  ALICEVISION_LOG_INFO("Number of threads: " << omp_get_max_threads());
+  ALICEVISION_LOG_INFO("SfMData: " << nbViews << " views, " << nbLandmarks << " landmarks, " << nbObservationsPerLandmark << " observations per landmark.");
+
+  system::Timer timer;
+  referenceSaveJSON(sfmData, referenceFilename);
+  const double referenceSaveMs = timer.elapsedMs();
+
+  timer.reset();
+  if(!Save(sfmData, filename, ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("Cannot save the SfMData file: " << filename);
+    return EXIT_FAILURE;
+  }
+  const double saveMs = timer.elapsedMs();
+
+  timer.reset();
+  {
+    sfmData::SfMData sfmDataLoad;
+    referenceLoadJSON(sfmDataLoad, referenceFilename);
+  }
+  const double referenceLoadMs = timer.elapsedMs();
+
+  sfmData::SfMData sfmDataLoad;
+  timer.reset();
+  if(!Load(sfmDataLoad, filename, ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("Cannot load the SfMData file: " << filename);
+    return EXIT_FAILURE;
+  }
+  const double loadMs = timer.elapsedMs();
+
+  // binary format
+  const std::string binaryFilename = (fs::path(outputFolder) / "sfmDataIOBenchmark.sfmb").string();
+
+  timer.reset();
+  if(!Save(sfmData, binaryFilename, ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("Cannot save the SfMData file: " << binaryFilename);
+    return EXIT_FAILURE;
+  }
+  const double binarySaveMs = timer.elapsedMs();
+
+  sfmData::SfMData sfmDataBinary;
+  timer.reset();
+  if(!Load(sfmDataBinary, binaryFilename, ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("Cannot load the SfMData file: " << binaryFilename);
+    return EXIT_FAILURE;
+  }
+  const double binaryLoadMs = timer.elapsedMs();
+
+  timer.reset();
+  {
+    sfmData::SfMData sfmDataViews;
+    Load(sfmDataViews, filename, ESfMData(ESfMData::VIEWS | ESfMData::INTRINSICS));
+  }
+  const double loadViewsMs = timer.elapsedMs();
+
+  timer.reset();
+  {
+    sfmData::SfMData sfmDataViews;
+    Load(sfmDataViews, binaryFilename, ESfMData(ESfMData::VIEWS | ESfMData::INTRINSICS));
+  }
+  const double binaryLoadViewsMs = timer.elapsedMs();
+
+  const bool sameFile = (readFile(referenceFilename) == readFile(filename));
+  const bool sameLandmarks = (sfmDataLoad.getLandmarks() == sfmData.getLandmarks()) &&
+                             (sfmDataBinary.getLandmarks() == sfmData.getLandmarks());
+
+  ALICEVISION_LOG_INFO("Results (file size: " << fs::file_size(filename) / (1024 * 1024) << " MB):" << std::endl
+                       << "\t- save: " << saveMs << " ms (reference: " << referenceSaveMs << " ms, speedup: " << referenceSaveMs / saveMs << ")" << std::endl
+                       << "\t- load: " << loadMs << " ms (reference: " << referenceLoadMs << " ms, speedup: " << referenceLoadMs / loadMs << ")" << std::endl
+                       << "\t- binary save: " << binarySaveMs << " ms, binary load: " << binaryLoadMs << " ms (file size: " << fs::file_size(binaryFilename) / (1024 * 1024) << " MB)" << std::endl
+                       << "\t- load views and intrinsics: " << loadViewsMs << " ms (binary: " << binaryLoadViewsMs << " ms)" << std::endl
+                       << "\t- same file as the reference: " << (sameFile ? "yes" : "no") << std::endl
+                       << "\t- same landmarks after reload: " << (sameLandmarks ? "yes" : "no"));
+
+  fs::remove(referenceFilename);
+  fs::remove(filename);
+  fs::remove(binaryFilename);
+
+  return (sameFile && sameLandmarks) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,149 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/octreeLOD.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace bfs = boost::filesystem;
+namespace po = boost::program_options;
+
+// Export point clouds (SfMData landmarks) and meshes as octree level of detail hierarchies for fast previews
+int main(int argc, char **argv)
+{
+  system::Timer timer;
+
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string sfmDataFilename;
+  std::string inputMeshPath;
+  std::string outputFolder;
+
+  mesh::OctreeLODParams params;
+
+  po::options_description allParams("AliceVision exportLOD");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("output,o", po::value<std::string>(&outputFolder)->required(),
+      "Output folder.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("help,h", "Produce help message.")
+    ("input,i", po::value<std::string>(&sfmDataFilename)->default_value(sfmDataFilename),
+      "SfMData file (sparse or dense point cloud), exported in the 'points' subfolder.")
+    ("inputMesh", po::value<std::string>(&inputMeshPath)->default_value(inputMeshPath),
+      "Input mesh (OBJ file format), exported in the 'mesh' subfolder.")
+    ("maxNodeSize", po::value<int>(&params.maxNodeSize)->default_value(params.maxNodeSize),
+      "Maximum number of points (or triangles) of an octree node, larger nodes are subdivided.")
+    ("gridResolution", po::value<int>(&params.gridResolution)->default_value(params.gridResolution),
+      "Number of sampling cells along each axis of an octree node.")
+    ("maxDepth", po::value<int>(&params.maxDepth)->default_value(params.maxDepth),
+      "Maximum depth of the octree.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  if(sfmDataFilename.empty() && inputMeshPath.empty())
+  {
+    ALICEVISION_LOG_ERROR("No input specified, at least an SfMData file or a mesh is required.");
+    return EXIT_FAILURE;
+  }
+
+  if(!sfmDataFilename.empty())
+  {
+    // load input SfMData scene
+    sfmData::SfMData sfmData;
+    if(!sfmDataIO::Load(sfmData, sfmDataFilename, sfmDataIO::ESfMData::STRUCTURE))
+    {
+      ALICEVISION_LOG_ERROR("The input SfMData file '" + sfmDataFilename + "' cannot be read.");
+      return EXIT_FAILURE;
+    }
+
+    std::vector<Point3d> points;
+    std::vector<rgb> colors;
+    points.reserve(sfmData.getLandmarks().size());
+    colors.reserve(sfmData.getLandmarks().size());
+    for(const auto& landmarkPair : sfmData.getLandmarks())
+    {
+      const sfmData::Landmark& landmark = landmarkPair.second;
+      points.emplace_back(landmark.X(0), landmark.X(1), landmark.X(2));
+      colors.emplace_back(landmark.rgb.r(), landmark.rgb.g(), landmark.rgb.b());
+    }
+    sfmData.getLandmarks().clear();
+
+    mesh::exportPointCloudLOD(points, colors, (bfs::path(outputFolder) / "points").string(), params);
+  }
+
+  if(!inputMeshPath.empty())
+  {
+    mesh::Mesh inputMesh;
+    if(!inputMesh.loadFromObjAscii(inputMeshPath))
+    {
+      ALICEVISION_LOG_ERROR("Unable to read input mesh from the file: " << inputMeshPath);
+      return EXIT_FAILURE;
+    }
+
+    mesh::exportMeshLOD(inputMesh, (bfs::path(outputFolder) / "mesh").string(), params);
+  }
+
+  ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
+  return EXIT_SUCCESS;
+}
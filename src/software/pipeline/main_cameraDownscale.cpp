@@ -1,19 +1,21 @@
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/ProcessingPipeline.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/progress.hpp>
 #include <aliceVision/mvsData/imageAlgo.hpp>
 
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 namespace po = boost::program_options;
@@ -24,6 +26,9 @@ int main(int argc, char * argv[]) {
   std::string sfmInputDataFilename = "";
   std::string sfmOutputDataFilename = "";
   float rescaleFactor = 1.0f;
+  int nbDecodeThreads = 3;
+  int nbEncodeThreads = 2;
+  int maxInFlightImages = 8;
 
   /*****
    * DESCRIBE COMMAND LINE PARAMETERS 
@@ -40,6 +45,11 @@ int main(int argc, char * argv[]) {
     ;
 
   po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("nbDecodeThreads", po::value<int>(&nbDecodeThreads)->default_value(nbDecodeThreads), "Number of threads reading the source images.")
+    ("nbEncodeThreads", po::value<int>(&nbEncodeThreads)->default_value(nbEncodeThreads), "Number of threads writing the rescaled images.")
+    ("maxInFlightImages", po::value<int>(&maxInFlightImages)->default_value(maxInFlightImages), "Maximum number of images loaded in memory at the same time.")
+    ;
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -105,40 +115,77 @@ int main(int argc, char * argv[]) {
     return EXIT_FAILURE;
   }
   
+  std::vector<sfmData::View*> views;
   for (auto & v : sfmData.getViews()) {
-    
+    views.push_back(v.second.get());
+  }
+
+  /*Rescaled image path of each view*/
+  std::vector<std::string> rescaledPaths(views.size());
+  for (std::size_t i = 0; i < views.size(); ++i) {
+    boost::filesystem::path old_path(views[i]->getImagePath());
+    std::string old_filename = old_path.stem().string();
+
+    std::stringstream sstream;
+    sstream << output_path << "/" << old_filename << "_rescaled.exr";
+    rescaledPaths[i] = sstream.str();
+  }
+
+  /**
+   * Decode -> rescale -> encode pipeline,
+   * disk reads and writes overlap the rescaling and the number of images in memory is bounded
+   */
+  struct RescaleItem {
+    image::Image<image::RGBfColor> image;
+  };
+
+  system::ProcessingPipeline<RescaleItem> pipeline(maxInFlightImages);
+
+  pipeline.addStage("decode", nbDecodeThreads, [&](std::size_t index, RescaleItem & item) {
     /*Read original image*/
-    image::Image<image::RGBfColor> originalImage;
-    image::readImage(v.second->getImagePath(), originalImage, image::EImageColorSpace::LINEAR);
+    image::readImage(views[index]->getImagePath(), item.image, image::EImageColorSpace::LINEAR);
+  });
 
-    unsigned int w = v.second->getWidth();
-    unsigned int h = v.second->getHeight();
+  /*Resampling is parallelized internally*/
+  pipeline.addStage("rescale", 1, [&](std::size_t index, RescaleItem & item) {
+    unsigned int w = views[index]->getWidth();
+    unsigned int h = views[index]->getHeight();
     unsigned int nw = (unsigned int)(floor(float(w) * rescaleFactor));
     unsigned int nh = (unsigned int)(floor(float(h) * rescaleFactor));
 
-    /*Create a rotated image*/
+    /*Create a rescaled image*/
     image::Image<image::RGBfColor> rescaled(nw, nh);
 
     oiio::ImageSpec imageSpecResized(nw, nh, 3, oiio::TypeDesc::FLOAT);
     oiio::ImageSpec imageSpecOrigin(w, h, 3, oiio::TypeDesc::FLOAT);
 
-    oiio::ImageBuf bufferOrigin(imageSpecOrigin, originalImage.data());
+    oiio::ImageBuf bufferOrigin(imageSpecOrigin, item.image.data());
     oiio::ImageBuf bufferResized(imageSpecResized, rescaled.data());
 
     oiio::ImageBufAlgo::resample(bufferResized, bufferOrigin);
 
-    boost::filesystem::path old_path(v.second->getImagePath());
-    std::string old_filename = old_path.stem().string();
+    item.image.swap(rescaled);
+  });
 
+  pipeline.addStage("encode", nbEncodeThreads, [&](std::size_t index, RescaleItem & item) {
     /*Save this image*/
-    std::stringstream sstream;
-    sstream << output_path << "/" << old_filename << "_rescaled.exr";
-    image::writeImage(sstream.str(), rescaled, image::EImageColorSpace::AUTO);
+    image::writeImage(rescaledPaths[index], item.image, image::EImageColorSpace::AUTO);
+  });
+
+  boost::progress_display progressBar(views.size(), std::cout, "Rescaling images\n");
+  pipeline.setItemDoneCallback([&](std::size_t index) { ++progressBar; });
+
+  pipeline.run(views.size());
+  pipeline.logStats();
+
+  /*Update views for this modification*/
+  for (std::size_t i = 0; i < views.size(); ++i) {
+    unsigned int nw = (unsigned int)(floor(float(views[i]->getWidth()) * rescaleFactor));
+    unsigned int nh = (unsigned int)(floor(float(views[i]->getHeight()) * rescaleFactor));
 
-    /*Update view for this modification*/
-    v.second->setWidth(nw);
-    v.second->setHeight(nh);
-    v.second->setImagePath(sstream.str());
+    views[i]->setWidth(nw);
+    views[i]->setHeight(nh);
+    views[i]->setImagePath(rescaledPaths[i]);
   }
 
   for (auto & i : sfmData.getIntrinsics()) {
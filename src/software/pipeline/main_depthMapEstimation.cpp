@@ -13,7 +13,9 @@
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/gpu/gpu.hpp>
 
 #include <boost/program_options.hpp>
@@ -22,7 +24,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -33,6 +35,8 @@ int main(int argc, char* argv[])
     system::Timer timer;
 
     std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+    std::string traceFile;
+    std::size_t maxMemory = 0;
     std::string sfmDataFilename;
     std::string outputFolder;
     std::string imagesFolder;
@@ -48,6 +52,9 @@ int main(int argc, char* argv[])
     float minViewAngle = 2.0f;
     float maxViewAngle = 70.0f;
 
+    // covisibility graph file
+    std::string covisibilityGraphFilename;
+
     // semiGlobalMatching
     int sgmMaxTCams = 10;
     int sgmWSH = 4;
@@ -95,6 +102,9 @@ int main(int argc, char* argv[])
             "minimum angle between two views.")
         ("maxViewAngle", po::value<float>(&maxViewAngle)->default_value(maxViewAngle),
             "maximum angle between two views.")
+        ("covisibilityGraph", po::value<std::string>(&covisibilityGraphFilename)->default_value(covisibilityGraphFilename),
+            "Camera covisibility graph file, shared by the processing chunks of the same SfMData: "
+            "loaded if it exists and matches the cameras, landmarks and view angles, otherwise computed and saved.")
         ("sgmMaxTCams", po::value<int>(&sgmMaxTCams)->default_value(sgmMaxTCams),
             "Semi Global Matching: Number of neighbour cameras.")
         ("sgmWSH", po::value<int>(&sgmWSH)->default_value(sgmWSH),
@@ -129,7 +139,12 @@ int main(int argc, char* argv[])
     po::options_description logParams("Log parameters");
     logParams.add_options()
       ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
-        "verbosity level (fatal, error, warning, info, debug, trace).");
+        "verbosity level (fatal, error, warning, info, debug, trace).")
+      ("traceFile", po::value<std::string>(&traceFile)->default_value(traceFile),
+        "Record a trace of the processing and export it to this file (Chrome trace / Perfetto JSON).")
+      ("maxMemory", po::value<std::size_t>(&maxMemory)->default_value(maxMemory),
+        "Maximum memory usage in MB (0: no limit, use the free RAM). Caches and chunked processing are sized accordingly.\n"
+        "The peak memory usage is reported at exit.");
 
     allParams.add(requiredParams).add(optionalParams).add(logParams);
 
@@ -166,6 +181,12 @@ int main(int argc, char* argv[])
     // set verbose level
     system::Logger::get()->setLogLevel(verboseLevel);
 
+    // record a trace of the processing if requested
+    system::TraceFile traceFileExport(traceFile);
+
+    // memory budget of the caches and chunked processing, report the memory usage at exit
+    system::MemoryBudgetScope memoryBudgetScope(maxMemory);
+
     // print GPU Information
     ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
 
@@ -197,6 +218,10 @@ int main(int argc, char* argv[])
     mp.setMinViewAngle(minViewAngle);
     mp.setMaxViewAngle(maxViewAngle);
 
+    // reuse the camera covisibility graph computed by a previous run on the same SfMData
+    if(!covisibilityGraphFilename.empty() && !mp.loadCovisibilityGraph(covisibilityGraphFilename))
+        mp.saveCovisibilityGraph(covisibilityGraphFilename);
+
     // set params in bpt
 
     // semiGlobalMatching
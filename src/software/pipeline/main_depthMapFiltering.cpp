@@ -22,7 +22,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -45,12 +45,16 @@ int main(int argc, char* argv[])
     float minViewAngle = 2.0f;
     float maxViewAngle = 70.0f;
 
+    // covisibility graph file
+    std::string covisibilityGraphFilename;
+
     int minNumOfConsistentCams = 3;
     int minNumOfConsistentCamsWithLowSimilarity = 4;
     int pixSizeBall = 0;
     int pixSizeBallWithLowSimilarity = 0;
     int nNearestCams = 10;
     bool computeNormalMaps = false;
+    int nbIOThreads = 2;
 
     po::options_description allParams("AliceVision depthMapFiltering\n"
                                       "Filter depth map to remove values that are not consistent with other depth maps");
@@ -74,6 +78,9 @@ int main(int argc, char* argv[])
             "minimum angle between two views.")
         ("maxViewAngle", po::value<float>(&maxViewAngle)->default_value(maxViewAngle),
             "maximum angle between two views.")
+        ("covisibilityGraph", po::value<std::string>(&covisibilityGraphFilename)->default_value(covisibilityGraphFilename),
+            "Camera covisibility graph file, shared by the processing chunks of the same SfMData: "
+            "loaded if it exists and matches the cameras, landmarks and view angles, otherwise computed and saved.")
         ("minNumOfConsistentCams", po::value<int>(&minNumOfConsistentCams)->default_value(minNumOfConsistentCams),
             "Minimal number of consistent cameras to consider the pixel.")
         ("minNumOfConsistentCamsWithLowSimilarity", po::value<int>(&minNumOfConsistentCamsWithLowSimilarity)->default_value(minNumOfConsistentCamsWithLowSimilarity),
@@ -85,7 +92,9 @@ int main(int argc, char* argv[])
         ("nNearestCams", po::value<int>(&nNearestCams)->default_value(nNearestCams),
             "Number of nearest cameras.")
         ("computeNormalMaps", po::value<bool>(&computeNormalMaps)->default_value(computeNormalMaps),
-            "Compute normal maps per depth map");
+            "Compute normal maps per depth map")
+        ("nbIOThreads", po::value<int>(&nbIOThreads)->default_value(nbIOThreads),
+            "Number of threads reading the depth maps and number of threads writing the filtered depth maps.");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
@@ -141,6 +150,10 @@ int main(int argc, char* argv[])
     mp.setMinViewAngle(minViewAngle);
     mp.setMaxViewAngle(maxViewAngle);
 
+    // reuse the camera covisibility graph computed by a previous run on the same SfMData
+    if(!covisibilityGraphFilename.empty() && !mp.loadCovisibilityGraph(covisibilityGraphFilename))
+        mp.saveCovisibilityGraph(covisibilityGraphFilename);
+
     StaticVector<int> cams;
     cams.reserve(mp.ncams);
 
@@ -169,8 +182,8 @@ int main(int argc, char* argv[])
 
     {
         fuseCut::Fuser fs(&mp);
-        fs.filterGroups(cams, pixSizeBall, pixSizeBallWithLowSimilarity, nNearestCams);
-        fs.filterDepthMaps(cams, minNumOfConsistentCams, minNumOfConsistentCamsWithLowSimilarity);
+        fs.filterDepthMapsPipeline(cams, pixSizeBall, pixSizeBallWithLowSimilarity, nNearestCams,
+                                   minNumOfConsistentCams, minNumOfConsistentCamsWithLowSimilarity, nbIOThreads);
     }
 
     if(computeNormalMaps)
@@ -10,14 +10,17 @@
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/feature/feature.hpp>
+#include <aliceVision/feature/FeaturesCache.hpp>
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_POPSIFT) \
  || ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
 #define ALICEVISION_HAVE_GPU_FEATURES
 #include <aliceVision/gpu/gpu.hpp>
 #endif
 #include <aliceVision/image/all.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/config.hpp>
@@ -37,7 +40,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -128,6 +131,17 @@ public:
     _imageDescribers.push_back(imageDescriber);
   }
 
+  /**
+   * @brief Use a features cache, the cache key depends on the image content and the describer configuration
+   * @param[in] featuresCache The features cache
+   * @param[in] describerPreset The image describers preset
+   */
+  void setFeaturesCache(const std::shared_ptr<feature::FeaturesCache>& featuresCache, const std::string& describerPreset)
+  {
+    _featuresCache = featuresCache;
+    _describerPreset = describerPreset;
+  }
+
   void process()
   {
     // iteration on each view in the range in order
@@ -162,16 +176,19 @@ public:
     if(!_cpuJobs.empty())
     {
       system::MemoryInfo memoryInformation = system::getMemoryInfo();
+      // free RAM bounded by the process memory budget if any
+      const std::size_t availableMemory = system::MemoryBudget::get().getAvailableMemory();
 
       ALICEVISION_LOG_DEBUG("Job max memory consumption: " << jobMaxMemoryConsuption << " B");
       ALICEVISION_LOG_DEBUG("Memory information: " << std::endl <<memoryInformation);
+      ALICEVISION_LOG_DEBUG("Available memory: " << availableMemory << " B");
 
       if(jobMaxMemoryConsuption == 0)
         throw std::runtime_error("Cannot compute feature extraction job max memory consumption.");
 
-      std::size_t nbThreads =  (0.9 * memoryInformation.freeRam) / jobMaxMemoryConsuption;
+      std::size_t nbThreads =  (0.9 * availableMemory) / jobMaxMemoryConsuption;
 
-      if(memoryInformation.freeRam == 0)
+      if(availableMemory == 0)
       {
         ALICEVISION_LOG_WARNING("Cannot find available system memory, this can be due to OS limitations.\n"
                                 "Use only one thread for CPU feature extraction.");
@@ -207,10 +224,13 @@ private:
 
   void computeViewJob(const ViewJob& job, bool useGPU = false)
   {
+    ALICEVISION_TRACE_ZONE("featureExtraction::computeView");
+
     image::Image<float> imageGrayFloat;
     image::Image<unsigned char> imageGrayUChar;
 
-    image::readImage(job.view.getImagePath(), imageGrayFloat, image::EImageColorSpace::SRGB);
+    // the image is only read if some features are not in the cache
+    const std::string imageHash = _featuresCache ? feature::FeaturesCache::computeFileHash(job.view.getImagePath()) : std::string();
 
     const auto imageDescriberIndexes = useGPU ? job.gpuImageDescriberIndexes : job.cpuImageDescriberIndexes;
 
@@ -220,23 +240,47 @@ private:
       const feature::EImageDescriberType imageDescriberType = imageDescriber->getDescriberType();
       const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriberType);
 
+      std::string cacheKey;
+      if(_featuresCache)
+      {
+        // cpu and gpu implementations don't give the same features
+        cacheKey = feature::FeaturesCache::computeKey(imageHash, imageDescriberType, _describerPreset + (useGPU ? "|gpu" : "|cpu"));
+
+        if(_featuresCache->get(cacheKey, job.getFeaturesPath(imageDescriberType), job.getDescriptorPath(imageDescriberType)))
+        {
+          ALICEVISION_LOG_INFO(imageDescriberTypeName << " features of view '" << job.view.getImagePath() << "' found in the features cache.");
+          continue;
+        }
+      }
+
+      if(imageGrayFloat.Width() == 0)
+        image::readImage(job.view.getImagePath(), imageGrayFloat, image::EImageColorSpace::SRGB);
+
       // Compute features and descriptors and export them to files
       ALICEVISION_LOG_INFO("Extracting " << imageDescriberTypeName  << " features from view '" << job.view.getImagePath() << "' " << (useGPU ? "[gpu]" : "[cpu]"));
 
       std::unique_ptr<feature::Regions> regions;
-      if(imageDescriber->useFloatImage())
-      {
-        // image buffer use float image, use the read buffer
-        imageDescriber->describe(imageGrayFloat, regions);
-      }
-      else
       {
-        // image buffer can't use float image
-        if(imageGrayUChar.Width() == 0) // the first time, convert the float buffer to uchar
-          imageGrayUChar = (imageGrayFloat.GetMat() * 255.f).cast<unsigned char>();
-        imageDescriber->describe(imageGrayUChar, regions);
+        ALICEVISION_TRACE_ZONE("featureExtraction::describe");
+
+        if(imageDescriber->useFloatImage())
+        {
+          // image buffer use float image, use the read buffer
+          imageDescriber->describe(imageGrayFloat, regions);
+        }
+        else
+        {
+          // image buffer can't use float image
+          if(imageGrayUChar.Width() == 0) // the first time, convert the float buffer to uchar
+            imageGrayUChar = (imageGrayFloat.GetMat() * 255.f).cast<unsigned char>();
+          imageDescriber->describe(imageGrayUChar, regions);
+        }
       }
       imageDescriber->Save(regions.get(), job.getFeaturesPath(imageDescriberType), job.getDescriptorPath(imageDescriberType));
+
+      if(_featuresCache)
+        _featuresCache->put(cacheKey, job.getFeaturesPath(imageDescriberType), job.getDescriptorPath(imageDescriberType));
+
       ALICEVISION_LOG_INFO(std::left << std::setw(6) << " " << regions->RegionCount() << " " << imageDescriberTypeName  << " features extracted from view '" << job.view.getImagePath() << "'");
     }
   }
@@ -247,6 +291,8 @@ private:
   int _rangeStart = -1;
   int _rangeSize = -1;
   int _maxThreads = -1;
+  std::shared_ptr<feature::FeaturesCache> _featuresCache;
+  std::string _describerPreset;
   std::vector<ViewJob> _cpuJobs;
   std::vector<ViewJob> _gpuJobs;
 };
@@ -259,6 +305,8 @@ int main(int argc, char **argv)
   // command-line parameters
 
   std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string traceFile;
+  std::size_t maxMemory = 0;
   std::string sfmDataFilename;
   std::string outputFolder;
 
@@ -270,6 +318,8 @@ int main(int argc, char **argv)
   int rangeSize = 1;
   int maxThreads = 0;
   bool forceCpuExtraction = false;
+  std::string featuresCacheFolder;
+  std::size_t featuresCacheMaxSize = 0;
 
   po::options_description allParams("AliceVision featureExtraction");
 
@@ -294,12 +344,22 @@ int main(int argc, char **argv)
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
       "Range size.")
     ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads),
-      "Specifies the maximum number of threads to run simultaneously (0 for automatic mode).");
+      "Specifies the maximum number of threads to run simultaneously (0 for automatic mode).")
+    ("featuresCacheFolder", po::value<std::string>(&featuresCacheFolder)->default_value(featuresCacheFolder),
+      "Folder of a persistent features cache, shared between runs and parallel jobs (empty: no cache).\n"
+      "The cached features are reused when the image content, the describer type and the preset are identical.")
+    ("featuresCacheMaxSize", po::value<std::size_t>(&featuresCacheMaxSize)->default_value(featuresCacheMaxSize),
+      "Maximum size of the features cache in MB (0: no limit). The least recently used entries are evicted.");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
     ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
-      "verbosity level (fatal, error, warning, info, debug, trace).");
+      "verbosity level (fatal, error, warning, info, debug, trace).")
+    ("traceFile", po::value<std::string>(&traceFile)->default_value(traceFile),
+      "Record a trace of the processing and export it to this file (Chrome trace / Perfetto JSON).")
+    ("maxMemory", po::value<std::size_t>(&maxMemory)->default_value(maxMemory),
+      "Maximum memory usage in MB (0: no limit, use the free RAM). Caches and chunked processing are sized accordingly.\n"
+      "The peak memory usage is reported at exit.");
 
   allParams.add(requiredParams).add(optionalParams).add(logParams);
 
@@ -334,6 +394,12 @@ int main(int argc, char **argv)
   // set verbose level
   system::Logger::get()->setLogLevel(verboseLevel);
 
+  // record a trace of the processing if requested
+  system::TraceFile traceFileExport(traceFile);
+
+  // memory budget of the caches and chunked processing, report the memory usage at exit
+  system::MemoryBudgetScope memoryBudgetScope(maxMemory);
+
   if(describerTypesName.empty())
   {
     ALICEVISION_LOG_ERROR("--describerTypes option is empty.");
@@ -401,6 +467,15 @@ int main(int argc, char **argv)
     }
   }
 
+  // initialize the features cache
+  std::shared_ptr<feature::FeaturesCache> featuresCache;
+  if(!featuresCacheFolder.empty())
+  {
+    featuresCache = std::make_shared<feature::FeaturesCache>(featuresCacheFolder, static_cast<std::uint64_t>(featuresCacheMaxSize) * 1024 * 1024);
+    // normalized preset name, for the cache key
+    extractor.setFeaturesCache(featuresCache, feature::EImageDescriberPreset_enumToString(feature::EImageDescriberPreset_stringToEnum(describerPreset)));
+  }
+
   // feature extraction routines
   // for each View of the SfMData container:
   // - if regions file exist continue,
@@ -410,6 +485,9 @@ int main(int argc, char **argv)
 
     extractor.process();
 
+    if(featuresCache)
+      featuresCache->logStatistics();
+
     ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
   }
   return EXIT_SUCCESS;
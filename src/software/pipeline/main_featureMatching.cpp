@@ -25,7 +25,9 @@
 #include <aliceVision/matchingImageCollection/GeometricFilterType.hpp>
 #include <aliceVision/matching/pairwiseAdjacencyDisplay.hpp>
 #include <aliceVision/matching/io.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/feature/selection.hpp>
 #include <aliceVision/graph/graph.hpp>
@@ -41,7 +43,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -91,6 +93,8 @@ int main(int argc, char **argv)
   // command-line parameters
 
   std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string traceFile;
+  std::size_t maxMemory = 0;
   std::string sfmDataFilename;
   std::string matchesFolder;
   std::vector<std::string> featuresFolders;
@@ -188,7 +192,12 @@ int main(int argc, char **argv)
   po::options_description logParams("Log parameters");
   logParams.add_options()
     ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
-      "verbosity level (fatal, error, warning, info, debug, trace).");
+      "verbosity level (fatal, error, warning, info, debug, trace).")
+    ("traceFile", po::value<std::string>(&traceFile)->default_value(traceFile),
+      "Record a trace of the processing and export it to this file (Chrome trace / Perfetto JSON).")
+    ("maxMemory", po::value<std::size_t>(&maxMemory)->default_value(maxMemory),
+      "Maximum memory usage in MB (0: no limit, use the free RAM). Caches and chunked processing are sized accordingly.\n"
+      "The peak memory usage is reported at exit.");
 
   allParams.add(requiredParams).add(optionalParams).add(logParams);
 
@@ -227,6 +236,12 @@ int main(int argc, char **argv)
   // set verbose level
   system::Logger::get()->setLogLevel(verboseLevel);
 
+  // record a trace of the processing if requested
+  system::TraceFile traceFileExport(traceFile);
+
+  // memory budget of the caches and chunked processing, report the memory usage at exit
+  system::MemoryBudgetScope memoryBudgetScope(maxMemory);
+
   // check and set input options
   if(matchesFolder.empty() || !fs::is_directory(matchesFolder))
   {
@@ -10,7 +10,9 @@
 #include <aliceVision/sfm/sfm.hpp>
 #include <aliceVision/sfm/pipeline/regionsIO.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/types.hpp>
@@ -25,7 +27,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -72,6 +74,8 @@ int main(int argc, char **argv)
   // command-line parameters
 
   std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string traceFile;
+  std::size_t maxMemory = 0;
   std::string sfmDataFilename;
   std::vector<std::string> featuresFolders;
   std::vector<std::string> matchesFolders;
@@ -169,7 +173,12 @@ int main(int argc, char **argv)
   po::options_description logParams("Log parameters");
   logParams.add_options()
     ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
-      "verbosity level (fatal, error, warning, info, debug, trace).");
+      "verbosity level (fatal, error, warning, info, debug, trace).")
+    ("traceFile", po::value<std::string>(&traceFile)->default_value(traceFile),
+      "Record a trace of the processing and export it to this file (Chrome trace / Perfetto JSON).")
+    ("maxMemory", po::value<std::size_t>(&maxMemory)->default_value(maxMemory),
+      "Maximum memory usage in MB (0: no limit, use the free RAM). Caches and chunked processing are sized accordingly.\n"
+      "The peak memory usage is reported at exit.");
 
   allParams.add(requiredParams).add(optionalParams).add(logParams);
 
@@ -204,6 +213,12 @@ int main(int argc, char **argv)
   // set verbose level
   system::Logger::get()->setLogLevel(verboseLevel);
 
+  // record a trace of the processing if requested
+  system::TraceFile traceFileExport(traceFile);
+
+  // memory budget of the caches and chunked processing, report the memory usage at exit
+  system::MemoryBudgetScope memoryBudgetScope(maxMemory);
+
   const double defaultLoRansacLocalizationError = 4.0;
   if(!robustEstimation::adjustRobustEstimatorThreshold(sfmParams.localizerEstimator, sfmParams.localizerEstimatorError, defaultLoRansacLocalizationError))
   {
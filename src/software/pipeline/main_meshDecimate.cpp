@@ -4,32 +4,138 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file,
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/geoMesh.hpp>
+#include <aliceVision/mesh/meshDecimation.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 
-#include <OpenMesh/Core/IO/reader/OBJReader.hh>
-#include <OpenMesh/Core/IO/writer/OBJWriter.hh>
-#include <OpenMesh/Core/IO/MeshIO.hh>
-#include <OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh>
-#include <OpenMesh/Core/Geometry/VectorT.hh>
-#include <OpenMesh/Tools/Decimater/DecimaterT.hh>
-#include <OpenMesh/Tools/Decimater/ModQuadricT.hh>
+#include <geogram/mesh/mesh.h>
+#include <geogram/mesh/mesh_io.h>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <map>
+#include <vector>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
 namespace bfs = boost::filesystem;
 namespace po = boost::program_options;
 
+/**
+ * @brief Load a mesh file: OBJ files are read with their vertex colors,
+ *        the other formats supported by Geogram (PLY, OFF, STL...) are read without colors.
+ * @param[in] filepath the mesh file path
+ * @param[out] mesh the loaded mesh
+ * @return true if the mesh is loaded
+ */
+bool loadMesh(const std::string& filepath, mesh::Mesh& mesh)
+{
+    if(boost::algorithm::to_lower_copy(bfs::path(filepath).extension().string()) == ".obj")
+        return mesh.loadFromObjAscii(filepath);
+
+    GEO::initialize();
+    GEO::Mesh geoMesh;
+    if(!GEO::mesh_load(filepath, geoMesh))
+        return false;
+
+    mesh::fromGeoMesh(geoMesh, mesh);
+    return !mesh.tris.empty();
+}
+
+/**
+ * @brief Set the mesh points visibilities from the dense point cloud of the meshing,
+ *        whose landmark ids are the mesh point indexes.
+ * @param[in] densePointCloud the dense point cloud
+ * @param[out] viewIds the view id of each visibility index
+ * @param[in,out] mesh the mesh
+ * @return the number of mesh points with a visibility
+ */
+int setVisibilitiesFromDensePointCloud(const sfmData::SfMData& densePointCloud, std::vector<IndexT>& viewIds, mesh::Mesh& mesh)
+{
+    std::map<IndexT, int> viewIdToIndex;
+    for(const auto& viewPair : densePointCloud.getViews())
+    {
+        viewIdToIndex[viewPair.first] = static_cast<int>(viewIds.size());
+        viewIds.push_back(viewPair.first);
+    }
+
+    mesh.pointsVisibilities.resize(mesh.pts.size());
+
+    int nbVisiblePts = 0;
+    for(const auto& landmarkPair : densePointCloud.getLandmarks())
+    {
+        if(landmarkPair.first >= static_cast<IndexT>(mesh.pts.size()))
+            continue;
+
+        mesh::PointVisibility& pointVisibility = mesh.pointsVisibilities[landmarkPair.first];
+        for(const auto& observationPair : landmarkPair.second.observations)
+        {
+            const auto it = viewIdToIndex.find(observationPair.first);
+            if(it != viewIdToIndex.end())
+                pointVisibility.push_back(it->second);
+        }
+        nbVisiblePts += static_cast<int>(!pointVisibility.empty());
+    }
+    return nbVisiblePts;
+}
+
+/**
+ * @brief Create the dense point cloud of the decimated mesh: one landmark per mesh point,
+ *        observed by the views of its visibility (same layout as the meshing output).
+ * @param[in] sfmData the input dense point cloud (views, intrinsics and poses)
+ * @param[in] viewIds the view id of each visibility index
+ * @param[in] mesh the decimated mesh
+ * @param[out] outSfmData the output dense point cloud
+ */
+void createDenseSfMData(const sfmData::SfMData& sfmData, const std::vector<IndexT>& viewIds, const mesh::Mesh& mesh, sfmData::SfMData& outSfmData)
+{
+    outSfmData = sfmData;
+    outSfmData.getLandmarks().clear();
+
+    const bool hasColors = (mesh.colors().size() == mesh.pts.size());
+
+    for(int i = 0; i < mesh.pts.size(); ++i)
+    {
+        const mesh::PointVisibility& pointVisibility = mesh.pointsVisibilities[i];
+        if(pointVisibility.empty())
+            continue;
+
+        const Point3d& point = mesh.pts[i];
+        const Vec3 pt3D(point.x, point.y, point.z);
+        sfmData::Landmark landmark(pt3D, feature::EImageDescriberType::UNKNOWN);
+
+        if(hasColors)
+        {
+            const rgb& color = mesh.colors()[i];
+            landmark.rgb = image::RGBColor(color.r, color.g, color.b);
+        }
+
+        for(const int viewIndex : pointVisibility)
+        {
+            const sfmData::View& view = sfmData.getView(viewIds[viewIndex]);
+            if(!sfmData.isPoseAndIntrinsicDefined(&view))
+                continue;
+            const camera::IntrinsicBase* intrinsicPtr = sfmData.getIntrinsicPtr(view.getIntrinsicId());
+            const sfmData::Observation observation(intrinsicPtr->project(sfmData.getPose(view).getTransform(), pt3D, true), UndefinedIndexT); // apply distortion
+            landmark.observations[view.getViewId()] = observation;
+        }
+        outSfmData.getLandmarks()[i] = landmark;
+    }
+}
+
 int main(int argc, char* argv[])
 {
     system::Timer timer;
@@ -37,21 +143,25 @@ int main(int argc, char* argv[])
     std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
     std::string inputMeshPath;
     std::string outputMeshPath;
+    std::string inputDensePointCloudPath;
+    std::string outputDensePointCloudPath;
 
     float simplificationFactor = 0;
     int fixedNbVertices = 0;
     int minVertices = 0;
     int maxVertices = 0;
     bool flipNormals = false;
+    int nbPartitions = 0;
+    double maxError = 0.0;
 
-    po::options_description allParams("AliceVision meshResampling");
+    po::options_description allParams("AliceVision meshDecimate");
 
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
         ("input,i", po::value<std::string>(&inputMeshPath)->required(),
-            "Input Mesh (OBJ file format).")
+            "Input Mesh (OBJ file format, or another format supported by Geogram: PLY, OFF, STL...).")
         ("output,o", po::value<std::string>(&outputMeshPath)->required(),
-            "Output mesh (OBJ file format).");
+            "Output mesh (OBJ file format only).");
 
     po::options_description optionalParams("Optional parameters");
     optionalParams.add_options()
@@ -64,7 +174,15 @@ int main(int argc, char* argv[])
         ("maxVertices", po::value<int>(&maxVertices)->default_value(maxVertices),
             "Max number of output vertices.")
         ("flipNormals", po::value<bool>(&flipNormals)->default_value(flipNormals),
-            "Option to flip face normals. It can be needed as it depends on the vertices order in triangles and the convention change from one software to another.");
+            "Option to flip face normals. It can be needed as it depends on the vertices order in triangles and the convention change from one software to another.")
+        ("nbPartitions", po::value<int>(&nbPartitions)->default_value(nbPartitions),
+            "Number of spatial partitions decimated in parallel (0: automatic).")
+        ("maxError", po::value<double>(&maxError)->default_value(maxError),
+            "Maximum quadric error of an edge collapse (0: no limit).")
+        ("inputDensePointCloud", po::value<std::string>(&inputDensePointCloudPath)->default_value(inputDensePointCloudPath),
+            "Dense point cloud of the input mesh (SfMData file from the meshing, one landmark per mesh vertex) to carry the visibilities.")
+        ("outputDensePointCloud", po::value<std::string>(&outputDensePointCloudPath)->default_value(outputDensePointCloudPath),
+            "Output dense point cloud (SfMData file) with one landmark per decimated mesh vertex, requires inputDensePointCloud.");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
@@ -106,19 +224,18 @@ int main(int argc, char* argv[])
     // set verbose level
     system::Logger::get()->setLogLevel(verboseLevel);
 
+    if(boost::algorithm::to_lower_copy(bfs::path(outputMeshPath).extension().string()) != ".obj")
+    {
+        ALICEVISION_LOG_ERROR("The output mesh must be an OBJ file: " << outputMeshPath);
+        return EXIT_FAILURE;
+    }
+
     bfs::path outDirectory = bfs::path(outputMeshPath).parent_path();
     if(!bfs::is_directory(outDirectory))
         bfs::create_directory(outDirectory);
 
-    // Mesh type
-    typedef OpenMesh::TriMesh_ArrayKernelT<>                      Mesh;
-    // Decimater type
-    typedef OpenMesh::Decimater::DecimaterT< Mesh >               Decimater;
-    // Decimation Module Handle type
-    typedef OpenMesh::Decimater::ModQuadricT< Mesh >::Handle HModQuadric;
-
-    Mesh mesh;
-    if(!OpenMesh::IO::read_mesh(mesh, inputMeshPath.c_str()))
+    mesh::Mesh mesh;
+    if(!loadMesh(inputMeshPath, mesh))
     {
         ALICEVISION_LOG_ERROR("Unable to read input mesh from the file: " << inputMeshPath);
         return EXIT_FAILURE;
@@ -126,7 +243,20 @@ int main(int argc, char* argv[])
 
     ALICEVISION_LOG_INFO("Mesh file: \"" << inputMeshPath << "\" loaded.");
 
-    int nbInputPoints = mesh.n_vertices();
+    sfmData::SfMData densePointCloud;
+    std::vector<IndexT> viewIds;
+    if(!inputDensePointCloudPath.empty())
+    {
+        if(!sfmDataIO::Load(densePointCloud, inputDensePointCloudPath, sfmDataIO::ESfMData::ALL_DENSE))
+        {
+            ALICEVISION_LOG_ERROR("The input dense point cloud '" << inputDensePointCloudPath << "' cannot be read.");
+            return EXIT_FAILURE;
+        }
+        const int nbVisiblePts = setVisibilitiesFromDensePointCloud(densePointCloud, viewIds, mesh);
+        ALICEVISION_LOG_INFO("Visibilities of " << nbVisiblePts << " / " << mesh.pts.size() << " vertices loaded.");
+    }
+
+    int nbInputPoints = mesh.pts.size();
     int nbOutputPoints = 0;
     if(fixedNbVertices != 0)
     {
@@ -150,48 +280,51 @@ int main(int argc, char* argv[])
         }
     }
 
-    ALICEVISION_LOG_INFO("Input mesh: " << nbInputPoints << " vertices and " << mesh.n_faces() << " facets.");
+    ALICEVISION_LOG_INFO("Input mesh: " << nbInputPoints << " vertices and " << mesh.tris.size() << " facets.");
     ALICEVISION_LOG_INFO("Target output mesh: " << nbOutputPoints << " vertices.");
 
     {
-        // a decimater object, connected to a mesh
-        Decimater   decimater(mesh);
-        // use a quadric module
-        HModQuadric hModQuadric;
-        // register module at the decimater
-        decimater.add(hModQuadric);
-
-        // the way to access the module
-        std::cout << decimater.module(hModQuadric).name() << std::endl;
-
-        /*
-         * since we need exactly one priority module (non-binary)
-         * we have to call set_binary(false) for our priority module
-         * in the case of HModQuadric, unset_max_err() calls set_binary(false) internally
-         */
-        decimater.module(hModQuadric).unset_max_err();
-        // let the decimater initialize the mesh and the modules
-        decimater.initialize();
-        // do decimation
-        size_t removedVertices = decimater.decimate_to(nbOutputPoints);
-        decimater.mesh().garbage_collection();
+        mesh::DecimationParams params;
+        params.targetNbPoints = nbOutputPoints;
+        params.nbPartitions = nbPartitions;
+        params.maxError = maxError;
+
+        mesh::decimateMesh(mesh, params);
     }
-    ALICEVISION_LOG_INFO("Output mesh: " << mesh.n_vertices() << " vertices and " << mesh.n_faces() << " facets.");
+    ALICEVISION_LOG_INFO("Output mesh: " << mesh.pts.size() << " vertices and " << mesh.tris.size() << " facets.");
 
-    if(mesh.n_faces() == 0)
+    if(mesh.tris.empty())
     {
         ALICEVISION_LOG_ERROR("Failed: the output mesh is empty.");
         return EXIT_FAILURE;
     }
 
+    if(flipNormals)
+        mesh.invertTriangleOrientations();
+
     ALICEVISION_LOG_INFO("Save mesh.");
     // Save output mesh
-    if(!OpenMesh::IO::write_mesh(mesh, outputMeshPath))
+    mesh.saveToObj(outputMeshPath);
+    ALICEVISION_LOG_INFO("Mesh file: \"" << outputMeshPath << "\" saved.");
+
+    if(!outputDensePointCloudPath.empty())
     {
-        ALICEVISION_LOG_ERROR("Failed to save mesh \"" << outputMeshPath << "\".");
-        return EXIT_FAILURE;
+        if(inputDensePointCloudPath.empty())
+        {
+            ALICEVISION_LOG_ERROR("The output dense point cloud requires an input dense point cloud.");
+            return EXIT_FAILURE;
+        }
+
+        sfmData::SfMData outDensePointCloud;
+        createDenseSfMData(densePointCloud, viewIds, mesh, outDensePointCloud);
+
+        ALICEVISION_LOG_INFO("Save dense point cloud.");
+        if(!sfmDataIO::Save(outDensePointCloud, outputDensePointCloudPath, sfmDataIO::ESfMData::ALL_DENSE))
+        {
+            ALICEVISION_LOG_ERROR("Failed to save dense point cloud \"" << outputDensePointCloudPath << "\".");
+            return EXIT_FAILURE;
+        }
     }
-    ALICEVISION_LOG_INFO("Mesh file: \"" << outputMeshPath << "\" saved.");
 
     ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
     return EXIT_SUCCESS;
@@ -10,6 +10,7 @@
 #include <aliceVision/fuseCut/LargeScale.hpp>
 #include <aliceVision/fuseCut/ReconstructionPlan.hpp>
 #include <aliceVision/fuseCut/DelaunayGraphCut.hpp>
+#include <aliceVision/fuseCut/PartitionedMeshing.hpp>
 #include <aliceVision/mesh/meshPostProcessing.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/Rgb.hpp>
@@ -19,15 +20,26 @@
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Tracer.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 3
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -127,12 +139,57 @@ void removeLandmarksWithoutObservations(sfmData::SfMData& sfmData)
   }
 }
 
+/**
+ * @brief Get the signature of the meshing parameters and inputs, the partitions meshes are recomputed when it changes.
+ * @note The options which do not change the partitions meshes (range, stitching, outputs and logs) are ignored.
+ */
+std::string getMeshingSignature(const po::variables_map& vm, const std::vector<std::string>& inputPaths, int ocTreeDim)
+{
+  const std::set<std::string> ignoredOptions = {"output", "outputMesh", "colorizeOutput", "saveRawDensePointCloud",
+                                                "rangeStart", "rangeSize", "seamWeldFactor", "seamMaxHoleEdges",
+                                                "verboseLevel", "traceFile", "maxMemory"};
+  std::ostringstream signature;
+  signature << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+  for(const auto& option : vm)
+  {
+    if(!ignoredOptions.count(option.first))
+      signature << option.first << ": " << option.second.value() << std::endl;
+  }
+  signature << "ocTreeDim: " << ocTreeDim << std::endl;
+
+  // the inputs can be recomputed in place: their files modification times are part of the signature
+  for(const std::string& inputPath : inputPaths)
+  {
+    if(inputPath.empty() || !fs::exists(inputPath))
+      continue;
+
+    std::size_t nbFiles = 1;
+    std::time_t lastWriteTime = fs::last_write_time(inputPath);
+    if(fs::is_directory(inputPath))
+    {
+      nbFiles = 0;
+      for(const fs::directory_entry& entry : fs::directory_iterator(inputPath))
+      {
+        if(!fs::is_regular_file(entry.status()))
+          continue;
+        ++nbFiles;
+        lastWriteTime = std::max(lastWriteTime, fs::last_write_time(entry.path()));
+      }
+    }
+    signature << "input: " << inputPath << ", " << nbFiles << " files, last modified " << lastWriteTime << std::endl;
+  }
+  return signature.str();
+}
+
 
 int main(int argc, char* argv[])
 {
     system::Timer timer;
 
     std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+    std::string traceFile;
+    std::size_t maxMemory = 0;
     std::string sfmDataFilename;
     std::string outputMesh;
     std::string outputDensePointCloud;
@@ -149,8 +206,11 @@ int main(int argc, char* argv[])
     bool addLandmarksToTheDensePointCloud = false;
     bool saveRawDensePointCloud = false;
     bool colorizeOutput = false;
+    int rangeStart = -1;
+    int rangeSize = -1;
 
     fuseCut::FuseParams fuseParams;
+    fuseCut::PartitioningParams partitioningParams;
 
     po::options_description allParams("AliceVision meshing");
 
@@ -191,7 +251,18 @@ int main(int argc, char* argv[])
         ("addLandmarksToTheDensePointCloud", po::value<bool>(&addLandmarksToTheDensePointCloud)->default_value(addLandmarksToTheDensePointCloud),
             "Add SfM Landmarks into the dense point cloud (created from depth maps). If only the SfM is provided in input, SfM landmarks will be used regardless of this option.")
         ("colorizeOutput", po::value<bool>(&colorizeOutput)->default_value(colorizeOutput),
-            "Whether to colorize output dense point cloud and mesh.");
+            "Whether to colorize output dense point cloud and mesh.")
+        ("partitionMaxLandmarks", po::value<int>(&partitioningParams.maxLandmarksPerPartition)->default_value(partitioningParams.maxLandmarksPerPartition),
+            "Partitioning 'auto': maximum number of SfM landmarks in a partition.")
+        ("partitionMaxDepth", po::value<int>(&partitioningParams.maxDepth)->default_value(partitioningParams.maxDepth),
+            "Partitioning 'auto': maximum depth of the partitions octree.")
+        ("partitionOverlap", po::value<double>(&partitioningParams.overlap)->default_value(partitioningParams.overlap),
+            "Partitioning 'auto': overlap of the reconstructed partitions with their neighbors, as a fraction of the partition size.")
+        ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
+            "Partitioning 'auto': compute only a sub-range of the partitions, from this index.")
+        ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
+            "Partitioning 'auto': compute only a sub-range of the partitions, of this size. "
+            "The partitions meshes are stitched by a call without range once all of them are computed.");
 
     po::options_description advancedParams("Advanced parameters");
     advancedParams.add_options()
@@ -218,12 +289,21 @@ int main(int argc, char* argv[])
         ("refineFuse", po::value<bool>(&fuseParams.refineFuse)->default_value(fuseParams.refineFuse),
             "refineFuse")
         ("saveRawDensePointCloud", po::value<bool>(&saveRawDensePointCloud)->default_value(saveRawDensePointCloud),
-            "Save dense point cloud before cut and filtering.");
+            "Save dense point cloud before cut and filtering.")
+        ("seamWeldFactor", po::value<double>(&partitioningParams.seamWeldFactor)->default_value(partitioningParams.seamWeldFactor),
+            "Partitioning 'auto': maximum distance between two merged seam vertices, as a factor of the local edge length.")
+        ("seamMaxHoleEdges", po::value<int>(&partitioningParams.seamMaxHoleEdges)->default_value(partitioningParams.seamMaxHoleEdges),
+            "Partitioning 'auto': maximum number of edges of the seam holes closed after the merge of the seam vertices.");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
       ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
-        "verbosity level (fatal, error, warning, info, debug, trace).");
+        "verbosity level (fatal, error, warning, info, debug, trace).")
+      ("traceFile", po::value<std::string>(&traceFile)->default_value(traceFile),
+        "Record a trace of the processing and export it to this file (Chrome trace / Perfetto JSON).")
+      ("maxMemory", po::value<std::size_t>(&maxMemory)->default_value(maxMemory),
+        "Maximum memory usage in MB (0: no limit, use the free RAM). Caches and chunked processing are sized accordingly.\n"
+        "The peak memory usage is reported at exit.");
 
     allParams.add(requiredParams).add(optionalParams).add(advancedParams).add(logParams);
 
@@ -260,12 +340,17 @@ int main(int argc, char* argv[])
     // set verbose level
     system::Logger::get()->setLogLevel(verboseLevel);
 
+    // record a trace of the processing if requested
+    system::TraceFile traceFileExport(traceFile);
+
+    // memory budget of the caches and chunked processing, report the memory usage at exit
+    system::MemoryBudgetScope memoryBudgetScope(maxMemory);
+
     if(depthMapsFolder.empty() || depthMapsFilterFolder.empty())
     {
       if(depthMapsFolder.empty() &&
          depthMapsFilterFolder.empty() &&
-         repartitionMode == eRepartitionMultiResolution &&
-         partitioningMode == ePartitioningSingleBlock)
+         repartitionMode == eRepartitionMultiResolution)
       {
         meshingFromDepthMaps = false;
         addLandmarksToTheDensePointCloud = true;
@@ -274,7 +359,7 @@ int main(int argc, char* argv[])
       {
         ALICEVISION_LOG_ERROR("Invalid input options:\n"
                               "- Meshing from depth maps require --depthMapsFolder and --depthMapsFilterFolder options.\n"
-                              "- Meshing from SfM require option --partitioning set to 'singleBlock' and option --repartition set to 'multiResolution'.");
+                              "- Meshing from SfM require option --repartition set to 'multiResolution'.");
         return EXIT_FAILURE;
       }
     }
@@ -412,7 +497,74 @@ int main(int argc, char* argv[])
             {
                 case ePartitioningAuto:
                 {
-                    throw std::invalid_argument("Meshing mode: 'multiResolution', partitioning: 'auto' is not yet implemented.");
+                    ALICEVISION_LOG_INFO("Meshing mode: multi-resolution, partitioning: auto.");
+                    std::array<Point3d, 8> hexah;
+
+                    float minPixSize;
+                    fuseCut::Fuser fs(&mp);
+
+                    if(meshingFromDepthMaps && !estimateSpaceFromSfM)
+                      fs.divideSpaceFromDepthMaps(&hexah[0], minPixSize);
+                    else
+                      fs.divideSpaceFromSfM(sfmData, &hexah[0], estimateSpaceMinObservations, estimateSpaceMinObservationAngle);
+
+                    // the fused dense points are sampled from the depth maps to keep the partitions without landmarks
+                    std::vector<Point3d> densePointsSamples;
+                    if(meshingFromDepthMaps)
+                      fs.sampleDepthMapsPoints(partitioningParams.nbDensePointsSamples, densePointsSamples);
+
+                    std::vector<fuseCut::MeshingPartition> partitions;
+                    fuseCut::computeMeshingPartitions(sfmData, densePointsSamples, &hexah[0], partitioningParams, partitions);
+                    std::vector<Point3d>().swap(densePointsSamples);
+                    ALICEVISION_LOG_INFO("Number of partitions: " << partitions.size());
+
+                    if(partitions.empty())
+                        throw std::logic_error("No partition to make the reconstruction");
+
+                    const std::string partitionsFolder = (outDirectory/"partitions").string();
+                    const std::string meshingSignature = getMeshingSignature(vm, {sfmDataFilename, depthMapsFolder, depthMapsFilterFolder}, ocTreeDim);
+
+                    int partitionsBegin = 0;
+                    int partitionsEnd = partitions.size();
+                    if(rangeSize != -1)
+                    {
+                        if(rangeStart < 0 || rangeSize < 0 || rangeStart >= static_cast<int>(partitions.size()))
+                        {
+                            ALICEVISION_LOG_ERROR("Range is incorrect: start " << rangeStart << ", size " << rangeSize << ", number of partitions " << partitions.size() << ".");
+                            return EXIT_FAILURE;
+                        }
+                        partitionsBegin = rangeStart;
+                        partitionsEnd = std::min(static_cast<int>(partitions.size()), rangeStart + rangeSize);
+                    }
+
+                    for(int partitionId = partitionsBegin; partitionId < partitionsEnd; ++partitionId)
+                    {
+                        const std::string partitionFolder = fuseCut::getPartitionFolder(partitionsFolder, partitionId);
+                        const std::string partitionSignature = fuseCut::getPartitionSignature(partitions[partitionId], meshingSignature);
+                        if(fuseCut::isPartitionMeshComputed(partitionFolder, partitionSignature))
+                        {
+                            ALICEVISION_LOG_INFO("Partition " << partitionId + 1 << " / " << partitions.size() << " already computed.");
+                            continue;
+                        }
+                        ALICEVISION_LOG_INFO("Partition " << partitionId + 1 << " / " << partitions.size() << ".");
+                        fuseCut::computePartitionMesh(mp, &hexah[0], partitions[partitionId], ocTreeDim,
+                                                      addLandmarksToTheDensePointCloud ? &sfmData : nullptr,
+                                                      meshingFromDepthMaps ? &fuseParams : nullptr,
+                                                      (meshingFromDepthMaps && !estimateSpaceFromSfM) ? nullptr : &sfmData,
+                                                      partitionFolder, partitionSignature);
+                    }
+
+                    // sub-range of the partitions: the stitching is done by another call
+                    if(rangeSize != -1)
+                    {
+                        ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
+                        return EXIT_SUCCESS;
+                    }
+
+                    mesh = fuseCut::stitchPartitionsMeshes(mp, &hexah[0], partitions, partitionsFolder, meshingSignature, partitioningParams, ptsCams);
+                    mesh::meshPostProcessing(mesh, ptsCams, mp, outDirectory.string()+"/", nullptr, &hexah[0]);
+
+                    break;
                 }
                 case ePartitioningSingleBlock:
                 {
@@ -404,6 +404,7 @@ public:
 
   bool downscale(image::Image<image::RGBfColor> & output, const image::Image<image::RGBfColor> & input) {
 
+    #pragma omp parallel for
     for (int i = 0; i < output.Height(); i++) {
       int ui = i * 2;
 
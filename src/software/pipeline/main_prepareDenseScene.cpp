@@ -9,6 +9,7 @@
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/ProcessingPipeline.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/program_options.hpp>
@@ -20,13 +21,15 @@
 #include <cmath>
 #include <vector>
 #include <set>
+#include <map>
+#include <fstream>
 #include <iterator>
 #include <iomanip>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -37,6 +40,69 @@ using namespace aliceVision::sfmData;
 namespace po = boost::program_options;
 namespace fs = boost::filesystem;
 
+/**
+ * @brief Image and metadata of a view going through the export pipeline
+ */
+struct ViewExportItem
+{
+  IndexT viewId = UndefinedIndexT;
+  oiio::ParamValueList metadata;
+  Image<RGBfColor> image;
+};
+
+/**
+ * @brief Find the image files of the views in the given folders.
+ *        Each folder is listed only once, the first file whose stem matches the view id
+ *        or the source image stem is used.
+ * @param[in] sfmData the SfMData
+ * @param[in] viewIds the view ids to find
+ * @param[in] imagesFolders the folders to search in (in order of priority)
+ * @param[out] imagePaths the image path per view id
+ */
+void findViewsImages(const SfMData& sfmData,
+                     const std::set<IndexT>& viewIds,
+                     const std::vector<std::string>& imagesFolders,
+                     std::map<IndexT, std::string>& imagePaths)
+{
+  for(const std::string& folder : imagesFolders)
+  {
+    // first file (in listing order) per stem
+    std::map<std::string, std::pair<std::size_t, std::string>> filesPerStem;
+    std::size_t fileIndex = 0;
+
+    for(fs::recursive_directory_iterator it(folder), end; it != end; ++it, ++fileIndex)
+    {
+      const fs::path& path = it->path();
+      filesPerStem.emplace(path.stem().string(), std::make_pair(fileIndex, path.stem().string() + path.extension().string()));
+    }
+
+    for(const IndexT viewId : viewIds)
+    {
+      if(imagePaths.count(viewId))
+        continue;
+
+      const std::string viewIdStem = std::to_string(viewId);
+      const std::string imageStem = fs::path(sfmData.getView(viewId).getImagePath()).stem().string();
+
+      const auto viewIdIt = filesPerStem.find(viewIdStem);
+      const auto imageIt = filesPerStem.find(imageStem);
+      const auto end = filesPerStem.end();
+
+      if(viewIdIt == end && imageIt == end)
+        continue;
+
+      const auto& found = (imageIt == end || (viewIdIt != end && viewIdIt->second.first < imageIt->second.first)) ? viewIdIt->second : imageIt->second;
+      imagePaths[viewId] = (fs::path(folder) / found.second).string();
+    }
+  }
+
+  for(const IndexT viewId : viewIds)
+  {
+    if(!imagePaths.count(viewId))
+      throw std::runtime_error("Cannot find view " + std::to_string(viewId) + " image file in given folder(s)");
+  }
+}
+
 bool prepareDenseScene(const SfMData& sfmData,
                        const std::vector<std::string>& imagesFolders,
                        int beginIndex,
@@ -45,7 +111,10 @@ bool prepareDenseScene(const SfMData& sfmData,
                        image::EImageFileType outputFileType,
                        bool saveMetadata,
                        bool saveMatricesFiles,
-                       bool evCorrection)
+                       bool evCorrection,
+                       int nbDecodeThreads,
+                       int nbEncodeThreads,
+                       int maxInFlightImages)
 {
   // defined view Ids
   std::set<IndexT> viewIds;
@@ -74,6 +143,20 @@ bool prepareDenseScene(const SfMData& sfmData,
     ALICEVISION_LOG_WARNING("Cannot save informations in images metadata.\n"
                             "Choose '.exr' file type if you want AliceVision custom metadata");
 
+  // source images, from the SfMData or from the given folders
+  std::map<IndexT, std::string> srcImages;
+  if(!imagesFolders.empty())
+  {
+    findViewsImages(sfmData, viewIds, imagesFolders, srcImages);
+  }
+  else
+  {
+    for(const IndexT viewId : viewIds)
+      srcImages[viewId] = sfmData.getView(viewId).getImagePath();
+  }
+
+  const std::vector<IndexT> viewIdsToExport(viewIds.begin(), viewIds.end());
+
   // export data
   boost::progress_display progressBar(viewIds.size(), std::cout, "Exporting Scene Undistorted Images\n");
 
@@ -81,33 +164,72 @@ bool prepareDenseScene(const SfMData& sfmData,
   const float medianCameraExposure = sfmData.getMedianCameraExposureSetting();
   ALICEVISION_LOG_INFO("Median Camera Exposure: " << medianCameraExposure << ", Median EV: " << std::log2(1.0f/medianCameraExposure));
 
-#pragma omp parallel for num_threads(3)
-  for(int i = 0; i < viewIds.size(); ++i)
+  // decode -> undistort -> encode pipeline:
+  // disk reads and writes overlap the undistortion, the number of images in memory is bounded
+  system::ProcessingPipeline<ViewExportItem> pipeline(maxInFlightImages);
+
+  pipeline.addStage("decode", nbDecodeThreads, [&](std::size_t index, ViewExportItem& item)
   {
-    auto itView = viewIds.begin();
-    std::advance(itView, i);
+    item.viewId = viewIdsToExport.at(index);
+    const View& view = sfmData.getView(item.viewId);
 
-    const IndexT viewId = *itView;
-    const View* view = sfmData.getViews().at(viewId).get();
+    // get metadata from source image to be sure we get all metadata. We don't use the metadatas from the Views inside the SfMData to avoid type conversion problems with string maps.
+    item.metadata = image::readImageMetadata(view.getImagePath());
 
-    Intrinsics::const_iterator iterIntrinsic = sfmData.getIntrinsics().find(view->getIntrinsicId());
+    readImage(srcImages.at(item.viewId), item.image, image::EImageColorSpace::LINEAR);
+  });
 
-    //we have a valid view with a corresponding camera & pose
-    const std::string baseFilename = std::to_string(viewId);
+  // undistortion is parallelized internally
+  pipeline.addStage("undistort", 1, [&](std::size_t index, ViewExportItem& item)
+  {
+    const View& view = sfmData.getView(item.viewId);
+    const IntrinsicBase* cam = sfmData.getIntrinsicPtr(view.getIntrinsicId());
+
+    // add exposure values to images metadata
+    const float cameraExposure = view.getCameraExposureSetting();
+    const float ev = std::log2(1.0 / cameraExposure);
+    const float exposureCompensation = medianCameraExposure / cameraExposure;
+    item.metadata.push_back(oiio::ParamValue("AliceVision:EV", ev));
+    item.metadata.push_back(oiio::ParamValue("AliceVision:EVComp", exposureCompensation));
+
+    // exposure correction
+    if(evCorrection)
+    {
+      ALICEVISION_LOG_INFO("View: " << item.viewId << ", Ev: " << ev << ", Ev compensation: " << exposureCompensation);
 
-    // get metadata from source image to be sure we get all metadata. We don't use the metadatas from the Views inside the SfMData to avoid type conversion problems with string maps.
-    std::string srcImage = view->getImagePath();
-    oiio::ParamValueList metadata = image::readImageMetadata(srcImage);
+      RGBfColor* pixels = item.image.data();
+      const int nbPixels = item.image.Width() * item.image.Height();
+
+      #pragma omp parallel for
+      for(int pix = 0; pix < nbPixels; ++pix)
+        pixels[pix] = pixels[pix] * exposureCompensation;
+    }
+
+    // undistort
+    if(cam->isValid() && cam->have_disto())
+    {
+      Image<RGBfColor> image_ud;
+      UndistortImage(item.image, cam, image_ud, FBLACK);
+      item.image.swap(image_ud);
+    }
+  });
+
+  pipeline.addStage("encode", nbEncodeThreads, [&](std::size_t index, ViewExportItem& item)
+  {
+    const View& view = sfmData.getView(item.viewId);
+
+    //we have a valid view with a corresponding camera & pose
+    const std::string baseFilename = std::to_string(item.viewId);
 
     // export camera
     if(saveMetadata || saveMatricesFiles)
     {
       // get camera pose / projection
-      const Pose3 pose = sfmData.getPose(*view).getTransform();
-      Mat34 P = iterIntrinsic->second.get()->get_projective_equivalent(pose);
+      const Pose3 pose = sfmData.getPose(view).getTransform();
+      Mat34 P = sfmData.getIntrinsicPtr(view.getIntrinsicId())->get_projective_equivalent(pose);
 
       // get camera intrinsics matrices
-      const Mat3 K = dynamic_cast<const Pinhole*>(sfmData.getIntrinsicPtr(view->getIntrinsicId()))->K();
+      const Mat3 K = dynamic_cast<const Pinhole*>(sfmData.getIntrinsicPtr(view.getIntrinsicId()))->K();
       const Mat3& R = pose.rotation();
       const Vec3& t = pose.translation();
 
@@ -154,79 +276,23 @@ bool prepareDenseScene(const SfMData& sfmData,
         Eigen::Map<RowMatrixXd>(vR.data(), R.rows(), R.cols()) = R;
 
         // add metadata
-        metadata.push_back(oiio::ParamValue("AliceVision:downscale", 1));
-        metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, vP.data()));
-        metadata.push_back(oiio::ParamValue("AliceVision:K", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vK.data()));
-        metadata.push_back(oiio::ParamValue("AliceVision:R", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vR.data()));
-        metadata.push_back(oiio::ParamValue("AliceVision:t", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::VEC3), 1, t.data()));
+        item.metadata.push_back(oiio::ParamValue("AliceVision:downscale", 1));
+        item.metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, vP.data()));
+        item.metadata.push_back(oiio::ParamValue("AliceVision:K", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vK.data()));
+        item.metadata.push_back(oiio::ParamValue("AliceVision:R", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vR.data()));
+        item.metadata.push_back(oiio::ParamValue("AliceVision:t", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::VEC3), 1, t.data()));
       }
     }
 
-    // export undistort image
-    {      
-      if(!imagesFolders.empty())
-      {
-        bool found = false;
-        for(const std::string& folder : imagesFolders)
-        {
-          const fs::recursive_directory_iterator end;
-          const auto findIt = std::find_if(fs::recursive_directory_iterator(folder), end,
-                                   [&view](const fs::directory_entry& e) {
-                                      return (e.path().stem() == std::to_string(view->getViewId()) ||
-                                              e.path().stem() == fs::path(view->getImagePath()).stem());});
-
-          if(findIt != end)
-          {
-            srcImage = (fs::path(folder) / (findIt->path().stem().string() + findIt->path().extension().string())).string();
-            found = true;
-            break;
-          }
-        }
-
-        if(!found)
-          throw std::runtime_error("Cannot find view " + std::to_string(view->getViewId()) + " image file in given folder(s)");
-      }
-
-
-      const std::string dstColorImage = (fs::path(outFolder) / (baseFilename + "." + image::EImageFileType_enumToString(outputFileType))).string();
-      const IntrinsicBase* cam = iterIntrinsic->second.get();
-      Image<RGBfColor> image, image_ud;
-
-      readImage(srcImage, image, image::EImageColorSpace::LINEAR);
-
-      // add exposure values to images metadata
-      float cameraExposure = view->getCameraExposureSetting();
-      float ev = std::log2(1.0 / cameraExposure);
-      float exposureCompensation = medianCameraExposure / cameraExposure;
-      metadata.push_back(oiio::ParamValue("AliceVision:EV", ev));
-      metadata.push_back(oiio::ParamValue("AliceVision:EVComp", exposureCompensation));
-
-      //exposure correction
-      if(evCorrection)
-      {
-          ALICEVISION_LOG_INFO("View: " << viewId << ", Ev: " << ev << ", Ev compensation: " << exposureCompensation);
-
-          for(int pix = 0; pix < image.Width() * image.Height(); ++pix)
-              image(pix) = image(pix) * exposureCompensation;
+    // export undistorted image
+    const std::string dstColorImage = (fs::path(outFolder) / (baseFilename + "." + image::EImageFileType_enumToString(outputFileType))).string();
+    writeImage(dstColorImage, item.image, image::EImageColorSpace::AUTO, item.metadata);
+  });
 
-      }
-      
-      // undistort
-      if(cam->isValid() && cam->have_disto())
-      {
-        // undistort the image and save it
-        UndistortImage(image, cam, image_ud, FBLACK);
-        writeImage(dstColorImage, image_ud, image::EImageColorSpace::AUTO, metadata);
-      }
-      else
-      {
-        writeImage(dstColorImage, image, image::EImageColorSpace::AUTO, metadata);
-      }
-    }
+  pipeline.setItemDoneCallback([&](std::size_t index) { ++progressBar; });
 
-    #pragma omp critical
-    ++progressBar;
-  }
+  pipeline.run(viewIdsToExport.size());
+  pipeline.logStats();
 
   return true;
 }
@@ -245,6 +311,9 @@ int main(int argc, char *argv[])
   bool saveMetadata = true;
   bool saveMatricesTxtFiles = false;
   bool evCorrection = false;
+  int nbDecodeThreads = 3;
+  int nbEncodeThreads = 2;
+  int maxInFlightImages = 8;
 
   po::options_description allParams("AliceVision prepareDenseScene");
 
@@ -271,7 +340,13 @@ int main(int argc, char *argv[])
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
       "Range size.")
     ("evCorrection", po::value<bool>(&evCorrection)->default_value(evCorrection),
-      "Correct exposure value.");
+      "Correct exposure value.")
+    ("nbDecodeThreads", po::value<int>(&nbDecodeThreads)->default_value(nbDecodeThreads),
+      "Number of threads reading the source images.")
+    ("nbEncodeThreads", po::value<int>(&nbEncodeThreads)->default_value(nbEncodeThreads),
+      "Number of threads writing the output images.")
+    ("maxInFlightImages", po::value<int>(&maxInFlightImages)->default_value(maxInFlightImages),
+      "Maximum number of images loaded in memory at the same time.");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -349,7 +424,8 @@ int main(int argc, char *argv[])
   }
 
   // export
-  if(prepareDenseScene(sfmData, imagesFolders, rangeStart, rangeEnd, outFolder, outputFileType, saveMetadata, saveMatricesTxtFiles, evCorrection))
+  if(prepareDenseScene(sfmData, imagesFolders, rangeStart, rangeEnd, outFolder, outputFileType, saveMetadata, saveMatricesTxtFiles, evCorrection,
+                       nbDecodeThreads, nbEncodeThreads, maxInFlightImages))
     return EXIT_SUCCESS;
 
   return EXIT_FAILURE;
@@ -0,0 +1,206 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfm/sfm.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/types.hpp>
+#include <aliceVision/config.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstdlib>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+/**
+ * @brief Global bundle adjustment of the merged reconstruction, with outliers removal.
+ * @param[in,out] sfmData the merged reconstruction
+ * @param[in] lockAllIntrinsics if true, the intrinsics are not refined
+ * @return true if the bundle adjustment succeeded
+ */
+bool refineMergedReconstruction(sfmData::SfMData& sfmData, bool lockAllIntrinsics)
+{
+  sfm::BundleAdjustmentCeres::CeresOptions options;
+
+  if(sfmData.getPoses().size() > 100)
+    options.setSparseBA();
+  else
+    options.setDenseBA();
+
+  sfm::BundleAdjustmentCeres BA(options);
+
+  sfm::BundleAdjustment::ERefineOptions refineOptions = sfm::BundleAdjustment::REFINE_ROTATION | sfm::BundleAdjustment::REFINE_TRANSLATION | sfm::BundleAdjustment::REFINE_STRUCTURE;
+  if(!lockAllIntrinsics)
+    refineOptions |= sfm::BundleAdjustment::REFINE_INTRINSICS_ALL;
+
+  if(!BA.adjust(sfmData, refineOptions))
+    return false;
+
+  // remove outliers (max_angle, residual error)
+  const std::size_t nbLandmarksInitial = sfmData.getLandmarks().size();
+  sfm::RemoveOutliers_PixelResidualError(sfmData, 4.0);
+  const std::size_t nbLandmarksPixelResidualFilter = sfmData.getLandmarks().size();
+  sfm::RemoveOutliers_AngleError(sfmData, 2.0);
+  const std::size_t nbLandmarksAngularFilter = sfmData.getLandmarks().size();
+
+  ALICEVISION_LOG_INFO("Outlier removal (remaining points):\n"
+                       "\t- # landmarks initial: " << nbLandmarksInitial << "\n"
+                       "\t- # landmarks after pixel residual filter: " << nbLandmarksPixelResidualFilter << "\n"
+                       "\t- # landmarks after angular filter: " << nbLandmarksAngularFilter);
+
+  // check that poses & intrinsic cover some measures (after outlier removal)
+  const IndexT minPointPerPose = 12;
+  const IndexT minTrackLength = 3;
+
+  if(sfm::eraseUnstablePosesAndObservations(sfmData, minPointPerPose, minTrackLength))
+    ALICEVISION_LOG_INFO("# landmarks after eraseUnstablePosesAndObservations: " << sfmData.getLandmarks().size());
+
+  return BA.adjust(sfmData, refineOptions);
+}
+
+int main(int argc, char **argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string sfmDataFilename;
+  std::vector<std::string> reconstructionFilenames;
+  std::string outputSfM;
+
+  // user optional parameters
+
+  sfm::ReconstructionMergingParams mergingParams;
+  bool refine = true;
+  bool lockAllIntrinsics = false;
+
+  po::options_description allParams(
+    "Merge sub-reconstructions (e.g. computed independently on the clusters of sfmPartitioning).\n"
+    "The sub-reconstructions are aligned on their common cameras and refined with a global bundle adjustment.\n"
+    "AliceVision sfmMerge");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
+      "SfMData file with all the views.")
+    ("inputReconstructions", po::value<std::vector<std::string>>(&reconstructionFilenames)->multitoken()->required(),
+      "Path to the SfMData files of the sub-reconstructions.")
+    ("output,o", po::value<std::string>(&outputSfM)->required(),
+      "Path to the output SfMData file.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("minNbCommonViews", po::value<std::size_t>(&mergingParams.minNbCommonViews)->default_value(mergingParams.minNbCommonViews),
+      "Minimum number of reconstructed views shared with the merged scene to align a sub-reconstruction.")
+    ("refine", po::value<bool>(&refine)->default_value(refine),
+      "Refine the merged reconstruction with a global bundle adjustment.")
+    ("lockAllIntrinsics", po::value<bool>(&lockAllIntrinsics)->default_value(lockAllIntrinsics),
+      "Force lock of all camera intrinsic parameters, so they will not be refined during Bundle Adjustment.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  // load input SfMData scene
+  sfmData::SfMData sfmData;
+  if(!sfmDataIO::Load(sfmData, sfmDataFilename, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::INTRINSICS|sfmDataIO::EXTRINSICS)))
+  {
+    ALICEVISION_LOG_ERROR("The input SfMData file '" + sfmDataFilename + "' cannot be read.");
+    return EXIT_FAILURE;
+  }
+
+  // load sub-reconstructions
+  std::vector<sfmData::SfMData> reconstructions(reconstructionFilenames.size());
+  for(std::size_t i = 0; i < reconstructionFilenames.size(); ++i)
+  {
+    if(!sfmDataIO::Load(reconstructions.at(i), reconstructionFilenames.at(i), sfmDataIO::ESfMData::ALL))
+    {
+      ALICEVISION_LOG_ERROR("The input SfMData file '" + reconstructionFilenames.at(i) + "' cannot be read.");
+      return EXIT_FAILURE;
+    }
+  }
+
+  aliceVision::system::Timer timer;
+
+  if(sfm::mergeReconstructions(sfmData, reconstructions, mergingParams) == 0)
+  {
+    ALICEVISION_LOG_ERROR("No sub-reconstruction can be merged.");
+    return EXIT_FAILURE;
+  }
+
+  // free the sub-reconstructions before the bundle adjustment
+  reconstructions.clear();
+
+  ALICEVISION_LOG_INFO("Merging took (s): " + std::to_string(timer.elapsed()));
+
+  if(refine)
+  {
+    timer.reset();
+    if(!refineMergedReconstruction(sfmData, lockAllIntrinsics))
+      ALICEVISION_LOG_WARNING("Global bundle adjustment of the merged reconstruction failed.");
+    ALICEVISION_LOG_INFO("Global bundle adjustment took (s): " + std::to_string(timer.elapsed()));
+  }
+
+  // features / matches folders are stored relatively to the output file
+  sfmData.setAbsolutePath(outputSfM);
+
+  // export to disk computed scene (data & visualizable results)
+  ALICEVISION_LOG_INFO("Export SfMData to disk: " + outputSfM);
+
+  if(!sfmDataIO::Save(sfmData, outputSfM, sfmDataIO::ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("The output SfMData file '" << outputSfM << "' cannot be written.");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,218 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp>
+#include <aliceVision/sfm/pipeline/hierarchical/viewGraphPartitioning.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/types.hpp>
+#include <aliceVision/config.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+/**
+ * @brief Get the SfMData of a cluster: the cluster views with their intrinsics and rigs, without poses and structure.
+ * @param[in] sfmData the input SfMData
+ * @param[in] viewIds the cluster view ids
+ * @return the cluster SfMData
+ */
+sfmData::SfMData getClusterSfMData(const sfmData::SfMData& sfmData, const std::set<IndexT>& viewIds)
+{
+  sfmData::SfMData clusterSfmData;
+
+  for(const IndexT viewId : viewIds)
+  {
+    const std::shared_ptr<sfmData::View>& view = sfmData.getViews().at(viewId);
+    clusterSfmData.views.emplace(viewId, std::make_shared<sfmData::View>(*view));
+
+    if(sfmData.getIntrinsics().count(view->getIntrinsicId()))
+      clusterSfmData.intrinsics[view->getIntrinsicId()] = std::shared_ptr<camera::IntrinsicBase>(sfmData.getIntrinsics().at(view->getIntrinsicId())->clone());
+
+    if(view->isPartOfRig())
+      clusterSfmData.getRigs()[view->getRigId()] = sfmData.getRigs().at(view->getRigId());
+  }
+  return clusterSfmData;
+}
+
+int main(int argc, char **argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string sfmDataFilename;
+  std::vector<std::string> featuresFolders;
+  std::vector<std::string> matchesFolders;
+  std::string outputFolder;
+
+  // user optional parameters
+
+  std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+  std::string clusterFileExtension = ".sfm";
+  sfm::ViewGraphPartitioningParams partitioningParams;
+  bool useOnlyMatchesFromInputFolder = false;
+
+  po::options_description allParams(
+    "Partition the view graph into overlapping clusters of views.\n"
+    "Each cluster can be reconstructed independently (e.g. with incrementalSfM) and the sub-reconstructions merged with sfmMerge.\n"
+    "AliceVision sfmPartitioning");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
+      "SfMData file.")
+    ("output,o", po::value<std::string>(&outputFolder)->required(),
+      "Output folder for the SfMData file of each cluster.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("featuresFolders,f", po::value<std::vector<std::string>>(&featuresFolders)->multitoken(),
+      "Path to folder(s) containing the extracted features, added to the cluster SfMData files.")
+    ("matchesFolders,m", po::value<std::vector<std::string>>(&matchesFolders)->multitoken(),
+      "Path to folder(s) in which computed matches are stored.")
+    ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
+      feature::EImageDescriberType_informations().c_str())
+    ("maxClusterSize", po::value<std::size_t>(&partitioningParams.maxClusterSize)->default_value(partitioningParams.maxClusterSize),
+      "Maximum number of views per cluster (before adding the overlapping views).")
+    ("overlapRatio", po::value<double>(&partitioningParams.overlapRatio)->default_value(partitioningParams.overlapRatio),
+      "Ratio of poses added to each cluster from its neighbor clusters.")
+    ("minOverlapSize", po::value<std::size_t>(&partitioningParams.minOverlapSize)->default_value(partitioningParams.minOverlapSize),
+      "Minimum number of poses shared with each connected neighbor cluster.")
+    ("minNumberOfMatches", po::value<std::size_t>(&partitioningParams.minNbMatches)->default_value(partitioningParams.minNbMatches),
+      "Minimum number of matches for an image pair to connect the two views. 0 means no limit.")
+    ("minClusterSize", po::value<std::size_t>(&partitioningParams.minClusterSize)->default_value(partitioningParams.minClusterSize),
+      "Connected components with less poses are ignored.")
+    ("clusterFileExtension", po::value<std::string>(&clusterFileExtension)->default_value(clusterFileExtension),
+      "Extension of the cluster SfMData files.")
+    ("useOnlyMatchesFromInputFolder", po::value<bool>(&useOnlyMatchesFromInputFolder)->default_value(useOnlyMatchesFromInputFolder),
+      "Use only matches from the input matchesFolder parameter.\n"
+      "Matches folders previously added to the SfMData file will be ignored.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  // load input SfMData scene
+  sfmData::SfMData sfmData;
+  if(!sfmDataIO::Load(sfmData, sfmDataFilename, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::INTRINSICS|sfmDataIO::EXTRINSICS)))
+  {
+    ALICEVISION_LOG_ERROR("The input SfMData file '" + sfmDataFilename + "' cannot be read.");
+    return EXIT_FAILURE;
+  }
+
+  // get imageDescriber type
+  const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
+
+  // matches reading
+  matching::PairwiseMatches pairwiseMatches;
+  if(!sfm::loadPairwiseMatches(pairwiseMatches, sfmData, matchesFolders, describerTypes, 0, 0, useOnlyMatchesFromInputFolder))
+  {
+    ALICEVISION_LOG_ERROR("Unable to load matches.");
+    return EXIT_FAILURE;
+  }
+
+  aliceVision::system::Timer timer;
+
+  std::vector<std::set<IndexT>> clusters;
+  sfm::partitionViewGraph(sfmData, pairwiseMatches, partitioningParams, clusters);
+
+  if(clusters.empty())
+  {
+    ALICEVISION_LOG_ERROR("No cluster found: the view graph has no connected component of at least " << partitioningParams.minClusterSize << " poses.");
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_LOG_INFO("View graph partitioning took (s): " + std::to_string(timer.elapsed()));
+
+  if(!fs::exists(outputFolder))
+    fs::create_directory(outputFolder);
+
+  // features / matches folders are given as absolute paths, they are stored relatively to each cluster file
+  std::vector<std::string> absoluteFeaturesFolders = sfmData.getFeaturesFolders();
+  std::vector<std::string> absoluteMatchesFolders;
+
+  if(!useOnlyMatchesFromInputFolder)
+    absoluteMatchesFolders = sfmData.getMatchesFolders();
+
+  for(const std::string& folder : featuresFolders)
+    absoluteFeaturesFolders.push_back(fs::absolute(folder).string());
+  for(const std::string& folder : matchesFolders)
+    absoluteMatchesFolders.push_back(fs::absolute(folder).string());
+
+  for(std::size_t c = 0; c < clusters.size(); ++c)
+  {
+    std::stringstream ss;
+    ss << "cluster_" << std::setw(4) << std::setfill('0') << c << clusterFileExtension;
+    const std::string clusterFilename = fs::absolute(fs::path(outputFolder) / ss.str()).string();
+
+    sfmData::SfMData clusterSfmData = getClusterSfMData(sfmData, clusters.at(c));
+    clusterSfmData.setAbsolutePath(clusterFilename);
+    clusterSfmData.addFeaturesFolders(absoluteFeaturesFolders);
+    clusterSfmData.addMatchesFolders(absoluteMatchesFolders);
+
+    ALICEVISION_LOG_INFO("Export cluster " << c << " (" << clusters.at(c).size() << " views): " << clusterFilename);
+
+    if(!sfmDataIO::Save(clusterSfmData, clusterFilename, sfmDataIO::ESfMData::ALL))
+    {
+      ALICEVISION_LOG_ERROR("The output SfMData file '" << clusterFilename << "' cannot be written.");
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -16,7 +16,9 @@
 #include <aliceVision/mvsUtils/ImagesCache.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Tracer.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -24,7 +26,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 3
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -41,6 +43,8 @@ int main(int argc, char* argv[])
     system::Timer timer;
 
     std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+    std::string traceFile;
+    std::size_t maxMemory = 0;
     std::string sfmDataFilename;
     std::string inputMeshFilepath;
     std::string outputFolder;
@@ -116,7 +120,12 @@ int main(int argc, char* argv[])
     po::options_description logParams("Log parameters");
     logParams.add_options()
       ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
-        "verbosity level (fatal, error, warning, info, debug, trace).");
+        "verbosity level (fatal, error, warning, info, debug, trace).")
+      ("traceFile", po::value<std::string>(&traceFile)->default_value(traceFile),
+        "Record a trace of the processing and export it to this file (Chrome trace / Perfetto JSON).")
+      ("maxMemory", po::value<std::size_t>(&maxMemory)->default_value(maxMemory),
+        "Maximum memory usage in MB (0: no limit, use the free RAM). Caches and chunked processing are sized accordingly.\n"
+        "The peak memory usage is reported at exit.");
 
     allParams.add(requiredParams).add(optionalParams).add(logParams);
 
@@ -153,6 +162,12 @@ int main(int argc, char* argv[])
     // set verbose level
     system::Logger::get()->setLogLevel(verboseLevel);
 
+    // record a trace of the processing if requested
+    system::TraceFile traceFileExport(traceFile);
+
+    // memory budget of the caches and chunked processing, report the memory usage at exit
+    system::MemoryBudgetScope memoryBudgetScope(maxMemory);
+
     texParams.visibilityRemappingMethod = mesh::EVisibilityRemappingMethod_stringToEnum(visibilityRemappingMethod);
     texParams.processColorspace = imageIO::EImageColorSpace_stringToEnum(processColorspaceName);
     // set output texture file type